@@ -0,0 +1,65 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+# (c) Camille Scott, 2026
+# File   : build-ukhs-tables.py
+# License: MIT
+# Author : Camille Scott <camille.scott.w@gmail.com>
+# Date   : 18.10.2026
+
+# Convert the gzipped text UKHS distribution into the binary tables read
+# by UKHS::load. The format must match UKHS::save in ukhs.cc.
+
+import argparse
+import glob
+import gzip
+import os
+import re
+import struct
+import sys
+
+
+TABLE_MAGIC   = b'GUKHS\0\0\0'
+TABLE_VERSION = 1
+
+CODES = {'A': 0, 'C': 1, 'G': 2, 'T': 3}
+
+
+def encode(unikmer):
+    code = 0
+    for symbol in unikmer.upper():
+        code = (code << 2) | CODES.get(symbol, 0)
+    return code
+
+
+def convert(text_path, table_path):
+    K, W = map(int, re.match(r'res_(\d+)_(\d+)_4_0\.txt\.gz$',
+                             os.path.basename(text_path)).groups())
+    with gzip.open(text_path, 'rt') as fp:
+        codes = [encode(line.strip()) for line in fp if line.strip()]
+
+    tmp_path = table_path + '.tmp'
+    with open(tmp_path, 'wb') as fp:
+        fp.write(TABLE_MAGIC)
+        fp.write(struct.pack('<HHHQ', TABLE_VERSION, W, K, len(codes)))
+        fp.write(struct.pack('<{0}Q'.format(len(codes)), *codes))
+    os.replace(tmp_path, table_path)
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('data_dir')
+    parser.add_argument('--force', action='store_true',
+                        help='Rebuild tables which are already up to date.')
+    args = parser.parse_args()
+
+    for text_path in sorted(glob.glob(os.path.join(args.data_dir, 'res_*_4_0.txt.gz'))):
+        table_path = text_path[:-len('.txt.gz')] + '.ukhs'
+        if not args.force and os.path.exists(table_path) and \
+           os.path.getmtime(table_path) >= os.path.getmtime(text_path):
+            continue
+        print('Building', table_path, file=sys.stderr)
+        convert(text_path, table_path)
+
+
+if __name__ == '__main__':
+    main()
@@ -115,7 +115,8 @@ find_library(LibCling_LIBRARY libCling.so PATHS ${Cppyy_DIR}/lib)
 #
 #   COMPILE_OPTIONS option
 #                       Options which are to be passed into the compile/link
-#                       command.
+#                       command. Also passed to genreflex, so that definitions
+#                       are seen when the dictionary is generated.
 #
 #   INCLUDE_DIRS dir    Include directories.
 #
@@ -174,7 +175,8 @@ function(cppyy_add_bindings pkg)
     # Set up genreflex args.
     #
     set(genreflex_cxxflags "--extra-cxxflags")
-    list(APPEND genreflex_cxxflags "-std=c++${ARG_LANGUAGE_STANDARD} -march=native")
+    string(REPLACE ";" " " genreflex_compile_options "${ARG_COMPILE_OPTIONS}")
+    list(APPEND genreflex_cxxflags "-std=c++${ARG_LANGUAGE_STANDARD} -march=native ${genreflex_compile_options}")
 
     set(genreflex_args)
     if("${ARG_INTERFACE_FILE}" STREQUAL "")
@@ -18,6 +18,8 @@ from goetia.timer import time_block
 
 cDBG = libgoetia.cDBG
 StreamingCompactor = libgoetia.StreamingCompactor
+StaticCompactor = libgoetia.StaticCompactor
+UnitigMapper = libgoetia.UnitigMapper
 
 
 def quick_compactor(K):
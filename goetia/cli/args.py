@@ -58,6 +58,18 @@ def get_output_interval_args(parser):
     return group
 
 
+def get_profiling_args(parser):
+    parser.add_argument('--perf-counters', action='store_true', default=False,
+                        help='Count hardware events (cycles, instructions, cache, TLB and'
+                             ' branch misses) in the parse, hash, storage and compactor'
+                             ' stages, and report them with each interval.')
+    parser.add_argument('--latencies', action='store_true', default=False,
+                        help='Record per-read latency histograms of the same stages, and'
+                             ' report their p50, p99, p999 and max with each interval'
+                             ' and sample.')
+    return parser
+
+
 def print_interval_settings(args):
     print('* Sequence parser interval:', args.interval, file=sys.stderr)
     print('*', '*' * 10, '*', sep='\n', file=sys.stderr)
@@ -25,7 +25,7 @@ from goetia.metadata import CUR_TIME
 from goetia.serialization import cDBGSerialization
 from goetia.utils import Counter
 
-from goetia.cli.args import get_output_interval_args, print_interval_settings
+from goetia.cli.args import get_output_interval_args, get_profiling_args, print_interval_settings
 from goetia.cli.runner import CommandRunner
 
 import blessings
@@ -50,7 +50,7 @@ class cDBGRunner(CommandRunner):
     def __init__(self, parser):
         get_graph_args(parser)
         get_cdbg_args(parser)
-        get_output_interval_args(parser)
+        get_profiling_args(get_output_interval_args(parser))
 
         group = get_fastx_args(parser)
         group.add_argument('-o', dest='output_filename', default='/dev/stdout')
@@ -146,7 +146,9 @@ class cDBGRunner(CommandRunner):
         # Iterator over samples (pairs or singles, depending on pairing-mode)
         sample_iter = iter_fastx_inputs(args.inputs, args.pairing_mode, names=args.names)
         # AsyncSequenceProcessor does event management and callback for the FileProcessors
-        self.processor = AsyncSequenceProcessor(self.file_processor, sample_iter, args.echo)
+        self.processor = AsyncSequenceProcessor(self.file_processor, sample_iter, args.echo,
+                                                perf_counters=args.perf_counters,
+                                                latencies=args.latencies)
         # Subscribe a listener to the FileProcessor producer
         self.worker_listener = self.processor.add_listener('worker_q', 'cdbg.consumer')
 
@@ -320,7 +322,9 @@ def get_cdbg_args(parser):
     group.add_argument('--unitig-bp-bins',
                         nargs='+',
                         type=int,
-                        help='Bin sizes of distribution.')
+                        help='Edges of the unitig length bins, in bases. Edges under '
+                             '4096 are counted exactly; larger ones are rounded to the '
+                             'length histogram\'s buckets, within 1/16 of their length.')
     group.add_argument('--unitig-bp-tick',
                        type=int,
                        default=10)
@@ -19,9 +19,10 @@ from cppyy.gbl import std
 
 from goetia import libgoetia
 from goetia.hashing import Canonical, StrandAware
-from goetia.sketches import UnikmerSketch
+from goetia.sketches import UnikmerSketch, UnikmerSketchBuilder
 from goetia.signatures import DraffSignature
-from goetia.storage import get_storage_args, process_storage_args
+from goetia.storage import (get_partitioned_storage_args, process_storage_args,
+                            BTreeStorage, HLLStorage, PHMapStorage, SparseppSetStorage)
 from goetia.cli.cli import format_filenames
 from goetia.cli.signature_runner import SignatureRunner
 
@@ -62,11 +63,15 @@ class DraffStreamFrame:
 class DraffRunner(SignatureRunner):
 
     def __init__(self, parser):
-        get_storage_args(parser)
+        get_partitioned_storage_args(parser)
         parser.add_argument('-W', type=int, default=31)
         parser.add_argument('-K', type=int, default=9)
         parser.add_argument('--prefix', nargs='*')
         parser.add_argument('--merge')
+        parser.add_argument('--threads', type=int, default=1,
+                            help='Build the sketch with this many threads; 0 uses '
+                                 'all cores. Only the set and HLL storage types '
+                                 'support more than one.')
         parser.add_argument('--distance-metric', default='cosine',
                             choices=['cosine', 'euclidean', 'canberra', 'braycurtis',
                                      'chebyshev', 'correlation', 'minkowski',
@@ -78,6 +83,9 @@ class DraffRunner(SignatureRunner):
     def postprocess_args(self, args):
         process_storage_args(args)
         args.sketch_t = UnikmerSketch[args.storage, StrandAware]
+        if args.threads != 1 and args.storage not in (BTreeStorage, HLLStorage,
+                                                      PHMapStorage, SparseppSetStorage):
+            raise ValueError('--threads requires a set or HLL storage type')
         super().postprocess_args(args)
         self._distance_metric = getattr(dmetrics, args.distance_metric)
     
@@ -91,8 +99,23 @@ class DraffRunner(SignatureRunner):
     
     @staticmethod
     def _make_processor(signature, args):
+        if args.threads != 1:
+            return UnikmerSketchBuilder[args.storage, StrandAware].build(signature,
+                                                                         args.threads,
+                                                                         args.interval)
         return args.sketch_t.Processor.build(signature,
                                              args.interval)
+
+    @staticmethod
+    def _make_saturation(signature, args):
+        # the native tracker only implements cosine distance
+        if args.distance_metric != 'cosine':
+            return None
+        return args.sketch_t.Saturation.build(signature,
+                                              args.window_size,
+                                              args.cutoff,
+                                              args.smoothing_function,
+                                              args.cutoff_function)
     
     @staticmethod
     def _convert_signature(sketch, msg):
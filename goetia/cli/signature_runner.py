@@ -13,8 +13,8 @@ import blessings
 import curio
 import numpy as np
 
-from goetia import __version__
-from goetia.cli.args import get_output_interval_args
+from goetia import __version__, libgoetia
+from goetia.cli.args import get_output_interval_args, get_profiling_args
 from goetia.cli.runner import CommandRunner
 from goetia.cli.signature_frame import SignatureStreamFrame
 from goetia.cli.status import StatusOutput
@@ -44,7 +44,7 @@ from goetia.utils import Counter, Namespace
 class SignatureRunner(CommandRunner):
 
     def __init__(self, parser, description=''):
-        get_output_interval_args(parser)
+        get_profiling_args(get_output_interval_args(parser))
         group = get_fastx_args(parser)
         group.add_argument('-i', dest='inputs', nargs='+', required=True)
 
@@ -115,6 +115,15 @@ class SignatureRunner(CommandRunner):
     def _make_processor(signature, args):
         raise NotImplementedError()
 
+    @staticmethod
+    def _make_saturation(signature, args):
+        """ Build a native saturation tracker for the signature, which computes
+        interval distances, smoothing and cutoffs in libgoetia without
+        copying the signature out at each interval. Returns None
+        to fall back to the Python distance function.
+        """
+        return None
+
     @staticmethod
     def _convert_signature(sig, msg):
         return sig
@@ -129,11 +138,18 @@ class SignatureRunner(CommandRunner):
 
     @staticmethod
     def _on_interval(msg, events_q, args, runner):
+        runner.last_interval = msg
+        if runner.saturation is not None:
+            # checked natively on the processing thread, which publishes
+            # the DistanceCalc and SampleSaturated events itself
+            return
+
         sig = runner._convert_signature(runner.signature, msg)
         distance, _ = runner.sigs.push((sig, msg.t))
-
         if not np.isnan(distance):
             cutoff_reached, stat, _ = runner.cutoff.push((distance, msg.t))
+
+        if not np.isnan(distance):
             #runner.status.update(msg.t, msg.sequence, distance)
 
             if not np.isnan(stat):
@@ -142,7 +158,7 @@ class SignatureRunner(CommandRunner):
                                        sequence=msg.sequence,
                                        distance=distance,
                                        stat=stat,
-                                       stat_type=runner.cutoff.name,
+                                       stat_type=runner.stat_type,
                                        file_names=msg.file_names,
                                        seconds_elapsed_total=msg.seconds_elapsed_total,
                                        seconds_elapsed_sample=msg.seconds_elapsed_sample,
@@ -156,9 +172,16 @@ class SignatureRunner(CommandRunner):
                                              file_names=msg.file_names))
                 runner.processor.saturate()
 
+    def _current_signature(self):
+        if self.saturation is None:
+            return self.sigs.tail()
+        if self.last_interval is None:
+            return None
+        return self._convert_signature(self.signature, self.last_interval)
+
     @staticmethod
     async def _stream_write(msg, args, runner):
-        await runner.signature_stream.write(runner._serialize_signature(runner.sigs.tail(), args))
+        await runner.signature_stream.write(runner._serialize_signature(runner._current_signature(), args))
     
     def setup(self, args):
         # Create the signature and the libgoetia sequence processor: implemented by subclass
@@ -168,8 +191,16 @@ class SignatureRunner(CommandRunner):
         # Pass the libgoetia processor over the async handler
         self.processor = AsyncSequenceProcessor(signature_processor,
                                                 iter_fastx_inputs(args.inputs, args.pairing_mode, names=args.names),
-                                                echo=args.echo)
+                                                echo=args.echo,
+                                                perf_counters=args.perf_counters,
+                                                latencies=args.latencies)
         
+        self.last_interval = None
+
+        # Prefer the native tracker, which diffs the signature in place; it
+        # handles distances, smoothing and the cutoff on its own
+        self.saturation = self._make_saturation(self.signature, args)
+
         # Signatures: held in a RollingPairwise, stores the signatures themselves (if desired)
         # and calls the distance function
         self.sigs = RollingPairwise(self._distance_func, history = 1)
@@ -179,6 +210,15 @@ class SignatureRunner(CommandRunner):
         self.cutoff = SlidingCutoff(args.window_size,
                                     args.smoothing_function_func,
                                     args.cutoff_function_func)
+        if self.saturation is not None:
+            self.stat_type = f'SaturationWindow(smoothing={args.smoothing_function}, '\
+                             f'cutoff={args.cutoff_function}, L={args.window_size})'
+            check_t = libgoetia.SaturationCheck[type(self.saturation)]
+            self.processor.event_bus.subscribe(check_t.build(self.saturation, args.saturate),
+                                               True)
+            self.processor.distance_stat_type = self.stat_type
+        else:
+            self.stat_type = self.cutoff.name
 
         #
         # Set up the event handlers. We set up two listeners:
@@ -215,7 +255,9 @@ class SignatureRunner(CommandRunner):
         if args.save_sig:
             #if args.save_stream:
             #    self._save_signatures(self.sigs.values(), args)
-            self._save_signature(self.sigs.tail(), args)
+            sig = self._current_signature()
+            if sig is not None:
+                self._save_signature(sig, args)
 
     def teardown(self):
         pass
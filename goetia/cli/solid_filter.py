@@ -14,7 +14,9 @@ from goetia.dbg import get_graph_args, process_graph_args
 from goetia.cli.args import get_output_interval_args
 from goetia.cli.runner import CommandRunner
 from goetia.parsing import get_fastx_args, iter_fastx_inputs
-from goetia.storage import get_storage_args
+from goetia.processors import JSONStreamWriter
+from goetia.sketches import AbundanceSpectrum
+from goetia.storage import get_storage_args, ByteStorage, NibbleStorage
 from goetia.utils import Counter
 
 import blessings
@@ -39,11 +41,24 @@ class SolidFilterRunner(CommandRunner):
         group.add_argument('--quiet', action='store_true', default=False)
         parser.add_argument('-C', '--solid-min-count', type=int, default=1)
         parser.add_argument('-P', '--solid-min-proportion', type=float, default=.75)
+        parser.add_argument('--spectrum', nargs='?', const='goetia.spectrum.json',
+                            help='Write the k-mer abundance spectrum at each interval. '
+                                 'Counted exactly for storages which can be enumerated, '
+                                 'and estimated from a subsample of k-mers otherwise. '
+                                 'Requires a counting storage.')
+        parser.add_argument('--spectrum-max-entries', type=int, default=1 << 16,
+                            help='Most distinct k-mers to keep in the spectrum subsample.')
+        parser.add_argument('--spectrum-max-abundance', type=int, default=255)
+        parser.add_argument('--threads', type=int, default=0,
+                            help='Threads for counting an exact spectrum; 0 uses all cores.')
 
         super().__init__(parser, description=desc)
 
     def postprocess_args(self, args):
         process_graph_args(args)
+        # set storages hold every k-mer once, so their spectrum is meaningless
+        if args.spectrum and not args.storage.is_counting:
+            raise ValueError('--spectrum requires a counting storage type')
 
     def setup(self, args):
         self.dbg_t       = args.graph_t
@@ -60,6 +75,29 @@ class SolidFilterRunner(CommandRunner):
                                                        args.interval)
         self.status = SolidFilterRunner.StatusOutput(term=self.term, quiet=args.quiet)
 
+        self.spectrum = None
+        if args.spectrum:
+            self.spectrum_stream = JSONStreamWriter(args.spectrum)
+            # count-min sketches can't be enumerated, so their spectrum is sampled
+            if args.storage in (ByteStorage, NibbleStorage):
+                self.spectrum = AbundanceSpectrum.build(args.spectrum_max_entries,
+                                                        args.spectrum_max_abundance)
+                self.solid_filter.set_spectrum(self.spectrum)
+
+    def write_spectrum(self, args, t, n_seqs):
+        if self.spectrum is not None:
+            hist = list(self.spectrum.histogram())
+            fraction = self.spectrum.sample_fraction()
+        else:
+            hist = list(AbundanceSpectrum.exact(self.storage,
+                                                args.spectrum_max_abundance,
+                                                args.threads))
+            fraction = 1.0
+        self.spectrum_stream.write({'t': t,
+                                    'seq_t': n_seqs,
+                                    'sample_fraction': fraction,
+                                    'spectrum': hist})
+
     class StatusOutput:
 
         def __init__(self, term=None, file=sys.stderr, quiet=False):
@@ -100,6 +138,8 @@ class SolidFilterRunner(CommandRunner):
             self.status.start_sample(name, sample)
             for n_seqs, time, n_skipped in self.processor.chunked_process(*sample):
                 self.status.update(time, n_seqs, self.processor.n_passed(), n_skipped)
+                if args.spectrum:
+                    self.write_spectrum(args, time, n_seqs)
             self.status.finish_sample()
 
     def teardown(self):
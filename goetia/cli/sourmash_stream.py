@@ -12,7 +12,7 @@ from sourmash.utils import decode_str, rustcall
 
 from goetia.cli.cli import format_filenames
 from goetia.cli.signature_runner import SignatureRunner
-from goetia.sketches import SourmashSketch
+from goetia.sketches import FracMinHash, SourmashSketch
 
 
 desc = '''
@@ -43,15 +43,29 @@ class SourmashRunner(SignatureRunner):
     @staticmethod
     def _make_signature(args):
         if args.scaled:
-            return SourmashSketch.Sketch.build(0, args.K, False, False, False, 42, args.scaled)
+            return FracMinHash.Sketch.build(args.K, args.scaled)
         else:
             return SourmashSketch.Sketch.build(args.N, args.K, False, False, False, 42, 0)
 
     @staticmethod
     def _make_processor(signature, args):
+        if args.scaled:
+            return FracMinHash.Processor.build(signature,
+                                               args.interval)
         return SourmashSketch.Processor.build(signature,
                                               args.interval)
 
+    @staticmethod
+    def _make_saturation(signature, args):
+        # only scaled sketches have a native tracker
+        if not args.scaled:
+            return None
+        return FracMinHash.Saturation.build(signature,
+                                            args.window_size,
+                                            args.cutoff,
+                                            args.smoothing_function,
+                                            args.cutoff_function)
+
     def _distance_func(self, sigs):
         sig_a, sig_b = sigs
         sim = sig_a.similarity(sig_b)
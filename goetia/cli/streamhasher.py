@@ -10,7 +10,7 @@ import curio
 
 from goetia import libgoetia
 from goetia.cli.runner import CommandRunner
-from goetia.cli.args import get_output_interval_args
+from goetia.cli.args import get_output_interval_args, get_profiling_args
 from goetia.cli.status import StatusOutput
 from goetia.dbg import get_graph_args, process_graph_args
 from goetia.messages import (Interval,
@@ -30,7 +30,7 @@ desc = '''
 class StreamHasherRunner(CommandRunner):
     
     def __init__(self, parser):
-        get_output_interval_args(parser)
+        get_profiling_args(get_output_interval_args(parser))
         get_graph_args(parser)
         group = get_fastx_args(parser)
         group.add_argument('-i', dest='inputs', nargs='+', required=True)
@@ -61,7 +61,9 @@ class StreamHasherRunner(CommandRunner):
                                                             args.interval)
 
         sample_iter = iter_fastx_inputs(args.inputs, args.pairing_mode, names=args.names)
-        self.processor = AsyncSequenceProcessor(self.ll_processor, sample_iter)
+        self.processor = AsyncSequenceProcessor(self.ll_processor, sample_iter,
+                                                perf_counters=args.perf_counters,
+                                                latencies=args.latencies)
 
         self.worker_listener = self.processor.add_listener('worker_q', 'consumer')
         
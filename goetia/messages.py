@@ -8,7 +8,7 @@
 
 from dataclasses import dataclass, field, is_dataclass
 from enum import Enum, Flag, IntEnum, auto
-from typing import List
+from typing import Dict, List
 
 from mashumaro.mixins.yaml import DataClassYAMLMixin
 from mashumaro.mixins.msgpack import DataClassMessagePackMixin
@@ -43,6 +43,10 @@ class Interval(AllMessages, DataClassYAMLMixin, DataClassMessagePackMixin):
     seconds_elapsed_sample: float = 0
     seconds_elapsed_interval: float = 0
     modulus: int = 0
+    # scope name -> hardware event name -> count, when profiling
+    perf_counters: Dict[str, Dict[str, int]] = field(default_factory=dict)
+    # scope name -> count, mean, p50, p99, p999 and max, in nanoseconds
+    latencies: Dict[str, Dict[str, int]] = field(default_factory=dict)
     msg_type: MessageType = MessageType.Interval
 
 
@@ -68,6 +72,8 @@ class SampleFinished(AllMessages, DataClassYAMLMixin, DataClassMessagePackMixin)
 
     seconds_elapsed_total: float = 0
     seconds_elapsed_sample: float = 0
+    # over the whole sample; see Interval
+    latencies: Dict[str, Dict[str, int]] = field(default_factory=dict)
     msg_type: MessageType = MessageType.SampleFinished
 
 
@@ -23,13 +23,15 @@ import curio
 from goetia import libgoetia
 from goetia.messages import (
     AllMessages,
+    DistanceCalc,
     EndStream,
     Error,
     Interval,
     SampleFinished,
+    SampleSaturated,
     SampleStarted,
 )
-from goetia.utils import is_iterable, time_iterable, Counter
+from goetia.utils import is_iterable, Counter
 
 
 DEFAULT_SOCKET = '/tmp/goetia.sock'
@@ -130,18 +132,28 @@ class RunState(Enum):
     STOP = 5
 
 
+def _scope_dict(scopes) -> dict:
+    # std::map<std::string, std::map<std::string, uint64_t>> to nested dicts
+    return {scope.first: {stat.first: int(stat.second) for stat in scope.second}
+            for scope in scopes}
+
+
 class AsyncSequenceProcessor:
 
     def __init__(self, processor,
                        sample_iter,
                        echo = None,
-                       broadcast_socket = None):
+                       broadcast_socket = None,
+                       perf_counters = False,
+                       latencies = False):
         """Manages advancing through a concrete FileProcessor
-        subblass asynchronously. The processor pushes Interval
-        updates on to the `worker_q`, which are also forwarded
+        subblass asynchronously. The processor publishes Interval
+        events to a native `event_bus`, whose batches are converted
+        to messages and pushed on to the `worker_q`, which are also forwarded
         to an `events_q`. Additional async tasks can subscribe to 
         either queue; the `events_q` is considered the outward-facing
-        point.
+        point. Native subscribers can be added to the `event_bus` before
+        starting.
 
         `sample_iter` should be conform to that produced by
         `goetia.processing.iter_fastx_inputs`.
@@ -152,6 +164,11 @@ class AsyncSequenceProcessor:
             echo (bool): Whether to echo `events_q` to the terminal.
             broadcast_socket (str, optional): AF_UNIX socket to broadcast
                 the events queue on.
+            perf_counters (bool): Whether to count hardware events in the
+                processor's profiling scopes and report them with each Interval.
+            latencies (bool): Whether to record latency histograms of the
+                processor's profiling scopes and report their quantiles with
+                each Interval and SampleFinished.
         """
  
         self.worker_q = curio.UniversalQueue()
@@ -173,9 +190,48 @@ class AsyncSequenceProcessor:
         self.processor = processor
         self.sample_iter = sample_iter
 
+        self.perf_counters = perf_counters
+        self.latencies = latencies
+        self.profiler = None
+        if perf_counters or latencies:
+            self.profiler = libgoetia.Profiler.build(True, perf_counters)
+            if perf_counters and not self.profiler.counters_available():
+                print('** WARNING: hardware performance counters are unavailable; '
+                      'perf counts will be reported as 0.', file=sys.stderr)
+            self.processor.set_profiler(self.profiler)
+
         self.run_echo = echo is not None
         self.echo_file = '/dev/stderr' if echo is True else echo
 
+        # The processor publishes Interval events from the processing thread
+        # to a native bus. Synchronous native subscribers, such as saturation
+        # checks, run there at the interval boundary; Python only sees the
+        # events in batches, through the collector.
+        self.event_bus = libgoetia.StreamEventBus.build()
+        self.event_collector = libgoetia.StreamEventCollector.build()
+        self.event_bus.subscribe(self.event_collector)
+        # The profiler is snapshotted at each interval boundary, rather
+        # than when its batch of events is collected.
+        self.profile_snapshotter = None
+        if self.profiler is not None:
+            self.profile_snapshotter = libgoetia.ProfileSnapshotter.build(self.profiler,
+                                                                          perf_counters,
+                                                                          latencies)
+            self.event_bus.subscribe(self.profile_snapshotter, True)
+        self.processor.set_event_bus(self.event_bus)
+        self.event_poll_interval = 0.01
+        self.worker_finished = False
+
+        # sample_id -> (sample name, file names), and -> error message
+        self.samples = {}
+        self.errors = {}
+        # reported with native DistanceCalc events
+        self.distance_stat_type = ''
+
+        self.worker_start_time = libgoetia.StreamEvent.now()
+        self.sample_start_time = self.worker_start_time
+        self.interval_start_time = self.worker_start_time
+
         self.state = RunState.READY
         self.processed = set()
 
@@ -227,62 +283,137 @@ class AsyncSequenceProcessor:
         self.listener_tasks.append(listener.task)
         return listener
 
+    def _take_profile(self, event) -> tuple:
+        """Take the profiler snapshot taken on the processing thread at
+        the event.
+
+        Returns:
+            tuple: Scope name to event name to count, and scope name to
+                statistic to nanoseconds; each empty when not profiling it.
+        """
+        if self.profile_snapshotter is None:
+            return {}, {}
+        snapshot = self.profile_snapshotter.take(event)
+        return _scope_dict(snapshot.perf_counters), _scope_dict(snapshot.latencies)
+
+    def _publish(self, publish, *args) -> None:
+        # Sample boundaries mustn't be dropped; if the bus is full, wait
+        # for the dispatcher to make room. Only the worker thread does this,
+        # between samples, never the processor itself.
+        while not publish(*args):
+            time.sleep(self.event_poll_interval)
+
     def worker(self) -> None:
         stream_time, n_seqs = 0, 0
-        worker_start_time = time.perf_counter()
-        for (sample, name), sample_start_time, _ in time_iterable(self.sample_iter):
-
-            self.worker_q.put(SampleStarted(sample_name=name,  # type: ignore
-                                            file_names=sample,
-                                            t=stream_time,
-                                            seconds_elapsed_total=time.perf_counter() - worker_start_time,
-                                            sequence=n_seqs))
-
-            try:
-                for (n_seqs, stream_time, n_skipped), \
-                    interval_start_time, interval_elapsed_time in \
-                    time_iterable(self.processor.chunked_process(*sample)):
-                    
-                    if self.state is RunState.STOP_SATURATED:
-                        # Saturation is tripped externally: just return immediately.
-                        return
-
-                    if self.state is RunState.SIGINT:
-                        # If we're interrupted, inform our listeners that something went wrong.
-                        self.worker_q.put(Error(t=stream_time,  # type: ignore
-                                                sequence=n_seqs,
-                                                sample_name=name,
-                                                file_names=sample,
-                                                error='Process terminated (SIGINT).'))
-                        return
-
-                    self.worker_q.put(Interval(t=stream_time,  # type: ignore
-                                               sequence=n_seqs,
-                                               sample_name=name,
-                                               seconds_elapsed_interval=interval_elapsed_time,
-                                               seconds_elapsed_sample=time.perf_counter() - sample_start_time,
-                                               seconds_elapsed_total=time.perf_counter() - worker_start_time,
-                                               start_time_seconds=interval_start_time,
-                                               file_names=sample))
+        self.worker_start_time = libgoetia.StreamEvent.now()
+        try:
+            for sample_id, (sample, name) in enumerate(self.sample_iter):
+                self.samples[sample_id] = (name, sample)
+                self._publish(self.event_bus.sample_started, sample_id, stream_time, n_seqs)
+
+                try:
+                    # The processor publishes its own Intervals to the event bus, so
+                    # it runs the whole sample without coming back to Python; it
+                    # returns early if the bus is asked to stop.
+                    n_seqs, stream_time = self.processor.process(*sample)
+                except Exception as e:
+                    self.errors[sample_id] = "".join(traceback.format_tb(e.__traceback__))
+                    self._publish(self.event_bus.error, stream_time, n_seqs)
+                    return
+
+                if self.state is RunState.SIGINT:
+                    # If we're interrupted, inform our listeners that something went wrong.
+                    self.errors[sample_id] = 'Process terminated (SIGINT).'
+                    self._publish(self.event_bus.error, stream_time, n_seqs)
+                    return
+
+                if self.state is RunState.STOP_SATURATED or self.event_bus.stop_requested():
+                    # Saturation was tripped, here or by a native check on the bus:
+                    # just return immediately.
+                    self.state = RunState.STOP_SATURATED
+                    return
 
                 self.processed.add(tuple(sample))
-                self.worker_q.put(SampleFinished(t=stream_time,  # type: ignore
-                                                 sequence=n_seqs,
-                                                 sample_name=name,
-                                                 seconds_elapsed_sample=time.perf_counter() - sample_start_time,
-                                                 seconds_elapsed_total=time.perf_counter() - worker_start_time,
-                                                 file_names=sample))
-            except Exception as e:
-                self.worker_q.put(Error(t=stream_time,  # type: ignore
-                                        sequence=n_seqs,
-                                        sample_name=name,
-                                        file_names=sample,
-                                        error="".join(traceback.format_tb(e.__traceback__)))) 
-                return
-            finally:
-                self.worker_q.put(EndStream(t=stream_time,  # type: ignore
-                                            seconds_elapsed_total=time.perf_counter() - worker_start_time,
-                                            sequence=n_seqs))
+                self._publish(self.event_bus.sample_finished, stream_time, n_seqs)
+        finally:
+            self._publish(self.event_bus.end_stream, stream_time, n_seqs)
+
+    def _event_message(self, event) -> AllMessages:
+        """Convert a native stream event into its message.
+        """
+        name, file_names = self.samples.get(event.sample_id, ('', []))
+        event_type = event.type
+        timestamp = event.timestamp
+        elapsed_total = timestamp - self.worker_start_time
+
+        if event_type == libgoetia.INTERVAL:
+            perf_counters, latencies = self._take_profile(event)
+            msg = Interval(t=event.t,  # type: ignore
+                           sequence=event.sequence,
+                           sample_name=name,
+                           file_names=file_names,
+                           start_time_seconds=self.interval_start_time,
+                           seconds_elapsed_interval=timestamp - self.interval_start_time,
+                           seconds_elapsed_sample=timestamp - self.sample_start_time,
+                           seconds_elapsed_total=elapsed_total,
+                           perf_counters=perf_counters,
+                           latencies=latencies)
+            self.interval_start_time = timestamp
+            return msg
+        if event_type == libgoetia.DISTANCE_CALC:
+            return DistanceCalc(t=event.t,  # type: ignore
+                                sequence=event.sequence,
+                                sample_name=name,
+                                file_names=file_names,
+                                stat_type=self.distance_stat_type,
+                                distance=event.distance,
+                                stat=event.stat,
+                                seconds_elapsed_interval=timestamp - self.interval_start_time,
+                                seconds_elapsed_sample=timestamp - self.sample_start_time,
+                                seconds_elapsed_total=elapsed_total)
+        if event_type == libgoetia.SAMPLE_STARTED:
+            self.sample_start_time = self.interval_start_time = timestamp
+            return SampleStarted(t=event.t,  # type: ignore
+                                 sequence=event.sequence,
+                                 sample_name=name,
+                                 file_names=file_names,
+                                 seconds_elapsed_total=elapsed_total)
+        if event_type == libgoetia.SAMPLE_FINISHED:
+            _, latencies = self._take_profile(event)
+            return SampleFinished(t=event.t,  # type: ignore
+                                  sequence=event.sequence,
+                                  sample_name=name,
+                                  file_names=file_names,
+                                  seconds_elapsed_sample=timestamp - self.sample_start_time,
+                                  seconds_elapsed_total=elapsed_total,
+                                  latencies=latencies)
+        if event_type == libgoetia.SAMPLE_SATURATED:
+            return SampleSaturated(t=event.t,  # type: ignore
+                                   sequence=event.sequence,
+                                   sample_name=name,
+                                   file_names=file_names)
+        if event_type == libgoetia.STREAM_ERROR:
+            return Error(t=event.t,  # type: ignore
+                         sequence=event.sequence,
+                         sample_name=name,
+                         file_names=file_names,
+                         error=self.errors.get(event.sample_id, ''))
+        return EndStream(t=event.t,  # type: ignore
+                         sequence=event.sequence,
+                         seconds_elapsed_total=elapsed_total)
+
+    async def pump_events(self) -> None:
+        """Collect batches of events from the native bus and put their
+        messages on the `worker_q`, until the worker is finished and the
+        bus has been drained.
+        """
+        while True:
+            finished = self.worker_finished
+            for event in self.event_collector.collect():
+                await self.worker_q.put(self._event_message(event))
+            if finished:
+                break
+            await curio.sleep(self.event_poll_interval)
     
     #def on_error(self, exception):
     #    self.worker_q.put(Error(t=self.processor.time_elapsed(),
@@ -329,11 +460,23 @@ class AsyncSequenceProcessor:
                 self.state = RunState.RUNNING
                 signal.signal(signal.SIGINT, lambda signo, frame: self.interrupt())
 
+                # the bus delivers to the collector on its own thread, and
+                # the pump hands batches over to the listeners
+                self.worker_finished = False
+                self.event_bus.start()
+                pump = await g.spawn(self.pump_events)
+
                 # give just a bit of time for the listeners to all spin up
                 await curio.sleep(0.05)
                 # then spawn the worker
                 w = await g.spawn_thread(self.worker)
                 await w.join()
+
+                # deliver everything still on the bus, then let the pump
+                # take its last batch
+                await curio.run_in_thread(self.event_bus.stop)
+                self.worker_finished = True
+                await pump.join()
                 await curio.sleep(0.05)
 
                 await self.worker_subs.kill()
@@ -342,12 +485,15 @@ class AsyncSequenceProcessor:
 
     def stop(self) -> None:
         self.state = RunState.STOP
+        self.event_bus.request_stop()
 
     def interrupt(self) -> None:
         self.state = RunState.SIGINT
+        self.event_bus.request_stop()
 
     def saturate(self) -> None:
         self.state = RunState.STOP_SATURATED
+        self.event_bus.request_stop()
 
 
 def every_n_intervals(func, n=1):
@@ -48,6 +48,8 @@ def pythonize_goetia(klass, name):
         def wrap_walk(func):
             pass
 
+        klass.insert_sequences.__release_gil__ = True
+
         klass.add = add
         klass.get_hash = wrap_get(klass.get)
         klass.get = wrap_query(klass.query)
@@ -10,10 +10,7 @@ def pythonize_goetia(klass, name):
     ukhs_inst, template = is_template_inst(name, 'UKHS')
     if ukhs_inst:
         
-        def parse_unikmers(W, K):
-            import gzip
-            import os
-
+        def validate_params(W, K):
             valid_W = list(range(20, 210, 10))
             valid_K = list(range(7, 11))
             W = W - (W % 10)
@@ -23,6 +20,13 @@ def pythonize_goetia(klass, name):
             if not K in valid_K:
                 raise ValueError('Invalid UKHS K.')
 
+            return W, K
+
+        def parse_unikmers(W, K):
+            import gzip
+            import os
+
+            W, K = validate_params(W, K)
             filename = os.path.join(DATA_DIR,
                                     'res_{0}_{1}_4_0.txt.gz'.format(K, W))
             unikmers = std.vector[std.string]()
@@ -34,15 +38,68 @@ def pythonize_goetia(klass, name):
 
         klass.parse_unikmers = staticmethod(parse_unikmers)
 
+        # the C++ binary table loader; load() below is shadowed by the
+        # (W, K) loader
+        klass.load_table = klass.load
+
+        def cache_dir():
+            import os
+
+            cache_home = os.environ.get('XDG_CACHE_HOME',
+                                        os.path.join(os.path.expanduser('~'), '.cache'))
+            return os.path.join(cache_home, 'goetia', 'ukhs')
+
+        def table_dirs():
+            # tables shipped with the package, then ones we've built; only
+            # the latter is ever written to
+            return [DATA_DIR, cache_dir()]
+
+        def save_table(ukhs, W, K):
+            import os
+
+            table_dir = cache_dir()
+            path = os.path.join(table_dir, 'res_{0}_{1}_4_0.ukhs'.format(K, W))
+            try:
+                os.makedirs(table_dir, exist_ok=True)
+                # write under a temporary name so concurrent loaders
+                # never see a partial table
+                tmp_path = '{0}.{1}.tmp'.format(path, os.getpid())
+                ukhs.save(tmp_path)
+                os.replace(tmp_path, path)
+                return path
+            except Exception:
+                return None
+
         def load(W, K):
+            import os
+
             key = (W, K, klass.__name__)
             if key in UKHS_CACHE:
                 return UKHS_CACHE[key]
-            else:
+
+            # prefer a prebuilt binary table; otherwise parse the text
+            # distribution and cache a table for next time
+            table_W, table_K = validate_params(W, K)
+            table_name = 'res_{0}_{1}_4_0.ukhs'.format(table_K, table_W)
+            ukhs = None
+            for table_dir in table_dirs():
+                path = os.path.join(table_dir, table_name)
+                if os.path.exists(path):
+                    try:
+                        ukhs = klass.load_table(path, W)
+                        break
+                    except Exception:
+                        # corrupt or stale; rebuilt and re-cached below
+                        ukhs = None
+            if ukhs is None:
                 unikmers = parse_unikmers(W, K)
-                ukhs = klass.build(W, K, unikmers)
-                UKHS_CACHE[key] = ukhs
-                return ukhs
+                ukhs = klass.build(table_W, K, unikmers)
+                save_table(ukhs, table_W, table_K)
+                if W != table_W:
+                    ukhs = klass.build(W, K, unikmers)
+
+            UKHS_CACHE[key] = ukhs
+            return ukhs
 
         klass.load = staticmethod(load)
 
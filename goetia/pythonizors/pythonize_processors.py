@@ -8,6 +8,8 @@ def pythonize_goetia(klass, name):
     if is_inst:
         klass.advance.__release_gil__ = True
         klass.process.__release_gil__ = True
+        klass.process_files.__release_gil__ = True
+        klass.process_sequences.__release_gil__ = True
 
         def chunked_process(self, file, right_file=None):
             if type(file) in (str, bytes):
@@ -14,7 +14,7 @@ from goetia.pythonizors import utils
 
 
 def pythonize_goetia(klass, name):
-    if name == 'SourmashSketch':
+    if name in ('SourmashSketch', 'FracMinHash'):
 
         def to_sourmash(self):
             try:
@@ -38,21 +38,60 @@ def pythonize_goetia(klass, name):
 
         klass.Sketch.to_sourmash = to_sourmash
 
+    if name == 'FracMinHash':
+        klass.Sketch.insert_sequences.__release_gil__ = True
+
+    is_builder, _ = utils.is_template_inst(name, 'UnikmerSketchBuilder')
+    if is_builder:
+        # these hide FileProcessor's, so they aren't covered by its pythonizor
+        klass.advance.__release_gil__ = True
+        klass.process_sequences.__release_gil__ = True
+
     is_inst, template =  utils.is_template_inst(name, 'UnikmerSketch')
     if is_inst:
-        def to_numpy(self) -> np.ndarray:
+        def to_numpy(self, copy: bool = True) -> np.ndarray:
             """
+            Args:
+                copy (bool): If False, return a read-only view onto the
+                    sketch's own counts, which changes as sequences are
+                    inserted; it must not outlive the sketch.
+
             Returns:
                 numpy.ndarray: Numpy array with the signature vector.
             """
             buffer = self.get_sketch_as_buffer()
             buffer.reshape((len(self),))
-            return np.frombuffer(buffer, dtype=np.uint64, count=len(self))
+            view = np.frombuffer(buffer, dtype=np.uint64, count=len(self))
+            view.flags.writeable = False
+            return view.copy() if copy else view
+
+        def snapshot(self, out: np.ndarray = None, max_tries: int = 8) -> np.ndarray:
+            """
+            Copy the signature vector into out without allocating, retrying
+            if an insert from another thread lands during the copy.
+
+            Args:
+                out (numpy.ndarray): uint64 array of len(self); allocated if None.
+                max_tries (int): Copies to attempt before giving up.
+
+            Returns:
+                numpy.ndarray: out.
+            """
+            if out is None:
+                out = np.empty(len(self), dtype=np.uint64)
+            view = self.to_numpy(copy=False)
+            for _ in range(max_tries):
+                version = self.get_sketch_version()
+                np.copyto(out, view)
+                if self.get_sketch_version() == version:
+                    return out
+            raise RuntimeError('Sketch changed during every snapshot attempt')
         
         def __len__(self) -> int:
             return self.get_size()
 
         klass.Sketch.to_numpy = to_numpy
+        klass.Sketch.snapshot = snapshot
         klass.Sketch.__len__   = __len__
 
         def wrap_build(build_func):
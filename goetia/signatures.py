@@ -15,12 +15,24 @@ from boltons.iterutils import windowed_iter
 import ijson
 import pandas as pd
 import numpy as np
-from scipy.spatial.distance import cosine
 from sourmash import SourmashSignature
 from sourmash._lowlevel import ffi, lib
 from sourmash.utils import RustObject, rustcall, decode_str
 
 from goetia import __version__
+from goetia import libgoetia
+
+
+def cosine(u, v):
+    '''Cosine distance between two count vectors, using libgoetia's
+    vector kernel. A drop-in for scipy.spatial.distance.cosine on sketches;
+    NaN if either vector is all zeros.
+    '''
+    u = np.ascontiguousarray(u, dtype=np.uint64)
+    v = np.ascontiguousarray(v, dtype=np.uint64)
+    if u.shape != v.shape:
+        raise ValueError(f'Sketch sizes differ: {u.shape} vs {v.shape}.')
+    return 1.0 - libgoetia.SketchDistance.cosine(u, v, len(u))
 
 
 class DraffSignature:
@@ -10,4 +10,7 @@ from goetia import libgoetia
 
 #HLLCounter = libgoetia.HLLStorage
 SourmashSketch = libgoetia.SourmashSketch
+FracMinHash    = libgoetia.FracMinHash
 UnikmerSketch  = libgoetia.UnikmerSketch
+UnikmerSketchBuilder = libgoetia.UnikmerSketchBuilder
+AbundanceSpectrum = libgoetia.AbundanceSpectrum
@@ -24,20 +24,25 @@ types = [_type for _type, _name in typenames]
 for hasher_t, name in typenames:
     globals()[name] = hasher_t
 
+# HLLStorage only counts distinct k-mers, so it's a backend for
+# partitioned sketches but not for dBGs.
+HLLStorage = libgoetia.HLLStorage
+partitioned_typenames = typenames + [(HLLStorage, 'HLLStorage')]
+
 
 count_t = libgoetia.count_t
 StorageTraits = libgoetia.StorageTraits
 
 
 def get_storage_args(parser, default='SparseppSetStorage',
-                     group_name='storage'):
+                     group_name='storage', partitioned=False):
     if 'storage' in [g.title for g in parser._action_groups]:
         return None
 
     group = parser.add_argument_group(group_name)
 
     group.add_argument('-S', '--storage',
-                       choices=[name for _, name in typenames], 
+                       choices=[name for _, name in (partitioned_typenames if partitioned else typenames)],
                        default=default)
     group.add_argument('-N', '--n_tables',
                        default=4, type=int)
@@ -63,8 +68,8 @@ def process_storage_args(args):
         args.max_tablesize = int(args.max_tablesize)
         args.storage_args = (args.max_tablesize, args.n_tables)
 
-    #elif args.storage is libgoetia.HLLStorage:
-    #    args.storage_args = (float(args.error_rate), )
+    elif args.storage is libgoetia.HLLStorage:
+        args.storage_args = (float(args.error_rate), )
 
     elif args.storage is libgoetia.QFStorage:
         args.storage_args = (int(math.ceil(math.log2(args.max_tablesize))), )
@@ -74,5 +79,7 @@ def process_storage_args(args):
 
 
 def get_partitioned_storage_args(parser):
-    group = get_storage_args(parser, 'partitioned storage')
+    group = get_storage_args(parser, group_name='partitioned storage',
+                             partitioned=True)
 
+    return group
@@ -37,6 +37,7 @@
 #include "goetia/hashing/rollinghashshifter.hh"
 #include "goetia/storage/storage_types.hh"
 #include "goetia/cdbg/cdbg_types.hh"
+#include "goetia/cdbg/events.hh"
 #include "goetia/cdbg/metrics.hh"
 #include "goetia/dbg.hh"
 
@@ -321,11 +322,37 @@ public:
 
         id_t     component_id_counter;
 
+        void _emit(update_meta_t op,
+                   id_t          node_id,
+                   id_t          other_id  = NULL_ID,
+                   uint64_t      left_end  = 0,
+                   uint64_t      right_end = 0,
+                   uint64_t      position  = 0,
+                   uint64_t      length    = 0) {
+            if (events) {
+                events->push(cDBGEvent(op, node_id, other_id, left_end,
+                                       right_end, position, length, _n_updates));
+            }
+        }
+
+        void _emit_unode(update_meta_t op,
+                         UnitigNode *  unode,
+                         id_t          other_id = NULL_ID,
+                         uint64_t      position = 0) {
+            if (events) {
+                _emit(op, unode->node_id, other_id,
+                      unode->left_end().value(), unode->right_end().value(),
+                      position, unode->sequence.length());
+            }
+        }
+
     public:
 
         const uint16_t K;
         std::shared_ptr<graph_type> dbg;
         std::shared_ptr<cDBGMetrics> metrics;
+        // optional update event log; null unless enable_events is called
+        std::shared_ptr<cDBGEventRing> events;
 
         Graph(std::shared_ptr<graph_type> dbg,
               uint64_t minimizer_window_size=8);
@@ -334,6 +361,26 @@ public:
             return std::unique_lock<std::mutex>(mutex);
         }
 
+        /**
+         * @Synopsis  Start recording update events to a bounded ring of the
+         *            given capacity. Events are dropped (and counted) if the
+         *            ring fills up before it is drained.
+         *
+         * @Returns   The event ring.
+         */
+        std::shared_ptr<cDBGEventRing> enable_events(uint64_t capacity = 1 << 16) {
+            auto lock = lock_nodes();
+            if (!events) {
+                events = cDBGEventRing::build(capacity);
+            }
+            return events;
+        }
+
+        void disable_events() {
+            auto lock = lock_nodes();
+            events.reset();
+        }
+
         /* Utility methods for iterating DNode and UNode
          * data structures. Note that these are not thread-safe
          * (the caller will need to lock).
@@ -371,6 +418,22 @@ public:
             return decision_nodes.size();
         }
 
+        /* Unitig length statistics, maintained as unitigs are updated;
+         * these don't need the lock and are O(1) or O(buckets).
+         */
+
+        uint64_t n_unitig_bases() const {
+            return metrics->unitig_lengths.total_bases();
+        }
+
+        uint64_t unitig_n50() const {
+            return metrics->unitig_lengths.n50();
+        }
+
+        uint64_t unitig_ng50(uint64_t genome_size) const {
+            return metrics->unitig_lengths.ng50(genome_size);
+        }
+
         uint64_t n_tags() const {
             return unitig_tag_map.size();
         }
@@ -525,7 +588,9 @@ public:
             if (unode != nullptr) {
                 pdebug("Deleting " << *unode);
                 id_t id = unode->node_id;
+                _emit_unode(DELETE_UNODE, unode);
                 metrics->decrement_cdbg_node(unode->meta());
+                metrics->unitig_lengths.remove(unode->sequence.length());
                 for (hash_type tag: unode->tags) {
                     unitig_tag_map.erase(tag);
                 }
@@ -556,6 +621,7 @@ public:
             if (dnode != nullptr) {
                 pdebug("Deleting " << *dnode);
                 id_t id = dnode->node_id;
+                _emit(DELETE_DNODE, id, NULL_ID, 0, 0, 0, dnode->sequence.length());
                 metrics->n_dnodes--;
                 metrics->n_deletes++;
                 
@@ -721,6 +787,11 @@ public:
                                                     size_t                 sample_size = 10000)
         -> std::tuple<size_t, size_t, size_t, std::vector<size_t>>;
 
+    /**
+     * @Synopsis  Number of k-mers in unitigs within each length bin, from
+     *            the incrementally maintained length histogram. See
+     *            UnitigLengthHistogram::kmers_per_bin.
+     */
     static auto compute_unitig_fragmentation(std::shared_ptr<Graph> cdbg,
                                              std::vector<size_t>    bins)
         -> std::vector<size_t>;
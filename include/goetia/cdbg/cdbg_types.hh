@@ -99,9 +99,33 @@ enum update_meta_t {
     SPLIT_UNODE,
     EXTEND_UNODE,
     CLIP_UNODE,
-    MERGE_UNODES
+    MERGE_UNODES,
+    DELETE_DNODE
 };
 
+
+inline const char * update_meta_repr(update_meta_t meta) {
+    switch(meta) {
+        case BUILD_UNODE:
+            return "BUILD_UNODE";
+        case BUILD_DNODE:
+            return "BUILD_DNODE";
+        case DELETE_UNODE:
+            return "DELETE_UNODE";
+        case SPLIT_UNODE:
+            return "SPLIT_UNODE";
+        case EXTEND_UNODE:
+            return "EXTEND_UNODE";
+        case CLIP_UNODE:
+            return "CLIP_UNODE";
+        case MERGE_UNODES:
+            return "MERGE_UNODES";
+        case DELETE_DNODE:
+            return "DELETE_DNODE";
+    }
+    return "UNDEFINED";
+}
+
 }
 
 #undef pdebug
@@ -10,7 +10,15 @@
 #define GOETIA_COMPACTOR_HH
 
 #include <assert.h>
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <deque>
+#include <future>
+#include <set>
+#include <tuple>
+#include <type_traits>
+#include <vector>
 
 #include "goetia/traversal/unitig_walker.hh"
 #include "goetia/hashing/kmeriterator.hh"
@@ -18,7 +26,9 @@
 #include "goetia/hashing/rollinghashshifter.hh"
 #include "goetia/storage/storage_types.hh"
 #include "goetia/cdbg/cdbg.hh"
+#include "goetia/parallel.hh"
 #include "goetia/processors.hh"
+#include "goetia/profiling.hh"
 
 
 namespace goetia {
@@ -177,6 +187,35 @@ struct StreamingCompactor<GraphType<StorageType, ShifterType>> {
 
         uint64_t _minimizer_window_size;
 
+        /* Reusable per-Compactor buffers for segment discovery. These are
+         * only used while holding the cDBG lock -- by the insert paths and
+         * by the public find_new_segments, which takes it -- so a single set
+         * per Compactor is sufficient; clearing them keeps their capacity,
+         * so steady-state insertion doesn't hit the allocator.
+         */
+        struct SegmentScratch {
+            std::vector<hash_type>             hashes;
+            std::vector<count_t>               counts;
+            phmap::flat_hash_set<value_type>   seen_new;
+            std::vector<compact_segment>       preprocess;
+            std::vector<compact_segment>       decision_segments;
+            std::vector<compact_segment>       segments;
+            std::set<hash_type>                new_kmers;
+            std::set<hash_type>                new_decision_kmers;
+            std::deque<neighbor_pair_type>     decision_neighbors;
+
+            void clear() {
+                hashes.clear();
+                counts.clear();
+                segments.clear();
+                new_kmers.clear();
+                new_decision_kmers.clear();
+                decision_neighbors.clear();
+            }
+        };
+
+        SegmentScratch scratch;
+
     public:
 
         const uint16_t K;
@@ -248,35 +287,93 @@ struct StreamingCompactor<GraphType<StorageType, ShifterType>> {
         size_t insert_sequence(const std::string& sequence,
                                std::shared_ptr<std::vector<hash_type>> hashes = nullptr) {
 
-            std::set<hash_type> new_kmers;
-            std::vector<compact_segment> segments;
-            std::set<hash_type> new_decision_kmers;
-            std::deque<neighbor_pair_type> decision_neighbors;
-            //std::vector<hash_type> hashes;
-            if (hashes == nullptr) {
-                hashes = std::make_shared<std::vector<hash_type>>();
-            }
-            
             auto lock = cdbg->lock_nodes();
+            ProfileScopeGuard profile(ProfileScope::COMPACTOR_UPDATE);
 
-            find_new_segments(sequence,
-                              *hashes,
-                              new_kmers,
-                              segments,
-                              new_decision_kmers,
-                              decision_neighbors);
+            // the scratch buffers are owned by the Compactor and only touched
+            // while holding the cDBG lock, so they can be safely reused
+            scratch.clear();
+            std::vector<hash_type>& read_hashes = hashes == nullptr ? scratch.hashes : *hashes;
+
+            _find_new_segments_locked(sequence,
+                              read_hashes,
+                              scratch.new_kmers,
+                              scratch.segments,
+                              scratch.new_decision_kmers,
+                              scratch.decision_neighbors);
 
             update_from_segments(sequence,
-                                 new_kmers,
-                                 segments,
-                                 new_decision_kmers,
-                                 decision_neighbors);
+                                 scratch.new_kmers,
+                                 scratch.segments,
+                                 scratch.new_decision_kmers,
+                                 scratch.decision_neighbors);
+
+            {
+                ProfileScopeGuard profile(ProfileScope::STORAGE_INSERT);
+                for (const auto& h : read_hashes) {
+                    dbg->insert(h);
+                }
+            }
 
-            for (const auto& h : *hashes) {
-                dbg->insert(h);
+            return read_hashes.size();
+        }
+
+        /**
+         * @Synopsis  Insert a sequence whose k-mer hashes have already been
+         *            computed, for example by an upstream counting stage, so
+         *            that the compactor doesn't have to rehash it.
+         *
+         * @Param sequence The sequence.
+         * @Param hashes   Pointer to its sequence.length() - K + 1 k-mer hashes.
+         *
+         * @Returns   Number of k-mers inserted.
+         */
+        size_t insert_hashed_sequence(const std::string& sequence,
+                                      const hash_type *  hashes) {
+
+            if (sequence.length() < this->K) {
+                throw SequenceLengthException("Sequence must have length >= K");
             }
+            const size_t n_kmers = sequence.length() - this->K + 1;
 
-            return hashes->size();
+            auto lock = cdbg->lock_nodes();
+            ProfileScopeGuard profile(ProfileScope::COMPACTOR_UPDATE);
+            scratch.clear();
+
+            scratch.counts.resize(n_kmers);
+            dbg->query_many(hashes, scratch.counts.data(), n_kmers);
+
+            _find_new_segments(sequence,
+                               hashes,
+                               scratch.counts,
+                               scratch.new_kmers,
+                               scratch.segments,
+                               scratch.new_decision_kmers,
+                               scratch.decision_neighbors);
+
+            update_from_segments(sequence,
+                                 scratch.new_kmers,
+                                 scratch.segments,
+                                 scratch.new_decision_kmers,
+                                 scratch.decision_neighbors);
+
+            {
+                ProfileScopeGuard profile(ProfileScope::STORAGE_INSERT);
+                for (size_t i = 0; i < n_kmers; ++i) {
+                    dbg->insert(hashes[i]);
+                }
+            }
+
+            return n_kmers;
+        }
+
+        size_t insert_hashed_sequence(const std::string&            sequence,
+                                      const std::vector<hash_type>& hashes) {
+            if (sequence.length() < this->K ||
+                hashes.size() != sequence.length() - this->K + 1) {
+                throw GoetiaException("Number of hashes does not match sequence length.");
+            }
+            return insert_hashed_sequence(sequence, hashes.data());
         }
 
         compact_segment init_segment(hash_type left_anchor,
@@ -350,20 +447,89 @@ struct StreamingCompactor<GraphType<StorageType, ShifterType>> {
                                std::set<hash_type>& new_decision_kmers,
                                std::deque<neighbor_pair_type>& decision_neighbors) {
 
+            auto lock = cdbg->lock_nodes();
+            _find_new_segments_locked(sequence,
+                                      hashes,
+                                      new_kmers,
+                                      segments,
+                                      new_decision_kmers,
+                                      decision_neighbors);
+        }
+
+    protected:
+
+        /**
+         * @Synopsis  As find_new_segments, with the cDBG lock already held,
+         *            as it must be to use the scratch buffers.
+         */
+        void _find_new_segments_locked(const std::string& sequence,
+                                       std::vector<hash_type>& hashes,
+                                       std::set<hash_type>& new_kmers,
+                                       std::vector<compact_segment>& segments,
+                                       std::set<hash_type>& new_decision_kmers,
+                                       std::deque<neighbor_pair_type>& decision_neighbors) {
+
             pdebug("FIND SEGMENTS: " << sequence);
 
-            KmerIterator<extender_type> kmers(sequence, this->K);
+            // Batched existence pass: hash the whole read up front and look
+            // up all of its k-mers with one query_many on the storage. In the
+            // common case where the read is already fully contained in the
+            // graph, this is the only work done.
+            scratch.counts.clear();
+            size_t start = hashes.size();
+            dbg->query_sequence(sequence, scratch.counts, hashes);
+
+            _find_new_segments(sequence,
+                               hashes.data() + start,
+                               scratch.counts,
+                               new_kmers,
+                               segments,
+                               new_decision_kmers,
+                               decision_neighbors);
+        }
+
+        /**
+         * @Synopsis  Segment discovery over a read which has already been hashed
+         *            and queried against the dBG.
+         *
+         * @Param sequence The read.
+         * @Param hashes   Its k-mer hashes, one per k-mer.
+         * @Param counts   The dBG counts of those hashes.
+         */
+        void _find_new_segments(const std::string&              sequence,
+                                const hash_type *               hashes,
+                                const std::vector<count_t>&     counts,
+                                std::set<hash_type>&            new_kmers,
+                                std::vector<compact_segment>&   segments,
+                                std::set<hash_type>&            new_decision_kmers,
+                                std::deque<neighbor_pair_type>& decision_neighbors) {
+
+            if (std::find(counts.begin(), counts.end(), 0) == counts.end()) {
+                pdebug("no new k-mers");
+                return;
+            }
+
             hash_type prev_hash, cur_hash;
             size_t pos = 0;
             bool cur_new = false, prev_new = false, cur_seen = false, prev_seen = false;
 
-            std::vector<compact_segment> preprocess;
+            // new k-mers seen so far in this read; flat set of raw hash values
+            // so the per-k-mer membership test doesn't walk a tree
+            auto& seen_new = scratch.seen_new;
+            seen_new.clear();
+            seen_new.reserve(counts.size());
+            for (const auto& h : new_kmers) {
+                seen_new.insert(h.value());
+            }
+
+            auto& preprocess = scratch.preprocess;
+            preprocess.clear();
             compact_segment current_segment; // start null
-            while(!kmers.done()) {
-                cur_hash = kmers.next();
-                cur_new = this->dbg->query(cur_hash) == 0;
-                cur_seen = new_kmers.count(cur_hash);
-                hashes.push_back(cur_hash);
+            for (; pos < counts.size(); ++pos) {
+                cur_hash = hashes[pos];
+                cur_new = counts[pos] == 0;
+                // a k-mer can only have been seen in this read if it is new
+                cur_seen = cur_new && !seen_new.insert(cur_hash.value()).second;
 
                 if(cur_new && !cur_seen) {
 
@@ -387,7 +553,6 @@ struct StreamingCompactor<GraphType<StorageType, ShifterType>> {
                     current_segment = compact_segment();
                 } 
 
-                ++pos;
                 prev_hash = cur_hash;
                 prev_new = cur_new;
                 prev_seen = cur_seen;
@@ -436,6 +601,7 @@ struct StreamingCompactor<GraphType<StorageType, ShifterType>> {
             // This is all super verbose but the goal is to avoid unecessary hashing
             // and a bunch of convoluted logic up in the main segment loop
             pdebug("start decision segment splitting.");
+            auto& decision_segments = scratch.decision_segments;
             for (auto segment : preprocess) {
                 if (segment.is_null()) {
                     segments.push_back(segment);
@@ -443,7 +609,7 @@ struct StreamingCompactor<GraphType<StorageType, ShifterType>> {
                 }
 
                 dbg->set_cursor(sequence.c_str() + segment.start_pos);
-                std::vector<compact_segment> decision_segments;
+                decision_segments.clear();
                 size_t pos = segment.start_pos;
                 size_t suffix_pos = pos + this->K - 1;
                 while (1) {
@@ -533,6 +699,8 @@ struct StreamingCompactor<GraphType<StorageType, ShifterType>> {
             }
         }
 
+    public:
+
        void update_from_segments(const std::string& sequence,
                                   std::set<hash_type>& new_kmers,
                                   std::vector<compact_segment>& segments,
@@ -946,76 +1114,350 @@ struct StreamingCompactor<GraphType<StorageType, ShifterType>> {
     };
     */
 
-    template <class ParserType = FastxParser<>>
-    class NormalizingCompactor : public FileProcessor<NormalizingCompactor<ParserType>,
-                                                      ParserType> { 
-    protected:
+    /* A read after it has passed through an abundance pre-filter: its k-mer
+     * hashes are kept so that the compactor doesn't need to rehash it.
+     */
+    struct PrefilteredRead {
+        Record                 record;
+        std::vector<hash_type> hashes;
+        std::vector<count_t>   counts;
+        uint64_t               n_kmers;
+        bool                   keep;
+
+        PrefilteredRead()
+            : n_kmers(0),
+              keep(false)
+        {
+        }
+    };
+
+
+    /**
+     * @Synopsis  Counting sketch shared by the pre-filter stages. Hashing is done
+     *            with a local shifter, so the methods here are safe to call from
+     *            multiple threads as long as the storage backend's insert and
+     *            query are (as they are for the count-min backends).
+     *
+     * @tparam CountStorageType Storage backend for the counts.
+     */
+    template <class CountStorageType>
+    class AbundanceSketch {
+
+    public:
 
+        typedef CountStorageType                    storage_type;
+        typedef StorageTraits<CountStorageType>     storage_traits;
+        typedef dBG<CountStorageType, ShifterType>  counts_type;
 
-        bool median_count_at_least(const std::string&          sequence,
-                                   unsigned int                cutoff,
-                                   dBG<ByteStorage,
-                                       ShifterType> *          counts) {
+        const uint16_t               K;
+        std::shared_ptr<counts_type> counts;
 
-            auto kmers = counts->get_hash_iter(sequence);
-            unsigned int min_req = 0.5 + float(sequence.size() - counts->K + 1) / 2;
-            unsigned int num_cutoff_kmers = 0;
+        AbundanceSketch(std::shared_ptr<graph_type>                      dbg,
+                        const typename storage_traits::params_type& params)
+            : K(dbg->K)
+        {
+            auto storage = CountStorageType::build(params);
+            auto hasher  = dbg->get_hasher();
+            counts = std::make_shared<counts_type>(storage, hasher);
+        }
 
-            // first loop:
-            // accumulate at least min_req worth of counts before checking to see
-            // if we have enough high-abundance k-mers to indicate success.
-            for (unsigned int i = 0; i < min_req; ++i) {
-                hash_type kmer = kmers->next();
-                if (counts->query(kmer) >= cutoff) {
-                    ++num_cutoff_kmers;
+        /**
+         * @Synopsis  Hash the read into read.hashes, replacing its contents.
+         *
+         * @Returns   false if the read is shorter than K.
+         */
+        bool hash_read(PrefilteredRead& read) const {
+            read.hashes.clear();
+            read.counts.clear();
+            const std::string& sequence = read.record.sequence;
+            if (sequence.length() < K) {
+                read.n_kmers = 0;
+                return false;
+            }
+            read.n_kmers = sequence.length() - K + 1;
+            read.hashes.reserve(read.n_kmers);
+            read.counts.reserve(read.n_kmers);
+
+            KmerIterator<ShifterType> kmers(sequence, K);
+            while (!kmers.done()) {
+                read.hashes.push_back(kmers.next());
+            }
+            return true;
+        }
+
+        void query_read(PrefilteredRead& read) const {
+            read.counts.resize(read.hashes.size());
+            for (size_t i = 0; i < read.hashes.size(); ++i) {
+                read.counts[i] = counts->query(read.hashes[i]);
+            }
+        }
+
+        void insert_read(PrefilteredRead& read) {
+            read.counts.resize(read.hashes.size());
+            for (size_t i = 0; i < read.hashes.size(); ++i) {
+                read.counts[i] = counts->insert_and_query(read.hashes[i]);
+            }
+        }
+
+        /**
+         * @Synopsis  Whether at least half of the counts are >= cutoff.
+         */
+        static bool median_count_at_least(const std::vector<count_t>& counts,
+                                          unsigned int                cutoff) {
+
+            size_t min_req = 0.5 + float(counts.size()) / 2;
+            size_t num_cutoff_kmers = 0;
+            for (const auto& count : counts) {
+                if (count >= cutoff && ++num_cutoff_kmers >= min_req) {
+                    return true;
                 }
             }
+            return false;
+        }
+    };
+
+
+    /**
+     * @Synopsis  Pipeline stage running an abundance pre-filter ahead of the
+     *            compactor. Reads are consumed in batches: the Derived class's
+     *            prefilter(PrefilteredRead&) is run over the batch on worker
+     *            threads, and then commit(const PrefilteredRead&) is called on
+     *            each read, in order, on the calling thread. Interval timing
+     *            is polled per read as in FileProcessor::advance, so reads left
+     *            in a batch when an interval completes are carried over to the
+     *            next call.
+     *
+     *            With a batch size over 1, batches are double-buffered: while
+     *            one batch is committed, the next is parsed and then counted
+     *            in the background, so counting overlaps the compactor.
+     *            prefilter must therefore not touch the cDBG, only the
+     *            counts; commit must not touch the counts. Batches are still
+     *            counted one after another, in order.
+     *
+     *            Because a batch is counted before any of it is committed, a
+     *            filter decision can't see the counts from earlier reads in
+     *            the same batch; with a batch size of 1 the stage is exactly
+     *            sequential.
+     *
+     * @tparam Derived    CRTP derived class.
+     * @tparam ParserType Sequence parser type.
+     */
+    template <class Derived,
+              class ParserType = FastxParser<>>
+    class PrefilterPipeline : public FileProcessor<Derived, ParserType> {
+
+    protected:
+
+        typedef FileProcessor<Derived, ParserType> Base;
+
+        // batches[current] is being committed; the other is being counted
+        // when counting is non-null
+        std::vector<PrefilteredRead> batches[2];
+        size_t                       batch_ends[2];
+        size_t                       current;
+        size_t                       batch_pos;
+        std::future<void>            counting;
+        PrefilteredRead              single;
+
+    public:
 
+        using Base::advance;
+        using Base::process_sequence;
 
-            // second loop: now check to see if we pass the threshold for each k-mer.
-            if (num_cutoff_kmers >= min_req) {
-                return true;
+        const size_t       batch_size;
+        const unsigned int n_threads;
+
+        PrefilterPipeline(size_t       batch_size,
+                          unsigned int n_threads,
+                          uint64_t     interval = IntervalCounter::DEFAULT_INTERVAL,
+                          bool         verbose  = false)
+            : Base(interval, verbose),
+              batch_ends{0, 0},
+              current(0),
+              batch_pos(0),
+              batch_size(std::max<size_t>(1, batch_size)),
+              n_threads(n_threads)
+        {
+            batches[0].resize(this->batch_size);
+            if (this->batch_size > 1) {
+                batches[1].resize(this->batch_size);
             }
-            while(!kmers->done()) {
-                hash_type kmer = kmers->next();
-                if (counts->query(kmer) >= cutoff) {
-                    ++num_cutoff_kmers;
-                    if (num_cutoff_kmers >= min_req) {
-                        return true;
+        }
+
+        /**
+         * @Synopsis  Single reads (for example, from split-paired readers)
+         *            go through the same prefilter and commit, inline.
+         */
+        uint64_t process_sequence(const Record& record) {
+            single.record = record;
+            try {
+                derived().prefilter(single);
+            } catch (InvalidCharacterException& e) {
+                return 0;
+            }
+            return derived().commit(single);
+        }
+
+        std::tuple<uint64_t, uint64_t, bool> advance(std::shared_ptr<ParserType>& parser) {
+            // nothing is left counting in the background between calls,
+            // even if commit throws
+            struct WaitForCounting {
+                std::future<void>& counting;
+                ~WaitForCounting() {
+                    if (counting.valid()) {
+                        counting.wait();
+                    }
+                }
+            } wait_for_counting{counting};
+
+            while (true) {
+                // drain whatever is left of the current batch first
+                auto& batch = batches[current];
+                while (batch_pos < batch_ends[current]) {
+                    uint64_t time_passed = derived().commit(batch[batch_pos]);
+                    ++batch_pos;
+                    ++this->_n_sequences;
+
+                    if (this->timer.poll(time_passed)) {
+                        const bool keep_going = this->publish_interval();
+                        return {this->_n_sequences, this->timer.total(),
+                                keep_going && (batch_pos < batch_ends[current] ||
+                                               counting.valid() ||
+                                               !parser->is_complete())};
                     }
                 }
+
+                if (counting.valid()) {
+                    // rethrows anything thrown while counting
+                    counting.get();
+                    current = 1 - current;
+                    batch_pos = 0;
+                } else if (parser->is_complete()) {
+                    return {this->_n_sequences, this->timer.total(), false};
+                } else {
+                    _fill_batch(*parser, current);
+                    _count_batch(current);
+                    batch_pos = 0;
+                }
+
+                if (batch_size > 1 && !parser->is_complete()) {
+                    const size_t next = 1 - current;
+                    _fill_batch(*parser, next);
+                    counting = std::async(std::launch::async,
+                                          [this, next]() { _count_batch(next); });
+                }
             }
-            return false;
         }
 
+        ~PrefilterPipeline() {
+            if (counting.valid()) {
+                counting.wait();
+            }
+        }
+
+    protected:
+
+        void _fill_batch(ParserType& parser, size_t which) {
+            auto& batch = batches[which];
+            size_t& batch_end = batch_ends[which];
+            batch_end = 0;
+            while (batch_end < batch_size && !parser.is_complete()) {
+                auto record = this->handle_next(parser);
+                if (!record) {
+                    continue;
+                }
+                batch[batch_end].record = std::move(record.value());
+                ++batch_end;
+            }
+        }
+
+        void _count_batch(size_t which) {
+            auto& batch = batches[which];
+            parallel_for_ranges(batch_ends[which], n_threads,
+                                [this, &batch](size_t begin, size_t end) {
+                                    for (size_t i = begin; i < end; ++i) {
+                                        try {
+                                            derived().prefilter(batch[i]);
+                                        } catch (InvalidCharacterException& e) {
+                                            batch[i].keep = false;
+                                            batch[i].n_kmers = 0;
+                                        }
+                                    }
+                                });
+        }
+
+        Derived& derived() {
+            return *static_cast<Derived*>(this);
+        }
+    };
+
+
+    /**
+     * @Synopsis  Digital normalization ahead of the compactor: reads whose
+     *            median k-mer count is already >= cutoff are skipped, the
+     *            rest are counted and inserted into the cDBG.
+     *
+     * @tparam ParserType       Sequence parser type.
+     * @tparam CountStorageType Storage backend for the abundance counts.
+     */
+    template <class ParserType = FastxParser<>,
+              class CountStorageType = ByteStorage>
+    class NormalizingCompactor : public PrefilterPipeline<NormalizingCompactor<ParserType, CountStorageType>,
+                                                          ParserType> {
+    public:
+
+        typedef AbundanceSketch<CountStorageType>         sketch_type;
+        typedef typename sketch_type::storage_traits      count_traits;
+
+    protected:
+
+        typedef PrefilterPipeline<NormalizingCompactor<ParserType, CountStorageType>,
+                                  ParserType> Base;
 
         std::shared_ptr<Compactor>                              compactor;
         std::shared_ptr<graph_type>                             graph;
 
-        std::unique_ptr<dBG<ByteStorage, ShifterType>> counts;
+        sketch_type                                             sketch;
         unsigned int                                            cutoff;
-        size_t                                                  n_seq_updates;
-
-        typedef FileProcessor<NormalizingCompactor<ParserType>,
-                              ParserType> Base;
+        std::atomic<uint64_t>                                   n_seq_updates;
 
     public:
 
         using Base::process_sequence;
+        using Base::advance;
+
+        // the historical default counts table, 4 x 100M slots, for the
+        // count-min backends; other backends get their own defaults
+        static typename count_traits::params_type default_count_params() {
+            typedef typename count_traits::params_type params_type;
+            if constexpr (std::is_same_v<params_type, std::tuple<uint64_t, uint16_t>>) {
+                return params_type(100000000, 4);
+            } else {
+                return count_traits::default_params;
+            }
+        }
         
         NormalizingCompactor(std::shared_ptr<Compactor> compactor,
                              unsigned int               cutoff,
                              uint64_t interval = IntervalCounter::DEFAULT_INTERVAL)
-            : Base(interval),
+            : NormalizingCompactor(compactor, cutoff, default_count_params(),
+                                   1, 1, interval)
+        {
+        }
+
+        NormalizingCompactor(std::shared_ptr<Compactor>                   compactor,
+                             unsigned int                                 cutoff,
+                             const typename count_traits::params_type&    count_params,
+                             size_t                                       batch_size,
+                             unsigned int                                 n_threads,
+                             uint64_t interval = IntervalCounter::DEFAULT_INTERVAL)
+            : Base(batch_size, n_threads, interval),
               compactor(compactor),
               graph(compactor->dbg),
+              sketch(compactor->dbg, count_params),
               cutoff(cutoff),
               n_seq_updates(0)
         {
-            auto storage = ByteStorage::build(100000000, 4);
-            auto hasher = graph->get_hasher();
-            counts = std::make_unique<dBG<ByteStorage,
-                                          ShifterType>>(storage, hasher);
         }
 
         static std::shared_ptr<NormalizingCompactor> build(std::shared_ptr<Compactor> compactor,
@@ -1025,40 +1467,61 @@ struct StreamingCompactor<GraphType<StorageType, ShifterType>> {
 
         }
 
-        uint64_t process_sequence(const Record& read) {
-
-            uint64_t sequence_n_kmers = read.sequence.length() - compactor->K + 1;
+        static std::shared_ptr<NormalizingCompactor> build(std::shared_ptr<Compactor>                compactor,
+                                                           unsigned int                              cutoff,
+                                                           const typename count_traits::params_type& count_params,
+                                                           size_t                                    batch_size,
+                                                           unsigned int                              n_threads,
+                                                           uint64_t interval = IntervalCounter::DEFAULT_INTERVAL) {
+            return std::make_shared<NormalizingCompactor>(compactor, cutoff, count_params,
+                                                          batch_size, n_threads, interval);
+        }
 
-            if (median_count_at_least(read.sequence, cutoff, counts.get())) {
-                return sequence_n_kmers;
+        /**
+         * @Synopsis  Worker-side stage: hash once, check the median count,
+         *            and count the read if it's kept.
+         */
+        void prefilter(PrefilteredRead& read) {
+            read.keep = false;
+            if (!sketch.hash_read(read)) {
+                return;
             }
+            sketch.query_read(read);
+            if (sketch_type::median_count_at_least(read.counts, cutoff)) {
+                return;
+            }
+            sketch.insert_read(read);
+            read.keep = true;
+        }
 
-            counts->insert_sequence(read.sequence);
+        /**
+         * @Synopsis  Compactor-side stage: insert kept reads using the hashes
+         *            computed by prefilter.
+         *
+         * @Returns   Number of k-mers in the read.
+         */
+        uint64_t commit(const PrefilteredRead& read) {
+            if (!read.keep) {
+                return read.n_kmers;
+            }
 
             try {
-                compactor->insert_sequence(read.sequence);
-            } catch (InvalidCharacterException &e) {
-                std::cerr << "WARNING: Bad sequence encountered at "
-                          << this->_n_reads << ": "
-                          << read.sequence << ", exception was "
-                          << e.what() << std::endl;
-                return 0;
-            } catch (SequenceLengthException &e) {
-                std::cerr << "NOTE: Skipped sequence that was too short: read "
-                          << this->_n_reads << " with sequence "
-                          << read.sequence
-                          << std::endl;
-                return 0;
+                compactor->insert_hashed_sequence(read.record.sequence,
+                                                  read.hashes.data());
             } catch (std::exception &e) {
-                std::cerr << "ERROR: Exception thrown at " << this->_n_reads 
+                std::cerr << "ERROR: Exception thrown at " << this->n_sequences()
                           << " with msg: " << e.what()
                           <<  std::endl;
-                throw e;
+                throw;
             }
 
             ++n_seq_updates;
             
-            return sequence_n_kmers;
+            return read.n_kmers;
+        }
+
+        uint64_t n_updates() const {
+            return n_seq_updates;
         }
 
         void report() {
@@ -1068,12 +1531,30 @@ struct StreamingCompactor<GraphType<StorageType, ShifterType>> {
     };
 
     
-    class SolidCompactor {
+    /**
+     * @Synopsis  Inserts only the solid (count >= min_abund) segments of each
+     *            sequence into the compactor. Each read is hashed once: the
+     *            hashes counted into the abundance sketch are handed straight
+     *            to the compactor.
+     *
+     * @tparam CountStorageType Storage backend for the abundance counts.
+     */
+    template <class CountStorageType = NibbleStorage>
+    class SolidFilter {
+
+    public:
+
+        typedef AbundanceSketch<CountStorageType>         sketch_type;
+        typedef typename sketch_type::storage_traits      count_traits;
+        typedef std::vector<std::pair<size_t, size_t>>    segment_list_type;
 
     private:
 
-        std::unique_ptr<dBG<NibbleStorage,
-                            ShifterType>> abund_filter;
+        sketch_type                   abund_filter;
+        // reused to hold solid segments without reallocating
+        std::string                   segment_buffer;
+        PrefilteredRead               read_buffer;
+        segment_list_type             segment_buffer_list;
 
     public:
 
@@ -1082,78 +1563,181 @@ struct StreamingCompactor<GraphType<StorageType, ShifterType>> {
 
         unsigned int                  min_abund;
 
-        SolidCompactor(std::shared_ptr<Compactor> compactor,
-                       unsigned int               min_abund,
-                       uint64_t                   abund_table_size,
-                       uint16_t                   n_abund_tables)
-            : compactor     (compactor),
+        SolidFilter(std::shared_ptr<Compactor>                compactor,
+                    unsigned int                              min_abund,
+                    const typename count_traits::params_type& count_params)
+            : abund_filter  (compactor->dbg, count_params),
+              compactor     (compactor),
               dbg           (compactor->dbg),
               min_abund     (min_abund)
         {
-            std::shared_ptr<NibbleStorage> abund_storage = NibbleStorage::build(abund_table_size,
-                                                                                                  n_abund_tables);
-            auto abund_hasher = dbg->get_hasher();
-            abund_filter = std::make_unique<dBG<NibbleStorage,
-                                                ShifterType>>(abund_storage,
-                                                              abund_hasher);
-        }
-
-        static std::shared_ptr<SolidCompactor> build(std::shared_ptr<Compactor> compactor,
-                                                     unsigned int               min_abund,
-                                                     uint64_t                   abund_table_size,
-                                                     uint16_t                   n_abund_tables) {
-            return std::make_shared<SolidCompactor>(compactor, min_abund, abund_table_size, n_abund_tables);
-        }
-                                                     
-
-        std::vector<std::pair<size_t, size_t>> find_solid_segments(const std::string& sequence) {
-            std::vector<hash_type>  hashes;
-            std::vector<count_t> counts;
-            abund_filter->insert_sequence(sequence, hashes, counts);
-
-            std::vector<std::pair<size_t, size_t>> segments;
-            auto hashes_iter = hashes.begin();
-            auto counts_iter = counts.begin();
-            size_t start, end, pos = 0;
-            hash_type cur_hash;
+        }
+
+        SolidFilter(std::shared_ptr<Compactor> compactor,
+                    unsigned int               min_abund,
+                    uint64_t                   abund_table_size,
+                    uint16_t                   n_abund_tables)
+            : SolidFilter(compactor,
+                          min_abund,
+                          typename count_traits::params_type(abund_table_size, n_abund_tables))
+        {
+        }
+
+        static std::shared_ptr<SolidFilter> build(std::shared_ptr<Compactor> compactor,
+                                                  unsigned int               min_abund,
+                                                  uint64_t                   abund_table_size,
+                                                  uint16_t                   n_abund_tables) {
+            return std::make_shared<SolidFilter>(compactor, min_abund, abund_table_size, n_abund_tables);
+        }
+
+        static std::shared_ptr<SolidFilter> build(std::shared_ptr<Compactor>                compactor,
+                                                  unsigned int                              min_abund,
+                                                  const typename count_traits::params_type& count_params) {
+            return std::make_shared<SolidFilter>(compactor, min_abund, count_params);
+        }
+
+        /**
+         * @Synopsis  Worker-side stage: hash the read and count it. Thread-safe.
+         */
+        void prefilter(PrefilteredRead& read) {
+            read.keep = abund_filter.hash_read(read);
+            if (read.keep) {
+                abund_filter.insert_read(read);
+            }
+        }
+
+        /**
+         * @Synopsis  Find the [start, end) sequence coordinates of runs of
+         *            solid k-mers from counts.
+         */
+        void find_solid_segments(const std::vector<count_t>& counts,
+                                 segment_list_type&          segments) const {
+            segments.clear();
+            size_t start = 0, pos = 0;
             bool   prev_solid = false, cur_solid = false;
-            while(hashes_iter != hashes.end()) {
-                cur_hash  = *hashes_iter;
-                cur_solid = (*counts_iter) >= min_abund;
+            for (const auto& count : counts) {
+                cur_solid = count >= min_abund;
                 if (cur_solid && !prev_solid) {
                     start = pos;
                 } else if (prev_solid && !cur_solid) {
-                    end = pos + compactor->K - 1;
-                    segments.emplace_back(start, end);
+                    segments.emplace_back(start, pos + compactor->K - 1);
                 }
-                
                 ++pos;
-                ++hashes_iter;
-                ++counts_iter;
                 prev_solid = cur_solid;
             }
 
             if (cur_solid) {
-                end = pos + compactor->K - 1;
-                segments.emplace_back(start, end);
+                segments.emplace_back(start, pos + compactor->K - 1);
             }
+        }
 
+        segment_list_type find_solid_segments(const std::string& sequence) {
+            read_buffer.record.sequence = sequence;
+            prefilter(read_buffer);
+            segment_list_type segments;
+            find_solid_segments(read_buffer.counts, segments);
             return segments;
         }
 
-        void insert_sequence(const std::string& sequence) {
+        /**
+         * @Synopsis  Compactor-side stage: insert the solid segments of a
+         *            prefiltered read, reusing its hashes.
+         *
+         * @Returns   Number of k-mers in the read.
+         */
+        uint64_t commit(const PrefilteredRead& read) {
+            if (!read.keep) {
+                return read.n_kmers;
+            }
+            find_solid_segments(read.counts, segment_buffer_list);
+            for (const auto& segment : segment_buffer_list) {
+                segment_buffer.assign(read.record.sequence,
+                                      segment.first,
+                                      segment.second - segment.first);
+                compactor->insert_hashed_sequence(segment_buffer,
+                                                  read.hashes.data() + segment.first);
+            }
+            return read.n_kmers;
+        }
+
+        uint64_t insert_sequence(const std::string& sequence) {
+            read_buffer.record.sequence = sequence;
+            prefilter(read_buffer);
+            return commit(read_buffer);
+        }
 
-            auto solid_segments = find_solid_segments(sequence);
-            for (auto segment : solid_segments) {
-                auto length = segment.second - segment.first;
-                compactor->insert_sequence(sequence.substr(segment.first,
-                                                           length));
+        /**
+         * @Synopsis  Count a batch of sequences on n_threads workers, then
+         *            insert their solid segments in order.
+         */
+        uint64_t insert_sequences(const std::vector<std::string>& sequences,
+                                  unsigned int                    n_threads = 1) {
+            std::vector<PrefilteredRead> reads(sequences.size());
+            parallel_for_ranges(sequences.size(), n_threads,
+                                [&](size_t begin, size_t end) {
+                                    for (size_t i = begin; i < end; ++i) {
+                                        reads[i].record.sequence = sequences[i];
+                                        prefilter(reads[i]);
+                                    }
+                                });
+            uint64_t n_kmers = 0;
+            for (const auto& read : reads) {
+                n_kmers += commit(read);
             }
+            return n_kmers;
         }
-              
-                                    
+
+        /**
+         * @Synopsis  File-driven solid compaction with counting on worker threads.
+         */
+        template <class ParserType = FastxParser<>>
+        class Processor : public PrefilterPipeline<Processor<ParserType>, ParserType> {
+
+        protected:
+
+            typedef PrefilterPipeline<Processor<ParserType>, ParserType> Base;
+
+        public:
+
+            using Base::process_sequence;
+            using Base::advance;
+
+            std::shared_ptr<SolidFilter> filter;
+
+            Processor(std::shared_ptr<SolidFilter> filter,
+                      size_t                       batch_size = 1024,
+                      unsigned int                 n_threads  = 1,
+                      uint64_t interval = IntervalCounter::DEFAULT_INTERVAL,
+                      bool     verbose  = false)
+                : Base(batch_size, n_threads, interval, verbose),
+                  filter(filter)
+            {
+            }
+
+            static std::shared_ptr<Processor> build(std::shared_ptr<SolidFilter> filter,
+                                                    size_t                       batch_size = 1024,
+                                                    unsigned int                 n_threads  = 1,
+                                                    uint64_t interval = IntervalCounter::DEFAULT_INTERVAL,
+                                                    bool     verbose  = false) {
+                return std::make_shared<Processor>(filter, batch_size, n_threads, interval, verbose);
+            }
+
+            void prefilter(PrefilteredRead& read) {
+                filter->prefilter(read);
+            }
+
+            uint64_t commit(const PrefilteredRead& read) {
+                return filter->commit(read);
+            }
+
+            void report() {
+
+            }
+        };
     };
 
+    using SolidCompactor = SolidFilter<NibbleStorage>;
+
 };
 
 
@@ -0,0 +1,260 @@
+/**
+ * (c) Camille Scott, 2026
+ * File   : events.hh
+ * License: MIT
+ * Author : Camille Scott <camille.scott.w@gmail.com>
+ * Date   : 18.10.2026
+ *
+ * Typed cDBG update events and a bounded, lock-free ring buffer for
+ * handing them to downstream consumers. The ring is a Vyukov-style
+ * bounded queue: any number of producers may push, and a single consumer
+ * drains in batches. When the ring is full, new events are dropped and
+ * counted rather than blocking the graph update.
+ */
+
+#ifndef GOETIA_CDBG_EVENTS_HH
+#define GOETIA_CDBG_EVENTS_HH
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "goetia/goetia.hh"
+#include "goetia/cdbg/cdbg_types.hh"
+
+
+namespace goetia {
+
+
+/**
+ * @Synopsis  A single cDBG update. The meaning of the fields depends on op:
+ *
+ *            BUILD_UNODE:  node_id is the new unitig, left_end/right_end its ends.
+ *            EXTEND_UNODE: node_id is the extended unitig, left_end/right_end its
+ *                          new ends, position is the direction (DIR_LEFT/DIR_RIGHT).
+ *            CLIP_UNODE:   as EXTEND_UNODE.
+ *            SPLIT_UNODE:  node_id is the left half, other_id the new right half,
+ *                          position the split offset in the original unitig.
+ *            MERGE_UNODES: node_id is the surviving unitig, other_id the
+ *                          unitig merged into it. A unitig merged with
+ *                          itself into a circle only gets EXTEND_UNODE.
+ *            DELETE_UNODE: node_id is the deleted unitig.
+ *            BUILD_DNODE / DELETE_DNODE: node_id is the decision k-mer hash.
+ *
+ *            length is the node sequence length after the update and
+ *            update_n the cDBG update count when the event was emitted.
+ */
+struct cDBGEvent {
+    update_meta_t op;
+    id_t          node_id;
+    id_t          other_id;
+    uint64_t      left_end;
+    uint64_t      right_end;
+    uint64_t      position;
+    uint64_t      length;
+    uint64_t      update_n;
+
+    cDBGEvent()
+        : op(BUILD_UNODE),
+          node_id(NULL_ID),
+          other_id(NULL_ID),
+          left_end(0),
+          right_end(0),
+          position(0),
+          length(0),
+          update_n(0)
+    {
+    }
+
+    cDBGEvent(update_meta_t op,
+              id_t          node_id,
+              id_t          other_id,
+              uint64_t      left_end,
+              uint64_t      right_end,
+              uint64_t      position,
+              uint64_t      length,
+              uint64_t      update_n)
+        : op(op),
+          node_id(node_id),
+          other_id(other_id),
+          left_end(left_end),
+          right_end(right_end),
+          position(position),
+          length(length),
+          update_n(update_n)
+    {
+    }
+
+    std::string repr() const {
+        std::ostringstream os;
+        os << *this;
+        return os.str();
+    }
+
+    friend inline std::ostream& operator<<(std::ostream& o, const cDBGEvent& e) {
+        o << "<cDBGEvent op=" << update_meta_repr(e.op)
+          << " node_id=" << e.node_id
+          << " other_id=" << e.other_id
+          << " left_end=" << e.left_end
+          << " right_end=" << e.right_end
+          << " position=" << e.position
+          << " length=" << e.length
+          << " update_n=" << e.update_n
+          << ">";
+        return o;
+    }
+};
+
+
+class cDBGEventRing {
+
+    struct Slot {
+        std::atomic<uint64_t> sequence;
+        cDBGEvent             event;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    const uint64_t          mask;
+
+    alignas(64) std::atomic<uint64_t> head;
+    alignas(64) std::atomic<uint64_t> tail;
+    alignas(64) std::atomic<uint64_t> _n_dropped;
+
+public:
+
+    const uint64_t capacity;
+
+    /**
+     * @Synopsis  Build a ring holding at least capacity events; the
+     *            capacity is rounded up to a power of two.
+     */
+    explicit cDBGEventRing(uint64_t capacity = 1 << 16);
+
+    static std::shared_ptr<cDBGEventRing> build(uint64_t capacity = 1 << 16) {
+        return std::make_shared<cDBGEventRing>(capacity);
+    }
+
+    /**
+     * @Synopsis  Push an event. Never blocks.
+     *
+     * @Returns   false if the ring was full and the event dropped.
+     */
+    bool push(const cDBGEvent& event) {
+        uint64_t pos = head.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots[pos & mask];
+            uint64_t seq = slot.sequence.load(std::memory_order_acquire);
+            int64_t diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+            if (diff == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.event = event;
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                _n_dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @Synopsis  Pop a single event. Single consumer only.
+     *
+     * @Returns   false if the ring was empty.
+     */
+    bool pop(cDBGEvent& event) {
+        uint64_t pos = tail.load(std::memory_order_relaxed);
+        Slot& slot = slots[pos & mask];
+        uint64_t seq = slot.sequence.load(std::memory_order_acquire);
+        if (static_cast<int64_t>(seq) - static_cast<int64_t>(pos + 1) < 0) {
+            return false;
+        }
+        event = slot.event;
+        slot.sequence.store(pos + mask + 1, std::memory_order_release);
+        tail.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @Synopsis  Pop up to max_events events into out, appending.
+     *
+     * @Returns   Number of events drained.
+     */
+    size_t drain(std::vector<cDBGEvent>& out, size_t max_events);
+
+    std::vector<cDBGEvent> drain(size_t max_events = 4096) {
+        std::vector<cDBGEvent> out;
+        drain(out, max_events);
+        return out;
+    }
+
+    /**
+     * @Synopsis  Approximate number of pending events.
+     */
+    uint64_t size() const {
+        uint64_t h = head.load(std::memory_order_relaxed);
+        uint64_t t = tail.load(std::memory_order_relaxed);
+        return h > t ? h - t : 0;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    uint64_t n_dropped() const {
+        return _n_dropped.load(std::memory_order_relaxed);
+    }
+
+    /*
+     * Binary delta format: a header of the magic bytes, format version and
+     * event count, followed by fixed-width little-endian records.
+     */
+
+    static constexpr char     DELTA_MAGIC[8]  = {'G', 'C', 'D', 'B', 'G', 'E', 'V', '\0'};
+    static constexpr uint16_t DELTA_VERSION   = 1;
+
+    static void write_delta(std::ostream&                 out,
+                            const std::vector<cDBGEvent>& events);
+
+    static void write_delta(const std::string&            filename,
+                            const std::vector<cDBGEvent>& events) {
+        std::ofstream out(filename, std::ios::binary);
+        write_delta(out, events);
+    }
+
+    static std::vector<cDBGEvent> read_delta(std::istream& in);
+
+    static std::vector<cDBGEvent> read_delta(const std::string& filename) {
+        std::ifstream in(filename, std::ios::binary);
+        if (!in) {
+            throw GoetiaFileException("Could not open cDBG delta file " + filename);
+        }
+        return read_delta(in);
+    }
+
+    /**
+     * @Synopsis  Drain up to max_events and append them to the stream as one
+     *            delta block.
+     *
+     * @Returns   Number of events written.
+     */
+    size_t drain_to(std::ostream& out, size_t max_events = 4096) {
+        auto events = drain(max_events);
+        if (events.size()) {
+            write_delta(out, events);
+        }
+        return events.size();
+    }
+};
+
+}
+
+#endif
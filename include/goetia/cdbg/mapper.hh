@@ -0,0 +1,224 @@
+/**
+ * (c) Camille Scott, 2026
+ * File   : mapper.hh
+ * License: MIT
+ * Author : Camille Scott <camille.scott.w@gmail.com>
+ * Date   : 18.10.2026
+ *
+ * Pseudo-alignment of reads against the unitigs of a cDBG. A sampled
+ * index maps unitig minimizer k-mers (and unitig ends) to their
+ * (unitig ID, offset); reads are then mapped by looking up each of their
+ * k-mers in the index. The index is a snapshot of the cDBG at build time,
+ * so mapping never touches the live graph and can run on many threads.
+ */
+
+#ifndef GOETIA_CDBG_MAPPER_HH
+#define GOETIA_CDBG_MAPPER_HH
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// save diagnostic state
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#pragma GCC diagnostic ignored "-Wchar-subscripts"
+#include "goetia/storage/phmap/phmap.h"
+#pragma GCC diagnostic pop
+
+#include "goetia/goetia.hh"
+#include "goetia/cdbg/cdbg.hh"
+#include "goetia/cdbg/cdbg_types.hh"
+#include "goetia/hashing/kmeriterator.hh"
+#include "goetia/minimizers.hh"
+#include "goetia/parallel.hh"
+#include "goetia/parsing/parsing.hh"
+#include "goetia/parsing/readers.hh"
+#include "goetia/sequences/exceptions.hh"
+
+
+namespace goetia {
+
+template <class T>
+struct UnitigMapper;
+
+
+template <template <class, class> class GraphType,
+          class StorageType,
+          class ShifterType>
+struct UnitigMapper<GraphType<StorageType, ShifterType>> {
+
+    typedef GraphType<StorageType, ShifterType>    graph_type;
+    typedef typename cDBG<graph_type>::Graph       cdbg_type;
+    typedef typename cDBG<graph_type>::UnitigNode  UnitigNode;
+
+    typedef ShifterType                            shifter_type;
+    typedef typename shifter_type::hash_type       hash_type;
+    typedef typename hash_type::value_type         value_type;
+
+    /* Location of a sampled k-mer within the cDBG.
+     */
+    struct UnitigHit {
+        id_t     unitig_id;
+        uint32_t offset;
+    };
+
+    /* The ordered unitigs traversed by a read. For each unitig, read_positions
+     * holds the position of the first k-mer in the read which hit it and
+     * unitig_offsets the position of that k-mer in the unitig.
+     */
+    struct ReadMapping {
+        std::string           name;
+        std::vector<id_t>     unitig_ids;
+        std::vector<uint32_t> read_positions;
+        std::vector<uint32_t> unitig_offsets;
+
+        size_t size() const {
+            return unitig_ids.size();
+        }
+
+        bool is_mapped() const {
+            return !unitig_ids.empty();
+        }
+    };
+
+    typedef phmap::flat_hash_map<value_type, UnitigHit> index_type;
+
+    class Mapper {
+
+    protected:
+
+        index_type index;
+        // cDBG update count when the index was last built
+        uint64_t   _index_updates;
+
+    public:
+
+        const uint16_t             K;
+        const int64_t              window_size;
+        std::shared_ptr<cdbg_type> cdbg;
+
+        Mapper(std::shared_ptr<cdbg_type> cdbg,
+               int64_t                    window_size = 8)
+            : _index_updates(0),
+              K(cdbg->K),
+              window_size(window_size),
+              cdbg(cdbg)
+        {
+            rebuild_index();
+        }
+
+        static std::shared_ptr<Mapper> build(std::shared_ptr<cdbg_type> cdbg,
+                                             int64_t                    window_size = 8) {
+            return std::make_shared<Mapper>(cdbg, window_size);
+        }
+
+        /**
+         * @Synopsis  Rebuild the sampled k-mer index from the current state
+         *            of the cDBG. Holds the cDBG lock while building.
+         */
+        void rebuild_index();
+
+        /**
+         * @Synopsis  Whether the cDBG has been updated since the index was built.
+         */
+        bool is_stale() const {
+            return cdbg->n_updates() != _index_updates;
+        }
+
+        size_t index_size() const {
+            return index.size();
+        }
+
+        /**
+         * @Synopsis  Map a single sequence to the unitigs in the index. Thread-safe
+         *            with respect to other map calls, but not rebuild_index.
+         *
+         * @Param sequence The sequence to map.
+         *
+         * @Returns   The ordered unitig hits; empty if the sequence is shorter
+         *            than K or shares no sampled k-mers with the cDBG. Throws
+         *            InvalidCharacterException on symbols outside the alphabet.
+         */
+        ReadMapping map_sequence(const std::string& sequence) const {
+            ReadMapping mapping;
+            map_sequence(sequence, mapping);
+            return mapping;
+        }
+
+        void map_sequence(const std::string& sequence,
+                          ReadMapping&       mapping) const;
+
+        /**
+         * @Synopsis  Map a batch of sequences over n_threads worker threads.
+         *
+         * @Param sequences Sequences to map.
+         * @Param n_threads Number of worker threads; 0 uses the hardware concurrency.
+         *
+         * @Returns   A mapping for each sequence, in input order. Sequences
+         *            with invalid characters are left unmapped.
+         */
+        std::vector<ReadMapping> map_sequences(const std::vector<std::string>& sequences,
+                                               unsigned int                    n_threads = 1) const;
+
+        /**
+         * @Synopsis  Consume the next batch_size reads from the parser and map
+         *            them over n_threads worker threads. Reads which fail to parse
+         *            are skipped.
+         *
+         * @Param parser     Sequence parser.
+         * @Param batch_size Maximum number of reads to consume.
+         * @Param n_threads  Number of worker threads; 0 uses the hardware concurrency.
+         *
+         * @Returns   A mapping for each read consumed, in parse order. Empty
+         *            when the parser is exhausted.
+         */
+        std::vector<ReadMapping> map_sequences(std::shared_ptr<FastxParser<>>& parser,
+                                               size_t                          batch_size = 10000,
+                                               unsigned int                    n_threads  = 1) const;
+
+    protected:
+
+        void _map_range(const std::vector<std::string>& sequences,
+                        std::vector<ReadMapping>&       mappings,
+                        size_t                          begin,
+                        size_t                          end) const {
+            for (size_t i = begin; i < end; ++i) {
+                // a bad read is left unmapped rather than failing the batch
+                try {
+                    map_sequence(sequences[i], mappings[i]);
+                } catch (InvalidCharacterException& e) {
+                    _clear_mapping(mappings[i]);
+                } catch (SequenceLengthException& e) {
+                    _clear_mapping(mappings[i]);
+                }
+            }
+        }
+
+        static void _clear_mapping(ReadMapping& mapping) {
+            mapping.unitig_ids.clear();
+            mapping.read_positions.clear();
+            mapping.unitig_offsets.clear();
+        }
+
+        void _index_unitig(const UnitigNode *             unode,
+                           InteriorMinimizer<value_type>& minimizer,
+                           std::vector<value_type>&       hashes);
+    };
+
+};
+
+extern template class goetia::UnitigMapper<goetia::dBG<goetia::BitStorage, goetia::FwdLemireShifter>>;
+extern template class goetia::UnitigMapper<goetia::dBG<goetia::BitStorage, goetia::CanLemireShifter>>;
+
+extern template class goetia::UnitigMapper<goetia::dBG<goetia::PHMapStorage, goetia::FwdLemireShifter>>;
+extern template class goetia::UnitigMapper<goetia::dBG<goetia::PHMapStorage, goetia::CanLemireShifter>>;
+
+extern template class goetia::UnitigMapper<goetia::dBG<goetia::SparseppSetStorage, goetia::FwdLemireShifter>>;
+extern template class goetia::UnitigMapper<goetia::dBG<goetia::SparseppSetStorage, goetia::CanLemireShifter>>;
+
+}
+
+#endif
@@ -10,6 +10,9 @@
 #ifndef GOETIA_CDBG_METRICS_HH
 #define GOETIA_CDBG_METRICS_HH
 
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <string>
 #include <iostream>
 #include <sstream>
@@ -21,6 +24,177 @@
 namespace goetia {
 
 
+/**
+ * @Synopsis  Log-linear histogram of unitig lengths, updated in place as
+ *            unitigs are built, resized and deleted. Each power-of-two
+ *            octave is split into SUB_BUCKETS linear buckets, so lengths
+ *            below 2 * SUB_BUCKETS are counted exactly and longer lengths
+ *            to within 1 / SUB_BUCKETS relative error. Unitigs shorter than
+ *            EXACT_LENGTHS are also counted by exact length, so that length
+ *            bins with edges among them are summed exactly. Bins are
+ *            atomic: writers hold the cDBG lock, readers don't need to.
+ */
+class UnitigLengthHistogram {
+
+public:
+
+    static constexpr unsigned int SUB_BITS    = 4;
+    static constexpr uint64_t     SUB_BUCKETS = 1 << SUB_BITS;
+    static constexpr size_t       N_BUCKETS   = (64 - SUB_BITS + 1) * SUB_BUCKETS;
+    // a power of two, so that it's also a bucket boundary
+    static constexpr uint64_t     EXACT_LENGTHS = 1 << 12;
+
+private:
+
+    std::array<std::atomic<uint64_t>, N_BUCKETS> _counts;
+    std::array<std::atomic<uint64_t>, N_BUCKETS> _bases;
+    std::array<std::atomic<uint64_t>, EXACT_LENGTHS> _exact_counts;
+    std::atomic<uint64_t>                        _total_bases;
+    std::atomic<uint64_t>                        _n_unitigs;
+
+public:
+
+    UnitigLengthHistogram() {
+        clear();
+    }
+
+    void clear() {
+        for (size_t i = 0; i < N_BUCKETS; ++i) {
+            _counts[i].store(0, std::memory_order_relaxed);
+            _bases[i].store(0, std::memory_order_relaxed);
+        }
+        for (auto& count : _exact_counts) {
+            count.store(0, std::memory_order_relaxed);
+        }
+        _total_bases.store(0, std::memory_order_relaxed);
+        _n_unitigs.store(0, std::memory_order_relaxed);
+    }
+
+    static size_t bucket_index(uint64_t length) {
+        if (length < 2 * SUB_BUCKETS) {
+            return length;
+        }
+        unsigned int msb   = 63 - __builtin_clzll(length);
+        unsigned int shift = msb - SUB_BITS;
+        return (shift + 1) * SUB_BUCKETS + (length >> shift) - SUB_BUCKETS;
+    }
+
+    /**
+     * @Synopsis  Smallest length falling in the given bucket.
+     */
+    static uint64_t bucket_lower(size_t index) {
+        if (index < 2 * SUB_BUCKETS) {
+            return index;
+        }
+        unsigned int shift = index / SUB_BUCKETS - 1;
+        return (SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+    }
+
+    void add(uint64_t length) {
+        size_t i = bucket_index(length);
+        _counts[i].fetch_add(1, std::memory_order_relaxed);
+        _bases[i].fetch_add(length, std::memory_order_relaxed);
+        if (length < EXACT_LENGTHS) {
+            _exact_counts[length].fetch_add(1, std::memory_order_relaxed);
+        }
+        _total_bases.fetch_add(length, std::memory_order_relaxed);
+        _n_unitigs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void remove(uint64_t length) {
+        size_t i = bucket_index(length);
+        _counts[i].fetch_sub(1, std::memory_order_relaxed);
+        _bases[i].fetch_sub(length, std::memory_order_relaxed);
+        if (length < EXACT_LENGTHS) {
+            _exact_counts[length].fetch_sub(1, std::memory_order_relaxed);
+        }
+        _total_bases.fetch_sub(length, std::memory_order_relaxed);
+        _n_unitigs.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @Synopsis  Move a unitig from old_length to new_length.
+     */
+    void update(uint64_t old_length, uint64_t new_length) {
+        if (old_length == new_length) {
+            return;
+        }
+        size_t old_i = bucket_index(old_length);
+        size_t new_i = bucket_index(new_length);
+        if (old_i != new_i) {
+            _counts[old_i].fetch_sub(1, std::memory_order_relaxed);
+            _counts[new_i].fetch_add(1, std::memory_order_relaxed);
+        }
+        _bases[old_i].fetch_sub(old_length, std::memory_order_relaxed);
+        _bases[new_i].fetch_add(new_length, std::memory_order_relaxed);
+        if (old_length < EXACT_LENGTHS) {
+            _exact_counts[old_length].fetch_sub(1, std::memory_order_relaxed);
+        }
+        if (new_length < EXACT_LENGTHS) {
+            _exact_counts[new_length].fetch_add(1, std::memory_order_relaxed);
+        }
+        if (new_length > old_length) {
+            _total_bases.fetch_add(new_length - old_length, std::memory_order_relaxed);
+        } else {
+            _total_bases.fetch_sub(old_length - new_length, std::memory_order_relaxed);
+        }
+    }
+
+    uint64_t total_bases() const {
+        return _total_bases.load(std::memory_order_relaxed);
+    }
+
+    uint64_t n_unitigs() const {
+        return _n_unitigs.load(std::memory_order_relaxed);
+    }
+
+    uint64_t bucket_count(size_t index) const {
+        return _counts[index].load(std::memory_order_relaxed);
+    }
+
+    uint64_t bucket_bases(size_t index) const {
+        return _bases[index].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @Synopsis  Estimate the Nx statistic: the length L such that unitigs
+     *            of length >= L hold at least fraction of the total bases
+     *            (or of genome_size, for NGx). Within the bucket where the
+     *            threshold is crossed, the mean unitig length is reported.
+     *
+     * @Param fraction    Fraction in (0, 1]; 0.5 for the N50.
+     * @Param genome_size Reference size for NGx; 0 to use the total bases.
+     *
+     * @Returns   The estimate, or 0 if the threshold is never reached.
+     */
+    uint64_t nx(double fraction, uint64_t genome_size = 0) const;
+
+    uint64_t n50() const {
+        return nx(0.5);
+    }
+
+    uint64_t ng50(uint64_t genome_size) const {
+        return nx(0.5, genome_size);
+    }
+
+    /**
+     * @Synopsis  Sum the k-mers in unitigs falling in each of the given
+     *            length bins: [bins[i], bins[i+1]) for each i, then
+     *            [bins.back(), inf) in the last position. Exact when every
+     *            bin edge is below EXACT_LENGTHS or on a bucket boundary;
+     *            otherwise a bucket straddling an edge is counted in the bin
+     *            holding its lower bound.
+     *
+     * @Param bins Ascending bin edges in bases.
+     * @Param K    K-mer size.
+     *
+     * @Returns   Number of k-mers per bin.
+     */
+    std::vector<size_t> kmers_per_bin(const std::vector<size_t>& bins,
+                                      uint16_t                   K) const;
+};
+
+
 class cDBGMetrics {
 
 public:
@@ -41,6 +215,8 @@ public:
     Gauge                    n_clips;
     Gauge                    n_deletes;
     Gauge                    n_circular_merges;
+
+    UnitigLengthHistogram    unitig_lengths;
     
     cDBGMetrics() :
         n_full            {"node_type", "full_unode"},
@@ -0,0 +1,220 @@
+/**
+ * (c) Camille Scott, 2026
+ * File   : static_compactor.hh
+ * License: MIT
+ * Author : Camille Scott <camille.scott.w@gmail.com>
+ * Date   : 18.10.2026
+ */
+
+#ifndef GOETIA_STATIC_COMPACTOR_HH
+#define GOETIA_STATIC_COMPACTOR_HH
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "goetia/goetia.hh"
+#include "goetia/dbg.hh"
+#include "goetia/cdbg/cdbg.hh"
+#include "goetia/parallel.hh"
+#include "goetia/parsing/readers.hh"
+#include "goetia/storage/storage_types.hh"
+#include "goetia/storage/phmap/phmap.h"
+#include "goetia/traversal/unitig_walker.hh"
+
+
+namespace goetia {
+
+template <class T>
+class StaticCompactor;
+
+/**
+ * @Synopsis  Batch compaction of a finished dBG into a cDBG, in the manner
+ *            of BCALM: rather than replaying reads through the streaming
+ *            compactor, every k-mer is classified as a decision or interior
+ *            k-mer in parallel, and then maximal unitigs are walked from
+ *            seeds by many threads at once, each claiming the unitigs it
+ *            finds in a shared set so that each is built exactly once.
+ *
+ *            Storage holds only k-mer hashes, which can't be turned back
+ *            into k-mers, so the k-mers are enumerated from sequences
+ *            covering the graph -- typically the reads or contigs it was
+ *            built from. Every k-mer of those sequences must be in the dBG.
+ *            The resulting cDBG matches what the streaming compactor would
+ *            produce from the same k-mers; node IDs are assigned in order
+ *            of unitig hash and each unitig is put on a canonical strand, so
+ *            the result doesn't depend on thread count.
+ */
+template <template <class, class> class GraphType,
+          class StorageType,
+          class ShifterType>
+class StaticCompactor<GraphType<StorageType, ShifterType>> {
+
+public:
+
+    typedef GraphType<StorageType, ShifterType> graph_type;
+
+    using cDBGType     = typename cDBG<graph_type>::Graph;
+    using UnitigNode   = typename cDBG<graph_type>::UnitigNode;
+    using DecisionNode = typename cDBG<graph_type>::DecisionNode;
+
+    typedef ShifterType                         shifter_type;
+    typedef typename shifter_type::hash_type    hash_type;
+    typedef typename hash_type::value_type      value_type;
+    typedef typename graph_type::kmer_type      kmer_type;
+    typedef typename graph_type::State          State;
+
+    // thread-safe through its internal per-submap locks
+    typedef phmap::parallel_flat_hash_set<value_type,
+                                          phmap::priv::hash_default_hash<value_type>,
+                                          phmap::priv::hash_default_eq<value_type>,
+                                          phmap::priv::Allocator<value_type>,
+                                          6,
+                                          std::mutex> claimed_set_type;
+
+    typedef phmap::flat_hash_set<value_type>    decision_set_type;
+
+    struct Report {
+        uint64_t n_kmers;
+        uint64_t n_dnodes;
+        uint64_t n_unodes;
+        uint64_t n_circular;
+    };
+
+protected:
+
+    struct FoundUnitig {
+        // smallest k-mer hash in the unitig; unique to it
+        value_type  key;
+        hash_type   left_end;
+        hash_type   right_end;
+        std::string sequence;
+        bool        circular;
+
+        friend bool operator<(const FoundUnitig& lhs, const FoundUnitig& rhs) {
+            return lhs.key < rhs.key;
+        }
+    };
+
+    decision_set_type decision_kmers;
+    claimed_set_type  claimed;
+    claimed_set_type  covered;
+    Report            report;
+
+    /**
+     * @Synopsis  Classify the k-mers of sequences in parallel and build
+     *            decision nodes for the new decision k-mers.
+     */
+    void _build_dnodes(const std::vector<std::string>& sequences);
+
+    /**
+     * @Synopsis  Walk the unitigs seeded from sequences in parallel and
+     *            build those not already built.
+     *
+     * @Returns   Number of unitigs built.
+     */
+    uint64_t _build_unodes(const std::vector<std::string>& sequences);
+
+    /**
+     * @Synopsis  Walk the unitig through the interior k-mer seed, which
+     *            must not be a decision k-mer. Decision k-mers which the
+     *            walker steps on to are trimmed back off.
+     *
+     * @Param kmers   Filled with the hashes of the unitig's k-mers.
+     */
+    FoundUnitig _walk_unitig(graph_type&              walker,
+                             const char *             seed,
+                             std::vector<value_type>& kmers);
+
+    /**
+     * @Synopsis  With canonical hashing, a unitig's strand depends on the
+     *            seed it was walked from, and so on which thread claimed
+     *            it. Turn it to the lexicographically smaller of its
+     *            sequence and reverse complement; circular unitigs stay
+     *            rotated to start at their smallest k-mer.
+     */
+    void _orient_unitig(FoundUnitig& unitig) const;
+
+    bool _read_batch(std::shared_ptr<FastxParser<>>& parser,
+                     std::vector<std::string>&       sequences,
+                     size_t                          batch_size);
+
+public:
+
+    const uint16_t               K;
+    std::shared_ptr<graph_type>  dbg;
+    std::shared_ptr<cDBGType>    cdbg;
+    const unsigned int           n_threads;
+
+    StaticCompactor(std::shared_ptr<graph_type> dbg,
+                    unsigned int                n_threads             = 0,
+                    uint64_t                    minimizer_window_size = 8)
+        : K         (dbg->K),
+          dbg       (dbg),
+          n_threads (n_threads)
+    {
+        cdbg = std::make_shared<cDBGType>(dbg, minimizer_window_size);
+        report = Report{0, 0, 0, 0};
+    }
+
+    static std::shared_ptr<StaticCompactor> build(std::shared_ptr<graph_type> dbg,
+                                                  unsigned int                n_threads             = 0,
+                                                  uint64_t                    minimizer_window_size = 8) {
+        return std::make_shared<StaticCompactor>(dbg, n_threads, minimizer_window_size);
+    }
+
+    /**
+     * @Synopsis  Compact the part of the dBG covered by sequences. Unitigs
+     *            and decision nodes already built by an earlier call are
+     *            left alone.
+     *
+     * @Param sequences   Sequences whose k-mers are all in the dBG.
+     *
+     * @Returns   Number of unitigs built.
+     */
+    uint64_t compact(const std::vector<std::string>& sequences);
+
+    /**
+     * @Synopsis  Compact from the sequences of a FASTA/Q file, in batches
+     *            of batch_size records. The file is read twice, once to
+     *            find the decision k-mers and once to walk the unitigs, so
+     *            that it needn't fit in memory.
+     *
+     * @Returns   Number of unitigs built.
+     */
+    uint64_t compact(const std::string& filename,
+                     size_t             batch_size = 100000);
+
+    /**
+     * @Synopsis  Compact, then write the cDBG out in the given format.
+     */
+    void compact_to(const std::string&              filename,
+                    const std::vector<std::string>& sequences,
+                    cDBGFormat                      format = cDBGFormat::GFA1) {
+        compact(sequences);
+        cdbg->write(filename, format);
+    }
+
+    bool is_decision_kmer(const hash_type& h) const {
+        return decision_kmers.count(h.value());
+    }
+
+    Report get_report() const {
+        return report;
+    }
+};
+
+}
+
+extern template class goetia::StaticCompactor<goetia::dBG<goetia::SparseppSetStorage, goetia::FwdLemireShifter>>;
+extern template class goetia::StaticCompactor<goetia::dBG<goetia::SparseppSetStorage, goetia::CanLemireShifter>>;
+
+extern template class goetia::StaticCompactor<goetia::dBG<goetia::PHMapStorage, goetia::FwdLemireShifter>>;
+extern template class goetia::StaticCompactor<goetia::dBG<goetia::PHMapStorage, goetia::CanLemireShifter>>;
+
+extern template class goetia::StaticCompactor<goetia::dBG<goetia::BTreeStorage, goetia::FwdLemireShifter>>;
+extern template class goetia::StaticCompactor<goetia::dBG<goetia::BTreeStorage, goetia::CanLemireShifter>>;
+
+#endif
@@ -12,6 +12,7 @@
 #include "goetia/meta.hh"
 #include "goetia/hashing/kmeriterator.hh"
 #include "goetia/processors.hh"
+#include "goetia/profiling.hh"
 #include "goetia/storage/storage.hh"
 #include "goetia/storage/storage_types.hh"
 #include "goetia/hashing/rollinghashshifter.hh"
@@ -72,6 +73,34 @@ protected:
 
     std::shared_ptr<StorageType> S;
 
+    // scratch for the hashes of the sequence being inserted or queried
+    std::vector<hash_type>       _hash_buffer;
+    // scratch for the raw values handed to the storage's batched queries
+    std::vector<typename hash_type::value_type> _value_buffer;
+
+    /**
+     * @Synopsis  Hash the k-mers of sequence on to the end of hashes: in
+     *            one pass with the shifter's sequence kernel if it has one,
+     *            otherwise a k-mer at a time. Either way the shifter ends up
+     *            on the last k-mer.
+     *
+     * @Returns   Number of k-mers hashed.
+     */
+    size_t _hash_sequence(const std::string&      sequence,
+                          std::vector<hash_type>& hashes) {
+        ProfileScopeGuard profile(ProfileScope::HASH);
+        if constexpr (has_sequence_kernel<ShifterType>::value) {
+            return this->hash_sequence(sequence, hashes);
+        } else {
+            KmerIterator<ShifterType> iter(sequence, this);
+            const size_t start = hashes.size();
+            while(!iter.done()) {
+                hashes.push_back(iter.next());
+            }
+            return hashes.size() - start;
+        }
+    }
+
 public:
 
     friend walker_type;
@@ -176,6 +205,33 @@ public:
         return S->query(h.value());
     }
 
+    /**
+     * @Synopsis  Gets the counts of n hashed k-mers in one batch, which
+     *            lets the storage overlap the lookups.
+     */
+    void query_many(const typename hash_type::value_type * hashes,
+                    count_t *                              counts,
+                    size_t                                 n) const {
+        S->query_many(hashes, counts, n);
+    }
+
+    /**
+     * @Synopsis  As above, for n k-mer hashes.
+     */
+    void query_many(const hash_type * hashes,
+                    count_t *         counts,
+                    size_t            n) {
+        _value_buffer.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            _value_buffer[i] = hashes[i].value();
+        }
+        S->query_many(_value_buffer.data(), counts, n);
+    }
+
+    std::shared_ptr<StorageType> get_storage() {
+        return S;
+    }
+
     /**
      * @Synopsis  Number of unique k-mers in the storage.
      *
@@ -250,71 +306,98 @@ public:
                              std::vector<hash_type>&  kmer_hashes,
                              std::vector<count_t>& counts) {
     
-        KmerIterator<ShifterType> iter(sequence, static_cast<ShifterType*>(this));
-
-        count_t count;
-        while(!iter.done()) {
-            auto h = iter.next();
-            count  = insert_and_query(h);
+        const size_t start = kmer_hashes.size();
+        const size_t n_kmers = _hash_sequence(sequence, kmer_hashes);
 
-            kmer_hashes.push_back(h);
-            counts.push_back(count);
+        {
+            ProfileScopeGuard profile(ProfileScope::STORAGE_INSERT);
+            for (size_t i = start; i < start + n_kmers; ++i) {
+                counts.push_back(insert_and_query(kmer_hashes[i]));
+            }
         }
 
-        return sequence.size() - K + 1;
+        return n_kmers;
     }
 
     uint64_t insert_sequence(const std::string&      sequence,
                              std::set<hash_type>& new_kmers) {
 
-        KmerIterator<ShifterType> iter(sequence, this);
+        _hash_buffer.clear();
+        const size_t n_kmers = _hash_sequence(sequence, _hash_buffer);
 
-        while(!iter.done()) {
-            hash_type h = iter.next();
-            if(insert(h)) {
-                new_kmers.insert(h);
+        {
+            ProfileScopeGuard profile(ProfileScope::STORAGE_INSERT);
+            for (const auto& h : _hash_buffer) {
+                if(insert(h)) {
+                    new_kmers.insert(h);
+                }
             }
         }
 
-        return sequence.size() - K + 1;
+        return n_kmers;
     }
 
     uint64_t insert_sequence(const std::string&      sequence,
                              std::vector<hash_type>& hashes) {
 
-        KmerIterator<ShifterType> iter(sequence, this);
+        const size_t start = hashes.size();
+        const size_t n_kmers = _hash_sequence(sequence, hashes);
 
-        while(!iter.done()) {
-            hash_type h = iter.next();
-            insert(h);
-            hashes.push_back(h);
+        {
+            ProfileScopeGuard profile(ProfileScope::STORAGE_INSERT);
+            for (size_t i = start; i < start + n_kmers; ++i) {
+                insert(hashes[i]);
+            }
         }
 
-        return sequence.size() - K + 1;
+        return n_kmers;
     }
 
     uint64_t insert_sequence(const std::string& sequence) {
     
-        KmerIterator<ShifterType> iter(sequence, this);
+        _hash_buffer.clear();
+        const size_t n_kmers = _hash_sequence(sequence, _hash_buffer);
 
-        while(!iter.done()) {
-            insert(iter.next());
+        {
+            ProfileScopeGuard profile(ProfileScope::STORAGE_INSERT);
+            for (const auto& h : _hash_buffer) {
+                insert(h);
+            }
         }
 
-        return sequence.size() - K + 1;
+        return n_kmers;
     }
 
     uint64_t insert_sequence(const std::string& sequence,
                              uint64_t&          n_new) {
     
-        KmerIterator<ShifterType> iter(sequence, this);
+        _hash_buffer.clear();
+        const size_t n_kmers = _hash_sequence(sequence, _hash_buffer);
         
         n_new = 0;
-        while(!iter.done()) {
-            n_new += insert(iter.next());
+        {
+            ProfileScopeGuard profile(ProfileScope::STORAGE_INSERT);
+            for (const auto& h : _hash_buffer) {
+                n_new += insert(h);
+            }
         }
 
-        return sequence.size() - K + 1;
+        return n_kmers;
+    }
+
+    /**
+     * @Synopsis  Insert all k-mers from each of the given sequences.
+     *
+     * @Param sequences Sequences to insert, each of length >= K.
+     *
+     * @Returns Total number of k-mers inserted.
+     */
+    uint64_t insert_sequences(const std::vector<std::string>& sequences) {
+        uint64_t n_kmers = 0;
+        for (const auto& sequence : sequences) {
+            n_kmers += insert_sequence(sequence);
+        }
+        return n_kmers;
     }
 
     /**
@@ -326,14 +409,15 @@ public:
      */
     std::vector<count_t> insert_and_query_sequence(const std::string& sequence)  {
 
-        KmerIterator<ShifterType> iter(sequence, this);
-        std::vector<count_t> counts(sequence.length() - K + 1);
+        _hash_buffer.clear();
+        const size_t n_kmers = _hash_sequence(sequence, _hash_buffer);
+        std::vector<count_t> counts(n_kmers);
 
-        size_t pos = 0;
-        while(!iter.done()) {
-            hash_type h = iter.next();
-            counts[pos] = S->insert_and_query(h.value());
-            ++pos;
+        {
+            ProfileScopeGuard profile(ProfileScope::STORAGE_INSERT);
+            for (size_t pos = 0; pos < n_kmers; ++pos) {
+                counts[pos] = S->insert_and_query(_hash_buffer[pos].value());
+            }
         }
 
         return counts;
@@ -348,31 +432,28 @@ public:
      */
     std::vector<count_t> query_sequence(const std::string& sequence)  {
 
-        KmerIterator<ShifterType> iter(sequence, this);
-        std::vector<count_t> counts(sequence.length() - K + 1);
-
-        size_t pos = 0;
-        while(!iter.done()) {
-            hash_type h = iter.next();
-            counts[pos] = query(h);
-            ++pos;
-        }
+        _hash_buffer.clear();
+        const size_t n_kmers = _hash_sequence(sequence, _hash_buffer);
+        std::vector<count_t> counts(n_kmers);
+        query_many(_hash_buffer.data(), counts.data(), n_kmers);
 
         return counts;
     }
 
+    /**
+     * @Synopsis  Hash the k-mers of sequence on to the end of hashes and
+     *            their counts, from one batched query, on to the end of counts.
+     */
     void query_sequence(const std::string&             sequence,
                         std::vector<count_t>& counts,
                         std::vector<hash_type>&  hashes) {
 
-        KmerIterator<ShifterType> iter(sequence, this);
+        const size_t start = hashes.size();
+        const size_t n_kmers = _hash_sequence(sequence, hashes);
 
-        while(!iter.done()) {
-            hash_type h = iter.next();
-            count_t result = query(h);
-            counts.push_back(result);
-            hashes.push_back(h);
-        }
+        const size_t offset = counts.size();
+        counts.resize(offset + n_kmers);
+        query_many(hashes.data() + start, counts.data() + offset, n_kmers);
     }
 
     void query_sequence(const std::string& sequence,
@@ -380,16 +461,14 @@ public:
                         std::vector<hash_type>& hashes,
                         std::set<hash_type>& new_hashes) {
 
-        KmerIterator<ShifterType> iter(sequence, this);
+        const size_t start = hashes.size();
+        const size_t offset = counts.size();
+        query_sequence(sequence, counts, hashes);
 
-        while(!iter.done()) {
-            hash_type h = iter.next();
-            auto result = query(h);
-            if (result == 0) {
-                new_hashes.insert(h);
+        for (size_t i = 0; i < hashes.size() - start; ++i) {
+            if (counts[offset + i] == 0) {
+                new_hashes.insert(hashes[start + i]);
             }
-            counts.push_back(result);
-            hashes.push_back(h);
         }
     }
 
@@ -480,6 +559,17 @@ struct Masked : public UnitigWalker<Masked<StorageType, ShifterType, MaskType>>
         return S->query(h.value());
     }
 
+    void query_many(const value_type * hashes,
+                    count_t *          counts,
+                    size_t             n) const {
+        S->query_many(hashes, counts, n);
+        for (size_t i = 0; i < n; ++i) {
+            if (counts[i] && mask.count(hash_type(hashes[i]))) {
+                counts[i] = 0;
+            }
+        }
+    }
+
     std::vector<count_t> query_sequence(const std::string& sequence)  {
 
         KmerIterator<ShifterType> iter(sequence, this);
@@ -0,0 +1,583 @@
+/**
+ * (c) Camille Scott, 2026
+ * File   : events.hh
+ * License: MIT
+ * Author : Camille Scott <camille.scott.w@gmail.com>
+ * Date   : 18.10.2026
+ *
+ * A native event bus for stream processing. Processors publish small POD
+ * events (interval boundaries, sample starts and ends, saturation) onto a
+ * bounded lock-free queue, and never wait on their consumers: when the
+ * queue is full, events are dropped and counted.
+ *
+ * Subscribers are either synchronous, called on the publishing thread
+ * before publish returns -- for checks like saturation, which have to see
+ * the sketch as it was at the interval boundary -- or asynchronous, called
+ * from the bus's dispatcher thread. Python collects batches of events on
+ * demand through a StreamEventCollector, rather than being called into at
+ * every interval.
+ */
+
+#ifndef GOETIA_EVENTS_HH
+#define GOETIA_EVENTS_HH
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "goetia/goetia.hh"
+#include "goetia/profiling.hh"
+
+
+namespace goetia {
+
+
+/**
+ * @Synopsis  Bounded multi-producer, multi-consumer queue, after Vyukov:
+ *            each slot carries a sequence number which tells producers and
+ *            consumers whose turn it is, so neither takes a lock.
+ *
+ * @tparam T  Element type; should be trivially copyable.
+ */
+template <class T>
+class EventQueue {
+
+    struct Slot {
+        std::atomic<uint64_t> sequence;
+        T                     value;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    const uint64_t          mask;
+
+    alignas(64) std::atomic<uint64_t> head;
+    alignas(64) std::atomic<uint64_t> tail;
+    alignas(64) std::atomic<uint64_t> _n_dropped;
+
+    static uint64_t round_capacity(uint64_t capacity) {
+        uint64_t c = 2;
+        while (c < capacity) {
+            c <<= 1;
+        }
+        return c;
+    }
+
+public:
+
+    const uint64_t capacity;
+
+    /**
+     * @Synopsis  Build a queue holding at least capacity elements; the
+     *            capacity is rounded up to a power of two.
+     */
+    explicit EventQueue(uint64_t capacity = 1 << 12)
+        : mask(round_capacity(capacity) - 1),
+          head(0),
+          tail(0),
+          _n_dropped(0),
+          capacity(mask + 1)
+    {
+        slots.reset(new Slot[this->capacity]);
+        for (uint64_t i = 0; i < this->capacity; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @Synopsis  Push an element. Never blocks.
+     *
+     * @Returns   false if the queue was full and the element dropped.
+     */
+    bool push(const T& value) {
+        uint64_t pos = head.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots[pos & mask];
+            uint64_t seq = slot.sequence.load(std::memory_order_acquire);
+            int64_t diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+            if (diff == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.value = value;
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                _n_dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @Synopsis  Pop an element. Never blocks.
+     *
+     * @Returns   false if the queue was empty.
+     */
+    bool pop(T& value) {
+        uint64_t pos = tail.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots[pos & mask];
+            uint64_t seq = slot.sequence.load(std::memory_order_acquire);
+            int64_t diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos + 1);
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = slot.value;
+                    slot.sequence.store(pos + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @Synopsis  Approximate number of pending elements.
+     */
+    uint64_t size() const {
+        uint64_t h = head.load(std::memory_order_relaxed);
+        uint64_t t = tail.load(std::memory_order_relaxed);
+        return h > t ? h - t : 0;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    uint64_t n_dropped() const {
+        return _n_dropped.load(std::memory_order_relaxed);
+    }
+};
+
+
+enum StreamEventType {
+    SAMPLE_STARTED = 0,
+    INTERVAL,
+    SAMPLE_FINISHED,
+    SAMPLE_SATURATED,
+    DISTANCE_CALC,
+    STREAM_ERROR,
+    END_STREAM
+};
+
+
+const char * stream_event_type_name(StreamEventType type);
+
+
+/**
+ * @Synopsis  A single stream event. timestamp is in seconds on the steady
+ *            clock, the same clock as Python's time.perf_counter on Linux;
+ *            distance and stat are only set on DISTANCE_CALC events, and
+ *            are NaN otherwise.
+ */
+struct StreamEvent {
+    StreamEventType type;
+    uint32_t        sample_id;
+    uint64_t        t;
+    uint64_t        sequence;
+    double          timestamp;
+    double          distance;
+    double          stat;
+
+    StreamEvent()
+        : StreamEvent(INTERVAL, 0, 0, 0)
+    {
+    }
+
+    StreamEvent(StreamEventType type,
+                uint32_t        sample_id,
+                uint64_t        t,
+                uint64_t        sequence,
+                double          distance = std::numeric_limits<double>::quiet_NaN(),
+                double          stat     = std::numeric_limits<double>::quiet_NaN())
+        : type(type),
+          sample_id(sample_id),
+          t(t),
+          sequence(sequence),
+          timestamp(now()),
+          distance(distance),
+          stat(stat)
+    {
+    }
+
+    static double now() {
+        return std::chrono::duration<double>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    std::string to_json() const;
+};
+
+
+class StreamEventBus;
+
+
+class StreamEventSubscriber {
+
+public:
+
+    virtual ~StreamEventSubscriber() = default;
+
+    /**
+     * @Synopsis  Handle an event. Synchronous subscribers are called on
+     *            the publishing thread, and can publish further events to
+     *            the bus; asynchronous subscribers are called from the
+     *            dispatcher thread, one event at a time and in order.
+     */
+    virtual void on_event(const StreamEvent& event, StreamEventBus& bus) = 0;
+};
+
+
+/**
+ * @Synopsis  Routes stream events from the processors to subscribers.
+ *            Subscribe everything before start(); the subscriber lists
+ *            aren't safe to change while events are being published.
+ */
+class StreamEventBus {
+
+    EventQueue<StreamEvent> queue;
+
+    std::vector<std::shared_ptr<StreamEventSubscriber>> sync_subscribers;
+    std::vector<std::shared_ptr<StreamEventSubscriber>> async_subscribers;
+
+    std::atomic<uint32_t> _sample_id;
+    std::atomic<bool>     _stop_requested;
+    std::atomic<bool>     _running;
+
+    std::thread             dispatcher;
+    std::mutex              wake_mutex;
+    std::condition_variable wake;
+
+    void run_dispatcher();
+
+public:
+
+    // how long the dispatcher sleeps when it misses a wakeup
+    static constexpr std::chrono::milliseconds POLL_INTERVAL{10};
+
+    explicit StreamEventBus(uint64_t capacity = 1 << 12);
+
+    ~StreamEventBus();
+
+    static std::shared_ptr<StreamEventBus> build(uint64_t capacity = 1 << 12) {
+        return std::make_shared<StreamEventBus>(capacity);
+    }
+
+    /**
+     * @Synopsis  Add a subscriber.
+     *
+     * @Param subscriber  The subscriber.
+     * @Param synchronous Call it on the publishing thread rather than the
+     *                    dispatcher thread.
+     */
+    void subscribe(std::shared_ptr<StreamEventSubscriber> subscriber,
+                   bool                                   synchronous = false);
+
+    /**
+     * @Synopsis  Queue an event for the asynchronous subscribers, then call
+     *            the synchronous ones. Never blocks on the asynchronous
+     *            subscribers.
+     *
+     * @Returns   false if the queue was full and the event was dropped;
+     *            the synchronous subscribers are called either way.
+     */
+    bool publish(const StreamEvent& event);
+
+    /*
+     * Conveniences for publishing each type of event for the current
+     * sample, which is set by sample_started.
+     */
+
+    bool sample_started(uint32_t sample_id, uint64_t t, uint64_t sequence);
+
+    bool interval(uint64_t t, uint64_t sequence) {
+        return publish(StreamEvent(INTERVAL, sample_id(), t, sequence));
+    }
+
+    bool sample_finished(uint64_t t, uint64_t sequence) {
+        return publish(StreamEvent(SAMPLE_FINISHED, sample_id(), t, sequence));
+    }
+
+    bool sample_saturated(uint64_t t, uint64_t sequence) {
+        return publish(StreamEvent(SAMPLE_SATURATED, sample_id(), t, sequence));
+    }
+
+    bool distance_calc(uint64_t t, uint64_t sequence, double distance, double stat) {
+        return publish(StreamEvent(DISTANCE_CALC, sample_id(), t, sequence, distance, stat));
+    }
+
+    bool error(uint64_t t, uint64_t sequence) {
+        return publish(StreamEvent(STREAM_ERROR, sample_id(), t, sequence));
+    }
+
+    bool end_stream(uint64_t t, uint64_t sequence) {
+        return publish(StreamEvent(END_STREAM, sample_id(), t, sequence));
+    }
+
+    uint32_t sample_id() const {
+        return _sample_id.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @Synopsis  Ask the processors publishing to this bus to stop at
+     *            their next interval; used to stop a saturated sample.
+     *            Cleared by sample_started.
+     */
+    void request_stop() {
+        _stop_requested.store(true, std::memory_order_relaxed);
+    }
+
+    bool stop_requested() const {
+        return _stop_requested.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @Synopsis  Start delivering events to the asynchronous subscribers
+     *            on the dispatcher thread.
+     */
+    void start();
+
+    /**
+     * @Synopsis  Deliver whatever's still queued, and join the dispatcher
+     *            thread.
+     */
+    void stop();
+
+    bool is_running() const {
+        return _running.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @Synopsis  Deliver queued events to the asynchronous subscribers on
+     *            the calling thread, for running without the dispatcher.
+     *
+     * @Returns   Number of events delivered.
+     */
+    size_t dispatch(size_t max_events = std::numeric_limits<size_t>::max());
+
+    uint64_t n_pending() const {
+        return queue.size();
+    }
+
+    uint64_t n_dropped() const {
+        return queue.n_dropped();
+    }
+};
+
+
+/**
+ * @Synopsis  Buffers events for a consumer that wants them in batches,
+ *            on its own schedule; the buffer is only locked for as long
+ *            as it takes to append or swap it out.
+ */
+class StreamEventCollector : public StreamEventSubscriber {
+
+    std::vector<StreamEvent> buffer;
+    std::mutex               mutex;
+
+public:
+
+    static std::shared_ptr<StreamEventCollector> build() {
+        return std::make_shared<StreamEventCollector>();
+    }
+
+    void on_event(const StreamEvent& event, StreamEventBus& bus) override;
+
+    /**
+     * @Synopsis  Take every event collected since the last call.
+     */
+    std::vector<StreamEvent> collect();
+};
+
+
+/**
+ * @Synopsis  Streams events to a file as a JSON list, in the same layout
+ *            as goetia.processors.JSONStreamWriter. The list is closed
+ *            when the writer is destroyed or close() is called.
+ */
+class JSONEventWriter : public StreamEventSubscriber {
+
+    std::ofstream out;
+    uint64_t      n_writes;
+
+public:
+
+    explicit JSONEventWriter(const std::string& filename);
+
+    ~JSONEventWriter();
+
+    static std::shared_ptr<JSONEventWriter> build(const std::string& filename) {
+        return std::make_shared<JSONEventWriter>(filename);
+    }
+
+    void on_event(const StreamEvent& event, StreamEventBus& bus) override;
+
+    void close();
+};
+
+
+/**
+ * @Synopsis  At each interval and sample end, reads a set of named
+ *            metrics and streams them as a JSON list, with the event's
+ *            time, sequence, sample and timestamp. Subscribed
+ *            synchronously, the values are exactly those at the interval
+ *            boundary, but the write happens on the processing thread.
+ *            Subscribed asynchronously, the readers run on the dispatcher
+ *            thread, must be safe to call while the processor is running
+ *            -- reading an atomic, for example -- and may see a later
+ *            state than the event's.
+ */
+class MetricSnapshotter : public StreamEventSubscriber {
+
+    std::vector<std::pair<std::string, std::function<double()>>> metrics;
+    std::ofstream                                                out;
+    uint64_t                                                     n_writes;
+
+public:
+
+    explicit MetricSnapshotter(const std::string& filename);
+
+    ~MetricSnapshotter();
+
+    static std::shared_ptr<MetricSnapshotter> build(const std::string& filename) {
+        return std::make_shared<MetricSnapshotter>(filename);
+    }
+
+    void track(const std::string& name, std::function<double()> reader) {
+        metrics.emplace_back(name, reader);
+    }
+
+    void on_event(const StreamEvent& event, StreamEventBus& bus) override;
+
+    void close();
+};
+
+
+/**
+ * @Synopsis  Takes a Profiler's totals and latencies at each interval,
+ *            and its sample latencies at each sample end, and holds them
+ *            until they're asked for by event. Subscribe it synchronously,
+ *            so that each snapshot covers exactly its own interval however
+ *            late the events are collected.
+ */
+class ProfileSnapshotter : public StreamEventSubscriber {
+
+public:
+
+    typedef std::map<std::string, std::map<std::string, uint64_t>> scope_stats_type;
+
+    struct Snapshot {
+        scope_stats_type perf_counters;
+        scope_stats_type latencies;
+    };
+
+private:
+
+    typedef std::tuple<uint32_t, uint64_t, StreamEventType> key_type;
+
+    std::shared_ptr<Profiler>    profiler;
+    const bool                   perf_counters;
+    const bool                   latencies;
+    std::map<key_type, Snapshot> snapshots;
+    std::mutex                   mutex;
+
+public:
+
+    /**
+     * @Param perf_counters Whether to take the hardware counter totals.
+     * @Param latencies     Whether to take the latency quantiles.
+     */
+    ProfileSnapshotter(std::shared_ptr<Profiler> profiler,
+                       bool                      perf_counters,
+                       bool                      latencies)
+        : profiler(profiler),
+          perf_counters(perf_counters),
+          latencies(latencies)
+    {
+    }
+
+    static std::shared_ptr<ProfileSnapshotter> build(std::shared_ptr<Profiler> profiler,
+                                                     bool                      perf_counters,
+                                                     bool                      latencies) {
+        return std::make_shared<ProfileSnapshotter>(profiler, perf_counters, latencies);
+    }
+
+    void on_event(const StreamEvent& event, StreamEventBus& bus) override;
+
+    /**
+     * @Synopsis  Remove and return the snapshot taken at event; empty if
+     *            there is none.
+     */
+    Snapshot take(const StreamEvent& event);
+};
+
+
+/**
+ * @Synopsis  Runs a native saturation tracker at each interval, on the
+ *            processing thread at the interval boundary, so that the
+ *            tracker never sees the sketch mid-insert. Publishes a
+ *            DISTANCE_CALC event once the smoothed statistic is defined;
+ *            if stop_on_saturation is set, publishes SAMPLE_SATURATED when
+ *            the cutoff is reached and asks the processor to stop.
+ *            Subscribe synchronously.
+ *
+ * @tparam TrackerType Has update(t) returning a SaturationStatus.
+ */
+template <class TrackerType>
+class SaturationCheck : public StreamEventSubscriber {
+
+    std::shared_ptr<TrackerType> tracker;
+    const bool                   stop_on_saturation;
+
+public:
+
+    SaturationCheck(std::shared_ptr<TrackerType> tracker,
+                    bool                         stop_on_saturation = true)
+        : tracker(tracker),
+          stop_on_saturation(stop_on_saturation)
+    {
+    }
+
+    static std::shared_ptr<SaturationCheck> build(std::shared_ptr<TrackerType> tracker,
+                                                  bool stop_on_saturation = true) {
+        return std::make_shared<SaturationCheck>(tracker, stop_on_saturation);
+    }
+
+    void on_event(const StreamEvent& event, StreamEventBus& bus) override {
+        if (event.type != INTERVAL) {
+            return;
+        }
+
+        auto status = tracker->update(event.t);
+        if (std::isnan(status.distance)) {
+            return;
+        }
+        if (!std::isnan(status.stat)) {
+            bus.distance_calc(event.t, event.sequence, status.distance, status.stat);
+        }
+
+        if (status.cutoff_reached && stop_on_saturation) {
+            bus.sample_saturated(event.t, event.sequence);
+            bus.request_stop();
+        }
+    }
+};
+
+}
+
+#endif
@@ -9,6 +9,7 @@
 #ifndef GOETIA_HASHEXTENDER_HH
 #define GOETIA_HASHEXTENDER_HH
 
+#include <array>
 #include <vector>
 
 #include "goetia/hashing/hashshifter.hh"
@@ -44,6 +45,89 @@ using supports_right_extension = is_detected<right_extension_t, ShifterType>;
 
 
 
+/**
+ * @Synopsis  Fixed-capacity stand-in for std::vector holding the
+ *            extensions of a single k-mer, of which there is at most one
+ *            per alphabet symbol. Lives on the stack, so gathering and
+ *            filtering neighbors during traversal never allocates.
+ */
+template <class ShiftType, size_t N>
+class ExtensionArray {
+
+    std::array<ShiftType, N> items;
+    uint8_t                  n;
+
+public:
+
+    typedef ShiftType                                       value_type;
+    typedef typename std::array<ShiftType, N>::iterator       iterator;
+    typedef typename std::array<ShiftType, N>::const_iterator const_iterator;
+
+    static constexpr size_t capacity = N;
+
+    ExtensionArray()
+        : n(0)
+    {
+    }
+
+    void push_back(const ShiftType& shift) {
+        items[n++] = shift;
+    }
+
+    void clear() {
+        n = 0;
+    }
+
+    size_t size() const {
+        return n;
+    }
+
+    bool empty() const {
+        return n == 0;
+    }
+
+    ShiftType& operator[](size_t i) {
+        return items[i];
+    }
+
+    const ShiftType& operator[](size_t i) const {
+        return items[i];
+    }
+
+    ShiftType& front() {
+        return items[0];
+    }
+
+    const ShiftType& front() const {
+        return items[0];
+    }
+
+    ShiftType& back() {
+        return items[n - 1];
+    }
+
+    const ShiftType& back() const {
+        return items[n - 1];
+    }
+
+    iterator begin() {
+        return items.begin();
+    }
+
+    iterator end() {
+        return items.begin() + n;
+    }
+
+    const_iterator begin() const {
+        return items.cbegin();
+    }
+
+    const_iterator end() const {
+        return items.cbegin() + n;
+    }
+};
+
+
 /**
  * @Synopsis  Find left and right extensions from a k-mer. This is stateful,
  *            with the current k-mer stored in a ring buffer. A HashShifter
@@ -79,6 +163,10 @@ public:
     typedef Shift<hash_type, DIR_LEFT>         shift_left_type;
     typedef Shift<hash_type, DIR_RIGHT>        shift_right_type;
 
+    template<bool Dir>
+        using extensions_type = ExtensionArray<Shift<hash_type, Dir>,
+                                               alphabet::SYMBOLS.size()>;
+
     using extension_policy::K;
 
     template<typename... ExtraArgs>
@@ -150,6 +238,22 @@ public:
         return this->left_extensions_impl();
     }
 
+    /**
+     * @Synopsis  As left_extensions, but gathered into a fixed-size
+     *            buffer rather than a new vector.
+     *
+     * @Param result   Cleared and filled with the extensions.
+     */
+    void left_extensions(extensions_type<DIR_LEFT>& result) {
+
+        if (!this->is_loaded()) {
+            throw UninitializedShifterException();
+        }
+
+        result.clear();
+        this->left_extensions_impl(result);
+    }
+
     /**
      * @Synopsis  Shift cursor right from current value using
      *            symbol c and return hash value.
@@ -188,6 +292,22 @@ public:
         return this->right_extensions_impl();
     }
 
+    /**
+     * @Synopsis  As right_extensions, but gathered into a fixed-size
+     *            buffer rather than a new vector.
+     *
+     * @Param result   Cleared and filled with the extensions.
+     */
+    void right_extensions(extensions_type<DIR_RIGHT>& result) {
+
+        if (!this->is_loaded()) {
+            throw UninitializedShifterException();
+        }
+
+        result.clear();
+        this->right_extensions_impl(result);
+    }
+
     /**
      * @Synopsis  Initialize the base hash function and set the kmer span cursor.
      *
@@ -352,15 +472,24 @@ public:
     std::vector<shift_left_type> left_extensions_impl() {
 
         std::vector<shift_left_type> hashes;
+        hashes.reserve(alphabet::SYMBOLS.size());
+        left_extensions_impl(hashes);
+        return hashes;
+    }
+
+    /**
+     * @Synopsis  Append the left extensions to hashes, which may be
+     *            a vector or an ExtensionArray.
+     */
+    template<class Container>
+    void left_extensions_impl(Container& hashes) {
+
         auto back = this->back();
         for (const auto& symbol : alphabet::SYMBOLS) {
             hash_type h = ShifterType::shift_left(symbol, back);
-            shift_left_type result(h, symbol);
-            hashes.push_back(result);
+            hashes.push_back(shift_left_type(h, symbol));
             ShifterType::shift_right(symbol, back);
         }
-
-        return hashes;
     }
 
     /**
@@ -386,13 +515,24 @@ public:
      std::vector<shift_right_type> right_extensions_impl() {
 
         std::vector<shift_right_type> hashes;
+        hashes.reserve(alphabet::SYMBOLS.size());
+        right_extensions_impl(hashes);
+        return hashes;
+    }
+
+    /**
+     * @Synopsis  Append the right extensions to hashes, which may be
+     *            a vector or an ExtensionArray.
+     */
+    template<class Container>
+    void right_extensions_impl(Container& hashes) {
+
         auto front = this->front();
         for (const auto& symbol : alphabet::SYMBOLS) {
             hash_type h = ShifterType::shift_right(front, symbol);
             hashes.push_back(shift_right_type(h, symbol));
             ShifterType::shift_left(front, symbol);
         }
-        return hashes;
     }
 
     hash_type set_cursor_impl(const char * sequence) {
@@ -54,6 +54,16 @@ struct has_minimizer {
 };
 
 
+/**
+ * @Synopsis  Whether the shifter can hash a whole sequence at once with
+ *            hash_sequence, rather than shifting k-mer by k-mer.
+ */
+template<class ShifterType>
+struct has_sequence_kernel {
+    static const bool value = false;
+};
+
+
 /**
  * @Synopsis  Policy client class for shifter adapters. Implementations
  *            must define _shift_left, _shift_right, _get, _hash_base,
@@ -68,6 +78,12 @@ struct has_minimizer {
 template<class T>
 struct HashShifter;
 
+template <typename HashType,
+          typename Alphabet>
+struct has_sequence_kernel<HashShifter<LemireShifterPolicy<HashType, Alphabet>>> {
+    static const bool value = true;
+};
+
 template <template<typename, typename> typename ShiftPolicy,
                                        typename HashType,
                                        typename Alphabet>
@@ -196,6 +212,29 @@ public:
     bool is_initialized() const {
         return initialized;
     }
+
+    /**
+     * @Synopsis  Hash every k-mer of sequence with the policy's
+     *            whole-sequence kernel, appending the hashes to out. The
+     *            shifter is left on the last k-mer, as it would be after
+     *            iterating over the sequence with a KmerIterator.
+     *
+     * @Returns   Number of k-mers hashed.
+     */
+    template<typename Dummy = size_t>
+    auto hash_sequence(const std::string&      sequence,
+                       std::vector<hash_type>& out)
+    -> std::enable_if_t<has_sequence_kernel<type>::value, Dummy> {
+        if (sequence.length() < K) {
+            throw SequenceLengthException("Sequence must have length >= K");
+        }
+        const size_t n_kmers = sequence.length() - K + 1;
+        const size_t start   = out.size();
+        out.resize(start + n_kmers);
+        this->hash_sequence_impl(sequence.c_str(), n_kmers, out.data() + start);
+        initialized = true;
+        return n_kmers;
+    }
 };
 
 extern template class HashShifter<FwdLemirePolicy>;
@@ -9,6 +9,10 @@
 #ifndef GOETIA_ROLLINGHASHSHIFTER_HH
 #define GOETIA_ROLLINGHASHSHIFTER_HH
 
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
 #include "goetia/goetia.hh"
 #include "goetia/meta.hh"
 #include "goetia/sequences/alphabets.hh"
@@ -19,6 +23,76 @@
 namespace goetia {
 
 
+/**
+ * @Synopsis  Whole-sequence kernel for the Lemire cyclic hash: hashes all
+ *            n_kmers k-mers of seq into out in one pass, giving the same
+ *            hashes as CyclicHash's eat and update. With FixedK set, the
+ *            rotation which retires the outgoing base is a constant and
+ *            the initial loop has a fixed trip count, so both fold at
+ *            compile time; FixedK = 0 is the generic kernel, which takes
+ *            K at run time.
+ *
+ * @tparam FixedK  K, or 0 for the generic kernel.
+ */
+template<class HashType, uint16_t FixedK>
+struct LemireSequenceKernel {
+
+    typedef typename HashType::value_type value_type;
+
+    static constexpr bool is_canonical = std::is_same<HashType, Canonical<value_type>>::value;
+
+    static inline value_type rotl(value_type x, unsigned int r) {
+        return (x << r) | (x >> ((64 - r) & 63));
+    }
+
+    static inline value_type rotr1(value_type x) {
+        return (x >> 1) | (x << 63);
+    }
+
+    /**
+     * @Param table     Per-symbol hashes.
+     * @Param rc_table  Per-symbol hashes of the symbols' complements;
+     *                  only read for canonical hashes.
+     * @Param K         Used when FixedK is 0.
+     */
+    static void hash_sequence(const value_type * table,
+                              const value_type * rc_table,
+                              const char *       seq,
+                              size_t             n_kmers,
+                              uint16_t           K,
+                              HashType *         out) {
+        const uint16_t     k = FixedK ? FixedK : K;
+        const unsigned int r = k % 64;
+        const unsigned char * s = reinterpret_cast<const unsigned char *>(seq);
+
+        value_type fw = 0, rc = 0;
+        for (uint16_t i = 0; i < k; ++i) {
+            fw = rotl(fw, 1) ^ table[s[i]];
+            if constexpr (is_canonical) {
+                rc = rotl(rc, 1) ^ rc_table[s[k - i - 1]];
+            }
+        }
+        if constexpr (is_canonical) {
+            out[0] = HashType(fw, rc);
+        } else {
+            out[0] = HashType(fw);
+        }
+
+        for (size_t i = 1; i < n_kmers; ++i) {
+            const unsigned char c_out = s[i - 1];
+            const unsigned char c_in  = s[i + k - 1];
+            fw = rotl(fw, 1) ^ rotl(table[c_out], r) ^ table[c_in];
+            if constexpr (is_canonical) {
+                rc = rotr1(rc ^ rotl(rc_table[c_in], r) ^ rc_table[c_out]);
+                out[i] = HashType(fw, rc);
+            } else {
+                out[i] = HashType(fw);
+            }
+        }
+    }
+};
+
+
 template<class HashType>
 struct LemireShifterPolicyBase {
 protected:
@@ -63,8 +137,43 @@ public:
     typedef Alphabet                       alphabet;
     static constexpr bool has_kmer_span = false;
 
+    typedef void (*sequence_kernel_type)(const value_type *, const value_type *,
+                                         const char *, size_t, uint16_t, hash_type *);
+
     const uint16_t K;
 
+    /**
+     * @Synopsis  The sequence kernel for K: one specialized on K for the
+     *            sizes we commonly run, otherwise the generic one.
+     */
+    static sequence_kernel_type select_sequence_kernel(uint16_t K) {
+        switch (K) {
+            case 21: return &LemireSequenceKernel<hash_type, 21>::hash_sequence;
+            case 25: return &LemireSequenceKernel<hash_type, 25>::hash_sequence;
+            case 27: return &LemireSequenceKernel<hash_type, 27>::hash_sequence;
+            case 31: return &LemireSequenceKernel<hash_type, 31>::hash_sequence;
+            case 33: return &LemireSequenceKernel<hash_type, 33>::hash_sequence;
+            case 51: return &LemireSequenceKernel<hash_type, 51>::hash_sequence;
+            default: return &LemireSequenceKernel<hash_type, 0>::hash_sequence;
+        }
+    }
+
+    /**
+     * @Synopsis  Hash the n_kmers k-mers starting at seq into out, then
+     *            leave the rolling hasher on the last of them.
+     */
+    void hash_sequence_impl(const char * seq,
+                            size_t       n_kmers,
+                            hash_type *  out) {
+        _sequence_kernel(this->hasher.hasher.hashvalues, _rc_table.data(),
+                         seq, n_kmers, K, out);
+        set_impl(out[n_kmers - 1]);
+    }
+
+    void set_impl(const hash_type& h) {
+        this->hasher.hashvalue = h.value();
+    }
+
     __attribute__((visibility("default")))
     inline hash_type hash_base_impl(const char * sequence) {
         this->hasher.reset();
@@ -107,10 +216,24 @@ public:
 
 protected:
 
+    sequence_kernel_type               _sequence_kernel;
+    // hashes of each symbol's complement, so that the kernel needn't
+    // complement bases one by one
+    std::array<value_type, 256>        _rc_table;
+
+    void _init_sequence_kernel() {
+        _sequence_kernel = select_sequence_kernel(K);
+        for (unsigned int c = 0; c < 256; ++c) {
+            const unsigned char comp = alphabet::complement(static_cast<char>(c));
+            _rc_table[c] = this->hasher.hasher.hashvalues[comp];
+        }
+    }
+
     explicit LemireShifterPolicy(uint16_t K)
         : LemireShifterPolicyBase<HashType>(K),
           K(K)
     {   
+        _init_sequence_kernel();
         //std::cout << "END LemireShifterPolicy(K) ctor " << this << " / " << static_cast<LemireShifterPolicyBase<HashType>*>(this) << std::endl;
     }
 
@@ -131,6 +254,7 @@ inline LemireShifterPolicy<Canonical<uint64_t>>
     : LemireShifterPolicyBase<Canonical<uint64_t>>(K),
       K(K)
 {
+    _init_sequence_kernel();
 }
 
 template<>
@@ -139,6 +263,16 @@ inline LemireShifterPolicy<Canonical<uint64_t>>
     : LemireShifterPolicyBase<Canonical<uint64_t>>(other.K),
       K(other.K)
 {
+    _init_sequence_kernel();
+}
+
+
+template<>
+inline void
+LemireShifterPolicy<Canonical<uint64_t>>
+::set_impl(const Canonical<uint64_t>& h) {
+    hasher.hashvalue    = h.fw_hash;
+    rc_hasher.hashvalue = h.rc_hash;
 }
 
 
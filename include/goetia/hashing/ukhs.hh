@@ -12,6 +12,8 @@
 
 #include <algorithm>
 #include <climits>
+#include <cstdint>
+#include <fstream>
 #include <iostream>
 #include <memory>
 #include <optional>
@@ -22,6 +24,7 @@
 
 #include "goetia/goetia.hh"
 #include "goetia/sequences/alphabets.hh"
+#include "goetia/sequences/exceptions.hh"
 #include "goetia/storage/sparsepp/spp.h"
 
 #include "goetia/hashing/canonical.hh"
@@ -33,6 +36,57 @@
 namespace goetia { 
 
 
+/**
+ * @Synopsis  2-bit DNA codes (A=0, C=1, G=2, T=3), most significant
+ *            symbol first. Symbols outside ACGT are coded as A.
+ */
+struct TwoBitCode {
+
+    static uint64_t encode(const char c) {
+        switch (c) {
+            case 'C': case 'c':
+                return 1;
+            case 'G': case 'g':
+                return 2;
+            case 'T': case 't':
+                return 3;
+            default:
+                return 0;
+        }
+    }
+
+    static uint64_t encode(const char * sequence, uint16_t K) {
+        uint64_t code = 0;
+        for (uint16_t i = 0; i < K; ++i) {
+            code = (code << 2) | encode(sequence[i]);
+        }
+        return code;
+    }
+
+    static uint64_t reverse_complement(uint64_t code, uint16_t K) {
+        uint64_t rc = 0;
+        for (uint16_t i = 0; i < K; ++i) {
+            rc = (rc << 2) | (3 - (code & 3));
+            code >>= 2;
+        }
+        return rc;
+    }
+
+    static void decode(uint64_t code, uint16_t K, char * sequence) {
+        for (uint16_t i = K; i-- > 0; ) {
+            sequence[i] = "ACGT"[code & 3];
+            code >>= 2;
+        }
+    }
+
+    static std::string decode(uint64_t code, uint16_t K) {
+        std::string sequence(K, 'A');
+        decode(code, K, sequence.data());
+        return sequence;
+    }
+};
+
+
 template <class ShifterType>
 struct UKHS {
 
@@ -42,6 +96,70 @@ struct UKHS {
 
     typedef Partitioned<hash_type>           Unikmer;
 
+    // Largest unikmer K for which the direct index is built; its bitmap
+    // takes 4^K / 8 bytes (2MB at K=12).
+    static constexpr uint16_t MAX_DIRECT_K   = 12;
+    static constexpr uint32_t NO_PARTITION   = std::numeric_limits<uint32_t>::max();
+
+    static constexpr bool is_canonical = std::is_same<hash_type,
+                                                      Canonical<value_type>>::value;
+
+    /**
+     * @Synopsis  Rolling hasher for unikmers which also tracks the 2-bit
+     *            code of its current k-mer, for direct-index queries.
+     */
+    class Hasher : public shifter_type {
+
+        uint64_t _code;
+        uint64_t _mask;
+        uint16_t _top_shift;
+
+    public:
+
+        explicit Hasher(uint16_t K)
+            : shifter_type(K),
+              _code(0),
+              _mask(K >= 32 ? ~uint64_t(0) : (uint64_t(1) << (2 * K)) - 1),
+              _top_shift(2 * (K - 1))
+        {
+        }
+
+        uint64_t code() const {
+            return _code;
+        }
+
+        hash_type hash_base(const char * sequence) {
+            _code = TwoBitCode::encode(sequence, this->K);
+            return shifter_type::hash_base(sequence);
+        }
+
+        hash_type hash_base(const std::string& sequence) {
+            if (sequence.length() < this->K) {
+                throw InvalidSequenceException("HashShifter::hash_base: Sequence must at least length K");
+            }
+            return hash_base(sequence.c_str());
+        }
+
+        template<class It>
+        hash_type hash_base(It begin, It end) {
+            _code = 0;
+            for (It it = begin; it != end; ++it) {
+                _code = (_code << 2) | TwoBitCode::encode(*it);
+            }
+            return shifter_type::hash_base(begin, end);
+        }
+
+        hash_type shift_right(const char& out, const char& in) {
+            _code = ((_code << 2) | TwoBitCode::encode(in)) & _mask;
+            return shifter_type::shift_right(out, in);
+        }
+
+        hash_type shift_left(const char& in, const char& out) {
+            _code = (_code >> 2) | (TwoBitCode::encode(in) << _top_shift);
+            return shifter_type::shift_left(in, out);
+        }
+    };
+
 
 protected:
 
@@ -50,6 +168,32 @@ protected:
     pmap_t                                             pmap;
     std::vector<hash_type>                             hashes;
 
+    /* Direct index over the 4^K 2-bit codes: a bitmap of the codes in the
+     * UKHS (both orientations, for canonical hashing), a cumulative
+     * popcount per word for rank queries, and the partition of each set
+     * code in rank order.
+     */
+    std::vector<uint64_t>                              code_bits;
+    std::vector<uint32_t>                              code_ranks;
+    std::vector<uint32_t>                              code_partitions;
+
+    void index_unikmer_code(uint64_t                                    code,
+                            uint32_t                                    partition,
+                            std::vector<std::pair<uint64_t, uint32_t>>& codes) const {
+        codes.emplace_back(code, partition);
+        if (is_canonical) {
+            codes.emplace_back(TwoBitCode::reverse_complement(code, K), partition);
+        }
+    }
+
+    void build_direct_index(std::vector<std::pair<uint64_t, uint32_t>>& codes);
+
+    // 2-bit codes of the source unikmers in input order, kept so the UKHS
+    // can be written back out as a binary table
+    std::vector<uint64_t>                              unikmer_codes;
+
+    void init_from_codes();
+
 
 public:
 
@@ -62,12 +206,56 @@ public:
                   uint16_t K,
                   std::vector<std::string>& unikmers);
 
+    /**
+     * @Synopsis  Build from the 2-bit codes (see TwoBitCode) of the
+     *            unikmers rather than their strings; partitions are
+     *            assigned in input order, as with the string constructor.
+     */
+    explicit UKHS(uint16_t W,
+                  uint16_t K,
+                  std::vector<uint64_t>&& codes);
+
     static std::shared_ptr<UKHS> build(uint16_t W,
                                       uint16_t K,
                                       std::vector<std::string>& ukhs) {
         return std::make_shared<UKHS>(W, K, ukhs);
     }
 
+    /*
+     * Binary table format: the magic bytes, format version, W, K and
+     * unikmer count, followed by the 2-bit code of each unikmer in
+     * partition order, all little-endian. The table holds only the source
+     * unikmers, so the same file loads for both forward and canonical
+     * hashing.
+     */
+
+    static constexpr char     TABLE_MAGIC[8] = {'G', 'U', 'K', 'H', 'S', '\0', '\0', '\0'};
+    static constexpr uint16_t TABLE_VERSION  = 1;
+
+    /**
+     * @Synopsis  Load a UKHS from a binary table written by save(). Much
+     *            faster than parsing the gzipped text distribution.
+     *
+     * @Param filename Path to the table.
+     * @Param W        Window size of the returned UKHS. A UKHS hits every
+     *                 window of its table's W, and so every larger window
+     *                 too; 0 uses the table's W.
+     *
+     * @Returns   The UKHS.
+     */
+    static std::shared_ptr<UKHS> load(const std::string& filename,
+                                      uint16_t           W = 0);
+
+    static std::shared_ptr<UKHS> load(std::istream& in,
+                                      uint16_t      W = 0);
+
+    /**
+     * @Synopsis  Write the UKHS as a binary table.
+     */
+    void save(const std::string& filename) const;
+
+    void save(std::ostream& out) const;
+
     std::optional<Unikmer> query(hash_type unikmer_hash) {
 
         auto search = pmap.find(unikmer_hash.value());
@@ -78,6 +266,42 @@ public:
         }
     }
 
+    /**
+     * @Synopsis  Query the unikmer under a Hasher's cursor. Uses the
+     *            direct index when K <= MAX_DIRECT_K, otherwise falls back
+     *            to the hash map.
+     */
+    std::optional<Unikmer> query(Hasher& hasher) {
+        if (!has_direct_index()) {
+            return query(hasher.get());
+        }
+        uint32_t partition = query_code(hasher.code());
+        if (partition == NO_PARTITION) {
+            return {};
+        }
+        return {{hasher.get(), partition}};
+    }
+
+    /**
+     * @Synopsis  Direct-index lookup of a 2-bit k-mer code. Only valid
+     *            when has_direct_index().
+     *
+     * @Returns   The code's partition, or NO_PARTITION.
+     */
+    uint32_t query_code(uint64_t code) const {
+        const size_t   word = code >> 6;
+        const uint64_t bit  = uint64_t(1) << (code & 63);
+        const uint64_t bits = code_bits[word];
+        if (!(bits & bit)) {
+            return NO_PARTITION;
+        }
+        return code_partitions[code_ranks[word] + __builtin_popcountll(bits & (bit - 1))];
+    }
+
+    bool has_direct_index() const {
+        return !code_bits.empty();
+    }
+
     std::vector<hash_type> get_hashes() const {
         return hashes;
     }
@@ -89,6 +313,159 @@ public:
 
 
 
+/**
+ * @Synopsis  Fixed-capacity ring of the unikmers in a window, along with
+ *            their indices in the window. Indices are stored relative to
+ *            a moving origin, so sliding the window is O(1) rather than a
+ *            pass over every stored index.
+ *
+ * @tparam MinimizerType The unikmer type.
+ */
+template <typename MinimizerType>
+class UnikmerWindow {
+
+    std::vector<MinimizerType> unikmers;
+    std::vector<int64_t>       positions;
+    size_t                     mask;
+    size_t                     head;
+    size_t                     count;
+    int64_t                    origin;
+
+    static size_t round_capacity(size_t capacity) {
+        size_t rounded = 1;
+        while (rounded < capacity) {
+            rounded <<= 1;
+        }
+        return rounded;
+    }
+
+    size_t slot(size_t i) const {
+        return (head + i) & mask;
+    }
+
+public:
+
+    explicit UnikmerWindow(size_t capacity)
+        : unikmers(round_capacity(capacity)),
+          positions(round_capacity(capacity)),
+          mask(round_capacity(capacity) - 1),
+          head(0),
+          count(0),
+          origin(0)
+    {
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    void clear() {
+        head   = 0;
+        count  = 0;
+        origin = 0;
+    }
+
+    const MinimizerType& operator[](size_t i) const {
+        return unikmers[slot(i)];
+    }
+
+    // index within the window of the i'th unikmer
+    int64_t index(size_t i) const {
+        return positions[slot(i)] - origin;
+    }
+
+    int64_t front_index() const {
+        return index(0);
+    }
+
+    int64_t back_index() const {
+        return index(count - 1);
+    }
+
+    void push_front(const MinimizerType& unikmer, int64_t index) {
+        head = (head - 1) & mask;
+        unikmers[head]  = unikmer;
+        positions[head] = index + origin;
+        ++count;
+    }
+
+    void push_back(const MinimizerType& unikmer, int64_t index) {
+        size_t tail = slot(count);
+        unikmers[tail]  = unikmer;
+        positions[tail] = index + origin;
+        ++count;
+    }
+
+    void pop_front() {
+        head = (head + 1) & mask;
+        --count;
+    }
+
+    void pop_back() {
+        --count;
+    }
+
+    /**
+     * @Synopsis  Move the window origin: every stored index changes by -delta.
+     */
+    void shift(int64_t delta) {
+        origin += delta;
+    }
+
+    /**
+     * @Synopsis  Position of the (first) minimum unikmer in [first, last).
+     *
+     * @Returns   The position, or last if the range is empty.
+     */
+    size_t min_position(size_t first, size_t last) const {
+        if (first >= last) {
+            return last;
+        }
+        size_t min_i = first;
+        for (size_t i = first + 1; i < last; ++i) {
+            if ((*this)[i] < (*this)[min_i]) {
+                min_i = i;
+            }
+        }
+        return min_i;
+    }
+};
+
+
+/**
+ * @Synopsis  The hashes of every k-mer in a sequence, as parallel arrays:
+ *            for the k-mer starting at i, its hash, the hash of its minimum
+ *            unikmer, and that unikmer's partition.
+ *
+ * @tparam ValueType The hash value type.
+ */
+template <typename ValueType>
+struct UnikmerHashBatch {
+
+    std::vector<ValueType> hashes;
+    std::vector<ValueType> unikmers;
+    std::vector<uint32_t>  partitions;
+
+    size_t size() const {
+        return hashes.size();
+    }
+
+    void resize(size_t n) {
+        hashes.resize(n);
+        unikmers.resize(n);
+        partitions.resize(n);
+    }
+
+    void clear() {
+        resize(0);
+    }
+};
+
+
 template<typename T>
 struct UnikmerShifterPolicy;
 
@@ -114,7 +491,7 @@ class UnikmerShifterPolicy<ShiftPolicy<HashType, Alphabet>> : public KmerSpan {
      * for a single k-mer. Sometimes, however, a few unikmers
      * will exist within the window; in this case, we choose
      * the minimum unikmer as the representative. Rather than
-     * use the minizer class for this, we'll just keep two deques,
+     * use the minizer class for this, we'll just keep two rings,
      * one with the indices and one with the unikmers, to track
      * the unikmers within the window; the logic is easier 
      * this way concerning directionality, and there will usually
@@ -147,6 +524,8 @@ public:
     typedef Shift<wmer_type, DIR_LEFT>                     shift_left_type;
     typedef Shift<wmer_type, DIR_RIGHT>                    shift_right_type;
 
+    typedef UnikmerHashBatch<value_type>                        batch_type;
+
     static constexpr bool has_kmer_span = true;
 
 protected:
@@ -154,8 +533,122 @@ protected:
     // K size of the unikmer
     uint16_t _unikmer_K;
 
-    base_shifter_type window_hasher;
-    base_shifter_type unikmer_hasher;
+    typedef typename ukhs_type::Hasher                          unikmer_hasher_type;
+    typedef UnikmerWindow<minimizer_type>                       window_type;
+
+public:
+
+    /**
+     * @Synopsis  Whole-sequence counterpart to the shifter: hashes every
+     *            k-mer of a sequence and finds its minimum unikmer in one
+     *            left-to-right pass. The k-mer and unikmer hashers roll
+     *            straight over the sequence, without the shifter's ring
+     *            buffer, and the window minima are kept in a monotone queue,
+     *            so each unikmer is pushed and popped at most once. Gives
+     *            the same hashes and partitions as shifting right.
+     */
+    class BatchHasher {
+
+        base_shifter_type   kmer_hasher;
+        unikmer_hasher_type unikmer_hasher;
+        // unikmers which may yet be a window minimum, increasing front to
+        // back, indexed by their position in the sequence
+        window_type         minima;
+
+    public:
+
+        std::shared_ptr<ukhs_type> ukhs_map;
+        const uint16_t             K;
+        const uint16_t             unikmer_K;
+
+        BatchHasher(uint16_t                   K,
+                    uint16_t                   unikmer_K,
+                    std::shared_ptr<ukhs_type> ukhs)
+            : kmer_hasher    (K),
+              unikmer_hasher (unikmer_K),
+              minima         (K - unikmer_K + 1),
+              ukhs_map       (std::move(ukhs)),
+              K              (K),
+              unikmer_K      (unikmer_K)
+        {
+        }
+
+        BatchHasher(const BatchHasher& other)
+            : BatchHasher(other.K, other.unikmer_K, other.ukhs_map)
+        {
+        }
+
+        /**
+         * @Synopsis  Hash the k-mers of sequence into out, which is
+         *            resized to the number of k-mers.
+         *
+         * @Returns   Number of k-mers.
+         */
+        size_t hash_sequence(const std::string& sequence,
+                             batch_type&        out) {
+            if (sequence.length() < K) {
+                throw SequenceLengthException("Sequence must have length >= K");
+            }
+
+            const char * seq     = sequence.c_str();
+            const size_t n       = sequence.length();
+            const size_t span    = K - unikmer_K;
+            const size_t n_kmers = n - K + 1;
+            out.resize(n_kmers);
+            minima.clear();
+
+            kmer_hasher.hash_base(seq);
+            unikmer_hasher.hash_base(seq);
+
+            // j is the position of the incoming unikmer, and the k-mer
+            // whose window it completes starts at j - span
+            for (size_t j = 0; j + unikmer_K <= n; ++j) {
+                if (j > 0) {
+                    unikmer_hasher.shift_right(seq[j - 1], seq[j + unikmer_K - 1]);
+                }
+                if (j >= span) {
+                    const int64_t first = j - span;
+                    while (!minima.empty() && minima.front_index() < first) {
+                        minima.pop_front();
+                    }
+                }
+
+                auto unikmer = ukhs_map->query(unikmer_hasher);
+                if (unikmer) {
+                    // strict, so the leftmost of equal unikmers stays the
+                    // minimum, as with UnikmerWindow::min_position
+                    while (!minima.empty() && unikmer.value() < minima[minima.size() - 1]) {
+                        minima.pop_back();
+                    }
+                    minima.push_back(unikmer.value(), j);
+                }
+
+                if (j < span) {
+                    continue;
+                }
+                const size_t i = j - span;
+                if (i > 0) {
+                    kmer_hasher.shift_right(seq[i - 1], seq[i + K - 1]);
+                }
+                if (minima.empty()) {
+                    throw HashShifterException("No unikmers in window!");
+                }
+                const minimizer_type& min = minima[0];
+                out.hashes[i]     = kmer_hasher.get().value();
+                out.unikmers[i]   = min.value().value();
+                out.partitions[i] = static_cast<uint32_t>(min.partition);
+            }
+
+            return n_kmers;
+        }
+    };
+
+    typedef BatchHasher                                         batch_hasher_type;
+
+protected:
+
+    base_shifter_type   window_hasher;
+    unikmer_hasher_type unikmer_hasher;
 
     // Current position of the unikmer hasher within
     // the window: it will need to be moved across the window
@@ -163,16 +656,13 @@ protected:
     bool unikmer_hasher_on_left;
 
     // We'll store the unikmers for the current window and their
-    // indices, only finding the minimum when queried.
-    std::deque<minimizer_type> window_unikmers;
-    std::deque<size_t>         unikmer_indices;
+    // indices, only finding the minimum when queried. A window holds at
+    // most K - unikmer_K + 1 unikmers.
+    window_type window_unikmers;
 
     void shift_unikmers_left() {
-        for (auto& index : unikmer_indices) {
-            ++index;
-        }
-        if (unikmer_indices.back() > K - _unikmer_K) {
-            unikmer_indices.pop_back();
+        window_unikmers.shift(-1);
+        if (!window_unikmers.empty() && window_unikmers.back_index() > K - _unikmer_K) {
             window_unikmers.pop_back();
         }
     }
@@ -193,27 +683,18 @@ protected:
         unikmer_hasher.shift_left(c, *(ring.begin() + _unikmer_K - 1));
 
         shift_unikmers_left();
-        auto unikmer = ukhs_map->query(unikmer_hasher.get());
+        auto unikmer = ukhs_map->query(unikmer_hasher);
         if (unikmer) {
-            unikmer_indices.push_front(0);
-            window_unikmers.push_front(unikmer.value());
+            window_unikmers.push_front(unikmer.value(), 0);
         }
     }
 
     void shift_unikmers_right() {
-        //std::cout << "indices: " << repr(unikmer_indices) << std::endl;
-        //std::cout << "unikmers: " << repr(window_unikmers) << std::endl;
-        if (unikmer_indices.front() == 0) {
-            unikmer_indices.pop_front();
+        if (!window_unikmers.empty() && window_unikmers.front_index() == 0) {
             window_unikmers.pop_front();
         }
 
-        for (auto& index : unikmer_indices) {
-            --index;
-        }
-
-        //std::cout << "new indices: " << repr(unikmer_indices) << std::endl;
-        //std::cout << "new unikmers: " << repr(window_unikmers) << std::endl;
+        window_unikmers.shift(1);
     }
 
     void update_unikmer_right(const char c) {
@@ -232,31 +713,25 @@ protected:
         unikmer_hasher.shift_right(*(ring.begin() + K - _unikmer_K), c);
         
         shift_unikmers_right();
-        auto unikmer = ukhs_map->query(unikmer_hasher.get());
+        auto unikmer = ukhs_map->query(unikmer_hasher);
         if (unikmer) {
             //std::cout << "UnikmerShifter: found unikmer" << std::endl;
-            unikmer_indices.push_back(K - _unikmer_K);
-            window_unikmers.push_back(unikmer.value());
+            window_unikmers.push_back(unikmer.value(), K - _unikmer_K);
         }
         //std::cout << "UnikmerShifter: leave update_unikmer, uhash: " << cur_unikmer << std::endl;
     }
 
-    static minimizer_type get_min_unikmer(std::deque<minimizer_type>& window_unikmers) {
-        //std::cout << "UnikmerShifter: " << repr(window_unikmers) << std::endl;
-        //std::cout << "UnikmerShifter: " << repr(unikmer_indices) << std::endl;
-
+    static minimizer_type get_min_unikmer(const window_type& window_unikmers) {
         //if (window_unikmers.size() == 0) {
         //    throw GoetiaException("Window should contain unikmer.");
         //}
         if (window_unikmers.size() ==  0) {
             throw HashShifterException("No unikmers in window!");
         }
-        return *std::min_element(std::begin(window_unikmers),
-                                 std::end(window_unikmers));
+        return window_unikmers[window_unikmers.min_position(0, window_unikmers.size())];
     }
 
     void clear_unikmers() {
-        unikmer_indices.clear();
         window_unikmers.clear();
     }
 
@@ -275,8 +750,7 @@ public:
                             window_hasher,
                             unikmer_hasher,
                             ukhs_map,
-                            window_unikmers,
-                            unikmer_indices);
+                            window_unikmers);
         this->load(sequence);
         unikmer_hasher_on_left = false;
 
@@ -286,14 +760,12 @@ public:
 
     template<class It>
     wmer_type hash_base_impl(It begin, It end) {
-        // TODO: this does extra copying
-        this->load(begin, end);
-        wmer_type h = _hash(this->to_string().c_str(),
+        wmer_type h = _hash(begin,
                             window_hasher,
                             unikmer_hasher,
                             ukhs_map,
-                            window_unikmers,
-                            unikmer_indices);
+                            window_unikmers);
+        this->load(begin, end);
         unikmer_hasher_on_left = false;
 
         return h;
@@ -317,40 +789,40 @@ public:
                              shifter.window_hasher,
                              shifter.unikmer_hasher,
                              shifter.ukhs_map,
-                             shifter.window_unikmers,
-                             shifter.unikmer_indices);
+                             shifter.window_unikmers);
     }
 
-    static wmer_type _hash(const char *                sequence,
-                           base_shifter_type&               window_hasher,
-                           base_shifter_type&               unikmer_hasher,
+    /**
+     * @Synopsis  Hash the K symbols from sequence, which may be a pointer
+     *            or any random-access iterator.
+     */
+    template<class It>
+    static wmer_type _hash(It                          sequence,
+                           base_shifter_type&          window_hasher,
+                           unikmer_hasher_type&        unikmer_hasher,
                            std::shared_ptr<ukhs_type>& ukhs_map,
-                           std::deque<minimizer_type>& window_unikmers,
-                           std::deque<size_t>&         unikmer_indices) {
+                           window_type&                window_unikmers) {
 
-        window_hasher.hash_base(sequence);
-        unikmer_hasher.hash_base(sequence);
+        window_hasher.hash_base(sequence, sequence + window_hasher.K);
+        unikmer_hasher.hash_base(sequence, sequence + unikmer_hasher.K);
         
-        unikmer_indices.clear();
         window_unikmers.clear();
 
-        auto unikmer = ukhs_map->query(unikmer_hasher.get());
+        auto unikmer = ukhs_map->query(unikmer_hasher);
         if (unikmer) {
-            unikmer_indices.push_back(0);
-            window_unikmers.push_back(unikmer.value());
+            window_unikmers.push_back(unikmer.value(), 0);
         }
 
         for (uint16_t i = unikmer_hasher.K; i < window_hasher.K; ++i) {
             // once we've eaten the first K bases, start keeping
             // track of unikmers
 
-            unikmer_hasher.shift_right(sequence[i - unikmer_hasher.K],
-                                       sequence[i]);
+            unikmer_hasher.shift_right(*(sequence + (i - unikmer_hasher.K)),
+                                       *(sequence + i));
 
-            unikmer = ukhs_map->query(unikmer_hasher.get());
+            unikmer = ukhs_map->query(unikmer_hasher);
             if (unikmer) {
-                unikmer_indices.push_back(i - unikmer_hasher.K + 1);
-                window_unikmers.push_back(unikmer.value());
+                window_unikmers.push_back(unikmer.value(), i - unikmer_hasher.K + 1);
             }
 
         }
@@ -395,16 +867,26 @@ public:
     -> std::vector<shift_left_type> {
 
         std::vector<shift_left_type> hashes;
+        hashes.reserve(alphabet::SYMBOLS.size());
+        left_extensions_impl(hashes);
+        return hashes;
+    }
+
+    /**
+     * @Synopsis  Append the left extensions to hashes, which may be
+     *            a vector or an ExtensionArray.
+     */
+    template<class Container>
+    void left_extensions_impl(Container& hashes) {
 
         // First get the min unikmer in the W-1 prefix, if there is one
-        auto _last = unikmer_indices.back() > K - _unikmer_K ? 
-                     std::end(window_unikmers) - 1 :
-                     std::end(window_unikmers);
-        auto _min = std::min_element(std::begin(window_unikmers),
-                                     _last);
+        size_t _last = !window_unikmers.empty() && window_unikmers.back_index() > K - _unikmer_K ?
+                       window_unikmers.size() - 1 :
+                       window_unikmers.size();
+        size_t _min = window_unikmers.min_position(0, _last);
         std::optional<minimizer_type> current_min;
         if (_min != _last) {
-            current_min = *_min;
+            current_min = window_unikmers[_min];
         }
         
         if (!unikmer_hasher_on_left) {
@@ -422,12 +904,12 @@ public:
             window_hasher.shift_left(symbol, back);
             unikmer_hasher.shift_left(symbol, uback);
 
-            auto unikmer = ukhs_map->query(unikmer_hasher.get());
+            auto unikmer = ukhs_map->query(unikmer_hasher);
             if (!current_min || (unikmer && unikmer.value() < current_min.value())) {
-                hashes.emplace_back(shift_left_type{wmer_type{window_hasher.get(), unikmer.value()},
+                hashes.push_back(shift_left_type{wmer_type{window_hasher.get(), unikmer.value()},
                                                     symbol});
             } else {
-                hashes.emplace_back(shift_left_type{wmer_type{window_hasher.get(), current_min.value()},
+                hashes.push_back(shift_left_type{wmer_type{window_hasher.get(), current_min.value()},
                                                     symbol});
             }
 
@@ -436,23 +918,30 @@ public:
             unikmer_hasher.shift_right(symbol, uback);
 
         }
-
-        return hashes;
     }
 
     auto right_extensions_impl()
     -> std::vector<shift_right_type> {
-        
+
         std::vector<shift_right_type> hashes;
+        hashes.reserve(alphabet::SYMBOLS.size());
+        right_extensions_impl(hashes);
+        return hashes;
+    }
+
+    /**
+     * @Synopsis  Append the right extensions to hashes, which may be
+     *            a vector or an ExtensionArray.
+     */
+    template<class Container>
+    void right_extensions_impl(Container& hashes) {
 
         // First get the min unikmer in the W-1 prefix, if there is one
-        auto _first = unikmer_indices.front() == 0 ? 
-                      std::begin(window_unikmers) + 1 :
-                      std::begin(window_unikmers);
-        auto _min = std::min_element(_first, std::end(window_unikmers));
+        size_t _first = !window_unikmers.empty() && window_unikmers.front_index() == 0 ? 1 : 0;
+        size_t _min   = window_unikmers.min_position(_first, window_unikmers.size());
         std::optional<minimizer_type> current_min;
-        if (_min != std::end(window_unikmers)) {
-            current_min = *_min;
+        if (_min != window_unikmers.size()) {
+            current_min = window_unikmers[_min];
         }
         
         if (unikmer_hasher_on_left) {
@@ -468,19 +957,21 @@ public:
             window_hasher.shift_right(front, symbol);
             unikmer_hasher.shift_right(ufront, symbol);
 
-            auto unikmer = ukhs_map->query(unikmer_hasher.get());
+            auto unikmer = ukhs_map->query(unikmer_hasher);
             if (!current_min || (unikmer && unikmer.value() < current_min.value())) {
-                hashes.emplace_back(shift_right_type{wmer_type{window_hasher.get(), unikmer.value()},
+                hashes.push_back(shift_right_type{wmer_type{window_hasher.get(), unikmer.value()},
                                                      symbol});
             } else {
-                hashes.emplace_back(shift_right_type{wmer_type{window_hasher.get(), current_min.value()},
+                hashes.push_back(shift_right_type{wmer_type{window_hasher.get(), current_min.value()},
                                                      symbol});
             }
             window_hasher.shift_left(front, symbol);
             unikmer_hasher.shift_left(ufront, symbol);
         }
+    }
 
-        return hashes;
+    batch_hasher_type batch_hasher() const {
+        return batch_hasher_type(K, _unikmer_K, ukhs_map);
     }
 
     hash_type set_cursor_impl(const char * sequence) {
@@ -494,12 +985,13 @@ protected:
     explicit UnikmerShifterPolicy(uint16_t K,
                                   uint16_t unikmer_K,
                                   std::shared_ptr<ukhs_type> ukhs)
-        :  KmerSpan       (K),
-           window_hasher  (K),
-           unikmer_hasher (unikmer_K),
-           K              (K),
-           _unikmer_K     (unikmer_K),
-           ukhs_map       (std::move(ukhs))
+        :  KmerSpan        (K),
+           window_hasher   (K),
+           unikmer_hasher  (unikmer_K),
+           window_unikmers (K - unikmer_K + 1),
+           K               (K),
+           _unikmer_K      (unikmer_K),
+           ukhs_map        (std::move(ukhs))
     {
         if (ukhs_map->W != K) {
             throw GoetiaException("Shifter K does not match UKHS::Map W.");
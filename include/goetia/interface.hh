@@ -47,6 +47,7 @@
 //#include "goetia/parsing/gfakluge/pliib.hpp"
 
 #include "goetia/metrics.hh"
+#include "goetia/profiling.hh"
 
 #include "goetia/dbg.hh"
 #include "goetia/pdbg.hh"
@@ -55,26 +56,35 @@
 #include "goetia/solidifier.hh"
 #include "goetia/diginorm.hh"
 
+#include "goetia/events.hh"
 #include "goetia/processors.hh"
 
 #include "goetia/cdbg/cdbg_types.hh"
 #include "goetia/cdbg/compactor.hh"
+#include "goetia/cdbg/mapper.hh"
 #include "goetia/cdbg/cdbg.hh"
+#include "goetia/cdbg/events.hh"
 #include "goetia/cdbg/metrics.hh"
 #include "goetia/cdbg/udbg.hh"
 #include "goetia/cdbg/utagger.hh"
 #include "goetia/cdbg/saturating_compactor.hh"
 #include "goetia/cdbg/ucompactor.hh"
+#include "goetia/cdbg/static_compactor.hh"
 
 #include "goetia/minimizers.hh"
+#include "goetia/parallel.hh"
 #include "goetia/sketches/unikmer_sketch.hh"
 #include "goetia/sketches/sourmash_sketch.hh"
+#include "goetia/sketches/fracminhash.hh"
 #include "goetia/sketches/sourmash/sourmash.hpp"
-//#include "goetia/sketches/hllcounter.hh"
+#include "goetia/sketches/hllcounter.hh"
+#include "goetia/sketches/saturation.hh"
+#include "goetia/sketches/spectrum.hh"
 
 #include "goetia/benchmarks/bench_storage.hh"
 
 #include "goetia/streamhasher.hh"
+#include "goetia/superkmer_counter.hh"
 
 #include <set>
 
@@ -11,9 +11,11 @@
 #define GOETIA_UTILITY_METRICS_HH
 
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <cstdint>
 #include <iterator>
+#include <ostream>
 #include <random>
 
 namespace goetia {
@@ -144,6 +146,92 @@ public:
     }
 };
 
+/**
+ * @Synopsis  Log-linear histogram of latencies, in the style of
+ *            HdrHistogram: values under 64 get a bucket each, and every
+ *            power of two above that is split into 32 linear sub-buckets,
+ *            so any value is known to within about 3%. Buckets are relaxed
+ *            atomics; it's meant to be written by one thread and drained
+ *            into another histogram by whichever thread reports it.
+ */
+class LatencyHistogram {
+
+public:
+
+    static constexpr unsigned SUB_BUCKET_BITS = 5;
+    static constexpr uint64_t SUB_BUCKETS     = 1ULL << SUB_BUCKET_BITS;
+    static constexpr size_t   N_BUCKETS       = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+private:
+
+    std::array<std::atomic<uint64_t>, N_BUCKETS> _buckets;
+    std::atomic<uint64_t>                        _count;
+    std::atomic<uint64_t>                        _sum;
+    std::atomic<uint64_t>                        _max;
+
+public:
+
+    LatencyHistogram();
+
+    static size_t bucket_index(uint64_t value) {
+        if (value < 2 * SUB_BUCKETS) {
+            return value;
+        }
+        const unsigned shift = 63 - __builtin_clzll(value) - SUB_BUCKET_BITS;
+        return (shift + 1) * SUB_BUCKETS + ((value >> shift) - SUB_BUCKETS);
+    }
+
+    /**
+     * @Synopsis  The largest value that falls in the given bucket.
+     */
+    static uint64_t bucket_upper_bound(size_t index);
+
+    void record(uint64_t value) {
+        _buckets[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+        _count.fetch_add(1, std::memory_order_relaxed);
+        _sum.fetch_add(value, std::memory_order_relaxed);
+
+        uint64_t current = _max.load(std::memory_order_relaxed);
+        while (value > current &&
+               !_max.compare_exchange_weak(current, value, std::memory_order_relaxed));
+    }
+
+    uint64_t count() const {
+        return _count.load(std::memory_order_relaxed);
+    }
+
+    uint64_t max() const {
+        return _max.load(std::memory_order_relaxed);
+    }
+
+    double mean() const;
+
+    /**
+     * @Synopsis  The value at the given quantile, as the upper bound of
+     *            its bucket, capped at the exact maximum.
+     *
+     * @Param quantile In [0, 1].
+     *
+     * @Returns   The value, or 0 if nothing has been recorded.
+     */
+    uint64_t value_at_quantile(double quantile) const;
+
+    /**
+     * @Synopsis  Add another histogram's counts to this one.
+     */
+    void merge(const LatencyHistogram& other);
+
+    /**
+     * @Synopsis  Move this histogram's counts into another, leaving this
+     *            one empty. Values recorded concurrently end up in one or
+     *            the other, but aren't lost.
+     */
+    void drain_into(LatencyHistogram& other);
+
+    void clear();
+};
+
+
 extern template class ReservoirSample<uint64_t>;
 extern template class ReservoirSample<double>;
 extern template class ReservoirSample<float>;
@@ -9,11 +9,17 @@
 #ifndef MINIMIZERS_HH
 #define MINIMIZERS_HH
 
+#include <algorithm>
 #include <cstdint>
-#include <deque>
+#include <limits>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
 #include "goetia/hashing/hashextender.hh"
 #include "goetia/hashing/kmeriterator.hh"
 #include "goetia/hashing/rollinghashshifter.hh"
@@ -27,28 +33,193 @@
 namespace goetia {
 
 
+/**
+ * @Synopsis  Batch sliding-window minima by the van Herk/Gil-Werman
+ *            algorithm: the input is cut into blocks of window_size, and
+ *            each window's minimum is the smaller of the suffix minimum of
+ *            its first block and the prefix minimum of its last. This costs
+ *            three comparisons per element regardless of window size, and
+ *            the final combine step is branch-free (and AVX2 for uint64_t).
+ *            Ties resolve to the leftmost position, as with RollingMin.
+ */
 template <class T>
-class RollingMin {
+class WindowMinima {
+
+public:
+
+    typedef std::pair<T, int64_t> value_type;
 
 protected:
 
-    std::deque<T> values;
-    std::deque<int64_t> indices;
-    const int64_t _window_size;
-    int64_t  _current_index;
+    std::vector<T>          prefix_values;
+    std::vector<T>          suffix_values;
+    std::vector<size_t>     prefix_positions;
+    std::vector<size_t>     suffix_positions;
+
+public:
+
+    const int64_t window_size;
+
+    explicit WindowMinima(int64_t window_size)
+        : window_size(std::max<int64_t>(1, window_size))
+    {
+    }
+
+    size_t n_windows(size_t n) const {
+        return n >= static_cast<size_t>(window_size) ? n - window_size + 1 : 0;
+    }
+
+    /**
+     * @Synopsis  Compute the minimum of each of the n_windows(n) windows.
+     *
+     * @Param values Input array.
+     * @Param n      Length of values.
+     * @Param out    Receives n_windows(n) minima.
+     *
+     * @Returns   Number of windows.
+     */
+    size_t compute(const T * values,
+                   size_t    n,
+                   T *       out) {
+
+        const size_t w = window_size;
+        const size_t n_out = n_windows(n);
+        if (n_out == 0) {
+            return 0;
+        }
+
+        prefix_values.resize(n);
+        suffix_values.resize(n);
+        for (size_t start = 0; start < n; start += w) {
+            const size_t end = std::min(start + w, n);
+            T min_value = values[start];
+            for (size_t i = start; i < end; ++i) {
+                min_value = std::min(min_value, values[i]);
+                prefix_values[i] = min_value;
+            }
+            min_value = values[end - 1];
+            for (size_t i = end; i-- > start; ) {
+                min_value = std::min(min_value, values[i]);
+                suffix_values[i] = min_value;
+            }
+        }
+
+        const T * suffix = suffix_values.data();
+        const T * prefix = prefix_values.data() + (w - 1);
+        size_t i = 0;
+
+#ifdef __AVX2__
+        if constexpr (std::is_same<T, uint64_t>::value) {
+            // AVX2 only has a signed 64-bit compare; flip the sign bits
+            const __m256i bias = _mm256_set1_epi64x(std::numeric_limits<int64_t>::min());
+            for (; i + 4 <= n_out; i += 4) {
+                __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(suffix + i));
+                __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prefix + i));
+                __m256i take_prefix = _mm256_cmpgt_epi64(_mm256_xor_si256(s, bias),
+                                                         _mm256_xor_si256(p, bias));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+                                    _mm256_blendv_epi8(s, p, take_prefix));
+            }
+        }
+#endif
+
+        for (; i < n_out; ++i) {
+            out[i] = std::min(suffix[i], prefix[i]);
+        }
+
+        return n_out;
+    }
+
+    /**
+     * @Synopsis  As above, also giving the position of each minimum in
+     *            values; ties resolve to the leftmost.
+     */
+    size_t compute(const T *    values,
+                   size_t       n,
+                   value_type * out) {
+
+        const size_t w = window_size;
+        const size_t n_out = n_windows(n);
+        if (n_out == 0) {
+            return 0;
+        }
+
+        prefix_positions.resize(n);
+        suffix_positions.resize(n);
+        for (size_t start = 0; start < n; start += w) {
+            const size_t end = std::min(start + w, n);
+            size_t min_pos = start;
+            for (size_t i = start; i < end; ++i) {
+                min_pos = values[i] < values[min_pos] ? i : min_pos;
+                prefix_positions[i] = min_pos;
+            }
+            // scanning right to left, take ties so the leftmost wins
+            min_pos = end - 1;
+            for (size_t i = end; i-- > start; ) {
+                min_pos = values[i] <= values[min_pos] ? i : min_pos;
+                suffix_positions[i] = min_pos;
+            }
+        }
+
+        const size_t * suffix = suffix_positions.data();
+        const size_t * prefix = prefix_positions.data() + (w - 1);
+        for (size_t i = 0; i < n_out; ++i) {
+            const size_t pos = values[suffix[i]] > values[prefix[i]] ? prefix[i] : suffix[i];
+            out[i] = value_type(values[pos], pos);
+        }
+
+        return n_out;
+    }
+};
+
+
+/**
+ * @Synopsis  Sliding-window minimum over a stream of values, as a
+ *            monotone queue in a fixed-capacity ring: a window never holds
+ *            more than window_size candidates, so the ring is allocated once
+ *            and updates never touch the allocator.
+ */
+template <class T>
+class RollingMin {
 
 public:
 
     typedef std::pair<T, int64_t> value_type;
 
+protected:
+
+    std::vector<value_type> ring;
+    uint64_t                ring_mask;
+    // front and one-past-back of the queue, as absolute counters
+    uint64_t                head;
+    uint64_t                tail;
+    const int64_t           _window_size;
+    int64_t                 _current_index;
+
+    WindowMinima<T>         batch;
+
+    static uint64_t ring_capacity(int64_t window_size) {
+        uint64_t capacity = 1;
+        while (capacity < static_cast<uint64_t>(std::max<int64_t>(1, window_size))) {
+            capacity <<= 1;
+        }
+        return capacity;
+    }
+
+public:
+
     RollingMin(int64_t window_size)
-        : _window_size(window_size),
-          _current_index(0) {
+        : ring(ring_capacity(window_size)),
+          ring_mask(ring.size() - 1),
+          head(0),
+          tail(0),
+          _window_size(window_size),
+          _current_index(0),
+          batch(window_size) {
     }
 
     void reset() {
-        values.clear();
-        indices.clear();
+        head = tail = 0;
         _current_index = 0;
     }
 
@@ -58,26 +229,51 @@ public:
 
     value_type update(T new_value) {
 
-
-        if (!indices.empty() && 
-            (indices.front() <= _current_index - _window_size)) {
-            
-            values.pop_front();
-            indices.pop_front();
+        if (head != tail &&
+            (ring[head & ring_mask].second <= _current_index - _window_size)) {
+            ++head;
         }
 
-        while (!values.empty() &&
-               (values.back() > new_value)) {
-
-            values.pop_back();
-            indices.pop_back();
+        while (head != tail &&
+               (ring[(tail - 1) & ring_mask].first > new_value)) {
+            --tail;
         }
 
-        indices.push_back(_current_index);
-        values.push_back(new_value);
+        ring[tail & ring_mask] = std::make_pair(new_value, _current_index);
+        ++tail;
         ++_current_index;
 
-        return std::make_pair(values.front(), indices.front());
+        return ring[head & ring_mask];
+    }
+
+    /**
+     * @Synopsis  Bulk minimizers: the minimum of every complete window of
+     *            values, with its position in values. Equivalent to
+     *            feeding values through update() after a reset() and keeping
+     *            the results from the window_size'th on, but much faster.
+     *            Does not touch the streaming state.
+     *
+     * @Param values Input array.
+     * @Param n      Length of values.
+     * @Param out    Replaced with the minimizers, one per window.
+     *
+     * @Returns   Number of windows.
+     */
+    size_t minimizers(const T *                values,
+                      size_t                   n,
+                      std::vector<value_type>& out) {
+        out.resize(batch.n_windows(n));
+        return batch.compute(values, n, out.data());
+    }
+
+    /**
+     * @Synopsis  As minimizers(), without positions.
+     */
+    size_t minimizer_values(const T *       values,
+                            size_t          n,
+                            std::vector<T>& out) {
+        out.resize(batch.n_windows(n));
+        return batch.compute(values, n, out.data());
     }
 
 };
@@ -88,7 +284,7 @@ class InteriorMinimizer : public RollingMin<T> {
 
 protected:
 
-    std::vector<typename RollingMin<T>::value_type> minimizers;
+    std::vector<typename RollingMin<T>::value_type> _minimizers;
 
 public:
 
@@ -99,50 +295,63 @@ public:
     std::pair<T, int64_t> update(T new_value) {
         auto current = RollingMin<T>::update(new_value);
         if (this->_current_index >= this->_window_size) {
-            //if (minimizers.empty() ||
-            //    current != minimizers.back()) {
+            //if (_minimizers.empty() ||
+            //    current != _minimizers.back()) {
 
-                minimizers.push_back(current);
+                _minimizers.push_back(current);
             //}
         }
         return current;
     }
 
+    /**
+     * @Synopsis  Replace the minimizers with those of values, computed in
+     *            bulk; the result is as if reset() and update() had been
+     *            called on each value, but the streaming state is left reset.
+     *
+     * @Returns   Number of minimizers.
+     */
+    size_t assign(const T * values,
+                  size_t    n) {
+        RollingMin<T>::reset();
+        return this->minimizers(values, n, _minimizers);
+    }
+
     const size_t size() const {
-        return minimizers.size();
+        return _minimizers.size();
     }
 
     std::vector<value_type> get_minimizers() const {
-        return minimizers;
+        return _minimizers;
     }
 
     std::vector<T> get_minimizer_values() const {
         std::vector<T> values;
-        for (auto m : minimizers) {
+        for (auto m : _minimizers) {
             values.push_back(m.first);
         }
         return values;
     }
 
     T get_front_value() const {
-        return minimizers.front().first;
+        return _minimizers.front().first;
     }
 
     T get_back_value() const {
-        return minimizers.back().first;
+        return _minimizers.back().first;
     }
 
     value_type get_front_minimizer() const {
-        return minimizers.front();
+        return _minimizers.front();
     }
 
     value_type get_back_minimizer() const {
-        return minimizers.back();
+        return _minimizers.back();
     }
 
     void reset() {
         RollingMin<T>::reset();
-        minimizers.clear();
+        _minimizers.clear();
     }
 };
 
@@ -157,6 +366,18 @@ struct WKMinimizer {
 
     class Minimizer : public minimizer_type {
 
+    protected:
+
+        std::vector<value_type> hashes;
+
+        void _hash_sequence(const std::string& sequence) {
+            KmerIterator<ShifterType> iter(sequence, K);
+            hashes.clear();
+            while(!iter.done()) {
+                hashes.push_back(iter.next().value());
+            }
+        }
+
     public:
 
         const uint16_t K;
@@ -169,26 +390,14 @@ struct WKMinimizer {
 
         auto get_minimizers(const std::string& sequence)
         -> typename minimizer_type::vector_type {
-            KmerIterator<ShifterType> iter(sequence, K);
-            this->reset();
-            
-            while(!iter.done()) {
-                hash_type h = iter.next();
-                minimizer_type::update(h.value());
-            }
-
+            _hash_sequence(sequence);
+            minimizer_type::assign(hashes.data(), hashes.size());
             return minimizer_type::get_minimizers();
         }
 
         std::vector<value_type> get_minimizer_values(const std::string& sequence) {
-            KmerIterator<ShifterType> iter(sequence, K);
-            this->reset();
-
-            while(!iter.done()) {
-                hash_type h = iter.next();
-                minimizer_type::update(h.value());
-            }
-
+            _hash_sequence(sequence);
+            minimizer_type::assign(hashes.data(), hashes.size());
             return minimizer_type::get_minimizer_values();
         }
 
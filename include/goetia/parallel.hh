@@ -0,0 +1,93 @@
+/**
+ * (c) Camille Scott, 2026
+ * File   : parallel.hh
+ * License: MIT
+ * Author : Camille Scott <camille.scott.w@gmail.com>
+ * Date   : 18.10.2026
+ *
+ * Minimal helpers for fanning batch work out over std::threads.
+ */
+
+#ifndef GOETIA_PARALLEL_HH
+#define GOETIA_PARALLEL_HH
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+
+namespace goetia {
+
+
+/**
+ * @Synopsis  Resolve a requested thread count: 0 means use the hardware
+ *            concurrency, and there's never any point in using more
+ *            threads than work items.
+ */
+inline unsigned int resolve_n_threads(unsigned int n_threads,
+                                      size_t       n_items) {
+    if (n_threads == 0) {
+        n_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return static_cast<unsigned int>(std::max<size_t>(1, std::min<size_t>(n_threads, n_items)));
+}
+
+
+/**
+ * @Synopsis  Split [0, n_items) into contiguous ranges and call
+ *            func(begin, end) for each on its own thread. Runs inline when
+ *            only one thread is needed. The first exception thrown by any
+ *            worker is rethrown on the calling thread after all have joined.
+ *
+ * @Param n_items   Number of work items.
+ * @Param n_threads Number of threads; 0 uses the hardware concurrency.
+ * @Param func      Callable taking (size_t begin, size_t end).
+ */
+template <typename Func>
+void parallel_for_ranges(size_t       n_items,
+                         unsigned int n_threads,
+                         Func&&       func) {
+
+    n_threads = resolve_n_threads(n_threads, n_items);
+    if (n_items == 0) {
+        return;
+    }
+    if (n_threads == 1) {
+        func(size_t(0), n_items);
+        return;
+    }
+
+    size_t chunk_size = (n_items + n_threads - 1) / n_threads;
+    std::vector<std::thread>        workers;
+    std::vector<std::exception_ptr> errors(n_threads);
+    workers.reserve(n_threads);
+
+    for (unsigned int t = 0; t < n_threads; ++t) {
+        size_t begin = t * chunk_size;
+        size_t end   = std::min(begin + chunk_size, n_items);
+        if (begin >= end) {
+            break;
+        }
+        workers.emplace_back([&func, &errors, t, begin, end]() {
+            try {
+                func(begin, end);
+            } catch (...) {
+                errors[t] = std::current_exception();
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+}
+
+#endif
@@ -59,6 +59,7 @@
 
 #include "goetia/goetia.hh"
 #include "goetia/parsing/parsing.hh"
+#include "goetia/profiling.hh"
 #include "goetia/sequences/alphabets.hh"
 
 
@@ -160,6 +161,7 @@ public:
 
         if (stat >= 0) {
             try {
+                ProfileScopeGuard profile(ProfileScope::VALIDATE);
                 Alphabet::validate(_kseq->seq.s, _kseq->seq.l);
             } catch (InvalidCharacterException &e) {
                 _spin_lock = 0;
@@ -28,6 +28,7 @@
 #include "goetia/storage/storage.hh"
 #include "goetia/storage/storage_types.hh"
 #include "goetia/storage/partitioned_storage.hh"
+#include "goetia/sketches/hllcounter.hh"
 
 #include <algorithm>
 #include <memory>
@@ -53,12 +54,31 @@ public:
     _goetia_walker_typedefs_from_graphtype(walker_type)
 
     typedef BaseStorageType                                    base_storage_type;
+    typedef typename shifter_type::batch_hasher_type           batch_hasher_type;
+    typedef typename shifter_type::batch_type                  batch_type;
 
 protected:
 
     std::shared_ptr<PartitionedStorage<BaseStorageType>> S;
     std::shared_ptr<ukhs_type>                           ukhs;
     extender_type                                        partitioner;
+    batch_hasher_type                                    batch_hasher;
+
+    // scratch for insert_sequence
+    batch_type                                           batch;
+
+    // a run of consecutive k-mers in a batch sharing a partition
+    struct PartitionRun {
+        uint32_t partition;
+        size_t   begin;
+        size_t   end;
+
+        bool operator<(const PartitionRun& other) const {
+            return partition < other.partition ||
+                   (partition == other.partition && begin < other.begin);
+        }
+    };
+    std::vector<PartitionRun>                            runs;
 
 public:
 
@@ -72,6 +92,7 @@ public:
         : K           (K),
           ukhs        (ukhs),
           partitioner (K, partition_K, ukhs),
+          batch_hasher(K, partition_K, ukhs),
           partition_K (partition_K)
     {
         S = std::make_shared<PartitionedStorage<BaseStorageType>>(ukhs->n_hashes(),
@@ -93,6 +114,7 @@ public:
         : K           (K),
           ukhs        (ukhs),
           partitioner (K, partition_K, ukhs),
+          batch_hasher(K, partition_K, ukhs),
           partition_K (partition_K)
     {
         S = std::make_shared<PartitionedStorage<BaseStorageType>>(ukhs->n_hashes(),
@@ -106,6 +128,7 @@ public:
         : K           (K),
           ukhs        (ukhs),
           partitioner (K, partition_K, ukhs),
+          batch_hasher(K, partition_K, ukhs),
           partition_K (partition_K),
           S(S->clone())
     {
@@ -225,13 +248,48 @@ public:
         return sequence.size() - K + 1;
     }
 
-    inline const uint64_t insert_sequence(const std::string& sequence) {
-        KmerIterator<extender_type> iter(sequence, &partitioner);
-
-        uint64_t n_consumed = 0;
-        while(!iter.done()) {
-            insert(iter.next());
+    /**
+     * @Synopsis  Hash every k-mer of sequence, with its unikmer and
+     *            partition, in a single pass.
+     *
+     * @Returns   Number of k-mers.
+     */
+    inline size_t hash_sequence(const std::string& sequence,
+                                batch_type&        out) {
+        return batch_hasher.hash_sequence(sequence, out);
+    }
+
+    /**
+     * @Synopsis  Insert a batch from hash_sequence, grouped by partition:
+     *            each partition's store is looked up, and its count
+     *            synced, once per batch rather than once per k-mer. k-mers
+     *            within a partition are inserted in sequence order.
+     */
+    inline void insert_batch(const batch_type& batch) {
+        runs.clear();
+        for (size_t i = 0; i < batch.size(); ++i) {
+            if (i == 0 || batch.partitions[i] != batch.partitions[i - 1]) {
+                runs.push_back({batch.partitions[i], i, i});
+            }
+            runs.back().end = i + 1;
+        }
+        std::sort(runs.begin(), runs.end());
+
+        for (size_t r = 0; r < runs.size(); ) {
+            const uint32_t partition = runs[r].partition;
+            auto *         store     = S->query_partition(partition);
+            for (; r < runs.size() && runs[r].partition == partition; ++r) {
+                for (size_t i = runs[r].begin; i < runs[r].end; ++i) {
+                    store->insert(batch.hashes[i]);
+                }
+            }
+            S->sync_partition_count(partition);
         }
+    }
+
+    inline const uint64_t insert_sequence(const std::string& sequence) {
+        hash_sequence(sequence, batch);
+        insert_batch(batch);
 
         return sequence.size() - K + 1;
     }
@@ -247,11 +305,13 @@ public:
         while(!iter.done()) {
             h = iter.next();
             if (h.minimizer.partition != cur_pid) {
+                S->sync_partition_count(cur_pid);
                 cur_pid = h.minimizer.partition;
                 cur_partition = S->query_partition(cur_pid);
             }
             cur_partition->insert(h.value());
         }
+        S->sync_partition_count(cur_pid);
 
         return sequence.size() - K + 1;
     }
@@ -444,10 +504,22 @@ public:
         S->reset();
     }
 
+    std::shared_ptr<PartitionedStorage<BaseStorageType>> get_storage() {
+        return S;
+    }
+
     std::vector<size_t> get_partition_counts() {
         return S->get_partition_counts();
     }
 
+    uint64_t get_partition_count(uint64_t partition) {
+        return S->get_partition_counts_view().get(partition);
+    }
+
+    const PartitionCounts& get_partition_counts_view() const {
+        return S->get_partition_counts_view();
+    }
+
     void * get_partition_counts_as_buffer() {
         return S->get_partition_counts_as_buffer();
     }
@@ -476,4 +548,7 @@ extern template class goetia::PdBG<goetia::NibbleStorage, goetia::CanUnikmerShif
 
 extern template class goetia::PdBG<goetia::QFStorage, goetia::FwdUnikmerShifter>;
 extern template class goetia::PdBG<goetia::QFStorage, goetia::CanUnikmerShifter>;
+
+extern template class goetia::PdBG<goetia::HLLStorage, goetia::FwdUnikmerShifter>;
+extern template class goetia::PdBG<goetia::HLLStorage, goetia::CanUnikmerShifter>;
 #endif
@@ -20,11 +20,14 @@
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include "goetia/goetia.hh"
+#include "goetia/events.hh"
 #include "goetia/metrics.hh"
 #include "goetia/parsing/parsing.hh"
 #include "goetia/parsing/readers.hh"
+#include "goetia/profiling.hh"
 #include "goetia/sequences/exceptions.hh"
 
 
@@ -52,6 +55,54 @@ protected:
     Gauge           _n_sequences;
     bool                     _verbose;
 
+    std::shared_ptr<Profiler>       _profiler;
+    std::shared_ptr<StreamEventBus> _events;
+
+    /**
+     * @Synopsis  Publish an interval to the event bus, if there is one.
+     *
+     * @Returns   Whether to keep going: false once the bus has been asked
+     *            to stop, e.g. when the sample has saturated.
+     */
+    bool publish_interval() {
+        if (!_events) {
+            return true;
+        }
+        _events->interval(timer.total(), _n_sequences);
+        return !_events->stop_requested();
+    }
+
+    /**
+     * @Synopsis  Check an in-memory sequence as the parser checks what it
+     *            reads: lowercase is upper-cased in place, and sequences
+     *            with invalid characters or under min_length are skipped.
+     *
+     * @Param strict     Raise on invalid sequences rather than skip them.
+     * @Param min_length Skip sequences under this length.
+     *
+     * @Returns   Whether to process the sequence.
+     */
+    bool validate_sequence(std::string& sequence,
+                           bool         strict,
+                           uint32_t     min_length) {
+        try {
+            ProfileScopeGuard profile(ProfileScope::VALIDATE);
+            alphabet::validate(&sequence[0], sequence.size());
+        } catch (InvalidCharacterException& e) {
+            if (strict) {
+                throw;
+            }
+            if (_verbose) {
+                std::cerr << "WARNING: Bad sequence encountered at "
+                          << this->n_sequences()
+                          << ", exception was "
+                          << e.what() << std::endl;
+            }
+            return false;
+        }
+        return sequence.size() >= min_length;
+    }
+
 public:
 
     typedef typename ParserType::alphabet alphabet;
@@ -94,8 +145,8 @@ public:
     std::tuple<uint64_t, uint64_t> process(std::shared_ptr<SplitPairedReader<ParserType>>& reader) {
         uint64_t n_sequences, time_total;
         bool remaining = true;
-        while(1) {
-            std::tie(n_sequences, time_total, remaining) = advance(reader);
+        while(remaining) {
+            std::tie(n_sequences, time_total, remaining) = derived().advance(reader);
         }
 
         return {n_sequences, time_total};
@@ -120,12 +171,93 @@ public:
         uint64_t n_sequences = 0, time_total = 0;
         bool remaining = true;
         while(remaining) {
-            std::tie(n_sequences, time_total, remaining) = advance(reader);
+            std::tie(n_sequences, time_total, remaining) = derived().advance(reader);
         }
 
         return {n_sequences, time_total};
     }
 
+    /**
+     * @Synopsis  Process a list of files as a single stream, grouping them
+     *            as goetia.parsing.iter_fastx_inputs does: with "split",
+     *            each two files are a (left, right) pair; with "single" or
+     *            "interleaved", each file is read on its own. Stops early
+     *            if the event bus is asked to stop.
+     *
+     * @Param inputs       Files to process, in order.
+     * @Param pairing_mode One of "single", "interleaved" or "split".
+     * @Param strict       Raise on invalid sequences rather than skip them.
+     * @Param min_length   Filter sequences under this length; if 0
+     *                     (default), do not filter.
+     *
+     * @Returns   Number of sequences processed, time passed.
+     */
+    std::tuple<uint64_t, uint64_t> process_files(const std::vector<std::string>& inputs,
+                                                 const std::string&              pairing_mode = "single",
+                                                 bool                            strict = false,
+                                                 uint32_t                        min_length = 0) {
+        const bool split = pairing_mode == "split";
+        if (!split && pairing_mode != "single" && pairing_mode != "interleaved") {
+            throw GoetiaException("Unknown pairing mode: " + pairing_mode);
+        }
+        if (split && inputs.size() % 2 != 0) {
+            throw GoetiaException("Split pairing mode needs an even number of files.");
+        }
+
+        const size_t step = split ? 2 : 1;
+        for (size_t i = 0; i < inputs.size(); i += step) {
+            if (split) {
+                process(inputs[i], inputs[i + 1], strict, min_length);
+            } else {
+                process(inputs[i], strict, min_length);
+            }
+            if (_events && _events->stop_requested()) {
+                break;
+            }
+        }
+
+        return {_n_sequences, timer.total()};
+    }
+
+    /**
+     * @Synopsis  Process sequences already in memory, as if they had been
+     *            read from a file. Stops early if the event bus is asked to
+     *            stop.
+     *
+     * @Param sequences  The sequences.
+     * @Param strict     Raise on invalid sequences rather than skip them.
+     * @Param min_length Filter sequences under this length; if 0
+     *                   (default), do not filter.
+     *
+     * @Returns   Number of sequences processed, time passed.
+     */
+    std::tuple<uint64_t, uint64_t> process_sequences(const std::vector<std::string>& sequences,
+                                                     bool                            strict = false,
+                                                     uint32_t                        min_length = 0) {
+        Profiler::Activation profiling(_profiler.get());
+
+        Record record;
+        for (const auto& sequence : sequences) {
+            record.sequence = sequence;
+            if (!validate_sequence(record.sequence, strict, min_length)) {
+                continue;
+            }
+
+            uint64_t time_passed;
+            {
+                ProfileScopeGuard profile(ProfileScope::PROCESS);
+                time_passed = derived().process_sequence(record);
+            }
+            ++_n_sequences;
+
+            if (timer.poll(time_passed) && !publish_interval()) {
+                break;
+            }
+        }
+
+        return {_n_sequences, timer.total()};
+    }
+
     /**
      * @Synopsis     Default paired-end sequence processing implementation:
      *               just consume both.
@@ -178,20 +310,29 @@ public:
      * @Returns   Tuple containing <total seqs processed, total time passed, whether sequences remain>
      */
     std::tuple<uint64_t, uint64_t, bool> advance(std::shared_ptr<SplitPairedReader<ParserType>>& reader) {
+        Profiler::Activation profiling(_profiler.get());
+
         std::optional<RecordPair> bundle;
         while (!reader->is_complete()) {
-            bundle = handle_next(*reader);
+            {
+                ProfileScopeGuard profile(ProfileScope::PARSE);
+                bundle = handle_next(*reader);
+            }
             
             if (!bundle) {
                 continue;
             }
 
-            uint64_t time_passed = derived().process_sequence(bundle.value());
+            uint64_t time_passed;
+            {
+                ProfileScopeGuard profile(ProfileScope::PROCESS);
+                time_passed = derived().process_sequence(bundle.value());
+            }
             int _bundle_count = (bool)bundle.value().first + (bool)bundle.value().second;
             _n_sequences += _bundle_count;
 
             if (timer.poll(time_passed)) {
-                return {_n_sequences, timer.total(), true};
+                return {_n_sequences, timer.total(), publish_interval()};
             }
         }
 
@@ -206,21 +347,29 @@ public:
      * @Returns   Tuple containing <total seqs processed, total time passed, whether sequences remain>
      */
     std::tuple<uint64_t, uint64_t, bool> advance(std::shared_ptr<ParserType>& parser) {
+        Profiler::Activation profiling(_profiler.get());
 
         std::optional<Record> record;
         // Iterate through the reads and consume their k-mers.
         while (!parser->is_complete()) {
-            record = handle_next(*parser);
+            {
+                ProfileScopeGuard profile(ProfileScope::PARSE);
+                record = handle_next(*parser);
+            }
             
             if (!record) {
                 continue;
             }
 
-            uint64_t time_passed = derived().process_sequence(record.value());
+            uint64_t time_passed;
+            {
+                ProfileScopeGuard profile(ProfileScope::PROCESS);
+                time_passed = derived().process_sequence(record.value());
+            }
             ++_n_sequences;
 
             if (timer.poll(time_passed)) {
-                return {_n_sequences, timer.total(), true};
+                return {_n_sequences, timer.total(), publish_interval()};
             }
             
         }
@@ -245,6 +394,32 @@ public:
         return timer.interval;
     }
 
+    /**
+     * @Synopsis  Count hardware events and latencies against the
+     *            profiler's scopes while advancing; nullptr (the default)
+     *            turns profiling off.
+     */
+    void set_profiler(std::shared_ptr<Profiler> profiler) {
+        _profiler = profiler;
+    }
+
+    std::shared_ptr<Profiler> get_profiler() const {
+        return _profiler;
+    }
+
+    /**
+     * @Synopsis  Publish an INTERVAL event to the bus at each interval, on
+     *            the processing thread; advance stops early once the bus
+     *            is asked to stop. nullptr (the default) publishes nothing.
+     */
+    void set_event_bus(std::shared_ptr<StreamEventBus> events) {
+        _events = events;
+    }
+
+    std::shared_ptr<StreamEventBus> get_event_bus() const {
+        return _events;
+    }
+
     template<typename... Args>
     static std::shared_ptr<Derived> build(Args&&... args,
                                           uint64_t interval,
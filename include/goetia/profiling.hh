@@ -0,0 +1,329 @@
+/**
+ * (c) Camille Scott, 2026
+ * File   : profiling.hh
+ * License: MIT
+ * Author : Camille Scott <camille.scott.w@gmail.com>
+ * Date   : 18.10.2026
+ *
+ * Hardware performance counters and latencies around named processing
+ * stages. Each thread opens its own group of counters with perf_event_open,
+ * counting only that thread in user space; ProfileScopeGuards read the
+ * group and the clock on entry and exit, add the counter differences to the
+ * active Profiler's totals, and record the elapsed time in that thread's
+ * latency histogram for the scope. Both are taken once per interval, when
+ * the threads' histograms are merged.
+ *
+ * Scopes nest and are inclusive: a parse scope includes the validate
+ * scope within it, processing a read includes any compactor update, and a
+ * compactor update includes the hashing and storage inserts it does.
+ *
+ * A scope with no active Profiler on its thread costs a thread-local load
+ * and a branch; building with GOETIA_NO_PROFILING removes the scopes
+ * entirely.
+ */
+
+#ifndef GOETIA_PROFILING_HH
+#define GOETIA_PROFILING_HH
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "goetia/metrics.hh"
+
+
+namespace goetia {
+
+enum class ProfileScope : uint8_t {
+    PARSE = 0,
+    VALIDATE,
+    PROCESS,
+    HASH,
+    STORAGE_INSERT,
+    COMPACTOR_UPDATE
+};
+
+constexpr size_t N_PROFILE_SCOPES = 6;
+
+
+enum class PerfEvent : uint8_t {
+    CYCLES = 0,
+    INSTRUCTIONS,
+    LLC_MISSES,
+    DTLB_MISSES,
+    BRANCH_MISSES
+};
+
+constexpr size_t N_PERF_EVENTS = 5;
+
+
+const char * profile_scope_name(ProfileScope scope);
+
+const char * perf_event_name(PerfEvent event);
+
+
+typedef std::array<uint64_t, N_PERF_EVENTS> PerfCounts;
+
+
+/**
+ * @Synopsis  The calling thread's group of hardware counters. Events the
+ *            kernel or CPU won't count -- in a VM without a PMU, say, or
+ *            with perf_event_paranoid set too high -- are left out and
+ *            always read as 0.
+ */
+class PerfCounterGroup {
+
+    std::array<int, N_PERF_EVENTS>    _fds;
+    // position of each open event in the group's read buffer
+    std::array<size_t, N_PERF_EVENTS> _slots;
+    int                               _leader;
+    size_t                            _n_open;
+
+public:
+
+    PerfCounterGroup();
+    ~PerfCounterGroup();
+
+    PerfCounterGroup(const PerfCounterGroup&) = delete;
+    PerfCounterGroup& operator=(const PerfCounterGroup&) = delete;
+
+    /**
+     * @Synopsis  The calling thread's group, opened on first use.
+     */
+    static PerfCounterGroup& this_thread();
+
+    bool is_open(PerfEvent event) const {
+        return _fds[static_cast<size_t>(event)] != -1;
+    }
+
+    bool is_available() const {
+        return _n_open > 0;
+    }
+
+    /**
+     * @Synopsis  Read the running totals of every event at once.
+     */
+    void read(PerfCounts& counts) const;
+};
+
+
+typedef std::array<LatencyHistogram, N_PROFILE_SCOPES> ScopeLatencies;
+
+
+/**
+ * @Synopsis  Per-scope totals of the hardware counters and latency
+ *            histograms, collected from the threads on which it's active.
+ */
+class Profiler {
+
+    struct ScopeTotals {
+        std::atomic<uint64_t>                            calls;
+        std::array<std::atomic<uint64_t>, N_PERF_EVENTS> counts;
+    };
+
+    struct ThreadLatencies {
+        std::thread::id id;
+        ScopeLatencies  scopes;
+    };
+
+    // inline, so that scopes read it without a call into the library
+    static inline thread_local Profiler * _active = nullptr;
+
+    std::array<ScopeTotals, N_PROFILE_SCOPES> _totals;
+    std::atomic<bool>                         _enabled;
+    const bool                                _count_events;
+
+    // each thread records into its own histograms; they're only locked to
+    // register a thread and to drain them
+    std::vector<std::unique_ptr<ThreadLatencies>> _threads;
+    std::mutex                                    _threads_mutex;
+    ScopeLatencies                                _sample_latencies;
+
+    ScopeLatencies& thread_latencies();
+
+    void drain_latencies(ScopeLatencies& into);
+
+    static std::map<std::string, std::map<std::string, uint64_t>>
+    summarize(const ScopeLatencies& latencies);
+
+public:
+
+    /**
+     * @Param enabled      Whether to profile at all.
+     * @Param count_events Whether to read the hardware counters; when
+     *                     false, only calls and latencies are recorded,
+     *                     and the counts are all 0.
+     */
+    Profiler(bool enabled = true, bool count_events = true);
+
+    static std::shared_ptr<Profiler> build(bool enabled = true,
+                                           bool count_events = true) {
+        return std::make_shared<Profiler>(enabled, count_events);
+    }
+
+    /**
+     * @Synopsis  The calling thread's active profiler, or nullptr.
+     */
+    static Profiler * active() {
+        return _active;
+    }
+
+    /**
+     * @Synopsis  Makes a profiler the calling thread's active one for its
+     *            lifetime, if it's enabled; a null or disabled profiler
+     *            deactivates profiling on the thread instead.
+     */
+    class Activation {
+
+        Profiler *       _previous;
+        ScopeLatencies * _previous_latencies;
+
+    public:
+
+        explicit Activation(Profiler * profiler);
+        ~Activation();
+
+        Activation(const Activation&) = delete;
+        Activation& operator=(const Activation&) = delete;
+    };
+
+    void enable() {
+        _enabled.store(true, std::memory_order_relaxed);
+    }
+
+    void disable() {
+        _enabled.store(false, std::memory_order_relaxed);
+    }
+
+    bool is_enabled() const {
+        return _enabled.load(std::memory_order_relaxed);
+    }
+
+    bool counts_events() const {
+        return _count_events;
+    }
+
+    /**
+     * @Synopsis  Whether the calling thread can open any hardware
+     *            counters. Opens its group if need be.
+     */
+    bool counters_available() const;
+
+    /**
+     * @Synopsis  Count one pass through a scope on the calling thread.
+     *
+     * @Param scope       The scope.
+     * @Param delta       Hardware events counted within it.
+     * @Param nanoseconds Time spent within it.
+     */
+    void add(ProfileScope scope, const PerfCounts& delta, uint64_t nanoseconds);
+
+    uint64_t calls(ProfileScope scope) const {
+        return _totals[static_cast<size_t>(scope)].calls.load(std::memory_order_relaxed);
+    }
+
+    uint64_t count(ProfileScope scope, PerfEvent event) const {
+        return _totals[static_cast<size_t>(scope)].counts[static_cast<size_t>(event)]
+                   .load(std::memory_order_relaxed);
+    }
+
+    void reset();
+
+    /**
+     * @Synopsis  Take the totals accumulated since the last call, and
+     *            start the next interval from zero.
+     *
+     * @Returns   Scope name to event name to total, with the number of
+     *            times the scope was entered under "calls". Scopes not
+     *            entered are left out.
+     */
+    std::map<std::string, std::map<std::string, uint64_t>> take_interval();
+
+    /**
+     * @Synopsis  Merge the threads' latency histograms for the interval
+     *            since the last call, and start the next one. The interval
+     *            is also added to the sample's histograms.
+     *
+     * @Returns   Scope name to "count", "mean", "p50", "p99", "p999" and
+     *            "max", in nanoseconds. Scopes not entered are left out.
+     */
+    std::map<std::string, std::map<std::string, uint64_t>> take_latencies();
+
+    /**
+     * @Synopsis  As take_latencies, but over every interval since the last
+     *            call, including the current one; meant to be taken when
+     *            a sample is finished.
+     */
+    std::map<std::string, std::map<std::string, uint64_t>> take_sample_latencies();
+};
+
+
+/**
+ * @Synopsis  Counts its own lifetime against a scope of the calling
+ *            thread's active profiler.
+ */
+class ProfileScopeGuard {
+
+#ifndef GOETIA_NO_PROFILING
+
+    typedef std::chrono::steady_clock clock_type;
+
+    Profiler *             _profiler;
+    ProfileScope           _scope;
+    PerfCounts             _start;
+    clock_type::time_point _start_time;
+
+public:
+
+    explicit ProfileScopeGuard(ProfileScope scope)
+        : _profiler(Profiler::active()),
+          _scope(scope)
+    {
+        if (__builtin_expect(_profiler != nullptr, 0)) {
+            if (_profiler->counts_events()) {
+                PerfCounterGroup::this_thread().read(_start);
+            } else {
+                _start.fill(0);
+            }
+            _start_time = clock_type::now();
+        }
+    }
+
+    ~ProfileScopeGuard() {
+        if (__builtin_expect(_profiler != nullptr, 0)) {
+            const auto elapsed = clock_type::now() - _start_time;
+            PerfCounts end{};
+            if (_profiler->counts_events()) {
+                PerfCounterGroup::this_thread().read(end);
+                for (size_t i = 0; i < N_PERF_EVENTS; ++i) {
+                    end[i] -= _start[i];
+                }
+            }
+            _profiler->add(_scope, end,
+                           std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+    }
+
+#else
+
+public:
+
+    explicit ProfileScopeGuard(ProfileScope) {
+    }
+
+#endif
+
+    ProfileScopeGuard(const ProfileScopeGuard&) = delete;
+    ProfileScopeGuard& operator=(const ProfileScopeGuard&) = delete;
+};
+
+}
+
+#endif
@@ -0,0 +1,275 @@
+/**
+ * (c) Camille Scott, 2026
+ * File   : fracminhash.hh
+ * License: MIT
+ * Author : Camille Scott <camille.scott.w@gmail.com>
+ * Date   : 18.10.2026
+ *
+ * A native scaled MinHash (FracMinHash) sketch, hash-compatible with
+ * sourmash: k-mers are canonicalized as the lexicographically smaller of
+ * the k-mer and its reverse complement, hashed with the first 64 bits of
+ * MurmurHash3_x64_128, and kept if the hash is at most max_hash. Unlike
+ * SourmashSketch, building one never crosses into the sourmash library.
+ */
+
+#ifndef GOETIA_FRACMINHASH_HH
+#define GOETIA_FRACMINHASH_HH
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "goetia/goetia.hh"
+#include "goetia/parallel.hh"
+#include "goetia/parsing/readers.hh"
+#include "goetia/processors.hh"
+#include "goetia/sequences/alphabets.hh"
+#include "goetia/sketches/saturation.hh"
+
+
+namespace goetia {
+
+    struct FracMinHash {
+
+        class Sketch {
+
+          protected:
+
+            // sorted, unique retained hashes, and hashes which passed the
+            // threshold but haven't been merged in yet
+            mutable std::vector<uint64_t> _mins;
+            mutable std::vector<uint64_t> _pending;
+
+            std::string                   _scratch;
+
+            const uint64_t                _max_hash;
+            const uint32_t                _seed;
+
+          public:
+
+            const uint16_t K;
+            const uint64_t scaled;
+            const size_t   batch_size;
+
+            /**
+             * @Param K          k-mer size.
+             * @Param scaled     Keep hashes at most 2^64 / scaled.
+             * @Param seed       Murmur seed; sourmash uses 42.
+             * @Param batch_size Number of pending hashes to buffer before
+             *                   merging them into the sorted sketch.
+             */
+            Sketch(uint16_t K,
+                   uint64_t scaled,
+                   uint32_t seed       = 42,
+                   size_t   batch_size = 1 << 14);
+
+            static std::shared_ptr<Sketch> build(uint16_t K,
+                                                 uint64_t scaled,
+                                                 uint32_t seed       = 42,
+                                                 size_t   batch_size = 1 << 14) {
+                return std::make_shared<Sketch>(K, scaled, seed, batch_size);
+            }
+
+            static uint64_t max_hash_from_scaled(uint64_t scaled) {
+                if (scaled == 0) {
+                    return 0;
+                } else if (scaled == 1) {
+                    return std::numeric_limits<uint64_t>::max();
+                } else {
+                    return static_cast<uint64_t>(static_cast<double>(std::numeric_limits<uint64_t>::max()) /
+                                                 static_cast<double>(scaled));
+                }
+            }
+
+            /**
+             * @Synopsis  The sourmash hash of a single k-mer: murmur3 of the
+             *            canonical k-mer. kmer must be upper-case ACGT.
+             */
+            static uint64_t hash_kmer(const char * kmer,
+                                      uint16_t     K,
+                                      uint32_t     seed = 42);
+
+            /**
+             * @Synopsis  Hash the k-mers of sequence and append those at most
+             *            max_hash to out. k-mers containing bases other than
+             *            ACGT are skipped, as sourmash does with force=true.
+             *            Thread-safe; scratch is a per-caller work buffer.
+             *
+             * @Returns   Number of k-mers hashed.
+             */
+            static size_t hash_sequence(const std::string&     sequence,
+                                        uint16_t               K,
+                                        uint32_t               seed,
+                                        uint64_t               max_hash,
+                                        std::vector<uint64_t>& out,
+                                        std::string&           scratch);
+
+            /**
+             * @Synopsis  Add a sequence's k-mers.
+             *
+             * @Returns   Number of k-mers hashed.
+             */
+            size_t insert_sequence(const std::string& sequence) {
+                size_t n_kmers = hash_sequence(sequence, K, _seed, _max_hash, _pending, _scratch);
+                if (_pending.size() >= batch_size) {
+                    flush();
+                }
+                return n_kmers;
+            }
+
+            /**
+             * @Synopsis  Add a batch of sequences, sharded over n_threads
+             *            worker threads; each shard is hashed independently
+             *            and the shards merged at the end.
+             *
+             * @Returns   Number of k-mers hashed.
+             */
+            size_t insert_sequences(const std::vector<std::string>& sequences,
+                                    unsigned int                    n_threads = 1);
+
+            /**
+             * @Synopsis  Add already-computed hashes, for instance from
+             *            hash_sequence; those above max_hash are dropped.
+             */
+            void insert_hashes(const uint64_t * hashes,
+                               size_t           n) {
+                for (size_t i = 0; i < n; ++i) {
+                    if (hashes[i] <= _max_hash) {
+                        _pending.push_back(hashes[i]);
+                    }
+                }
+                if (_pending.size() >= batch_size) {
+                    flush();
+                }
+            }
+
+            void insert_hash(uint64_t hash) {
+                insert_hashes(&hash, 1);
+            }
+
+            /**
+             * @Synopsis  Merge the pending hashes into the sorted sketch.
+             */
+            void flush() const;
+
+            /**
+             * @Synopsis  Union another sketch into this one. The sketches
+             *            must have the same K, seed and scaled.
+             */
+            void merge(const Sketch& other);
+
+            bool is_compatible(const Sketch& other) const {
+                return K == other.K && _seed == other._seed && _max_hash == other._max_hash;
+            }
+
+            /**
+             * @Returns   The retained hashes, sorted.
+             */
+            std::vector<uint64_t> mins() const {
+                flush();
+                return _mins;
+            }
+
+            size_t size() const {
+                flush();
+                return _mins.size();
+            }
+
+            uint64_t count_common(const Sketch& other) const;
+
+            double jaccard(const Sketch& other) const;
+
+            /*
+             * Accessors mirroring sourmash::MinHash, so that a sketch
+             * converts to a sourmash MinHash the same way SourmashSketch's does.
+             */
+
+            uint32_t num() const {
+                return 0;
+            }
+
+            uint32_t ksize() const {
+                return K;
+            }
+
+            uint32_t seed() const {
+                return _seed;
+            }
+
+            uint64_t max_hash() const {
+                return _max_hash;
+            }
+
+            bool is_protein() const {
+                return false;
+            }
+
+            bool dayhoff() const {
+                return false;
+            }
+
+            bool hp() const {
+                return false;
+            }
+
+            bool track_abundance() const {
+                return false;
+            }
+        };
+
+        using Processor = InserterProcessor<Sketch, FastxParser<DNAN_SIMPLE>>;
+
+        /**
+         * @Synopsis  Saturation tracking for a FracMinHash sketch. Reports
+         *            the Jaccard similarity between the sketch now and at
+         *            the previous update, as sourmash's similarity would.
+         *            A sketch only ever gains hashes, so the earlier state is
+         *            a subset of the later and the similarity is just the
+         *            ratio of their sizes. Must not run concurrently with
+         *            inserts into the sketch.
+         */
+        class Saturation {
+
+        protected:
+
+            std::shared_ptr<Sketch> sketch;
+            SaturationWindow        window;
+            size_t                  last_size;
+
+        public:
+
+            Saturation(std::shared_ptr<Sketch> sketch,
+                       size_t                  window_size,
+                       double                  cutoff,
+                       const std::string&      smoothing       = "mean",
+                       const std::string&      cutoff_function = "all")
+                : sketch    (sketch),
+                  window    (window_size, cutoff, smoothing, cutoff_function),
+                  last_size (0)
+            {
+            }
+
+            static std::shared_ptr<Saturation> build(std::shared_ptr<Sketch> sketch,
+                                                     size_t                  window_size,
+                                                     double                  cutoff,
+                                                     const std::string&      smoothing       = "mean",
+                                                     const std::string&      cutoff_function = "all") {
+                return std::make_shared<Saturation>(sketch, window_size, cutoff, smoothing, cutoff_function);
+            }
+
+            SaturationStatus update(uint64_t t) {
+                const size_t size = sketch->size();
+                double similarity = (last_size == 0 || size == 0)
+                                    ? std::numeric_limits<double>::quiet_NaN()
+                                    : static_cast<double>(last_size) / static_cast<double>(size);
+                last_size = size;
+                return window.push(similarity, t);
+            }
+        };
+    };
+
+}
+
+#endif
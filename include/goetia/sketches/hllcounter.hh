@@ -43,14 +43,17 @@ Contact: khmer-project@idyll.org
 #ifndef HLLCOUNTER_HH
 #define HLLCOUNTER_HH
 
+#include <cmath>
 #include <cstdint>
+#include <fstream>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "goetia/goetia.hh"
 #include "goetia/meta.hh"
 #include "goetia/storage/storage.hh"
-#include "goetia/sketches/sketch/include/sketch/hll.h"
+#include "goetia/storage/partitioned_storage.hh"
 
 namespace goetia {
 
@@ -66,39 +69,132 @@ struct StorageTraits<HLLStorage> {
 };
 
 
-class HLLStorage : public Storage<uint64_t>,
-                   public Tagged<HLLStorage>
-{
-
-/*
- * This is just a thin wrapper around sketch::hll_t to make it 
- * compatible with partitioned_storage for use as a backend
- * in UnikmerSketch. It is *not* meant to be used as an
- * actual dBG storage.
+/**
+ * @Synopsis  Kernels over raw HyperLogLog register arrays: one byte per
+ *            register, holding the rank of the leftmost set bit seen. They
+ *            work on any contiguous run of registers, so they cover a
+ *            single counter or every partition of a PartitionedStorage.
  */
-public:
+struct HLLRegisters {
+
+    static constexpr uint8_t MIN_PRECISION = 4;
+    static constexpr uint8_t MAX_PRECISION = 18;
+
+    /**
+     * @Synopsis  Number of index bits needed for a relative standard error
+     *            of error_rate, clamped to [MIN_PRECISION, MAX_PRECISION].
+     */
+    static uint8_t precision_from_error(double error_rate);
+
+    static double alpha(size_t n_registers);
+
+    /**
+     * @Synopsis  Register-wise max of src into dst.
+     */
+    static void merge(uint8_t *       dst,
+                      const uint8_t * src,
+                      size_t          n_registers);
+
+    /**
+     * @Synopsis  Sum of 2^-register and the number of empty registers.
+     */
+    static void harmonic_sum(const uint8_t * registers,
+                             size_t          n_registers,
+                             double&         sum,
+                             size_t&         n_zeros);
+
+    /**
+     * @Synopsis  The bias-corrected cardinality estimate of one counter,
+     *            falling back to linear counting at small cardinalities.
+     */
+    static double estimate(const uint8_t * registers,
+                           size_t          n_registers);
+
+    /**
+     * @Synopsis  The estimate from a precomputed harmonic sum.
+     */
+    static double estimate(double sum,
+                           size_t n_zeros,
+                           size_t n_registers);
+
+    static inline double inverse_pow2(uint8_t rank) {
+        return std::ldexp(1.0, -static_cast<int>(rank));
+    }
 
-    typedef sketch::hll::shll_t sketch_t;
+    /**
+     * @Synopsis  Scramble a hash before use; goetia's rolling hashes
+     *            aren't well mixed enough in their high bits to be used
+     *            directly as register indices.
+     */
+    static inline uint64_t mix(uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    /**
+     * @Synopsis  The register index and rank for h.
+     */
+    static inline void index_and_rank(uint64_t  h,
+                                      uint8_t   p,
+                                      uint64_t& index,
+                                      uint8_t&  rank) {
+        h = mix(h);
+        index = h >> (64 - p);
+        // the sentinel bit caps the rank at 64 - p + 1
+        const uint64_t rest = (h << p) | (uint64_t(1) << (p - 1));
+        rank  = static_cast<uint8_t>(__builtin_clzll(rest) + 1);
+    }
+};
+
+
+/**
+ * @Synopsis  A HyperLogLog cardinality counter exposed as a Storage, for
+ *            use as a PartitionedStorage backend in UnikmerSketch. It
+ *            counts distinct k-mers only: query and insert_and_query can't
+ *            report per-k-mer counts and always return 1, so it is *not*
+ *            meant to be used as an actual dBG storage. A counter either
+ *            owns its registers or is a view over registers owned by a
+ *            PartitionedStorage<HLLStorage>.
+ */
+class HLLStorage final : public Storage<uint64_t>,
+                         public Tagged<HLLStorage>
+{
 
 protected:
 
-    std::shared_ptr<sketch_t> counter;
+    std::vector<uint8_t> _owned;
+    uint8_t *            _registers;
+
+    // harmonic sum and empty register count, maintained on insert so the
+    // estimate is O(1)
+    double               _sum;
+    uint64_t             _n_zeros;
 
 public:
 
     using Storage<uint64_t>::value_type;
     using Traits = StorageTraits<HLLStorage>;
-    const double error_rate;
 
-    HLLStorage(double error_rate)
-        : error_rate(error_rate) {
-        int p = ceil(log2(pow(1.04 / error_rate, 2)));
-        counter = std::make_shared<sketch_t>(p);
-    }
+    const double  error_rate;
+    const uint8_t p;
+    const size_t  n_registers;
+
+    explicit HLLStorage(double error_rate);
+
+    /**
+     * @Synopsis  A counter over external registers, which must hold
+     *            1 << precision_from_error(error_rate) bytes and outlive it.
+     */
+    HLLStorage(double    error_rate,
+               uint8_t * registers);
 
-    //HLLStorage(int nc) {
-    //    counter = std::make_shared<sketches::HLLCounter>(nc);
-    //}
+    HLLStorage(const HLLStorage& other);
+
+    HLLStorage(HLLStorage&& other) = default;
 
     std::shared_ptr<HLLStorage> clone() const {
         return std::make_shared<HLLStorage>(error_rate);
@@ -112,25 +208,57 @@ public:
         return make_shared_from_tuple<HLLStorage>(params);
     }
 
-    void reset() {
-        counter = std::make_shared<sketch_t>(error_rate);
+    void reset();
+
+    /**
+     * @Returns   Number of non-empty registers.
+     */
+    const uint64_t n_occupied() const;
+
+    const uint64_t n_unique_kmers() const {
+        return static_cast<uint64_t>(std::llround(estimate()));
     }
 
-    const uint64_t n_occupied() const {
-        return 0;
+    double estimate() const {
+        return HLLRegisters::estimate(_sum, _n_zeros, n_registers);
     }
 
-    const uint64_t n_unique_kmers() const {
-        return counter->report();
+    /**
+     * @Synopsis  Recompute the harmonic sum after the registers were
+     *            changed other than by insert.
+     */
+    void recount() {
+        size_t n_zeros;
+        HLLRegisters::harmonic_sum(_registers, n_registers, _sum, n_zeros);
+        _n_zeros = n_zeros;
     }
 
+    /**
+     * @Returns   The expected relative standard error of the estimate.
+     */
+    double relative_error() const {
+        return 1.04 / std::sqrt(static_cast<double>(n_registers));
+    }
+
+    /**
+     * @Returns   true if a register, and so the estimate, changed.
+     */
     const inline bool insert(value_type h) {
-        counter->addh(h);
-        return true;
+        uint64_t index;
+        uint8_t  rank;
+        HLLRegisters::index_and_rank(h, p, index, rank);
+        const uint8_t old = _registers[index];
+        if (rank > old) {
+            _registers[index] = rank;
+            _sum     += HLLRegisters::inverse_pow2(rank) - HLLRegisters::inverse_pow2(old);
+            _n_zeros -= (old == 0);
+            return true;
+        }
+        return false;
     }
 
     const count_t insert_and_query(value_type h) {
-        counter->addh(h);
+        insert(h);
         return 1;
     }
 
@@ -138,25 +266,180 @@ public:
         return 1;
     }
 
+    /**
+     * @Synopsis  Union other into this counter. Both must have the same
+     *            precision.
+     */
+    void merge(const HLLStorage& other);
+
+    const uint8_t * registers() const {
+        return _registers;
+    }
+
+    void save(std::string, uint16_t ) {
+    }
+
+    void load(std::string, uint16_t &) {
+    }
+
+    static std::shared_ptr<HLLStorage> deserialize(std::ifstream& in);
+
+    void serialize(std::ofstream& out);
+
+    byte_t ** get_raw_tables() {
+        return nullptr;
+    }
+};
+
+
+/**
+ * @Synopsis  Partitioned HLL storage for draff sketches. Rather than one
+ *            heap allocation per partition, the registers of every
+ *            partition live in a single contiguous array, partition i
+ *            occupying [i * n_registers, (i + 1) * n_registers), so
+ *            merging or estimating the whole sketch is one linear pass.
+ */
+template<>
+class PartitionedStorage<HLLStorage> : public Storage<uint64_t> {
+
+protected:
+
+    std::vector<uint8_t>    registers;
+    std::vector<HLLStorage> partitions;
+    const uint64_t          n_partitions;
+    PartitionCounts         counts;
+
+public:
+
+    typedef uint64_t                         value_type;
+    typedef HLLStorage                       base_storage_type;
+    typedef StorageTraits<base_storage_type> storage_traits;
+
+    const double error_rate;
+
+    explicit PartitionedStorage(const uint64_t n_partitions)
+        : PartitionedStorage(n_partitions, storage_traits::default_params)
+    {
+    }
+
+    PartitionedStorage(const uint64_t                              n_partitions,
+                       const typename storage_traits::params_type& params)
+        : PartitionedStorage(n_partitions, std::get<0>(params))
+    {
+    }
+
+    PartitionedStorage(const uint64_t n_partitions,
+                       double         error_rate);
+
+    PartitionedStorage(const uint64_t      n_partitions,
+                       base_storage_type * S)
+        : PartitionedStorage(n_partitions, S->error_rate)
+    {
+    }
+
+    PartitionedStorage(const PartitionedStorage&) = delete;
+
+    std::shared_ptr<PartitionedStorage<HLLStorage>> clone() const {
+        return std::make_shared<PartitionedStorage<HLLStorage>>(n_partitions, error_rate);
+    }
+
+    void reset();
+
+    const uint64_t n_unique_kmers() const {
+        return counts.sum();
+    }
+
+    const uint64_t n_occupied() const {
+        return partitions.front().n_occupied();
+    }
+
+    const uint64_t n_partition_stores() const {
+        return n_partitions;
+    }
+
+    size_t n_registers() const {
+        return partitions.front().n_registers;
+    }
+
     void save(std::string, uint16_t ) {
     }
 
     void load(std::string, uint16_t &) {
     }
 
-    static std::shared_ptr<HLLStorage> deserialize(std::ifstream& in) {
+    inline const bool insert(value_type h, uint64_t partition) {
+        auto partition_store = query_partition(partition);
+        if (partition_store->insert(h)) {
+            counts.set(partition, partition_store->n_unique_kmers());
+            return true;
+        }
+        return false;
+    }
+
+    inline const count_t insert_and_query(value_type h, uint64_t partition) {
+        insert(h, partition);
+        return 1;
+    }
+
+    inline void sync_partition_count(uint64_t partition) {
+        counts.set(partition, query_partition(partition)->n_unique_kmers());
     }
 
-    void serialize(std::ofstream& out) {
+    inline const count_t query(value_type h, uint64_t partition) {
+        return query_partition(partition)->query(h);
     }
 
+    HLLStorage * query_partition(uint64_t partition) {
+        if (partition < n_partitions) {
+            return &partitions[partition];
+        } else {
+            throw GoetiaException("Invalid storage partition: " + std::to_string(partition));
+        }
+    }
+
+    /**
+     * @Synopsis  Union every partition of other into this storage in one
+     *            pass. Both must have the same partition count and precision.
+     */
+    void merge(const PartitionedStorage<HLLStorage>& other);
+
     byte_t ** get_raw_tables() {
         return nullptr;
     }
+
+    const uint8_t * get_registers() const {
+        return registers.data();
+    }
+
+    const bool insert(value_type khash ) {
+        throw GoetiaException("Method not available!");
+    }
+
+    const count_t insert_and_query(value_type khash) {
+        throw GoetiaException("Method not available!");
+    }
+
+    const count_t query(value_type khash) const {
+        throw GoetiaException("Method not available!");
+    }
+
+    /**
+     * @Returns   The cardinality estimate of each partition.
+     */
+    std::vector<size_t> get_partition_counts() {
+        return counts.to_vector();
+    }
+
+    const PartitionCounts& get_partition_counts_view() const {
+        return counts;
+    }
+
+    void * get_partition_counts_as_buffer() {
+        return const_cast<uint64_t *>(counts.data());
+    }
 };
 
 
 }
 
 #endif // HLLCOUNTER_HH
-
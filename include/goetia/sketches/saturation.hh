@@ -0,0 +1,166 @@
+/**
+ * (c) Camille Scott, 2026
+ * File   : saturation.hh
+ * License: MIT
+ * Author : Camille Scott <camille.scott.w@gmail.com>
+ * Date   : 18.10.2026
+ *
+ * Streaming saturation detection for sketches. At each interval a sketch
+ * reports its distance from its state at the previous interval; the
+ * distances are smoothed over a sliding window, and the smoothed values
+ * checked against a cutoff over a second window. This mirrors
+ * goetia.saturation.SlidingCutoff, but runs without copying sketches out
+ * to Python.
+ */
+
+#ifndef GOETIA_SATURATION_HH
+#define GOETIA_SATURATION_HH
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "goetia/goetia.hh"
+
+
+namespace goetia {
+
+
+/**
+ * @Synopsis  Vector kernels for sketch distances.
+ */
+struct SketchDistance {
+
+    /**
+     * @Returns   The cosine similarity of a and b; NaN if either is zero.
+     */
+    static double cosine(const uint64_t * a,
+                         const uint64_t * b,
+                         size_t           n);
+};
+
+
+/**
+ * @Synopsis  Cosine distance between consecutive states of a count
+ *            vector, updated from only the entries which changed. Keeps a
+ *            snapshot of the previous state and its squared norm, so each
+ *            update costs O(changed) rather than O(size).
+ */
+class IncrementalCosine {
+
+    std::vector<uint64_t> snapshot;
+    // squared norm of snapshot, kept exact so updates don't drift
+    unsigned __int128     norm2;
+
+public:
+
+    explicit IncrementalCosine(size_t size)
+        : snapshot(size, 0),
+          norm2(0)
+    {
+    }
+
+    /**
+     * @Synopsis  Set entries indices[i] to counts[i], and return the
+     *            cosine distance from the previous state to the new one.
+     *            NaN while the previous state is all zeros.
+     */
+    double update(const uint32_t * indices,
+                  const uint64_t * counts,
+                  size_t           n_changed);
+
+    /**
+     * @Synopsis  As update, but from the full current count vector.
+     */
+    double update(const uint64_t * counts);
+
+    const std::vector<uint64_t>& get_snapshot() const {
+        return snapshot;
+    }
+
+    void reset() {
+        std::fill(snapshot.begin(), snapshot.end(), 0);
+        norm2 = 0;
+    }
+};
+
+
+struct SaturationStatus {
+    uint64_t t;
+    // distance from the previous interval
+    double   distance;
+    // smoothed distance over the window; NaN until the window fills
+    double   stat;
+    bool     cutoff_reached;
+};
+
+
+/**
+ * @Synopsis  Sliding-window smoothing and cutoff over interval distances.
+ *            Smoothing functions are "mean", "median" and "stddev";
+ *            cutoff functions are "all" (every smoothed value in the window
+ *            exceeds the cutoff) and "median".
+ */
+class SaturationWindow {
+
+public:
+
+    enum smoothing_t {
+        SMOOTH_MEAN,
+        SMOOTH_MEDIAN,
+        SMOOTH_STDDEV
+    };
+
+    enum cutoff_t {
+        CUTOFF_ALL,
+        CUTOFF_MEDIAN
+    };
+
+protected:
+
+    std::deque<double> values;
+    std::deque<double> stats;
+    std::vector<double> scratch;
+
+public:
+
+    const size_t      window_size;
+    const double      cutoff;
+    const smoothing_t smoothing;
+    const cutoff_t    cutoff_function;
+
+    SaturationWindow(size_t             window_size,
+                     double             cutoff,
+                     const std::string& smoothing       = "mean",
+                     const std::string& cutoff_function = "all");
+
+    /**
+     * @Synopsis  Push the distance for interval t. NaN distances (as on
+     *            the first interval) are reported but not windowed.
+     */
+    SaturationStatus push(double   distance,
+                          uint64_t t);
+
+    void reset() {
+        values.clear();
+        stats.clear();
+    }
+
+    static smoothing_t parse_smoothing(const std::string& name);
+    static cutoff_t    parse_cutoff(const std::string& name);
+
+protected:
+
+    double _smooth();
+    bool   _check_cutoff();
+    double _median(const std::deque<double>& items);
+};
+
+}
+
+#endif
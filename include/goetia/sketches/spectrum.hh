@@ -0,0 +1,160 @@
+/**
+ * (c) Camille Scott, 2026
+ * File   : spectrum.hh
+ * License: MIT
+ * Author : Camille Scott <camille.scott.w@gmail.com>
+ * Date   : 18.10.2026
+ *
+ * k-mer abundance spectra: the number of distinct k-mers seen once, twice,
+ * and so on. Exact counters can be enumerated, so their spectrum is just
+ * tallied from the stored counts; count-min sketches can't, so theirs is
+ * estimated from a uniform subsample of hash space, FracMinHash style,
+ * which is counted exactly as the stream goes by.
+ */
+
+#ifndef GOETIA_SPECTRUM_HH
+#define GOETIA_SPECTRUM_HH
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "goetia/goetia.hh"
+#include "goetia/storage/storage.hh"
+#include "goetia/storage/phmap/phmap.h"
+
+
+namespace goetia {
+
+    class AbundanceSpectrum {
+
+      protected:
+
+        // mixed hash -> exact abundance, for hashes at most _max_hash
+        phmap::flat_hash_map<uint64_t, uint32_t> _sample;
+        uint64_t                                 _max_hash;
+        uint64_t                                 _n_kmers;
+
+        /**
+         * @Synopsis  Halve the sampled hash space until the sample fits in
+         *            max_entries again.
+         */
+        void _downsample();
+
+      public:
+
+        const size_t   max_entries;
+        const uint32_t max_abundance;
+
+        /**
+         * @Param max_entries    Most distinct k-mers to hold in the sample;
+         *                       once exceeded, the sampling rate is halved.
+         * @Param max_abundance  Length of the histograms, less one; higher
+         *                       abundances are tallied in the last bin.
+         */
+        AbundanceSpectrum(size_t   max_entries   = 1 << 16,
+                          uint32_t max_abundance = 255);
+
+        static std::shared_ptr<AbundanceSpectrum> build(size_t   max_entries   = 1 << 16,
+                                                        uint32_t max_abundance = 255) {
+            return std::make_shared<AbundanceSpectrum>(max_entries, max_abundance);
+        }
+
+        /**
+         * @Synopsis  splitmix64's finalizer. Storage hashes are often far
+         *            from uniform -- canonical hashes favor the lower half,
+         *            for one -- so they're mixed before being thresholded.
+         *            It's a bijection, so the mixed hash still identifies
+         *            the k-mer.
+         */
+        static uint64_t mix(uint64_t h) {
+            h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+            return h ^ (h >> 31);
+        }
+
+        void insert_hash(uint64_t h) {
+            ++_n_kmers;
+            const uint64_t m = mix(h);
+            if (m <= _max_hash) {
+                ++_sample[m];
+                if (_sample.size() > max_entries) {
+                    _downsample();
+                }
+            }
+        }
+
+        void insert_hashes(const uint64_t * hashes,
+                           size_t           n) {
+            for (size_t i = 0; i < n; ++i) {
+                insert_hash(hashes[i]);
+            }
+        }
+
+        /**
+         * @Synopsis  Fold in another spectrum's sample, as when each of
+         *            several threads sampled part of a stream. Both are cut
+         *            down to the smaller of their sampling rates.
+         */
+        void merge(const AbundanceSpectrum& other);
+
+        void clear();
+
+        /**
+         * @Returns   Fraction of hash space being sampled.
+         */
+        double sample_fraction() const {
+            return (static_cast<double>(_max_hash) + 1.0) /
+                   (static_cast<double>(std::numeric_limits<uint64_t>::max()) + 1.0);
+        }
+
+        uint64_t max_hash() const {
+            return _max_hash;
+        }
+
+        /**
+         * @Returns   Number of distinct k-mers currently in the sample.
+         */
+        size_t n_sampled() const {
+            return _sample.size();
+        }
+
+        /**
+         * @Returns   Number of k-mers inserted, sampled or not.
+         */
+        uint64_t n_kmers() const {
+            return _n_kmers;
+        }
+
+        /**
+         * @Synopsis  The exact spectrum of the sampled k-mers. Element i is
+         *            the number with abundance i; element 0 is always 0.
+         */
+        std::vector<uint64_t> sampled_histogram() const;
+
+        /**
+         * @Synopsis  The estimated spectrum of the whole stream: the sampled
+         *            histogram scaled up by the inverse sampling rate.
+         */
+        std::vector<double> histogram() const;
+
+        /**
+         * @Synopsis  The exact spectrum of an enumerable storage, tallied
+         *            over n_shards shards of its contents on as many
+         *            threads. Counts are as the storage reports them, so a
+         *            saturating counter piles its tail into its maximum.
+         *
+         * @Param n_threads  Number of threads; 0 for all available.
+         *
+         * @Returns   Element i is the number of stored k-mers with count i,
+         *            with counts above max_abundance in the last element.
+         */
+        static std::vector<uint64_t> exact(const Storage<uint64_t>& storage,
+                                           uint32_t                 max_abundance = 255,
+                                           unsigned int             n_threads     = 0);
+    };
+
+}
+
+#endif
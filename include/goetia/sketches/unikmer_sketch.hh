@@ -18,6 +18,7 @@
 #include <vector>
 
 #include "goetia/goetia.hh"
+#include "goetia/parallel.hh"
 #include "goetia/processors.hh"
 
 #include "goetia/hashing/kmeriterator.hh"
@@ -25,7 +26,8 @@
 #include "goetia/hashing/ukhs.hh"
 #include "goetia/hashing/unikmershifter.hh"
 #include "goetia/hashing/canonical.hh"
-//#include "goetia/sketches/hllcounter.hh"
+#include "goetia/sketches/hllcounter.hh"
+#include "goetia/sketches/saturation.hh"
 #include "goetia/storage/storage_types.hh"
 
 #include "goetia/pdbg.hh"
@@ -58,11 +60,17 @@ struct UnikmerSketch {
 
         std::shared_ptr<ukhs_type> ukhs_map;
         std::shared_ptr<pdbg_type> sketch;
+        typename pdbg_type::batch_type batch;
+
+        // partitions inserted into since the last clear_changed_partitions
+        std::vector<uint8_t>       partition_changed;
+        std::vector<uint32_t>      changed_partitions;
 
     public:
 
         const uint16_t W;
         const uint16_t K;
+        const typename storage_traits::params_type storage_params;
 
         explicit Sketch(uint16_t W,
                            uint16_t K,
@@ -75,9 +83,11 @@ struct UnikmerSketch {
                            uint16_t K,
                            std::shared_ptr<ukhs_type> ukhs_map,
                            const typename storage_traits::params_type& storage_params)
-            : W         (W),
-              K         (K),
-              ukhs_map  (ukhs_map)
+            : ukhs_map          (ukhs_map),
+              partition_changed (ukhs_map->n_hashes(), 0),
+              W                 (W),
+              K                 (K),
+              storage_params    (storage_params)
         {
             sketch = std::make_shared<pdbg_type>(W,
                                                     K,
@@ -99,14 +109,58 @@ struct UnikmerSketch {
         }
 
         inline void insert(const std::string& kmer) {
-            sketch->insert(kmer);
+            auto h = sketch->hash(kmer);
+            sketch->insert(h);
+            mark_changed(h.minimizer.partition);
         }
 
         inline size_t insert_sequence(const std::string& sequence) {
-            sketch->insert_sequence(sequence);
+            sketch->hash_sequence(sequence, batch);
+            sketch->insert_batch(batch);
+            for (const auto partition : batch.partitions) {
+                mark_changed(partition);
+            }
             return sequence.length() - K + 1;
         }
 
+        /**
+         * @Synopsis  Record that a partition's count may have changed, for
+         *            callers inserting through get_pdbg.
+         */
+        inline void mark_changed(uint64_t partition) {
+            if (!partition_changed[partition]) {
+                partition_changed[partition] = 1;
+                changed_partitions.push_back(static_cast<uint32_t>(partition));
+            }
+        }
+
+        /**
+         * @Returns   The partitions inserted into since the last call to
+         *            clear_changed_partitions, in first-touched order.
+         */
+        const std::vector<uint32_t>& get_changed_partitions() const {
+            return changed_partitions;
+        }
+
+        void clear_changed_partitions() {
+            for (const auto partition : changed_partitions) {
+                partition_changed[partition] = 0;
+            }
+            changed_partitions.clear();
+        }
+
+        uint64_t get_partition_count(uint64_t partition) {
+            return sketch->get_partition_count(partition);
+        }
+
+        std::shared_ptr<ukhs_type> get_ukhs() const {
+            return ukhs_map;
+        }
+
+        std::shared_ptr<pdbg_type> get_pdbg() const {
+            return sketch;
+        }
+
         size_t get_size() const {
             return sketch->n_partitions();
         }
@@ -115,16 +169,25 @@ struct UnikmerSketch {
             return sketch->get_partition_counts();
         }
 
+        /**
+         * @Returns   The sketch's persistent partition counts: a read-only
+         *            view, updated in place as sequences are inserted.
+         */
         void * get_sketch_as_buffer() {
             return sketch->get_partition_counts_as_buffer();
         }
 
+        /**
+         * @Returns   Counter bumped on every change to the partition counts;
+         *            a reader copying get_sketch_as_buffer can compare it
+         *            before and after to detect a concurrent insert.
+         */
+        uint64_t get_sketch_version() const {
+            return sketch->get_partition_counts_view().version();
+        }
+
         uint64_t get_n_kmers() const {
-            size_t n_kmers = 0;
-            for (const auto& c : sketch->get_partition_counts()) {
-                n_kmers += c;
-            }
-            return n_kmers;
+            return sketch->get_partition_counts_view().sum();
         }
 
         /*
@@ -140,10 +203,244 @@ struct UnikmerSketch {
     };
 
     using Processor = InserterProcessor<Sketch>; 
+
+    /**
+     * @Synopsis  Saturation tracking for a draff sketch: at each update,
+     *            the cosine distance between the partition counts now and
+     *            at the previous update, computed from only the partitions
+     *            changed in between, fed through a SaturationWindow. Must
+     *            not run concurrently with inserts into the sketch.
+     */
+    class Saturation {
+
+    protected:
+
+        std::shared_ptr<Sketch> sketch;
+        IncrementalCosine       distance;
+        SaturationWindow        window;
+        std::vector<uint64_t>   counts;
+
+    public:
+
+        Saturation(std::shared_ptr<Sketch> sketch,
+                   size_t                  window_size,
+                   double                  cutoff,
+                   const std::string&      smoothing       = "mean",
+                   const std::string&      cutoff_function = "all")
+            : sketch   (sketch),
+              distance (sketch->get_size()),
+              window   (window_size, cutoff, smoothing, cutoff_function)
+        {
+        }
+
+        static std::shared_ptr<Saturation> build(std::shared_ptr<Sketch> sketch,
+                                                 size_t                  window_size,
+                                                 double                  cutoff,
+                                                 const std::string&      smoothing       = "mean",
+                                                 const std::string&      cutoff_function = "all") {
+            return std::make_shared<Saturation>(sketch, window_size, cutoff, smoothing, cutoff_function);
+        }
+
+        SaturationStatus update(uint64_t t) {
+            const auto& changed = sketch->get_changed_partitions();
+            counts.resize(changed.size());
+            for (size_t i = 0; i < changed.size(); ++i) {
+                counts[i] = sketch->get_partition_count(changed[i]);
+            }
+            double d = distance.update(changed.data(), counts.data(), changed.size());
+            sketch->clear_changed_partitions();
+            return window.push(d, t);
+        }
+    };
  
 
 };
 
+
+/**
+ * @Synopsis  Multi-threaded construction of a draff sketch. Reads are
+ *            parsed into batches; each batch is split over the workers,
+ *            which hash and insert their reads into thread-local partition
+ *            stores, and the touched partitions are then merged into the
+ *            sketch: set union for the exact backends, register max for
+ *            HLL. Both are order-independent, so the sketch is the same
+ *            whatever the thread count. Batches never cross an interval
+ *            boundary, which falls on the same read as in
+ *            FileProcessor::advance, so saturation curves stay comparable
+ *            with the single-threaded Processor.
+ *
+ *            StorageType must have merge(const StorageType&); instantiated
+ *            for PHMapStorage, SparseppSetStorage, BTreeStorage and
+ *            HLLStorage.
+ */
+template <class StorageType, class HashType>
+class UnikmerSketchBuilder : public FileProcessor<UnikmerSketchBuilder<StorageType, HashType>,
+                                                  FastxParser<>> {
+
+public:
+
+    typedef UnikmerSketch<StorageType, HashType>  sketch_type;
+    typedef typename sketch_type::Sketch          Sketch;
+    typedef typename sketch_type::pdbg_type       pdbg_type;
+    typedef typename pdbg_type::batch_type        batch_type;
+    typedef FastxParser<>                         parser_type;
+
+protected:
+
+    typedef FileProcessor<UnikmerSketchBuilder<StorageType, HashType>,
+                          parser_type> Base;
+
+    struct Worker {
+        std::shared_ptr<pdbg_type> local;
+        batch_type                 batch;
+        std::vector<uint8_t>       touched;
+    };
+
+    std::vector<Worker>      workers;
+    std::vector<std::string> sequences;
+    std::vector<uint32_t>    touched_partitions;
+
+    /**
+     * @Synopsis  The interval time of a sequence, as Processor counts it:
+     *            Sketch::insert_sequence's return value, or 0 for sequences
+     *            too short to hash.
+     */
+    uint64_t _time_of(const std::string& sequence) const {
+        return sequence.length() < sketch->W ? 0 : sequence.length() - sketch->K + 1;
+    }
+
+    void _push(const Record& record) {
+        sequences.push_back(record.sequence);
+    }
+
+    void _push(const RecordPair& pair) {
+        if (pair.first) {
+            sequences.push_back(pair.first.value().sequence);
+        }
+        if (pair.second) {
+            sequences.push_back(pair.second.value().sequence);
+        }
+    }
+
+    uint64_t _time_of(const Record& record) const {
+        return _time_of(record.sequence);
+    }
+
+    uint64_t _time_of(const RecordPair& pair) const {
+        return (pair.first ? _time_of(pair.first.value().sequence) : 0) +
+               (pair.second ? _time_of(pair.second.value().sequence) : 0);
+    }
+
+    uint64_t _n_records(const Record&) const {
+        return 1;
+    }
+
+    uint64_t _n_records(const RecordPair& pair) const {
+        return (bool)pair.first + (bool)pair.second;
+    }
+
+    void _insert_batch();
+
+    void _merge();
+
+    template<typename ReaderType>
+    std::tuple<uint64_t, uint64_t, bool> _advance(ReaderType& reader) {
+        sequences.clear();
+        while (!reader.is_complete()) {
+            auto record = this->handle_next(reader);
+            if (!record) {
+                continue;
+            }
+
+            _push(record.value());
+            this->_n_sequences += _n_records(record.value());
+            bool interval_done = this->timer.poll(_time_of(record.value()));
+
+            if (interval_done || sequences.size() >= batch_size) {
+                _insert_batch();
+                if (interval_done) {
+                    // after the merge, so the bus's subscribers see the
+                    // whole interval in the sketch
+                    return {this->_n_sequences, this->timer.total(), this->publish_interval()};
+                }
+            }
+        }
+        _insert_batch();
+
+        return {this->_n_sequences, this->timer.total(), false};
+    }
+
+public:
+
+    using Base::process;
+    typedef typename Base::alphabet alphabet;
+
+    std::shared_ptr<Sketch> sketch;
+    const unsigned int      n_threads;
+    const size_t            batch_size;
+
+    /**
+     * @Param sketch     The sketch to build into.
+     * @Param n_threads  Number of worker threads; 0 uses the hardware
+     *                   concurrency.
+     * @Param interval   Interval size, in k-mers.
+     * @Param verbose    Report skipped sequences.
+     * @Param batch_size Maximum reads per batch; at the end of each batch,
+     *                   the workers' stores are merged into the sketch.
+     */
+    UnikmerSketchBuilder(std::shared_ptr<Sketch> sketch,
+                         unsigned int            n_threads  = 0,
+                         uint64_t                interval   = IntervalCounter::DEFAULT_INTERVAL,
+                         bool                    verbose    = false,
+                         size_t                  batch_size = 1 << 14);
+
+    static std::shared_ptr<UnikmerSketchBuilder> build(std::shared_ptr<Sketch> sketch,
+                                                       unsigned int            n_threads  = 0,
+                                                       uint64_t                interval   = IntervalCounter::DEFAULT_INTERVAL,
+                                                       bool                    verbose    = false,
+                                                       size_t                  batch_size = 1 << 14) {
+        return std::make_shared<UnikmerSketchBuilder>(sketch, n_threads, interval, verbose, batch_size);
+    }
+
+    std::tuple<uint64_t, uint64_t, bool> advance(std::shared_ptr<parser_type>& parser) {
+        return _advance(*parser);
+    }
+
+    std::tuple<uint64_t, uint64_t, bool> advance(std::shared_ptr<SplitPairedReader<parser_type>>& reader) {
+        return _advance(*reader);
+    }
+
+    /**
+     * @Synopsis  As FileProcessor::process_sequences, in batches of
+     *            batch_size.
+     */
+    std::tuple<uint64_t, uint64_t> process_sequences(const std::vector<std::string>& batch,
+                                                     bool                            strict = false,
+                                                     uint32_t                        min_length = 0) {
+        sequences.clear();
+        for (const auto& sequence : batch) {
+            sequences.push_back(sequence);
+            if (!this->validate_sequence(sequences.back(), strict, min_length)) {
+                sequences.pop_back();
+                continue;
+            }
+            ++this->_n_sequences;
+            bool interval_done = this->timer.poll(_time_of(sequences.back()));
+
+            if (interval_done || sequences.size() >= batch_size) {
+                _insert_batch();
+                if (interval_done && !this->publish_interval()) {
+                    return {this->_n_sequences, this->timer.total()};
+                }
+            }
+        }
+        _insert_batch();
+
+        return {this->_n_sequences, this->timer.total()};
+    }
+};
+
+
 extern template class goetia::UnikmerSketch<goetia::BitStorage, goetia::Hash<uint64_t>>;
 extern template class goetia::UnikmerSketch<goetia::BitStorage, goetia::Canonical<uint64_t>>;
 
@@ -165,8 +462,20 @@ extern template class goetia::UnikmerSketch<goetia::NibbleStorage, goetia::Canon
 extern template class goetia::UnikmerSketch<goetia::QFStorage, goetia::Hash<uint64_t>>;
 extern template class goetia::UnikmerSketch<goetia::QFStorage, goetia::Canonical<uint64_t>>;
 
-//extern template class goetia::UnikmerSketch<goetia::HLLStorage, goetia::Hash<uint64_t>>;
-//extern template class goetia::UnikmerSketch<goetia::HLLStorage, goetia::Canonical<uint64_t>>;
+extern template class goetia::UnikmerSketch<goetia::HLLStorage, goetia::Hash<uint64_t>>;
+extern template class goetia::UnikmerSketch<goetia::HLLStorage, goetia::Canonical<uint64_t>>;
+
+extern template class goetia::UnikmerSketchBuilder<goetia::SparseppSetStorage, goetia::Hash<uint64_t>>;
+extern template class goetia::UnikmerSketchBuilder<goetia::SparseppSetStorage, goetia::Canonical<uint64_t>>;
+
+extern template class goetia::UnikmerSketchBuilder<goetia::PHMapStorage, goetia::Hash<uint64_t>>;
+extern template class goetia::UnikmerSketchBuilder<goetia::PHMapStorage, goetia::Canonical<uint64_t>>;
+
+extern template class goetia::UnikmerSketchBuilder<goetia::BTreeStorage, goetia::Hash<uint64_t>>;
+extern template class goetia::UnikmerSketchBuilder<goetia::BTreeStorage, goetia::Canonical<uint64_t>>;
+
+extern template class goetia::UnikmerSketchBuilder<goetia::HLLStorage, goetia::Hash<uint64_t>>;
+extern template class goetia::UnikmerSketchBuilder<goetia::HLLStorage, goetia::Canonical<uint64_t>>;
 
 }
 
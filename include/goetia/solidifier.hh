@@ -11,6 +11,7 @@
 
 #include "goetia/processors.hh"
 #include "goetia/dbg.hh"
+#include "goetia/sketches/spectrum.hh"
 #include "goetia/storage/storage.hh"
 
 
@@ -32,7 +33,11 @@ struct StreamingSolidFilter<GraphType<StorageType, ShifterType>> {
 
     class Filter {
       private:
-        std::shared_ptr<graph_type> dbg;
+        std::shared_ptr<graph_type>        dbg;
+        std::shared_ptr<AbundanceSpectrum> spectrum;
+
+        std::vector<hash_type>             _hashes;
+        std::vector<count_t>               _counts;
 
       public:
         const uint16_t    K;
@@ -55,12 +60,34 @@ struct StreamingSolidFilter<GraphType<StorageType, ShifterType>> {
             return std::make_shared<Filter>(dbg, min_prop_solid, solid_threshold);
         }
 
+        /**
+         * @Synopsis  Feed the hash of every k-mer filtered from here on to
+         *            spectrum, so that the stream's abundance spectrum can
+         *            be followed as it goes. Pass nullptr to stop.
+         */
+        void set_spectrum(std::shared_ptr<AbundanceSpectrum> spectrum) {
+            this->spectrum = spectrum;
+        }
+
+        std::shared_ptr<AbundanceSpectrum> get_spectrum() const {
+            return spectrum;
+        }
+
         std::tuple<bool, uint64_t> filter_sequence(const std::string& sequence) {
-            auto counts = dbg->insert_and_query_sequence(sequence);
+            _counts.clear();
+            if (spectrum) {
+                _hashes.clear();
+                dbg->insert_sequence(sequence, _hashes, _counts);
+                for (const auto& h : _hashes) {
+                    spectrum->insert_hash(h.value());
+                }
+            } else {
+                _counts = dbg->insert_and_query_sequence(sequence);
+            }
             uint32_t n_not_solid = 0;
             uint32_t n_kmers = sequence.length() - K + 1;
 
-            for (const auto& count : counts) {
+            for (const auto& count : _counts) {
                 if (count < solid_threshold) {
                     ++n_not_solid;
                 }
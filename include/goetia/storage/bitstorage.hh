@@ -223,6 +223,19 @@ public:
     // get the count for the given k-mer hash.
     const count_t query(value_type khash) const;
 
+    void query_many(const value_type * hashes,
+                    count_t *          counts,
+                    size_t             n) const {
+        // most misses are decided by the first table, so fetch its
+        // bytes for every hash before testing any of them
+        for (size_t i = 0; i < n; ++i) {
+            __builtin_prefetch(_counts[0] + (hashes[i] % _tablesizes[0]) / 8);
+        }
+        for (size_t i = 0; i < n; ++i) {
+            counts[i] = query(hashes[i]);
+        }
+    }
+
     // Writing to the tables outside of defined methods has undefined behavior!
     // As such, this should only be used to return read-only interfaces
     byte_t ** get_raw_tables()
@@ -22,17 +22,99 @@
 #include "goetia/storage/storage_types.hh"
 #include "sparsepp/spp.h"
 
+#include <atomic>
+#include <memory>
 #include <vector>
 
 namespace goetia {
 
 
+/**
+ * @Synopsis  Per-partition distinct k-mer counts, kept up to date as
+ *            partitions are inserted into, so that readers can take them
+ *            without querying every partition. The counts are a flat array
+ *            of uint64_t, readable in place (eg. as a NumPy view) through
+ *            data(); version() increments after every change, so a reader
+ *            can detect a torn snapshot by checking it before and after
+ *            copying.
+ */
+class PartitionCounts {
+
+    static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t),
+                  "atomic<uint64_t> must be layout-compatible with uint64_t");
+
+    std::unique_ptr<std::atomic<uint64_t>[]> counts;
+    std::atomic<uint64_t>                    _version;
+
+public:
+
+    const uint64_t size;
+
+    explicit PartitionCounts(uint64_t size)
+        : counts(new std::atomic<uint64_t>[size]),
+          _version(0),
+          size(size)
+    {
+        for (uint64_t i = 0; i < size; ++i) {
+            counts[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @Synopsis  Set the count of a partition.
+     *
+     * @Returns   true if it changed.
+     */
+    inline bool set(uint64_t partition,
+                    uint64_t count) {
+        if (counts[partition].load(std::memory_order_relaxed) != count) {
+            counts[partition].store(count, std::memory_order_relaxed);
+            _version.fetch_add(1, std::memory_order_release);
+            return true;
+        }
+        return false;
+    }
+
+    inline uint64_t get(uint64_t partition) const {
+        return counts[partition].load(std::memory_order_relaxed);
+    }
+
+    uint64_t sum() const {
+        uint64_t total = 0;
+        for (uint64_t i = 0; i < size; ++i) {
+            total += get(i);
+        }
+        return total;
+    }
+
+    void clear() {
+        for (uint64_t i = 0; i < size; ++i) {
+            counts[i].store(0, std::memory_order_relaxed);
+        }
+        _version.fetch_add(1, std::memory_order_release);
+    }
+
+    uint64_t version() const {
+        return _version.load(std::memory_order_acquire);
+    }
+
+    const uint64_t * data() const {
+        return reinterpret_cast<const uint64_t *>(counts.get());
+    }
+
+    std::vector<size_t> to_vector() const {
+        return std::vector<size_t>(data(), data() + size);
+    }
+};
+
+
 template <class BaseStorageType>
 class PartitionedStorage : public Storage<uint64_t> {
 
 protected:
     std::vector<std::shared_ptr<BaseStorageType>> partitions;
     const uint64_t                                n_partitions;
+    PartitionCounts                               counts;
 
 public:
 
@@ -47,7 +129,8 @@ public:
     
     PartitionedStorage (const uint64_t n_partitions,
                         const typename StorageTraits<BaseStorageType>::params_type& params)
-        : n_partitions(n_partitions)
+        : n_partitions(n_partitions),
+          counts(n_partitions)
     {
         for (size_t i = 0; i < n_partitions; ++i) {
             partitions.push_back(
@@ -59,7 +142,8 @@ public:
     template <typename... Args>
     PartitionedStorage(const uint64_t  n_partitions,
                        Args&&...       args)
-        : n_partitions(n_partitions)
+        : n_partitions(n_partitions),
+          counts(n_partitions)
     {
         for (size_t i = 0; i < n_partitions; ++i) {
             partitions.push_back(
@@ -70,7 +154,8 @@ public:
 
     PartitionedStorage(const uint64_t n_partitions,
                        base_storage_type* S)
-        : n_partitions(n_partitions)
+        : n_partitions(n_partitions),
+          counts(n_partitions)
     {
         for (size_t i = 0; i < n_partitions; ++i) {
             partitions.push_back(std::move(S->clone()));
@@ -87,6 +172,7 @@ public:
         for (size_t i = 0; i < n_partitions; ++i) {
             partitions[i]->reset();
         }
+        counts.clear();
     }
 
     //std::vector<uint64_t> get_tablesizes() const {
@@ -94,11 +180,7 @@ public:
     //}
 
     const uint64_t n_unique_kmers() const {
-        uint64_t sum = 0;
-        for (auto& partition : partitions) {
-            sum += partition->n_unique_kmers();
-        }
-        return sum;
+        return counts.sum();
     }
 
     //const uint64_t n_tables() const {
@@ -133,12 +215,25 @@ public:
     }
 
     inline const bool insert(value_type h, uint64_t partition) {
-        return query_partition(partition)->insert(h);
+        auto partition_store = query_partition(partition);
+        bool is_new = partition_store->insert(h);
+        counts.set(partition, partition_store->n_unique_kmers());
+        return is_new;
     }
 
     inline const count_t insert_and_query(value_type h, uint64_t partition) {
         auto partition_store = query_partition(partition);
-        return partition_store->insert_and_query(h);
+        count_t count = partition_store->insert_and_query(h);
+        counts.set(partition, partition_store->n_unique_kmers());
+        return count;
+    }
+
+    /**
+     * @Synopsis  Refresh the tracked count of a partition after inserting
+     *            into it directly through query_partition.
+     */
+    inline void sync_partition_count(uint64_t partition) {
+        counts.set(partition, query_partition(partition)->n_unique_kmers());
     }
 
     inline const count_t query(value_type h, uint64_t partition) {
@@ -146,6 +241,31 @@ public:
     }
 
 
+    /**
+     * @Synopsis  Shards are runs of whole partitions, or with more shards
+     *            than partitions, each partition is itself split between
+     *            the shards which map to it.
+     */
+    void for_each_range_batched(size_t                     n_shards,
+                                size_t                     shard_id,
+                                const batch_callback_type& f,
+                                size_t                     batch_size = 4096) const {
+        check_shard(n_shards, shard_id);
+
+        if (n_shards <= n_partitions) {
+            auto [begin, end] = shard_bounds(n_partitions, n_shards, shard_id);
+            for (size_t partition = begin; partition < end; ++partition) {
+                partitions[partition]->for_each_range_batched(1, 0, f, batch_size);
+            }
+        } else {
+            // the shards mapping to partition p are [first, last)
+            const size_t partition = shard_id * n_partitions / n_shards;
+            const size_t first     = (partition * n_shards + n_partitions - 1) / n_partitions;
+            const size_t last      = ((partition + 1) * n_shards + n_partitions - 1) / n_partitions;
+            partitions[partition]->for_each_range_batched(last - first, shard_id - first, f, batch_size);
+        }
+    }
+
     BaseStorageType * query_partition(uint64_t partition) {
         if (partition < n_partitions) {
             return partitions[partition].get();
@@ -172,19 +292,19 @@ public:
     }
 
     std::vector<size_t> get_partition_counts() {
-        std::vector<size_t> counts;
-        for (auto& partition : partitions) {
-            counts.push_back(partition->n_unique_kmers());
-        }
+        return counts.to_vector();
+    }
+
+    /**
+     * @Returns   The live per-partition counts, owned by the storage; see
+     *            PartitionCounts.
+     */
+    const PartitionCounts& get_partition_counts_view() const {
         return counts;
     }
 
     void * get_partition_counts_as_buffer() {
-        size_t * counts = (size_t *) malloc(sizeof(size_t) * n_partitions);
-        for (size_t pidx = 0; pidx < n_partitions; ++pidx) {
-            counts[pidx] = partitions[pidx]->n_unique_kmers();
-        }
-        return counts;
+        return const_cast<uint64_t *>(counts.data());
     }
 };
 
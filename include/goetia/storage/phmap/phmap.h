@@ -2761,6 +2761,16 @@ public:
         inner.set_.clear();
     }
 
+    // extension - calls fCallback with the specified submap, under its
+    // shared lock
+    // ----------------------------------------
+    template <class F>
+    void with_submap(std::size_t submap_index, F&& fCallback) const {
+        const Inner& inner = sets_[submap_index];
+        typename Lockable::SharedLock m(const_cast<Inner&>(inner));
+        fCallback(inner.set_);
+    }
+
     // This overload kicks in when the argument is an rvalue of insertable and
     // decomposable type other than init_type.
     //
@@ -83,6 +83,10 @@ public:
         return n_buckets();
     }
 
+    static size_t n_submaps() {
+        return store_type::subcnt();
+    }
+
     void save(std::string, uint16_t );
 
     void load(std::string, uint16_t &);
@@ -96,8 +100,35 @@ public:
 
     const count_t insert_and_query(value_type h);
 
+    /**
+     * @Synopsis  Union another store's k-mers into this one.
+     */
+    void merge(const PHMapStorage& other) {
+        _store->insert(other._store->begin(), other._store->end());
+    }
+
     const count_t query(value_type h) const;
 
+    void query_many(const value_type * hashes,
+                    count_t *          counts,
+                    size_t             n) const {
+        for (size_t i = 0; i < n; ++i) {
+            _store->prefetch(hashes[i]);
+        }
+        for (size_t i = 0; i < n; ++i) {
+            counts[i] = _store->count(hashes[i]);
+        }
+    }
+
+
+    /**
+     * @Synopsis  Shards are runs of the store's submaps, so there's no
+     *            point in more shards than PHMapStorage::n_submaps().
+     */
+    void for_each_range_batched(size_t                     n_shards,
+                                size_t                     shard_id,
+                                const batch_callback_type& f,
+                                size_t                     batch_size = 4096) const;
 
     byte_t ** get_raw_tables() {
         return nullptr;
@@ -132,6 +132,16 @@ public:
   void save(std::string outfilename, uint16_t ksize);
   void load(std::string infilename, uint16_t &ksize);
 
+  /**
+   * @Synopsis  Shards are equal ranges of the filter's slots. The filter
+   *            only keeps the low key_bits of each hash, so those
+   *            truncated hashes are what is enumerated.
+   */
+  void for_each_range_batched(size_t                     n_shards,
+                              size_t                     shard_id,
+                              const batch_callback_type& f,
+                              size_t                     batch_size = 4096) const;
+
   byte_t **get_raw_tables() { return nullptr; }
   void reset() {}; //nop
 
@@ -98,9 +98,26 @@ public:
 
     const count_t insert_and_query(value_type h);
 
+    /**
+     * @Synopsis  Union another store's k-mers into this one.
+     */
+    void merge(const SparseppSetStorage& other) {
+        _store->insert(other._store->begin(), other._store->end());
+    }
+
     const count_t query(value_type h) const;
 
 
+    /**
+     * @Synopsis  Shards are contiguous runs of the table's iteration
+     *            order; sparsepp can't seek, so each shard steps over
+     *            those before it.
+     */
+    void for_each_range_batched(size_t                     n_shards,
+                                size_t                     shard_id,
+                                const batch_callback_type& f,
+                                size_t                     batch_size = 4096) const;
+
     byte_t ** get_raw_tables() {
         return nullptr;
     }
@@ -46,9 +46,11 @@
 #ifndef GOETIA_STORAGE_HH
 #define GOETIA_STORAGE_HH
 
+#include <algorithm>
 #include <cmath>
 #include <cassert>
 #include <array>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <tuple>
@@ -123,6 +125,57 @@ public:
     virtual const count_t insert_and_query(value_type khash) = 0;
     virtual const count_t query(value_type khash) const = 0;
 
+    /**
+     * @Synopsis  Query n hashes at once, writing their counts to counts.
+     *            Backends which can issue the lookups' memory fetches
+     *            together, rather than taking one miss at a time,
+     *            override this.
+     */
+    virtual void query_many(const value_type * hashes,
+                            count_t *          counts,
+                            size_t             n) const {
+        for (size_t i = 0; i < n; ++i) {
+            counts[i] = query(hashes[i]);
+        }
+    }
+
+    typedef std::function<void(value_type, count_t)>                         range_callback_type;
+    typedef std::function<void(const value_type *, const count_t *, size_t)> batch_callback_type;
+
+    /**
+     * @Synopsis  Enumerate one of n_shards disjoint shards of the stored
+     *            values, passing them to f along with their counts in
+     *            batches of up to batch_size. Together the shards cover
+     *            every stored value exactly once, and different shards
+     *            can be enumerated on different threads at once, so long
+     *            as nothing is inserted meanwhile. Sketches which only
+     *            keep bits or counters for the values can't be enumerated
+     *            and throw.
+     */
+    virtual void for_each_range_batched(size_t                     n_shards,
+                                        size_t                     shard_id,
+                                        const batch_callback_type& f,
+                                        size_t                     batch_size = 4096) const {
+        throw GoetiaException("Storage does not support enumeration.");
+    }
+
+    /**
+     * @Synopsis  Enumerate a shard one value at a time; see
+     *            for_each_range_batched.
+     */
+    void for_each_range(size_t                     n_shards,
+                        size_t                     shard_id,
+                        const range_callback_type& f) const {
+        for_each_range_batched(n_shards, shard_id,
+                               [&f](const value_type * values,
+                                    const count_t *    counts,
+                                    size_t             n) {
+                                   for (size_t i = 0; i < n; ++i) {
+                                       f(values[i], counts[i]);
+                                   }
+                               });
+    }
+
     virtual byte_t ** get_raw_tables() = 0;
     virtual void reset() = 0;
 
@@ -140,6 +193,67 @@ public:
     }
 
     virtual void serialize(std::ofstream& out) {}
+
+protected:
+
+    static void check_shard(size_t n_shards,
+                            size_t shard_id) {
+        if (n_shards == 0 || shard_id >= n_shards) {
+            throw GoetiaException("Invalid shard " + std::to_string(shard_id) +
+                                  " of " + std::to_string(n_shards));
+        }
+    }
+
+    /**
+     * @Synopsis  [begin, end) of shard shard_id when n_items are split into
+     *            n_shards contiguous shards.
+     */
+    static std::pair<size_t, size_t> shard_bounds(size_t n_items,
+                                                  size_t n_shards,
+                                                  size_t shard_id) {
+        return {static_cast<size_t>(static_cast<__uint128_t>(n_items) * shard_id / n_shards),
+                static_cast<size_t>(static_cast<__uint128_t>(n_items) * (shard_id + 1) / n_shards)};
+    }
+
+    /**
+     * @Synopsis  Collects values and counts for for_each_range_batched,
+     *            handing them to the callback batch_size at a time.
+     */
+    class EnumerationBuffer {
+
+        const batch_callback_type& f;
+        const size_t               batch_size;
+        std::vector<value_type>    values;
+        std::vector<count_t>       counts;
+
+    public:
+
+        EnumerationBuffer(const batch_callback_type& f,
+                          size_t                     batch_size)
+            : f          (f),
+              batch_size (std::max<size_t>(batch_size, 1))
+        {
+            values.reserve(this->batch_size);
+            counts.reserve(this->batch_size);
+        }
+
+        inline void push(value_type value,
+                         count_t    count) {
+            values.push_back(value);
+            counts.push_back(count);
+            if (values.size() == batch_size) {
+                flush();
+            }
+        }
+
+        void flush() {
+            if (values.size()) {
+                f(values.data(), counts.data(), values.size());
+                values.clear();
+                counts.clear();
+            }
+        }
+    };
 };
 
 
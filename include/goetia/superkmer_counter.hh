@@ -0,0 +1,419 @@
+/**
+ * (c) Camille Scott, 2026
+ * File   : superkmer_counter.hh
+ * License: MIT
+ * Author : Camille Scott <camille.scott.w@gmail.com>
+ * Date   : 18.10.2026
+ *
+ * Out-of-core k-mer counting with minimizer-partitioned super-k-mers.
+ * Phase one (Spiller) cuts reads into super-k-mers -- maximal runs of
+ * consecutive k-mers whose minimizers fall in the same bucket -- and
+ * appends them 2-bit packed to one of N bucket files. A k-mer's bucket is
+ * a function of the k-mer alone, so every occurrence of a k-mer lands in
+ * the same bucket. Phase two counts each bucket independently, on any
+ * storage backend, into a sorted count table; tables are merged with
+ * KmerCountTable::merge.
+ */
+
+#ifndef GOETIA_SUPERKMER_COUNTER_HH
+#define GOETIA_SUPERKMER_COUNTER_HH
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "goetia/goetia.hh"
+#include "goetia/minimizers.hh"
+#include "goetia/parallel.hh"
+#include "goetia/processors.hh"
+#include "goetia/hashing/canonical.hh"
+#include "goetia/hashing/hashshifter.hh"
+#include "goetia/storage/storage.hh"
+
+
+namespace goetia {
+
+
+/**
+ * @Synopsis  Reading and writing of super-k-mer bucket records: a
+ *            little-endian uint32 length in bases, followed by the bases
+ *            2-bit packed (A=0, C=1, G=2, T=3), four to a byte, first base
+ *            in the high bits.
+ */
+struct SuperKmerIO {
+
+    /**
+     * @Synopsis  Append a super-k-mer record to buffer. sequence must be
+     *            ACGT only, in either case.
+     */
+    static void write(std::vector<uint8_t>& buffer,
+                      const char *          sequence,
+                      uint32_t              length);
+
+    /**
+     * @Synopsis  Read the next record from in into sequence.
+     *
+     * @Returns   false at the end of the stream.
+     */
+    static bool read(std::istream&         in,
+                     std::string&          sequence,
+                     std::vector<uint8_t>& scratch);
+};
+
+
+/**
+ * @Synopsis  A sorted table of (k-mer hash, count) pairs on disk. The
+ *            format is a header of the magic bytes, format version, K and
+ *            entry count, followed by little-endian (uint64 hash, uint32
+ *            count) records in increasing hash order.
+ */
+struct KmerCountTable {
+
+    struct Entry {
+        uint64_t hash;
+        uint32_t count;
+
+        bool operator<(const Entry& other) const {
+            return hash < other.hash;
+        }
+    };
+
+    static constexpr char     TABLE_MAGIC[8] = {'G', 'K', 'M', 'C', 'N', 'T', '\0', '\0'};
+    static constexpr uint16_t TABLE_VERSION  = 1;
+
+    class Writer {
+
+        std::ofstream out;
+        uint64_t      _n_entries;
+        uint64_t      _last_hash;
+
+    public:
+
+        const uint16_t K;
+
+        Writer(const std::string& filename,
+               uint16_t           K);
+
+        ~Writer() {
+            close();
+        }
+
+        /**
+         * @Synopsis  Append an entry; hashes must be written in strictly
+         *            increasing order.
+         */
+        void write(const Entry& entry);
+
+        /**
+         * @Synopsis  Patch the entry count into the header and close the file.
+         */
+        void close();
+
+        uint64_t n_entries() const {
+            return _n_entries;
+        }
+    };
+
+    class Reader {
+
+        std::ifstream in;
+        uint64_t      _n_entries;
+        uint64_t      _n_read;
+        uint16_t      _K;
+
+    public:
+
+        explicit Reader(const std::string& filename);
+
+        /**
+         * @Synopsis  Read the next entry.
+         *
+         * @Returns   false when the table is exhausted.
+         */
+        bool next(Entry& entry);
+
+        uint64_t n_entries() const {
+            return _n_entries;
+        }
+
+        uint16_t K() const {
+            return _K;
+        }
+    };
+
+    static void write(const std::string&        filename,
+                      uint16_t                  K,
+                      const std::vector<Entry>& entries);
+
+    static std::vector<Entry> read(const std::string& filename);
+
+    /**
+     * @Synopsis  Merge sorted count tables into a single sorted table,
+     *            summing the counts of hashes present in more than one input.
+     *            The inputs may be the buckets of one sample, or whole tables
+     *            from different samples.
+     *
+     * @Param filenames       Input tables; all must have the same K.
+     * @Param output_filename Merged table.
+     *
+     * @Returns   Number of distinct hashes in the merged table.
+     */
+    static uint64_t merge(const std::vector<std::string>& filenames,
+                          const std::string&              output_filename);
+};
+
+
+template <class ShifterType>
+struct SuperKmerCounter {
+
+    typedef ShifterType                      shifter_type;
+    typedef typename shifter_type::hash_type hash_type;
+    typedef typename hash_type::value_type   value_type;
+    typedef KmerCountTable::Entry            Entry;
+
+    /**
+     * @Synopsis  Phase one: partition reads into super-k-mer bucket files.
+     *            Minimizers are the smallest minimizer_K-mer hash within each
+     *            k-mer, under the same hash function (and so strandedness)
+     *            as the k-mers themselves. Bases other than ACGT split reads.
+     */
+    class Spiller {
+
+    protected:
+
+        struct Bucket {
+            std::ofstream        out;
+            std::vector<uint8_t> buffer;
+            uint64_t             n_superkmers = 0;
+            uint64_t             n_kmers      = 0;
+        };
+
+        std::vector<Bucket>      buckets;
+        WindowMinima<value_type> window;
+        std::vector<value_type>  mmer_hashes;
+        std::vector<value_type>  kmer_minimizers;
+        shifter_type             mmer_hasher;
+        std::string              segment;
+        uint64_t                 _n_superkmers;
+        uint64_t                 _n_kmers;
+        bool                     _closed;
+
+    public:
+
+        const uint16_t    K;
+        const uint16_t    minimizer_K;
+        const uint32_t    n_buckets;
+        const std::string prefix;
+        const size_t      buffer_size;
+
+        /**
+         * @Param K           k-mer size.
+         * @Param minimizer_K Minimizer size; must be at most K.
+         * @Param n_buckets   Number of bucket files.
+         * @Param prefix      Bucket files are written to
+         *                    {prefix}.{bucket}.skm.
+         * @Param buffer_size Per-bucket write buffer size in bytes.
+         */
+        Spiller(uint16_t           K,
+                uint16_t           minimizer_K,
+                uint32_t           n_buckets,
+                const std::string& prefix,
+                size_t             buffer_size = 1 << 16);
+
+        ~Spiller() {
+            try {
+                close();
+            } catch (...) {
+            }
+        }
+
+        static std::shared_ptr<Spiller> build(uint16_t           K,
+                                              uint16_t           minimizer_K,
+                                              uint32_t           n_buckets,
+                                              const std::string& prefix,
+                                              size_t             buffer_size = 1 << 16) {
+            return std::make_shared<Spiller>(K, minimizer_K, n_buckets, prefix, buffer_size);
+        }
+
+        /**
+         * @Synopsis  Cut a sequence into super-k-mers and buffer them for
+         *            their buckets.
+         *
+         * @Returns   Number of k-mers spilled.
+         */
+        uint64_t insert_sequence(const std::string& sequence);
+
+        /**
+         * @Synopsis  Write all buffered super-k-mers out to their files.
+         */
+        void flush();
+
+        /**
+         * @Synopsis  Flush and close the bucket files. They can then be
+         *            counted; further inserts throw.
+         */
+        void close();
+
+        std::string bucket_filename(uint32_t bucket) const {
+            return prefix + "." + std::to_string(bucket) + ".skm";
+        }
+
+        std::vector<std::string> bucket_filenames() const {
+            std::vector<std::string> filenames;
+            for (uint32_t bucket = 0; bucket < n_buckets; ++bucket) {
+                filenames.push_back(bucket_filename(bucket));
+            }
+            return filenames;
+        }
+
+        uint64_t n_superkmers() const {
+            return _n_superkmers;
+        }
+
+        uint64_t n_kmers() const {
+            return _n_kmers;
+        }
+
+        uint64_t bucket_n_kmers(uint32_t bucket) const {
+            return buckets.at(bucket).n_kmers;
+        }
+
+    protected:
+
+        void _spill_segment(const char * sequence,
+                            size_t       length);
+
+        void _write_superkmer(uint32_t     bucket,
+                              const char * sequence,
+                              size_t       length);
+
+        void _flush_bucket(Bucket& bucket);
+    };
+
+    using Processor = InserterProcessor<Spiller>;
+
+    /**
+     * @Synopsis  Phase two for a single bucket: count its k-mers with a
+     *            fresh StorageType and return them in hash order. With a
+     *            probabilistic backend, k-mers colliding with one already
+     *            counted are folded into its entry.
+     *
+     * @Param filename Bucket file written by a Spiller.
+     * @Param K        k-mer size.
+     * @Param params   Storage parameters; sized for one bucket.
+     *
+     * @Returns   Sorted (hash, count) entries.
+     */
+    template <class StorageType>
+    static std::vector<Entry> count_bucket(const std::string& filename,
+                                           uint16_t           K,
+                                           const typename StorageTraits<StorageType>::params_type& params
+                                               = StorageTraits<StorageType>::default_params) {
+
+        std::ifstream in(filename, std::ios::binary);
+        if (!in) {
+            throw GoetiaFileException("Could not open super-k-mer bucket " + filename);
+        }
+
+        auto storage = StorageType::build(params);
+        shifter_type hasher(K);
+        std::vector<value_type> seen;
+        std::string superkmer;
+        std::vector<uint8_t> scratch;
+
+        while (SuperKmerIO::read(in, superkmer, scratch)) {
+            if (superkmer.size() < K) {
+                continue;
+            }
+            value_type h = hasher.hash_base(superkmer.c_str()).value();
+            for (size_t i = 0; ; ++i) {
+                // keep the first sighting of each hash; presence-only
+                // backends report 1 for every sighting, so dedup below too
+                if (storage->insert_and_query(h) == 1) {
+                    seen.push_back(h);
+                }
+                if (i + K >= superkmer.size()) {
+                    break;
+                }
+                h = hasher.shift_right(superkmer[i], superkmer[i + K]).value();
+            }
+        }
+
+        std::sort(seen.begin(), seen.end());
+        seen.erase(std::unique(seen.begin(), seen.end()), seen.end());
+
+        std::vector<Entry> entries;
+        entries.reserve(seen.size());
+        for (const value_type h : seen) {
+            entries.push_back({static_cast<uint64_t>(h),
+                               static_cast<uint32_t>(storage->query(h))});
+        }
+        return entries;
+    }
+
+    /**
+     * @Synopsis  Phase two: count the buckets over n_threads worker threads,
+     *            writing a sorted count table for each next to its bucket,
+     *            then merge them into output_filename. Each worker holds
+     *            one bucket's storage at a time.
+     *
+     * @Param filenames       Bucket files, usually Spiller::bucket_filenames().
+     * @Param K               k-mer size.
+     * @Param output_filename Merged count table.
+     * @Param n_threads       Number of worker threads; 0 uses the hardware concurrency.
+     * @Param params          Storage parameters for each bucket.
+     * @Param keep_tables     Keep the per-bucket count tables rather than
+     *                        removing them after the merge.
+     *
+     * @Returns   Number of distinct k-mers counted.
+     */
+    template <class StorageType>
+    static uint64_t count_buckets(const std::vector<std::string>& filenames,
+                                  uint16_t                        K,
+                                  const std::string&              output_filename,
+                                  unsigned int                    n_threads = 1,
+                                  const typename StorageTraits<StorageType>::params_type& params
+                                      = StorageTraits<StorageType>::default_params,
+                                  bool                            keep_tables = false) {
+
+        std::vector<std::string> tables;
+        for (const auto& filename : filenames) {
+            tables.push_back(filename + ".counts");
+        }
+
+        // buckets vary a lot in size, so hand them out one at a time
+        std::atomic<size_t> next_bucket(0);
+        n_threads = resolve_n_threads(n_threads, filenames.size());
+        parallel_for_ranges(n_threads, n_threads,
+                            [&](size_t, size_t) {
+                                size_t bucket;
+                                while ((bucket = next_bucket.fetch_add(1)) < filenames.size()) {
+                                    KmerCountTable::write(tables[bucket], K,
+                                                          count_bucket<StorageType>(filenames[bucket],
+                                                                                    K,
+                                                                                    params));
+                                }
+                            });
+
+        uint64_t n_distinct = KmerCountTable::merge(tables, output_filename);
+        if (!keep_tables) {
+            for (const auto& table : tables) {
+                std::remove(table.c_str());
+            }
+        }
+        return n_distinct;
+    }
+};
+
+
+extern template class SuperKmerCounter<FwdLemireShifter>;
+extern template class SuperKmerCounter<CanLemireShifter>;
+
+}
+
+#endif
@@ -16,7 +16,10 @@
 #include "goetia/hashing/canonical.hh"
 #include "goetia/storage/storage.hh"
 
+#include <algorithm>
+#include <cstdint>
 #include <deque>
+#include <limits>
 #include <memory>
 #include <set>
 #include <unordered_set>
@@ -157,6 +160,154 @@ struct SeenRemover {
 };
 
 
+/**
+ * @Synopsis  Set of visited node hashes for a single walk. Open
+ *            addressing with linear probing over a flat table; each slot
+ *            is stamped with the epoch it was filled in, so clear() just
+ *            moves to the next epoch instead of touching the table, and a
+ *            walk allocates nothing once the table has grown to fit it.
+ *            Iterates in insertion order.
+ */
+template <class ValueType>
+class VisitedSet {
+
+    // a slot holds a live key if stamped with the current epoch, and
+    // a tombstone if stamped epoch + 1; any older stamp is empty
+    std::vector<ValueType> keys;
+    std::vector<uint32_t>  stamps;
+    std::vector<ValueType> members;
+    uint32_t               epoch;
+    size_t                 n_filled;
+    uint8_t                shift;
+
+    size_t _slot(ValueType value) const {
+        return static_cast<size_t>((static_cast<uint64_t>(value) * 0x9E3779B97F4A7C15ULL) >> shift);
+    }
+
+    /**
+     * @Returns   The slot holding value, or the table size if absent.
+     */
+    size_t _find(ValueType value) const {
+        const size_t mask = keys.size() - 1;
+        for (size_t i = _slot(value); ; i = (i + 1) & mask) {
+            if (stamps[i] == epoch) {
+                if (keys[i] == value) {
+                    return i;
+                }
+            } else if (stamps[i] != epoch + 1) {
+                return keys.size();
+            }
+        }
+    }
+
+    void _rehash(size_t capacity) {
+        keys.assign(capacity, ValueType());
+        stamps.assign(capacity, 0);
+        epoch    = 2;
+        n_filled = 0;
+        shift    = 64 - __builtin_ctzll(capacity);
+        for (const auto& value : members) {
+            _place(value);
+        }
+    }
+
+    void _place(ValueType value) {
+        const size_t mask = keys.size() - 1;
+        size_t i = _slot(value);
+        while (stamps[i] == epoch || stamps[i] == epoch + 1) {
+            i = (i + 1) & mask;
+        }
+        keys[i]   = value;
+        stamps[i] = epoch;
+        ++n_filled;
+    }
+
+public:
+
+    typedef typename std::vector<ValueType>::const_iterator const_iterator;
+
+    explicit VisitedSet(size_t capacity = 64)
+        : members(),
+          epoch(2),
+          n_filled(0)
+    {
+        size_t size = 16;
+        while (size < capacity * 2) {
+            size <<= 1;
+        }
+        _rehash(size);
+    }
+
+    /**
+     * @Returns   True if value was not already in the set.
+     */
+    bool insert(ValueType value) {
+        if (_find(value) != keys.size()) {
+            return false;
+        }
+        // keep the table at most half full, counting tombstones
+        if ((n_filled + 1) * 2 > keys.size()) {
+            members.push_back(value);
+            _rehash(members.size() * 2 > keys.size() / 2 ? keys.size() * 2 : keys.size());
+            return true;
+        }
+        members.push_back(value);
+        _place(value);
+        return true;
+    }
+
+    template <class It>
+    void insert(It begin, It end) {
+        for (; begin != end; ++begin) {
+            insert(*begin);
+        }
+    }
+
+    size_t count(ValueType value) const {
+        return _find(value) != keys.size();
+    }
+
+    size_t erase(ValueType value) {
+        size_t i = _find(value);
+        if (i == keys.size()) {
+            return 0;
+        }
+        stamps[i] = epoch + 1;
+        // erased nodes are nearly always the most recent
+        auto it = std::find(members.rbegin(), members.rend(), value);
+        members.erase(std::next(it).base());
+        return 1;
+    }
+
+    void clear() {
+        members.clear();
+        n_filled = 0;
+        if (epoch >= std::numeric_limits<uint32_t>::max() - 2) {
+            std::fill(stamps.begin(), stamps.end(), 0);
+            epoch = 2;
+        } else {
+            epoch += 2;
+        }
+    }
+
+    size_t size() const {
+        return members.size();
+    }
+
+    bool empty() const {
+        return members.empty();
+    }
+
+    const_iterator begin() const {
+        return members.cbegin();
+    }
+
+    const_iterator end() const {
+        return members.cend();
+    }
+};
+
+
 template <class T>
 struct UnitigWalker;
 
@@ -183,6 +334,9 @@ public:
     typedef typename extender_type::shift_left_type  shift_left_type;
     typedef typename extender_type::shift_right_type shift_right_type;
 
+    template<bool Dir>
+        using extensions_type = typename extender_type::template extensions_type<Dir>;
+
     typedef typename extender_type::kmer_type        kmer_type;
 
     typedef std::pair<std::vector<kmer_type>,
@@ -313,19 +467,21 @@ public:
     using extender_type::shift_right;
     using extender_type::K;
 
-    std::set<value_type> seen;
+    VisitedSet<value_type> seen;
 
     void clear_seen() {
         seen.clear();
     }
 
     size_t in_degree() {
-        auto extensions = this->left_extensions();
+        extensions_type<DIR_LEFT> extensions;
+        this->left_extensions(extensions);
         return count_nodes(extensions);
     }
 
     size_t out_degree() {
-        auto extensions = this->right_extensions();
+        extensions_type<DIR_RIGHT> extensions;
+        this->right_extensions(extensions);
         return count_nodes(extensions);
     }
 
@@ -370,6 +526,37 @@ public:
         return n_found;
     }
 
+    template<bool Dir>
+    size_t count_nodes(const extensions_type<Dir>& extensions) {
+
+        count_t counts[extensions_type<Dir>::capacity];
+        query_extensions(extensions, counts);
+
+        uint8_t n_found = 0;
+        for (size_t i = 0; i < extensions.size(); ++i) {
+            n_found += counts[i] != 0;
+        }
+        return n_found;
+    }
+
+    /**
+     * @Synopsis  Query the graph for all of extensions in one batch, so
+     *            that the storage can overlap their lookups.
+     *
+     * @Param extensions
+     * @Param counts      Receives the count of each extension.
+     */
+    template<bool Dir>
+    void query_extensions(const extensions_type<Dir>& extensions,
+                          count_t *                   counts) {
+
+        value_type hashes[extensions_type<Dir>::capacity];
+        for (size_t i = 0; i < extensions.size(); ++i) {
+            hashes[i] = extensions[i].value();
+        }
+        derived().query_many(hashes, counts, extensions.size());
+    }
+
 
     /**
      * @Synopsis  Count how many nodes are in the in the induced
@@ -417,6 +604,28 @@ public:
         return result;
     }
 
+    /**
+     * @Synopsis  Keep only the shifts from nodes that exist in the graph,
+     *            without allocating.
+     *
+     * @Param extensions
+     * @Param result      Cleared and filled with the valid shifts.
+     */
+    template<bool Dir>
+    void filter_nodes(const extensions_type<Dir>& extensions,
+                      extensions_type<Dir>&       result) {
+
+        count_t counts[extensions_type<Dir>::capacity];
+        query_extensions(extensions, counts);
+
+        result.clear();
+        for (size_t i = 0; i < extensions.size(); ++i) {
+            if (counts[i] != 0) {
+                result.push_back(extensions[i]);
+            }
+        }
+    }
+
     /**
      * @Synopsis  Return only the shifts from nodes that exist in the graph.
      *
@@ -652,8 +861,8 @@ public:
      *            STOP_SEEN if the single node is in the seen set;
      *            STEP if there is a single node not in the seen set.
      */
-    template<bool Dir>
-    State look_state(std::vector<shift_type<Dir>>& neighbors) {
+    template<class Neighbors>
+    State look_state(const Neighbors& neighbors) {
         if (neighbors.size() > 1) {
             pdebug("Stop: forward d-node");
             return State::DECISION_FWD;
@@ -676,32 +885,35 @@ public:
      * 
      * @tparam WalkFunctor 
      * @param f 
-     * @return std::pair<State, std::vector<shift_type<DIR_LEFT>>> 
+     * @return std::pair<State, extensions_type<DIR_LEFT>> 
      */
     template<typename WalkFunctor>
     auto step_left(WalkFunctor& f)
-    -> std::pair<State, std::vector<shift_type<DIR_LEFT>>> {
+    -> std::pair<State, extensions_type<DIR_LEFT>> {
+
+        extensions_type<DIR_LEFT> extensions, neighbors;
+        this->left_extensions(extensions);
+        filter_nodes(extensions, neighbors);
 
-        auto neighbors = this->filter_nodes(this->left_extensions());
         auto state = look_state(neighbors);
         if (state == State::STEP) {
             if (!f(neighbors.front().hash)) {
-                return {State::STOP_CALLBACK, std::move(neighbors)};
+                return {State::STOP_CALLBACK, neighbors};
             }
 
             this->shift_left(neighbors.front().symbol);
             this->seen.insert(neighbors.front().value());
         }
-        return {state, std::move(neighbors)};
+        return {state, neighbors};
     }
 
     /**
      * @brief Overload for step_left with default null functor for WalkFunctor.
      * 
-     * @return std::pair<State, std::vector<shift_type<DIR_LEFT>>> 
+     * @return std::pair<State, extensions_type<DIR_LEFT>> 
      */
     auto step_left()
-    -> std::pair<State, std::vector<shift_type<DIR_LEFT>>> {
+    -> std::pair<State, extensions_type<DIR_LEFT>> {
         null_walk_func_t func;
         return step_left(func);
     }
@@ -714,32 +926,35 @@ public:
      * 
      * @tparam WalkFunctor 
      * @param f 
-     * @return std::pair<State, std::vector<shift_type<DIR_RIGHT>>> 
+     * @return std::pair<State, extensions_type<DIR_RIGHT>> 
      */
     template<typename WalkFunctor>
     auto step_right(WalkFunctor& f)
-    -> std::pair<State, std::vector<shift_type<DIR_RIGHT>>> {
+    -> std::pair<State, extensions_type<DIR_RIGHT>> {
+
+        extensions_type<DIR_RIGHT> extensions, neighbors;
+        this->right_extensions(extensions);
+        filter_nodes(extensions, neighbors);
 
-        auto neighbors = this->filter_nodes(this->right_extensions());
         auto state = look_state(neighbors);
         if (state == State::STEP) {
             if (!f(neighbors.front().hash)) {
-                return {State::STOP_CALLBACK, std::move(neighbors)};
+                return {State::STOP_CALLBACK, neighbors};
             }
 
             this->shift_right(neighbors.front().symbol);
             this->seen.insert(neighbors.front().value());
         }
-        return {state, std::move(neighbors)};
+        return {state, neighbors};
     }
 
     /**
      * @brief Overload for step_right with default null functor for WalkFunctor.
      * 
-     * @return std::pair<State, std::vector<shift_type<DIR_RIGHT>>> 
+     * @return std::pair<State, extensions_type<DIR_RIGHT>> 
      */
     auto step_right()
-    -> std::pair<State, std::vector<shift_type<DIR_RIGHT>>> {
+    -> std::pair<State, extensions_type<DIR_RIGHT>> {
         null_walk_func_t func;
         return step_right(func);
     }
@@ -988,7 +1203,7 @@ public:
 
         std::vector<std::pair<Walk<DIR_LEFT>, Walk<DIR_RIGHT>>> unitigs;
         null_walk_func_t f;
-        std::set<value_type> seq_seen;
+        VisitedSet<value_type> seq_seen;
         for (size_t i = 0; i < sequence.size() - this->K + 1; ++i) {
             if (seq_seen.count(hashes[i].value())) {
                 continue;
@@ -0,0 +1,52 @@
+/**
+ * (c) Camille Scott, 2026
+ * File   : binary_io.hh
+ * License: MIT
+ * Author : Camille Scott <camille.scott.w@gmail.com>
+ * Date   : 18.10.2026
+ *
+ * Fixed-width little-endian integer I/O for the binary table formats,
+ * so that they're portable regardless of host byte order.
+ */
+
+#ifndef GOETIA_BINARY_IO_HH
+#define GOETIA_BINARY_IO_HH
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+
+
+namespace goetia {
+
+/**
+ * @Synopsis  Write the low n_bytes (at most 8) of value, little-endian.
+ */
+inline void write_le(std::ostream& out, uint64_t value, int n_bytes) {
+    uint8_t buf[8];
+    for (int i = 0; i < n_bytes; ++i) {
+        buf[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+    out.write(reinterpret_cast<const char*>(buf), n_bytes);
+}
+
+/**
+ * @Synopsis  Decode n_bytes (at most 8) little-endian bytes.
+ */
+inline uint64_t read_le(const uint8_t * buf, int n_bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < n_bytes; ++i) {
+        value |= static_cast<uint64_t>(buf[i]) << (8 * i);
+    }
+    return value;
+}
+
+inline uint64_t read_le(std::istream& in, int n_bytes) {
+    uint8_t buf[8] = {0};
+    in.read(reinterpret_cast<char*>(buf), n_bytes);
+    return read_le(buf, n_bytes);
+}
+
+}
+
+#endif
@@ -4,8 +4,11 @@ set(_headers
     include/goetia/cdbg/cdbg.hh
     include/goetia/cdbg/cdbg_types.hh
     include/goetia/cdbg/compactor.hh
+    include/goetia/cdbg/events.hh
+    include/goetia/cdbg/mapper.hh
     include/goetia/cdbg/metrics.hh
     include/goetia/cdbg/saturating_compactor.hh
+    include/goetia/cdbg/static_compactor.hh
     include/goetia/cdbg/ucompactor.hh
     include/goetia/cdbg/udbg.hh
     include/goetia/cdbg/utagger.hh
@@ -29,18 +32,24 @@ set(_headers
     include/goetia/meta.hh
     include/goetia/metrics.hh
     include/goetia/minimizers.hh
+    include/goetia/parallel.hh
     include/goetia/parsing/kseq.h
     include/goetia/parsing/parsing.hh
     include/goetia/parsing/readers.hh
     include/goetia/pdbg.hh
+    include/goetia/events.hh
     include/goetia/processors.hh
+    include/goetia/profiling.hh
     include/goetia/ring_span.hpp
     include/goetia/solidifier.hh
     include/goetia/diginorm.hh
     include/goetia/sketches/sourmash/sourmash.hpp
     include/goetia/sketches/sourmash/sourmash.h
     include/goetia/sketches/sourmash_sketch.hh
-    #include/goetia/sketches/hllcounter.hh
+    include/goetia/sketches/fracminhash.hh
+    include/goetia/sketches/hllcounter.hh
+    include/goetia/sketches/saturation.hh
+    include/goetia/sketches/spectrum.hh
     include/goetia/sketches/unikmer_sketch.hh
     include/goetia/storage/bitstorage.hh
     include/goetia/storage/bytestorage.hh
@@ -55,8 +64,10 @@ set(_headers
     include/goetia/storage/storage.hh
     include/goetia/storage/storage_types.hh
     include/goetia/traversal/unitig_walker.hh
+    include/goetia/utils/binary_io.hh
     include/goetia/utils/stringutils.h
     include/goetia/streamhasher.hh
+    include/goetia/superkmer_counter.hh
 )
 
 set(_sources
@@ -71,7 +82,10 @@ set(_sources
     src/goetia/storage/partitioned_storage.cc
     src/goetia/sketches/unikmer_sketch.cc
     src/goetia/sketches/sourmash_sketch.cc
-    #src/goetia/sketches/hllcounter.cc
+    src/goetia/sketches/fracminhash.cc
+    src/goetia/sketches/hllcounter.cc
+    src/goetia/sketches/saturation.cc
+    src/goetia/sketches/spectrum.cc
     src/goetia/benchmarks/bench_storage.cc
     src/goetia/hashing/hashshifter.cc
     src/goetia/hashing/hashextender.cc
@@ -90,19 +104,34 @@ set(_sources
     src/goetia/goetia.cc
     src/goetia/meta.cc
     src/goetia/metrics.cc
+    src/goetia/events.cc
     src/goetia/processors.cc
+    src/goetia/profiling.cc
     src/goetia/cdbg/metrics.cc
     src/goetia/cdbg/cdbg.cc
+    src/goetia/cdbg/events.cc
     src/goetia/cdbg/compactor.cc
+    src/goetia/cdbg/mapper.cc
     src/goetia/cdbg/ucompactor.cc
     src/goetia/cdbg/utagger.cc
     src/goetia/cdbg/udbg.cc
     src/goetia/cdbg/saturating_compactor.cc
+    src/goetia/cdbg/static_compactor.cc
     src/goetia/parsing/readers.cc
     src/goetia/parsing/parsing.cc
     src/goetia/minimizers.cc
     src/goetia/storage/cqf/gqf.c
     src/goetia/streamhasher.cc
+    src/goetia/superkmer_counter.cc
+)
+
+set(_bench_sources
+    src/goetia/benchmarks/micro/micro.cc
+    src/goetia/benchmarks/micro/hashing.cc
+    src/goetia/benchmarks/micro/storage.cc
+    src/goetia/benchmarks/micro/parsing.cc
+    src/goetia/benchmarks/micro/compactor.cc
+    src/goetia/benchmarks/micro/traversal.cc
 )
 
 set(_interface_headers
@@ -110,8 +139,11 @@ set(_interface_headers
     include/goetia/cdbg/cdbg.hh
     include/goetia/cdbg/cdbg_types.hh
     include/goetia/cdbg/compactor.hh
+    include/goetia/cdbg/events.hh
+    include/goetia/cdbg/mapper.hh
     include/goetia/cdbg/metrics.hh
     include/goetia/cdbg/saturating_compactor.hh
+    include/goetia/cdbg/static_compactor.hh
     include/goetia/cdbg/ucompactor.hh
     include/goetia/cdbg/udbg.hh
     include/goetia/cdbg/utagger.hh
@@ -132,15 +164,21 @@ set(_interface_headers
     include/goetia/meta.hh
     include/goetia/metrics.hh
     include/goetia/minimizers.hh
+    include/goetia/parallel.hh
     include/goetia/parsing/parsing.hh
     include/goetia/parsing/readers.hh
     include/goetia/pdbg.hh
+    include/goetia/events.hh
     include/goetia/processors.hh
+    include/goetia/profiling.hh
     include/goetia/solidifier.hh
     include/goetia/diginorm.hh
     include/goetia/sketches/sourmash/sourmash.hpp
     include/goetia/sketches/sourmash_sketch.hh
-    #include/goetia/sketches/hllcounter.hh
+    include/goetia/sketches/fracminhash.hh
+    include/goetia/sketches/hllcounter.hh
+    include/goetia/sketches/saturation.hh
+    include/goetia/sketches/spectrum.hh
     include/goetia/sketches/unikmer_sketch.hh
     include/goetia/storage/bitstorage.hh
     include/goetia/storage/bytestorage.hh
@@ -155,6 +193,7 @@ set(_interface_headers
     include/goetia/storage/storage_types.hh
     include/goetia/traversal/unitig_walker.hh
     include/goetia/streamhasher.hh
+    include/goetia/superkmer_counter.hh
 )
 
 set(_data
@@ -205,6 +244,10 @@ foreach (path ${_sources})
     list(APPEND LIB_SOURCES ${CMAKE_SOURCE_DIR}/${path})
 endforeach(path)
 
+foreach (path ${_bench_sources})
+    list(APPEND BENCH_SOURCES ${CMAKE_SOURCE_DIR}/${path})
+endforeach(path)
+
 foreach (path ${_data})
     list(APPEND LIB_DATA ${CMAKE_SOURCE_DIR}/py/data/${path})
 endforeach(path)
@@ -0,0 +1,90 @@
+/**
+ * (c) Camille Scott, 2026
+ * File   : compactor.cc
+ * License: MIT
+ * Author : Camille Scott <camille.scott.w@gmail.com>
+ * Date   : 18.10.2026
+ *
+ * Streaming compaction: Compactor::insert_sequence over a batch of reads,
+ * from a fresh graph each iteration.
+ */
+
+#include "micro.hh"
+
+#include "goetia/cdbg/compactor.hh"
+#include "goetia/dbg.hh"
+#include "goetia/hashing/shifter_types.hh"
+#include "goetia/storage/storage_types.hh"
+
+
+namespace goetia {
+namespace bench {
+
+namespace {
+
+    constexpr uint16_t COMPACTOR_K = 31;
+
+    template <class StorageType>
+    void compact_reads(benchmark::State&               state,
+                       const std::vector<std::string>& reads) {
+
+        typedef dBG<StorageType, FwdLemireShifter>    graph_type;
+        typedef StreamingCompactor<graph_type>        compactor_type;
+
+        std::shared_ptr<typename compactor_type::Compactor> compactor;
+        for (auto _ : state) {
+            state.PauseTiming();
+            compactor.reset();
+            compactor = compactor_type::Compactor::build(graph_type::build(StorageType::build(),
+                                                                           COMPACTOR_K));
+            state.ResumeTiming();
+
+            for (const auto& read : reads) {
+                benchmark::DoNotOptimize(compactor->insert_sequence(read));
+            }
+        }
+
+        state.counters["unodes"] = compactor->cdbg->n_unitig_nodes();
+        state.counters["dnodes"] = compactor->cdbg->n_decision_nodes();
+        set_throughput(state, total_kmers(reads, COMPACTOR_K), total_length(reads));
+    }
+
+}
+
+
+/*
+ * Reads at 3x coverage of a random genome; the argument is the
+ * substitution error rate per thousand bases. Errors make the bubbles and
+ * tips that exercise splitting and clipping.
+ */
+
+template <class StorageType>
+static void BM_CompactorSynthetic(benchmark::State& state) {
+    const auto reads = sample_reads(random_sequence(100000), 2000, 150,
+                                    state.range(0) / 1000.0);
+    compact_reads<StorageType>(state, reads);
+}
+
+BENCHMARK_TEMPLATE(BM_CompactorSynthetic, SparseppSetStorage)
+    ->ArgName("errors_per_kb")->Arg(0)->Arg(10)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_CompactorSynthetic, PHMapStorage)
+    ->ArgName("errors_per_kb")->Arg(0)->Arg(10)->Unit(benchmark::kMillisecond);
+
+
+/*
+ * Error-free reads at 3x coverage of the first 100kb of the S. pombe
+ * transcripts, which have real repeat structure.
+ */
+
+template <class StorageType>
+static void BM_CompactorPombe(benchmark::State& state) {
+    const auto& genome = load_genome(data_path("sacPom.pombase.fa.gz"), 100000);
+    const auto  reads  = sample_reads(genome, 2000, 150);
+    compact_reads<StorageType>(state, reads);
+}
+
+BENCHMARK_TEMPLATE(BM_CompactorPombe, SparseppSetStorage)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_CompactorPombe, PHMapStorage)->Unit(benchmark::kMillisecond);
+
+}
+}
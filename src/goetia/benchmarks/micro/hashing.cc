@@ -0,0 +1,180 @@
+/**
+ * (c) Camille Scott, 2026
+ * File   : hashing.cc
+ * License: MIT
+ * Author : Camille Scott <camille.scott.w@gmail.com>
+ * Date   : 18.10.2026
+ *
+ * k-mer hashing: rolling KmerIterator over each shifter, the whole-read
+ * kernels, and UKHS lookups.
+ */
+
+#include "micro.hh"
+
+#include "goetia/hashing/kmeriterator.hh"
+#include "goetia/hashing/shifter_types.hh"
+#include "goetia/hashing/ukhs.hh"
+
+
+namespace goetia {
+namespace bench {
+
+namespace {
+
+    const std::vector<std::string>& hashing_reads() {
+        static const auto reads = sample_reads(random_sequence(1000000), 10000);
+        return reads;
+    }
+
+
+    template <class ShifterType>
+    struct ShifterFactory {
+        static ShifterType make(uint16_t K) {
+            return ShifterType(K);
+        }
+    };
+
+    // unikmer shifters need a UKHS whose window is at most K
+    template <class ShifterType>
+    struct UnikmerShifterFactory {
+        static ShifterType make(uint16_t K) {
+            typedef typename ShifterType::base_shifter_type base_type;
+            return ShifterType(K, 7, load_ukhs<base_type>(K, 7));
+        }
+    };
+
+    template <>
+    struct ShifterFactory<FwdUnikmerShifter> : UnikmerShifterFactory<FwdUnikmerShifter> {};
+
+    template <>
+    struct ShifterFactory<CanUnikmerShifter> : UnikmerShifterFactory<CanUnikmerShifter> {};
+
+}
+
+
+template <class ShifterType>
+static void BM_KmerIterator(benchmark::State& state) {
+    const uint16_t K     = state.range(0);
+    const auto&    reads = hashing_reads();
+    auto shifter         = ShifterFactory<ShifterType>::make(K);
+
+    for (auto _ : state) {
+        for (const auto& read : reads) {
+            KmerIterator<ShifterType> kmers(read, &shifter);
+            while (!kmers.done()) {
+                auto h = kmers.next();
+                benchmark::DoNotOptimize(h);
+            }
+        }
+    }
+
+    set_throughput(state, total_kmers(reads, K), total_length(reads));
+}
+
+BENCHMARK_TEMPLATE(BM_KmerIterator, FwdLemireShifter)->Arg(21)->Arg(31)->Arg(51);
+BENCHMARK_TEMPLATE(BM_KmerIterator, CanLemireShifter)->Arg(21)->Arg(31)->Arg(51);
+BENCHMARK_TEMPLATE(BM_KmerIterator, FwdUnikmerShifter)->Arg(31)->Arg(51);
+BENCHMARK_TEMPLATE(BM_KmerIterator, CanUnikmerShifter)->Arg(31)->Arg(51);
+
+
+template <class ShifterType>
+static void BM_HashSequence(benchmark::State& state) {
+    const uint16_t K     = state.range(0);
+    const auto&    reads = hashing_reads();
+    ShifterType    shifter(K);
+
+    std::vector<typename ShifterType::hash_type> hashes;
+    for (auto _ : state) {
+        for (const auto& read : reads) {
+            hashes.clear();
+            shifter.hash_sequence(read, hashes);
+            benchmark::DoNotOptimize(hashes.data());
+        }
+    }
+
+    set_throughput(state, total_kmers(reads, K), total_length(reads));
+}
+
+// 23 has no specialized kernel and takes the generic path
+BENCHMARK_TEMPLATE(BM_HashSequence, FwdLemireShifter)->Arg(21)->Arg(23)->Arg(31)->Arg(51);
+BENCHMARK_TEMPLATE(BM_HashSequence, CanLemireShifter)->Arg(21)->Arg(23)->Arg(31)->Arg(51);
+
+
+template <class ShifterType>
+static void BM_UnikmerBatchHasher(benchmark::State& state) {
+    const uint16_t K     = state.range(0);
+    const auto&    reads = hashing_reads();
+    auto shifter         = ShifterFactory<ShifterType>::make(K);
+
+    typename ShifterType::BatchHasher hasher(K, shifter.unikmer_K(), shifter.ukhs_map);
+    typename ShifterType::batch_type  batch;
+    for (auto _ : state) {
+        for (const auto& read : reads) {
+            hasher.hash_sequence(read, batch);
+            benchmark::DoNotOptimize(batch.hashes.data());
+        }
+    }
+
+    set_throughput(state, total_kmers(reads, K), total_length(reads));
+}
+
+BENCHMARK_TEMPLATE(BM_UnikmerBatchHasher, FwdUnikmerShifter)->Arg(31)->Arg(51);
+BENCHMARK_TEMPLATE(BM_UnikmerBatchHasher, CanUnikmerShifter)->Arg(31)->Arg(51);
+
+
+/*
+ * UKHS lookups of every unikmer in the reads, through the direct 2-bit
+ * code index and through the hash map.
+ */
+
+template <class ShifterType>
+static void BM_UKHSQueryDirect(benchmark::State& state) {
+    const uint16_t K     = state.range(0);
+    const auto&    reads = hashing_reads();
+    auto ukhs            = load_ukhs<ShifterType>(30, K);
+
+    typename UKHS<ShifterType>::Hasher hasher(K);
+    for (auto _ : state) {
+        for (const auto& read : reads) {
+            hasher.hash_base(read.c_str());
+            auto hit = ukhs->query(hasher);
+            benchmark::DoNotOptimize(hit);
+            for (size_t i = K; i < read.size(); ++i) {
+                hasher.shift_right(read[i - K], read[i]);
+                hit = ukhs->query(hasher);
+                benchmark::DoNotOptimize(hit);
+            }
+        }
+    }
+
+    set_throughput(state, total_kmers(reads, K), total_length(reads));
+}
+
+template <class ShifterType>
+static void BM_UKHSQueryMap(benchmark::State& state) {
+    const uint16_t K     = state.range(0);
+    const auto&    reads = hashing_reads();
+    auto ukhs            = load_ukhs<ShifterType>(30, K);
+
+    ShifterType hasher(K);
+    for (auto _ : state) {
+        for (const auto& read : reads) {
+            auto hit = ukhs->query(hasher.hash_base(read.c_str()));
+            benchmark::DoNotOptimize(hit);
+            for (size_t i = K; i < read.size(); ++i) {
+                hit = ukhs->query(hasher.shift_right(read[i - K], read[i]));
+                benchmark::DoNotOptimize(hit);
+            }
+        }
+    }
+
+    set_throughput(state, total_kmers(reads, K), total_length(reads));
+}
+
+BENCHMARK_TEMPLATE(BM_UKHSQueryDirect, FwdLemireShifter)->Arg(7)->Arg(10);
+BENCHMARK_TEMPLATE(BM_UKHSQueryDirect, CanLemireShifter)->Arg(7)->Arg(10);
+BENCHMARK_TEMPLATE(BM_UKHSQueryMap, FwdLemireShifter)->Arg(7)->Arg(10);
+BENCHMARK_TEMPLATE(BM_UKHSQueryMap, CanLemireShifter)->Arg(7)->Arg(10);
+
+}
+}
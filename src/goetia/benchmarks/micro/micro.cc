@@ -0,0 +1,130 @@
+/**
+ * (c) Camille Scott, 2026
+ * File   : micro.cc
+ * License: MIT
+ * Author : Camille Scott <camille.scott.w@gmail.com>
+ * Date   : 18.10.2026
+ */
+
+#include "micro.hh"
+
+#include <cctype>
+#include <map>
+#include <random>
+
+#include <zlib.h>
+
+#include "goetia/goetia.hh"
+#include "goetia/parsing/readers.hh"
+
+
+namespace goetia {
+namespace bench {
+
+
+std::string data_path(const std::string& filename) {
+    return std::string(GOETIA_BENCH_DATA_DIR) + "/" + filename;
+}
+
+
+std::string random_sequence(size_t length, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::string sequence(length, 'A');
+    for (auto& c : sequence) {
+        c = "ACGT"[rng() & 3];
+    }
+    return sequence;
+}
+
+
+std::vector<std::string> sample_reads(const std::string& genome,
+                                      size_t             n_reads,
+                                      size_t             read_length,
+                                      double             error_rate,
+                                      uint64_t           seed) {
+    if (genome.size() < read_length) {
+        throw GoetiaException("Genome shorter than the read length");
+    }
+
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<size_t> start_dist(0, genome.size() - read_length);
+    std::uniform_real_distribution<double> error_dist(0.0, 1.0);
+
+    std::vector<std::string> reads;
+    reads.reserve(n_reads);
+    for (size_t i = 0; i < n_reads; ++i) {
+        std::string read = genome.substr(start_dist(rng), read_length);
+        if (error_rate > 0.0) {
+            for (auto& c : read) {
+                if (error_dist(rng) < error_rate) {
+                    // always a different base
+                    c = "CGTA"[(std::string("ACGT").find(c) + (rng() % 3)) & 3];
+                }
+            }
+        }
+        reads.push_back(std::move(read));
+    }
+    return reads;
+}
+
+
+const std::string& load_genome(const std::string& filename,
+                               size_t             max_bases) {
+    static std::map<std::pair<std::string, size_t>, std::string> cache;
+
+    auto key = std::make_pair(filename, max_bases);
+    auto search = cache.find(key);
+    if (search != cache.end()) {
+        return search->second;
+    }
+
+    std::string genome;
+    auto parser = FastxParser<>::build(filename);
+    while (!parser->is_complete() && genome.size() < max_bases) {
+        std::optional<Record> record;
+        try {
+            record = parser->next();
+        } catch (InvalidRead& e) {
+            continue;
+        }
+        // records with non-ACGT bases come back empty
+        if (record) {
+            genome += record.value().sequence;
+        }
+    }
+    if (genome.size() > max_bases) {
+        genome.resize(max_bases);
+    }
+
+    return cache.emplace(key, std::move(genome)).first->second;
+}
+
+
+std::vector<std::string> load_unikmers(uint16_t W, uint16_t K) {
+    const std::string filename = std::string(GOETIA_UKHS_DATA_DIR) + "/res_"
+                                 + std::to_string(K) + "_"
+                                 + std::to_string(W - (W % 10)) + "_4_0.txt.gz";
+
+    gzFile fp = gzopen(filename.c_str(), "rb");
+    if (fp == NULL) {
+        throw GoetiaFileException("Could not open " + filename);
+    }
+
+    std::vector<std::string> unikmers;
+    char line[256];
+    while (gzgets(fp, line, sizeof(line)) != NULL) {
+        std::string unikmer(line);
+        while (!unikmer.empty() && std::isspace(unikmer.back())) {
+            unikmer.pop_back();
+        }
+        if (!unikmer.empty()) {
+            unikmers.push_back(std::move(unikmer));
+        }
+    }
+    gzclose(fp);
+
+    return unikmers;
+}
+
+}
+}
@@ -0,0 +1,131 @@
+/**
+ * (c) Camille Scott, 2026
+ * File   : micro.hh
+ * License: MIT
+ * Author : Camille Scott <camille.scott.w@gmail.com>
+ * Date   : 18.10.2026
+ *
+ * Shared fixtures for the goetia_microbench suite: reproducible synthetic
+ * genomes and reads, reads cut from the test data, UKHS construction, and
+ * the throughput counters every benchmark reports.
+ *
+ * Every benchmark sets bytes/s (bases consumed) and, where k-mers are
+ * involved, a kmers/s rate counter. Hardware counters come from Google
+ * Benchmark's libpfm support, eg:
+ *
+ *     goetia_microbench --benchmark_perf_counters=CYCLES,CACHE-MISSES
+ *
+ * which adds per-iteration CYCLES and CACHE-MISSES columns to every row.
+ */
+
+#ifndef GOETIA_MICROBENCH_HH
+#define GOETIA_MICROBENCH_HH
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "goetia/hashing/ukhs.hh"
+
+
+#ifndef GOETIA_BENCH_DATA_DIR
+#define GOETIA_BENCH_DATA_DIR "tests/test-data"
+#endif
+
+#ifndef GOETIA_UKHS_DATA_DIR
+#define GOETIA_UKHS_DATA_DIR "goetia/data"
+#endif
+
+
+namespace goetia {
+namespace bench {
+
+// fixed so that runs are comparable between builds
+constexpr uint64_t BENCH_SEED = 0x60e71a;
+
+
+std::string data_path(const std::string& filename);
+
+
+/**
+ * @Synopsis  A uniformly random DNA sequence.
+ */
+std::string random_sequence(size_t length, uint64_t seed = BENCH_SEED);
+
+
+/**
+ * @Synopsis  Reads sampled uniformly from genome, with substitution errors
+ *            at error_rate per base.
+ */
+std::vector<std::string> sample_reads(const std::string& genome,
+                                      size_t             n_reads,
+                                      size_t             read_length = 150,
+                                      double             error_rate  = 0.0,
+                                      uint64_t           seed        = BENCH_SEED);
+
+
+/**
+ * @Synopsis  The concatenated ACGT-only records of a FASTA/Q file, up to
+ *            max_bases. Loaded once per file and cached.
+ */
+const std::string& load_genome(const std::string& filename,
+                               size_t             max_bases);
+
+
+/**
+ * @Synopsis  Unikmers from the bundled res_{K}_{W}_4_0.txt.gz
+ *            distribution, W rounded down to a multiple of 10.
+ */
+std::vector<std::string> load_unikmers(uint16_t W, uint16_t K);
+
+
+template <class ShifterType>
+std::shared_ptr<UKHS<ShifterType>> load_ukhs(uint16_t W, uint16_t K) {
+    auto unikmers = load_unikmers(W, K);
+    return UKHS<ShifterType>::build(W, K, unikmers);
+}
+
+
+inline uint64_t total_length(const std::vector<std::string>& sequences) {
+    uint64_t n = 0;
+    for (const auto& sequence : sequences) {
+        n += sequence.size();
+    }
+    return n;
+}
+
+
+inline uint64_t total_kmers(const std::vector<std::string>& sequences,
+                            uint16_t                        K) {
+    uint64_t n = 0;
+    for (const auto& sequence : sequences) {
+        if (sequence.size() >= K) {
+            n += sequence.size() - K + 1;
+        }
+    }
+    return n;
+}
+
+
+/**
+ * @Synopsis  Report kmers/s and bytes/s, given the work done per
+ *            iteration. Call after the benchmark loop.
+ */
+inline void set_throughput(benchmark::State& state,
+                           uint64_t          kmers_per_iteration,
+                           uint64_t          bytes_per_iteration) {
+    const int64_t iterations = state.iterations();
+    if (kmers_per_iteration) {
+        state.counters["kmers"] = benchmark::Counter(static_cast<double>(kmers_per_iteration * iterations),
+                                                     benchmark::Counter::kIsRate);
+    }
+    state.SetBytesProcessed(bytes_per_iteration * iterations);
+}
+
+}
+}
+
+#endif
@@ -0,0 +1,116 @@
+/**
+ * (c) Camille Scott, 2026
+ * File   : parsing.cc
+ * License: MIT
+ * Author : Camille Scott <camille.scott.w@gmail.com>
+ * Date   : 18.10.2026
+ *
+ * FastxParser throughput over plain and gzipped synthetic FASTQ, and over
+ * the gzipped S. pombe transcripts in the test data.
+ */
+
+#include "micro.hh"
+
+#include <cstdio>
+#include <fstream>
+
+#include <unistd.h>
+#include <zlib.h>
+
+#include "goetia/parsing/readers.hh"
+
+
+namespace goetia {
+namespace bench {
+
+namespace {
+
+    struct TempFastq {
+        std::string path;
+
+        ~TempFastq() {
+            if (!path.empty()) {
+                std::remove(path.c_str());
+            }
+        }
+    };
+
+
+    /**
+     * @Synopsis  Write reads to a FASTQ file in the temp dir, gzipped or
+     *            not, once per run; it's removed at exit.
+     */
+    const std::string& synthetic_fastq(bool gzipped) {
+        static TempFastq files[2];
+        std::string& path = files[gzipped].path;
+        if (!path.empty()) {
+            return path;
+        }
+
+        const auto reads = sample_reads(random_sequence(1000000), 100000, 150, 0.01);
+        std::string fastq;
+        for (size_t i = 0; i < reads.size(); ++i) {
+            fastq += "@read" + std::to_string(i) + "\n" + reads[i] + "\n+\n"
+                     + std::string(reads[i].size(), 'I') + "\n";
+        }
+
+        const std::string suffix = gzipped ? ".fq.gz" : ".fq";
+        std::string name = "/tmp/goetia_microbench_XXXXXX" + suffix;
+        int fd = mkstemps(&name[0], suffix.size());
+        if (fd == -1) {
+            throw GoetiaFileException("Could not create a temporary FASTQ");
+        }
+        close(fd);
+        path = name;
+
+        if (gzipped) {
+            gzFile fp = gzopen(path.c_str(), "wb");
+            gzwrite(fp, fastq.data(), fastq.size());
+            gzclose(fp);
+        } else {
+            std::ofstream out(path);
+            out << fastq;
+        }
+        return path;
+    }
+
+
+    void parse_file(benchmark::State& state, const std::string& filename) {
+        uint64_t n_bases   = 0;
+        uint64_t n_records = 0;
+        for (auto _ : state) {
+            auto parser = FastxParser<>::build(filename);
+            while (!parser->is_complete()) {
+                auto record = parser->next();
+                if (record) {
+                    n_bases += record.value().sequence.size();
+                    ++n_records;
+                }
+            }
+        }
+
+        state.SetBytesProcessed(n_bases);
+        state.counters["records"] = benchmark::Counter(n_records, benchmark::Counter::kIsRate);
+    }
+
+}
+
+
+static void BM_FastxParser_FASTQ(benchmark::State& state) {
+    parse_file(state, synthetic_fastq(false));
+}
+
+static void BM_FastxParser_FASTQ_gz(benchmark::State& state) {
+    parse_file(state, synthetic_fastq(true));
+}
+
+static void BM_FastxParser_FASTA_gz(benchmark::State& state) {
+    parse_file(state, data_path("sacPom.pombase.fa.gz"));
+}
+
+BENCHMARK(BM_FastxParser_FASTQ)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_FastxParser_FASTQ_gz)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_FastxParser_FASTA_gz)->Unit(benchmark::kMillisecond);
+
+}
+}
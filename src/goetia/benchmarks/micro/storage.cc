@@ -0,0 +1,185 @@
+/**
+ * (c) Camille Scott, 2026
+ * File   : storage.cc
+ * License: MIT
+ * Author : Camille Scott <camille.scott.w@gmail.com>
+ * Date   : 18.10.2026
+ *
+ * Storage backends: insert, query and batched query of random hashes.
+ * Each benchmark takes a table size and a load factor in percent; the
+ * sketches are built with four tables of that size, the QF with that many
+ * slots, and the exact sets grow as needed, so for them the table size
+ * just scales the number of hashes, table size * load.
+ */
+
+#include "micro.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "goetia/storage/storage_types.hh"
+
+
+namespace goetia {
+namespace bench {
+
+namespace {
+
+    template <class StorageType>
+    struct StorageFactory {
+        static std::shared_ptr<StorageType> make(uint64_t) {
+            return StorageType::build();
+        }
+    };
+
+    template <class StorageType>
+    struct SketchFactory {
+        static std::shared_ptr<StorageType> make(uint64_t table_size) {
+            return StorageType::build(table_size, 4);
+        }
+    };
+
+    template <>
+    struct StorageFactory<BitStorage> : SketchFactory<BitStorage> {};
+
+    template <>
+    struct StorageFactory<NibbleStorage> : SketchFactory<NibbleStorage> {};
+
+    template <>
+    struct StorageFactory<ByteStorage> : SketchFactory<ByteStorage> {};
+
+    template <>
+    struct StorageFactory<QFStorage> {
+        static std::shared_ptr<QFStorage> make(uint64_t table_size) {
+            return QFStorage::build(static_cast<int>(std::log2(table_size)));
+        }
+    };
+
+
+    std::vector<uint64_t> random_hashes(size_t n, uint64_t seed) {
+        std::mt19937_64 rng(seed);
+        std::vector<uint64_t> hashes(n);
+        for (auto& h : hashes) {
+            h = rng();
+        }
+        return hashes;
+    }
+
+
+    size_t n_hashes(const benchmark::State& state) {
+        return static_cast<size_t>(state.range(0)) * state.range(1) / 100;
+    }
+
+
+    void storage_args(benchmark::internal::Benchmark * b) {
+        b->ArgNames({"table_size", "load"});
+        for (int64_t table_size : {1 << 16, 1 << 20, 1 << 23}) {
+            for (int64_t load : {10, 50, 90}) {
+                b->Args({table_size, load});
+            }
+        }
+        b->Unit(benchmark::kMillisecond);
+    }
+
+}
+
+
+template <class StorageType>
+static void BM_StorageInsert(benchmark::State& state) {
+    const auto hashes = random_hashes(n_hashes(state), BENCH_SEED);
+
+    // a fresh table each time round, rather than reset(), which is a
+    // no-op for QFStorage
+    std::shared_ptr<StorageType> storage;
+    for (auto _ : state) {
+        state.PauseTiming();
+        storage.reset();
+        storage = StorageFactory<StorageType>::make(state.range(0));
+        state.ResumeTiming();
+
+        for (auto h : hashes) {
+            benchmark::DoNotOptimize(storage->insert(h));
+        }
+    }
+
+    set_throughput(state, hashes.size(), hashes.size() * sizeof(uint64_t));
+}
+
+
+/*
+ * Queries are half hits, half misses, interleaved.
+ */
+
+template <class StorageType>
+static void BM_StorageQuery(benchmark::State& state) {
+    const auto hashes = random_hashes(n_hashes(state), BENCH_SEED);
+    const auto misses = random_hashes(hashes.size(), BENCH_SEED + 1);
+    auto storage      = StorageFactory<StorageType>::make(state.range(0));
+    for (auto h : hashes) {
+        storage->insert(h);
+    }
+
+    std::vector<uint64_t> queries;
+    queries.reserve(hashes.size() * 2);
+    for (size_t i = 0; i < hashes.size(); ++i) {
+        queries.push_back(hashes[i]);
+        queries.push_back(misses[i]);
+    }
+
+    for (auto _ : state) {
+        for (auto h : queries) {
+            benchmark::DoNotOptimize(storage->query(h));
+        }
+    }
+
+    set_throughput(state, queries.size(), queries.size() * sizeof(uint64_t));
+}
+
+
+template <class StorageType>
+static void BM_StorageQueryMany(benchmark::State& state) {
+    const auto hashes = random_hashes(n_hashes(state), BENCH_SEED);
+    const auto misses = random_hashes(hashes.size(), BENCH_SEED + 1);
+    auto storage      = StorageFactory<StorageType>::make(state.range(0));
+    for (auto h : hashes) {
+        storage->insert(h);
+    }
+
+    std::vector<uint64_t> queries;
+    queries.reserve(hashes.size() * 2);
+    for (size_t i = 0; i < hashes.size(); ++i) {
+        queries.push_back(hashes[i]);
+        queries.push_back(misses[i]);
+    }
+
+    // a read's worth of k-mers at a time, as dBG::query_sequence does
+    constexpr size_t batch_size = 128;
+    std::vector<count_t> counts(batch_size);
+    for (auto _ : state) {
+        for (size_t i = 0; i < queries.size(); i += batch_size) {
+            const size_t n = std::min(batch_size, queries.size() - i);
+            storage->query_many(queries.data() + i, counts.data(), n);
+            benchmark::DoNotOptimize(counts.data());
+        }
+    }
+
+    set_throughput(state, queries.size(), queries.size() * sizeof(uint64_t));
+}
+
+
+#define GOETIA_STORAGE_BENCHMARKS(StorageType)                                  \
+    BENCHMARK_TEMPLATE(BM_StorageInsert, StorageType)->Apply(storage_args);    \
+    BENCHMARK_TEMPLATE(BM_StorageQuery, StorageType)->Apply(storage_args);     \
+    BENCHMARK_TEMPLATE(BM_StorageQueryMany, StorageType)->Apply(storage_args);
+
+GOETIA_STORAGE_BENCHMARKS(BitStorage)
+GOETIA_STORAGE_BENCHMARKS(NibbleStorage)
+GOETIA_STORAGE_BENCHMARKS(ByteStorage)
+GOETIA_STORAGE_BENCHMARKS(QFStorage)
+GOETIA_STORAGE_BENCHMARKS(SparseppSetStorage)
+GOETIA_STORAGE_BENCHMARKS(PHMapStorage)
+GOETIA_STORAGE_BENCHMARKS(BTreeStorage)
+
+}
+}
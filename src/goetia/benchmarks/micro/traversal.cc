@@ -0,0 +1,114 @@
+/**
+ * (c) Camille Scott, 2026
+ * File   : traversal.cc
+ * License: MIT
+ * Author : Camille Scott <camille.scott.w@gmail.com>
+ * Date   : 18.10.2026
+ *
+ * UnitigWalker: walks along independent random contigs, so that every walk
+ * runs the length of its contig. The argument is the contig length.
+ */
+
+#include "micro.hh"
+
+#include "goetia/dbg.hh"
+#include "goetia/hashing/shifter_types.hh"
+#include "goetia/storage/storage_types.hh"
+
+
+namespace goetia {
+namespace bench {
+
+namespace {
+
+    constexpr uint16_t WALK_K         = 31;
+    constexpr size_t   WALK_N_KMERS   = 200000;
+
+    template <class StorageType>
+    struct GraphStorageFactory {
+        static std::shared_ptr<StorageType> make() {
+            return StorageType::build();
+        }
+    };
+
+    // large enough that false positives don't branch the walks
+    template <>
+    struct GraphStorageFactory<ByteStorage> {
+        static std::shared_ptr<ByteStorage> make() {
+            return ByteStorage::build(WALK_N_KMERS * 32, 4);
+        }
+    };
+
+    template <class GraphType>
+    std::shared_ptr<GraphType> build_contig_graph(const std::vector<std::string>& contigs) {
+        typedef typename GraphType::storage_type storage_type;
+
+        auto graph = GraphType::build(GraphStorageFactory<storage_type>::make(), WALK_K);
+        for (const auto& contig : contigs) {
+            graph->insert_sequence(contig);
+        }
+        return graph;
+    }
+
+    std::vector<std::string> random_contigs(size_t length) {
+        std::vector<std::string> contigs;
+        for (size_t i = 0; i < WALK_N_KMERS / length; ++i) {
+            contigs.push_back(random_sequence(length, BENCH_SEED + i));
+        }
+        return contigs;
+    }
+
+}
+
+
+template <class GraphType>
+static void BM_WalkRight(benchmark::State& state) {
+    const auto contigs = random_contigs(state.range(0));
+    auto graph         = build_contig_graph<GraphType>(contigs);
+
+    uint64_t n_steps = 0;
+    for (auto _ : state) {
+        for (const auto& contig : contigs) {
+            auto walk = graph->walk_right(contig.substr(0, WALK_K));
+            n_steps += walk.path.size();
+        }
+    }
+
+    state.counters["kmers"] = benchmark::Counter(n_steps, benchmark::Counter::kIsRate);
+    state.SetBytesProcessed(n_steps);
+}
+
+
+template <class GraphType>
+static void BM_WalkLeft(benchmark::State& state) {
+    const auto contigs = random_contigs(state.range(0));
+    auto graph         = build_contig_graph<GraphType>(contigs);
+
+    uint64_t n_steps = 0;
+    for (auto _ : state) {
+        for (const auto& contig : contigs) {
+            auto walk = graph->walk_left(contig.substr(contig.size() - WALK_K));
+            n_steps += walk.path.size();
+        }
+    }
+
+    state.counters["kmers"] = benchmark::Counter(n_steps, benchmark::Counter::kIsRate);
+    state.SetBytesProcessed(n_steps);
+}
+
+
+#define GOETIA_WALK_BENCHMARKS(StorageType, ShifterType)                               \
+    BENCHMARK_TEMPLATE(BM_WalkRight, dBG<StorageType, ShifterType>)                    \
+        ->ArgName("contig_length")->Arg(100)->Arg(1000)->Arg(10000)                    \
+        ->Unit(benchmark::kMillisecond);                                               \
+    BENCHMARK_TEMPLATE(BM_WalkLeft, dBG<StorageType, ShifterType>)                     \
+        ->ArgName("contig_length")->Arg(100)->Arg(1000)->Arg(10000)                    \
+        ->Unit(benchmark::kMillisecond);
+
+GOETIA_WALK_BENCHMARKS(PHMapStorage, FwdLemireShifter)
+GOETIA_WALK_BENCHMARKS(PHMapStorage, CanLemireShifter)
+GOETIA_WALK_BENCHMARKS(ByteStorage, FwdLemireShifter)
+GOETIA_WALK_BENCHMARKS(ByteStorage, CanLemireShifter)
+
+}
+}
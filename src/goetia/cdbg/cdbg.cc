@@ -104,11 +104,14 @@ Graph::find_unode_neighbors(UnitigNode * unode)
 
     DecisionNode * left = nullptr, * right = nullptr;
 
+    typename graph_type::template extensions_type<DIR_LEFT>  left_shifts;
+    typename graph_type::template extensions_type<DIR_RIGHT> right_shifts;
+
     dbg->set_cursor(unode->sequence.c_str());
-    auto left_shifts = dbg->left_extensions();
+    dbg->left_extensions(left_shifts);
 
     dbg->set_cursor(unode->sequence.c_str() + unode->sequence.size() - this->K);
-    auto right_shifts = dbg->right_extensions();
+    dbg->right_extensions(right_shifts);
 
     uint8_t n_left = 0;
     for (auto shift : left_shifts) {
@@ -340,6 +343,7 @@ Graph::build_dnode(hash_type hash,
         // the memory location changes after the move; get a fresh address
         dnode = query_dnode(hash);
         metrics->n_dnodes++;
+        _emit(BUILD_DNODE, dnode->node_id, NULL_ID, 0, 0, 0, kmer.length());
         pdebug("BUILD_DNODE complete: " << *dnode);
     } else {
         pdebug("BUILD_DNODE: d-node for " << hash << " already exists.");
@@ -383,6 +387,7 @@ Graph::build_unode(const std::string& sequence,
     _n_unitig_nodes++;
     _n_updates++;
     metrics->n_unodes++;
+    metrics->unitig_lengths.add(sequence.length());
 
     // Link up its new tags
     unode_ptr->tags.insert(std::end(unode_ptr->tags),
@@ -397,6 +402,7 @@ Graph::build_unode(const std::string& sequence,
     auto unode_meta = recompute_node_meta(unode_ptr);
     unode_ptr->set_node_meta(unode_meta);
     metrics->increment_cdbg_node(unode_meta);
+    _emit_unode(BUILD_UNODE, unode_ptr);
 
     pdebug("BUILD_UNODE complete: " << *unode_ptr);
 
@@ -426,6 +432,8 @@ Graph::clip_unode(bool      clip_from,
         pdebug("CLIP complete: deleted null unode.");
     } else {
         metrics->n_clips++;
+        metrics->unitig_lengths.update(unode->sequence.length(),
+                                       unode->sequence.length() - 1);
         if (clip_from == DIR_LEFT) {
             unode->sequence = unode->sequence.substr(1);
             unode->set_left_end(new_unode_end);
@@ -434,6 +442,7 @@ Graph::clip_unode(bool      clip_from,
             auto meta = recompute_node_meta(unode);
             metrics->increment_cdbg_node(meta);
             unode->set_node_meta(meta);
+            _emit_unode(CLIP_UNODE, unode, NULL_ID, clip_from);
 
             pdebug("CLIP complete: " << *unode);
         } else {
@@ -444,6 +453,7 @@ Graph::clip_unode(bool      clip_from,
             auto meta = recompute_node_meta(unode);
             metrics->increment_cdbg_node(meta);
             unode->set_node_meta(meta);
+            _emit_unode(CLIP_UNODE, unode, NULL_ID, clip_from);
 
             pdebug("CLIP complete: " << *unode);
         }
@@ -478,11 +488,13 @@ Graph::extend_unode(bool               ext_dir,
            << " adding " << new_sequence << " to"
            << std::endl << *unode);
     
+    size_t old_length = unode->sequence.length();
     if (ext_dir == DIR_RIGHT) {
         unode->extend_right(new_unode_end, new_sequence);
     } else {
         unode->extend_left(new_unode_end, new_sequence);
     }
+    metrics->unitig_lengths.update(old_length, unode->sequence.length());
 
     std::copy(new_tags.begin(), new_tags.end(), std::back_inserter(unode->tags));
     for (auto tag: new_tags) {
@@ -495,6 +507,7 @@ Graph::extend_unode(bool               ext_dir,
     metrics->increment_cdbg_node(meta);
     unode->set_node_meta(meta);
     ++_n_updates;
+    _emit_unode(EXTEND_UNODE, unode, NULL_ID, ext_dir);
 
     pdebug("EXTEND complete: " << *unode);
 }
@@ -528,8 +541,10 @@ Graph::split_unode(id_t node_id,
 
             split_at = unode->sequence.find(split_kmer);
             pdebug("Split k-mer found at " << split_at);
+            size_t old_length = unode->sequence.length();
             unode->sequence = unode->sequence.substr(split_at + 1) +
                               unode->sequence.substr((this->K - 1), split_at);
+            metrics->unitig_lengths.update(old_length, unode->sequence.length());
             switch_unode_ends(unode->left_end(), new_left_end);
             unitig_end_map.insert(std::make_pair(new_right_end, unode));
 
@@ -541,6 +556,7 @@ Graph::split_unode(id_t node_id,
             metrics->decrement_cdbg_node(CIRCULAR);
             metrics->increment_cdbg_node(FULL);
             ++_n_updates;
+            _emit_unode(SPLIT_UNODE, unode, NULL_ID, split_at);
 
             pdebug("SPLIT complete (CIRCULAR): " << *unode);
             return;
@@ -557,7 +573,9 @@ Graph::split_unode(id_t node_id,
         right_unode_right_end = unode->right_end();
         switch_unode_ends(unode->right_end(), new_right_end);
         unode->set_right_end(new_right_end);
+        size_t old_length = unode->sequence.length();
         unode->sequence = unode->sequence.substr(0, split_at + this->K - 1);
+        metrics->unitig_lengths.update(old_length, unode->sequence.length());
         
         metrics->n_splits++;
         metrics->decrement_cdbg_node(unode->meta());
@@ -572,6 +590,7 @@ Graph::split_unode(id_t node_id,
                                 tags,
                                 new_left_end,
                                 right_unode_right_end);
+    _emit_unode(SPLIT_UNODE, unode, new_node->node_id, split_at);
 
     pdebug("SPLIT complete: " << std::endl << *unode << std::endl << *new_node);
 
@@ -630,6 +649,8 @@ Graph::merge_unodes(const std::string& span_sequence,
                      left_end, // this is left_unode's right_end
                      left_unode->left_end(),
                      new_tags);
+        // nothing was absorbed, so there's no MERGE_UNODES event: the
+        // EXTEND_UNODE from closing the circle reports the update
     } else {
 
         pdebug("MERGE: " << left_end << " to " << right_end
@@ -656,6 +677,7 @@ Graph::merge_unodes(const std::string& span_sequence,
                      new_right_end,
                      new_tags);
         metrics->n_merges++;
+        _emit_unode(MERGE_UNODES, left_unode, rid);
 
     }
     
@@ -797,30 +819,9 @@ cDBG<GraphType<StorageType, ShifterType>>
                                std::vector<size_t>    bins)
 -> std::vector<size_t> {
 
-    //auto time_start = std::chrono::system_clock::now();
-    auto lock       = cdbg->lock_nodes();
-    //_cerr("Summing unitig length bins...");
-
-    std::vector<size_t> bin_sums(bins.size(), 0);
-
-    for (auto it = cdbg->unodes_begin(); it != cdbg->unodes_end(); ++it) {
-        auto seq_len = it->second->sequence.length();
-        for (size_t bin_num = 0; bin_num < bins.size() - 1; bin_num++) {
-            if (seq_len >= bins[bin_num] && seq_len < bins[bin_num+1]) {
-                bin_sums[bin_num] += (seq_len - cdbg->K + 1);
-                break;
-            }
-        }
-        if (seq_len > bins.back()) {
-            bins[bins.size() - 1] += seq_len;
-        }
-    }
-
-    //auto time_elapsed = std::chrono::system_clock::now() - time_start;
-    //_cerr("Finished summing unitig length bins. Elapsed time: " <<
-    //      std::chrono::duration<double>(time_elapsed).count());
-
-    return bin_sums;
+    // maintained incrementally by the unode update methods, so there's
+    // no need to lock or walk the unitigs here
+    return cdbg->metrics->unitig_lengths.kmers_per_bin(bins, cdbg->K);
 }
 
 template class cDBG<goetia::dBG<BitStorage, FwdLemireShifter>>;
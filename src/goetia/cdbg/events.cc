@@ -0,0 +1,155 @@
+/**
+ * (c) Camille Scott, 2026
+ * File   : events.cc
+ * License: MIT
+ * Author : Camille Scott <camille.scott.w@gmail.com>
+ * Date   : 18.10.2026
+ */
+
+#include "goetia/cdbg/events.hh"
+#include "goetia/utils/binary_io.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+
+namespace goetia {
+
+
+constexpr char     cDBGEventRing::DELTA_MAGIC[8];
+constexpr uint16_t cDBGEventRing::DELTA_VERSION;
+
+
+namespace {
+
+    // op, then seven u64 fields
+    constexpr uint64_t DELTA_RECORD_BYTES = 1 + 7 * 8;
+
+    // bytes left in a seekable stream, or 0 if it can't tell
+    uint64_t remaining_bytes(std::istream& in) {
+        const auto here = in.tellg();
+        if (here < 0) {
+            return 0;
+        }
+        in.seekg(0, std::ios::end);
+        const auto end = in.tellg();
+        in.seekg(here);
+        return end > here ? static_cast<uint64_t>(end - here) : 0;
+    }
+
+}
+
+
+cDBGEventRing::cDBGEventRing(uint64_t capacity)
+    : mask(([capacity]() {
+               uint64_t c = 2;
+               while (c < capacity) {
+                   c <<= 1;
+               }
+               return c;
+           })() - 1),
+      head(0),
+      tail(0),
+      _n_dropped(0),
+      capacity(mask + 1)
+{
+    slots.reset(new Slot[this->capacity]);
+    for (uint64_t i = 0; i < this->capacity; ++i) {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+
+size_t cDBGEventRing::drain(std::vector<cDBGEvent>& out, size_t max_events) {
+    size_t n_drained = 0;
+    cDBGEvent event;
+    out.reserve(out.size() + std::min<uint64_t>(max_events, size()));
+    while (n_drained < max_events && pop(event)) {
+        out.push_back(event);
+        ++n_drained;
+    }
+    return n_drained;
+}
+
+
+void cDBGEventRing::write_delta(std::ostream&                 out,
+                                const std::vector<cDBGEvent>& events) {
+
+    out.write(DELTA_MAGIC, sizeof(DELTA_MAGIC));
+    uint8_t version[2] = {static_cast<uint8_t>(DELTA_VERSION & 0xFF),
+                          static_cast<uint8_t>(DELTA_VERSION >> 8)};
+    out.write(reinterpret_cast<const char*>(version), 2);
+    write_le(out, events.size(), 8);
+
+    for (const auto& event : events) {
+        uint8_t op = static_cast<uint8_t>(event.op);
+        out.write(reinterpret_cast<const char*>(&op), 1);
+        write_le(out, event.node_id, 8);
+        write_le(out, event.other_id, 8);
+        write_le(out, event.left_end, 8);
+        write_le(out, event.right_end, 8);
+        write_le(out, event.position, 8);
+        write_le(out, event.length, 8);
+        write_le(out, event.update_n, 8);
+    }
+}
+
+
+std::vector<cDBGEvent> cDBGEventRing::read_delta(std::istream& in) {
+
+    std::vector<cDBGEvent> events;
+
+    // a delta file is a concatenation of blocks; read until EOF
+    while (in.peek() != std::char_traits<char>::eof()) {
+        char magic[sizeof(DELTA_MAGIC)];
+        in.read(magic, sizeof(DELTA_MAGIC));
+        if (!in || std::memcmp(magic, DELTA_MAGIC, sizeof(DELTA_MAGIC)) != 0) {
+            throw GoetiaFileException("Invalid cDBG delta block header.");
+        }
+
+        uint8_t version[2];
+        in.read(reinterpret_cast<char*>(version), 2);
+        if (!in) {
+            throw GoetiaFileException("Truncated cDBG delta block header.");
+        }
+        uint16_t block_version = version[0] | (static_cast<uint16_t>(version[1]) << 8);
+        if (block_version != DELTA_VERSION) {
+            throw GoetiaFileException("Unsupported cDBG delta version: "
+                                      + std::to_string(block_version));
+        }
+
+        uint64_t n_events = read_le(in, 8);
+        if (!in) {
+            throw GoetiaFileException("Truncated cDBG delta block header.");
+        }
+        // the count is untrusted; reserve no more than the rest of the
+        // stream could hold
+        events.reserve(events.size() + std::min(n_events,
+                                                remaining_bytes(in) / DELTA_RECORD_BYTES));
+        for (uint64_t i = 0; i < n_events; ++i) {
+            cDBGEvent event;
+            uint8_t op;
+            in.read(reinterpret_cast<char*>(&op), 1);
+            if (in && op > DELETE_DNODE) {
+                throw GoetiaFileException("Invalid cDBG delta op: " + std::to_string(op));
+            }
+            event.op        = static_cast<update_meta_t>(op);
+            event.node_id   = read_le(in, 8);
+            event.other_id  = read_le(in, 8);
+            event.left_end  = read_le(in, 8);
+            event.right_end = read_le(in, 8);
+            event.position  = read_le(in, 8);
+            event.length    = read_le(in, 8);
+            event.update_n  = read_le(in, 8);
+            if (!in) {
+                throw GoetiaFileException("Truncated cDBG delta block.");
+            }
+            events.push_back(event);
+        }
+    }
+
+    return events;
+}
+
+}
@@ -0,0 +1,181 @@
+/**
+ * (c) Camille Scott, 2026
+ * File   : mapper.cc
+ * License: MIT
+ * Author : Camille Scott <camille.scott.w@gmail.com>
+ * Date   : 18.10.2026
+ */
+
+#include "goetia/cdbg/mapper.hh"
+
+#include "goetia/dbg.hh"
+#include "goetia/hashing/rollinghashshifter.hh"
+#include "goetia/storage/storage_types.hh"
+
+
+namespace goetia {
+
+
+template <template <class, class> class GraphType,
+          class StorageType,
+          class ShifterType>
+void
+UnitigMapper<GraphType<StorageType, ShifterType>>::
+Mapper::rebuild_index() {
+
+    auto lock = cdbg->lock_nodes();
+
+    index.clear();
+    InteriorMinimizer<value_type> minimizer(window_size);
+    std::vector<value_type> hashes;
+
+    for (auto it = cdbg->unodes_begin(); it != cdbg->unodes_end(); ++it) {
+        _index_unitig(it->second.get(), minimizer, hashes);
+    }
+
+    _index_updates = cdbg->n_updates();
+}
+
+
+template <template <class, class> class GraphType,
+          class StorageType,
+          class ShifterType>
+void
+UnitigMapper<GraphType<StorageType, ShifterType>>::
+Mapper::_index_unitig(const UnitigNode *             unode,
+                      InteriorMinimizer<value_type>& minimizer,
+                      std::vector<value_type>&       hashes) {
+
+    KmerIterator<ShifterType> kmers(unode->sequence, this->K);
+    hashes.clear();
+    while (!kmers.done()) {
+        hashes.push_back(kmers.next().value());
+    }
+    minimizer.assign(hashes.data(), hashes.size());
+
+    const uint32_t n_kmers = unode->sequence.length() - this->K + 1;
+
+    // the ends are always indexed, so that short unitigs and reads
+    // only overlapping the end of a unitig still get a hit
+    index.insert_or_assign(unode->left_end().value(),
+                           UnitigHit{unode->node_id, 0});
+    index.insert_or_assign(unode->right_end().value(),
+                           UnitigHit{unode->node_id, n_kmers - 1});
+
+    // consecutive windows share minimizers; only the offset of the
+    // first occurrence is kept
+    for (const auto& m : minimizer.get_minimizers()) {
+        index.try_emplace(m.first,
+                          UnitigHit{unode->node_id, static_cast<uint32_t>(m.second)});
+    }
+}
+
+
+template <template <class, class> class GraphType,
+          class StorageType,
+          class ShifterType>
+void
+UnitigMapper<GraphType<StorageType, ShifterType>>::
+Mapper::map_sequence(const std::string& sequence,
+                     ReadMapping&       mapping) const {
+
+    _clear_mapping(mapping);
+
+    if (sequence.length() < this->K) {
+        return;
+    }
+
+    // the shifters hash whatever they're given, so validate the read as
+    // the parsers do: lowercase is upper-cased, other symbols rejected
+    std::string read(sequence);
+    ShifterType::alphabet::validate(&read[0], read.length());
+
+    KmerIterator<ShifterType> kmers(read, this->K);
+    uint32_t pos = 0;
+    while (!kmers.done()) {
+        auto search = index.find(kmers.next().value());
+        if (search != index.end() &&
+            (mapping.unitig_ids.empty() ||
+             mapping.unitig_ids.back() != search->second.unitig_id)) {
+
+            mapping.unitig_ids.push_back(search->second.unitig_id);
+            mapping.read_positions.push_back(pos);
+            mapping.unitig_offsets.push_back(search->second.offset);
+        }
+        ++pos;
+    }
+}
+
+
+template <template <class, class> class GraphType,
+          class StorageType,
+          class ShifterType>
+auto
+UnitigMapper<GraphType<StorageType, ShifterType>>::
+Mapper::map_sequences(const std::vector<std::string>& sequences,
+                      unsigned int                    n_threads) const
+-> std::vector<ReadMapping> {
+
+    std::vector<ReadMapping> mappings(sequences.size());
+
+    // each worker writes its own contiguous slice of the output,
+    // so no synchronization is needed
+    parallel_for_ranges(sequences.size(), n_threads,
+                        [&](size_t begin, size_t end) {
+                            _map_range(sequences, mappings, begin, end);
+                        });
+
+    return mappings;
+}
+
+
+template <template <class, class> class GraphType,
+          class StorageType,
+          class ShifterType>
+auto
+UnitigMapper<GraphType<StorageType, ShifterType>>::
+Mapper::map_sequences(std::shared_ptr<FastxParser<>>& parser,
+                      size_t                          batch_size,
+                      unsigned int                    n_threads) const
+-> std::vector<ReadMapping> {
+
+    std::vector<std::string> names;
+    std::vector<std::string> sequences;
+    names.reserve(batch_size);
+    sequences.reserve(batch_size);
+
+    while (!parser->is_complete() && sequences.size() < batch_size) {
+        std::optional<Record> record;
+        try {
+            record = parser->next();
+        } catch (InvalidCharacterException& e) {
+            continue;
+        } catch (InvalidRead& e) {
+            continue;
+        }
+        if (!record) {
+            continue;
+        }
+        names.push_back(std::move(record->name));
+        sequences.push_back(std::move(record->sequence));
+    }
+
+    auto mappings = map_sequences(sequences, n_threads);
+    for (size_t i = 0; i < mappings.size(); ++i) {
+        mappings[i].name = std::move(names[i]);
+    }
+
+    return mappings;
+}
+
+
+template class UnitigMapper<goetia::dBG<BitStorage, FwdLemireShifter>>;
+template class UnitigMapper<goetia::dBG<BitStorage, CanLemireShifter>>;
+
+template class UnitigMapper<goetia::dBG<SparseppSetStorage, FwdLemireShifter>>;
+template class UnitigMapper<goetia::dBG<SparseppSetStorage, CanLemireShifter>>;
+
+template class UnitigMapper<goetia::dBG<PHMapStorage, FwdLemireShifter>>;
+template class UnitigMapper<goetia::dBG<PHMapStorage, CanLemireShifter>>;
+
+}
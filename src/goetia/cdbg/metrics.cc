@@ -8,3 +8,74 @@
  */
 
 #include "goetia/cdbg/metrics.hh"
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace goetia {
+
+
+uint64_t
+UnitigLengthHistogram::nx(double   fraction,
+                          uint64_t genome_size) const {
+
+    uint64_t reference = genome_size ? genome_size : total_bases();
+    uint64_t target    = std::ceil(fraction * reference);
+    if (target == 0) {
+        return 0;
+    }
+
+    uint64_t cumulative = 0;
+    for (size_t i = N_BUCKETS; i-- > 0; ) {
+        uint64_t count = bucket_count(i);
+        if (count == 0) {
+            continue;
+        }
+        uint64_t bases = bucket_bases(i);
+        cumulative += bases;
+        if (cumulative >= target) {
+            return bases / count;
+        }
+    }
+
+    return 0;
+}
+
+
+std::vector<size_t>
+UnitigLengthHistogram::kmers_per_bin(const std::vector<size_t>& bins,
+                                     uint16_t                   K) const {
+
+    std::vector<size_t> bin_sums(bins.size(), 0);
+    if (bins.empty()) {
+        return bin_sums;
+    }
+
+    auto bin_of = [&bins](uint64_t length) -> size_t {
+        return std::upper_bound(bins.begin(), bins.end(), length) - bins.begin() - 1;
+    };
+
+    // the short unitigs by exact length, the rest by bucket
+    for (uint64_t length = bins.front(); length < EXACT_LENGTHS; ++length) {
+        uint64_t count = _exact_counts[length].load(std::memory_order_relaxed);
+        if (count != 0) {
+            bin_sums[bin_of(length)] += count * (length - (K - 1));
+        }
+    }
+    for (size_t i = bucket_index(EXACT_LENGTHS); i < N_BUCKETS; ++i) {
+        uint64_t count = bucket_count(i);
+        if (count == 0) {
+            continue;
+        }
+        uint64_t lower = bucket_lower(i);
+        if (lower < bins.front()) {
+            continue;
+        }
+        bin_sums[bin_of(lower)] += bucket_bases(i) - count * (K - 1);
+    }
+
+    return bin_sums;
+}
+
+}
@@ -0,0 +1,322 @@
+/**
+ * (c) Camille Scott, 2026
+ * File   : static_compactor.cc
+ * License: MIT
+ * Author : Camille Scott <camille.scott.w@gmail.com>
+ * Date   : 18.10.2026
+ */
+
+#include <algorithm>
+#include <type_traits>
+
+#include "goetia/cdbg/static_compactor.hh"
+#include "goetia/storage/storage_types.hh"
+#include "goetia/hashing/rollinghashshifter.hh"
+
+namespace goetia {
+
+
+template <template <class, class> class GraphType,
+          class StorageType,
+          class ShifterType>
+void
+StaticCompactor<GraphType<StorageType, ShifterType>>::
+_build_dnodes(const std::vector<std::string>& sequences) {
+
+    const unsigned int n_shards = resolve_n_threads(n_threads, sequences.size());
+    std::vector<std::vector<kmer_type>> shards(n_shards);
+    std::vector<uint64_t>               shard_kmers(n_shards, 0);
+    size_t chunk_size = sequences.empty() ? 0 : (sequences.size() + n_shards - 1) / n_shards;
+
+    parallel_for_ranges(sequences.size(), n_shards,
+                        [&](size_t begin, size_t end) {
+                            const size_t shard = begin / chunk_size;
+                            auto& found = shards[shard];
+                            // shares dbg's storage, but has its own cursor
+                            graph_type walker(*dbg);
+
+                            for (size_t i = begin; i < end; ++i) {
+                                const std::string& sequence = sequences[i];
+                                if (sequence.size() < K) {
+                                    continue;
+                                }
+                                hash_type h = walker.set_cursor(sequence);
+                                for (size_t pos = 0; ; ++pos) {
+                                    ++shard_kmers[shard];
+                                    if (walker.in_degree() > 1 || walker.out_degree() > 1) {
+                                        found.push_back(kmer_type{h, walker.get_cursor()});
+                                    }
+                                    if (pos + K >= sequence.size()) {
+                                        break;
+                                    }
+                                    h = walker.shift_right(sequence[pos + K]);
+                                }
+                            }
+                        });
+
+    std::vector<kmer_type> new_dkmers;
+    for (unsigned int shard = 0; shard < n_shards; ++shard) {
+        report.n_kmers += shard_kmers[shard];
+        for (auto& kmer : shards[shard]) {
+            if (decision_kmers.insert(kmer.value()).second) {
+                new_dkmers.push_back(std::move(kmer));
+            }
+        }
+    }
+    std::sort(new_dkmers.begin(), new_dkmers.end(),
+              [](const kmer_type& a, const kmer_type& b) { return a.value() < b.value(); });
+
+    auto lock = cdbg->lock_nodes();
+    for (auto& kmer : new_dkmers) {
+        cdbg->build_dnode(kmer.hash, kmer.kmer);
+    }
+    report.n_dnodes += new_dkmers.size();
+}
+
+
+template <template <class, class> class GraphType,
+          class StorageType,
+          class ShifterType>
+auto
+StaticCompactor<GraphType<StorageType, ShifterType>>::
+_walk_unitig(graph_type&               walker,
+             const char *              seed,
+             std::vector<value_type>&  kmers)
+-> FoundUnitig {
+
+    walker.set_cursor(seed);
+    auto lwalk = walker.walk_left();
+    walker.set_cursor(seed);
+    auto rwalk = walker.walk_right();
+
+    // a walk stopping on DECISION_FWD has stepped on to a k-mer with
+    // several onward neighbors, which is a decision k-mer
+    if (lwalk.end_state == State::DECISION_FWD && lwalk.path.size()) {
+        lwalk.path.pop_back();
+    }
+    if (rwalk.end_state == State::DECISION_FWD && rwalk.path.size()) {
+        rwalk.path.pop_back();
+    }
+
+    FoundUnitig unitig;
+    unitig.circular = false;
+
+    kmers.clear();
+    kmers.push_back(rwalk.start.value());
+    for (const auto& shift : rwalk.path) {
+        kmers.push_back(shift.value());
+    }
+
+    if (lwalk.end_state == State::STOP_SEEN && rwalk.end_state == State::STOP_SEEN) {
+        // rwalk came all the way back around to the seed, so its sequence has
+        // period n; the seed's last base completes it. With canonical hashing
+        // the walk can instead have folded back on to the reverse complement,
+        // which isn't a cycle.
+        const std::string cycle = rwalk.to_string();
+        const size_t      n     = rwalk.path.size() + 1;
+        if ((cycle + seed[K - 1]).substr(n) == std::string(seed, K)) {
+            const size_t anchor = std::min_element(kmers.begin(), kmers.end()) - kmers.begin();
+            unitig.key = kmers[anchor];
+            // rotate to start at the smallest k-mer, which is then both ends,
+            // as the streaming compactor represents circular unitigs
+            const std::string period = cycle.substr(0, n);
+            std::string rotated;
+            while (rotated.size() < anchor + n + K - 1) {
+                rotated += period;
+            }
+            unitig.sequence  = rotated.substr(anchor, n + K - 1);
+            unitig.left_end  = shifter_type::hash(unitig.sequence.substr(0, K), K);
+            unitig.right_end = unitig.left_end;
+            unitig.circular  = true;
+            return unitig;
+        }
+    }
+
+    for (const auto& shift : lwalk.path) {
+        kmers.push_back(shift.value());
+    }
+    unitig.key = *std::min_element(kmers.begin(), kmers.end());
+    unitig.sequence  = lwalk.glue(rwalk);
+    unitig.left_end  = lwalk.tail();
+    unitig.right_end = rwalk.tail();
+
+    return unitig;
+}
+
+
+template <template <class, class> class GraphType,
+          class StorageType,
+          class ShifterType>
+void
+StaticCompactor<GraphType<StorageType, ShifterType>>::
+_orient_unitig(FoundUnitig& unitig) const {
+
+    if constexpr (std::is_same_v<hash_type, Canonical<value_type>>) {
+        typedef typename shifter_type::alphabet alphabet;
+
+        const std::string rc = alphabet::reverse_complement(unitig.sequence);
+        if (unitig.circular) {
+            // the rc strand's k-mer at n - 1 is the reverse complement of
+            // the anchor; rotate it to the front
+            const size_t      n      = unitig.sequence.size() - K + 1;
+            const std::string period = rc.substr(0, n);
+            std::string rotated;
+            while (rotated.size() < 2 * n + K - 2) {
+                rotated += period;
+            }
+            rotated = rotated.substr(n - 1, n + K - 1);
+            if (rotated < unitig.sequence) {
+                unitig.sequence  = std::move(rotated);
+                unitig.left_end  = shifter_type::hash(unitig.sequence.substr(0, K), K);
+                unitig.right_end = unitig.left_end;
+            }
+        } else if (rc < unitig.sequence) {
+            unitig.sequence  = rc;
+            unitig.left_end  = shifter_type::hash(unitig.sequence.substr(0, K), K);
+            unitig.right_end = shifter_type::hash(unitig.sequence.substr(unitig.sequence.size() - K), K);
+        }
+    }
+}
+
+
+template <template <class, class> class GraphType,
+          class StorageType,
+          class ShifterType>
+uint64_t
+StaticCompactor<GraphType<StorageType, ShifterType>>::
+_build_unodes(const std::vector<std::string>& sequences) {
+
+    const unsigned int n_shards = resolve_n_threads(n_threads, sequences.size());
+    std::vector<std::vector<FoundUnitig>> shards(n_shards);
+    size_t chunk_size = sequences.empty() ? 0 : (sequences.size() + n_shards - 1) / n_shards;
+
+    parallel_for_ranges(sequences.size(), n_shards,
+                        [&](size_t begin, size_t end) {
+                            const size_t shard = begin / chunk_size;
+                            auto& found = shards[shard];
+                            graph_type walker(*dbg);
+                            std::vector<value_type> kmers;
+
+                            for (size_t i = begin; i < end; ++i) {
+                                const std::string& sequence = sequences[i];
+                                if (sequence.size() < K) {
+                                    continue;
+                                }
+                                hash_type h = walker.set_cursor(sequence);
+                                for (size_t pos = 0; ; ++pos) {
+                                    const value_type v = h.value();
+                                    if (!decision_kmers.count(v) && !covered.count(v)) {
+                                        auto unitig = _walk_unitig(walker, sequence.c_str() + pos, kmers);
+                                        if (claimed.insert(unitig.key).second) {
+                                            covered.insert(kmers.begin(), kmers.end());
+                                            _orient_unitig(unitig);
+                                            found.push_back(std::move(unitig));
+                                        }
+                                        if (pos + K < sequence.size()) {
+                                            walker.set_cursor(sequence.c_str() + pos);
+                                        }
+                                    }
+                                    if (pos + K >= sequence.size()) {
+                                        break;
+                                    }
+                                    h = walker.shift_right(sequence[pos + K]);
+                                }
+                            }
+                        });
+
+    std::vector<FoundUnitig> unitigs;
+    for (auto& shard : shards) {
+        std::move(shard.begin(), shard.end(), std::back_inserter(unitigs));
+    }
+    std::sort(unitigs.begin(), unitigs.end());
+
+    std::vector<hash_type> tags;
+    auto lock = cdbg->lock_nodes();
+    for (const auto& unitig : unitigs) {
+        cdbg->build_unode(unitig.sequence, tags, unitig.left_end, unitig.right_end);
+        if (unitig.circular) {
+            ++report.n_circular;
+        }
+    }
+    report.n_unodes += unitigs.size();
+
+    return unitigs.size();
+}
+
+
+template <template <class, class> class GraphType,
+          class StorageType,
+          class ShifterType>
+uint64_t
+StaticCompactor<GraphType<StorageType, ShifterType>>::
+compact(const std::vector<std::string>& sequences) {
+
+    _build_dnodes(sequences);
+    return _build_unodes(sequences);
+}
+
+
+template <template <class, class> class GraphType,
+          class StorageType,
+          class ShifterType>
+bool
+StaticCompactor<GraphType<StorageType, ShifterType>>::
+_read_batch(std::shared_ptr<FastxParser<>>& parser,
+            std::vector<std::string>&       sequences,
+            size_t                          batch_size) {
+
+    sequences.clear();
+    while (!parser->is_complete() && sequences.size() < batch_size) {
+        std::optional<Record> record;
+        try {
+            record = parser->next();
+        } catch (InvalidCharacterException &e) {
+            continue;
+        } catch (InvalidRead& e) {
+            continue;
+        }
+
+        if (record) {
+            sequences.push_back(std::move(record.value().sequence));
+        }
+    }
+    return !sequences.empty();
+}
+
+
+template <template <class, class> class GraphType,
+          class StorageType,
+          class ShifterType>
+uint64_t
+StaticCompactor<GraphType<StorageType, ShifterType>>::
+compact(const std::string& filename,
+        size_t             batch_size) {
+
+    std::vector<std::string> sequences;
+    sequences.reserve(batch_size);
+
+    auto parser = FastxParser<>::build(filename);
+    while (_read_batch(parser, sequences, batch_size)) {
+        _build_dnodes(sequences);
+    }
+
+    uint64_t n_unodes = 0;
+    parser = FastxParser<>::build(filename);
+    while (_read_batch(parser, sequences, batch_size)) {
+        n_unodes += _build_unodes(sequences);
+    }
+
+    return n_unodes;
+}
+
+}
+
+
+template class goetia::StaticCompactor<goetia::dBG<goetia::SparseppSetStorage, goetia::FwdLemireShifter>>;
+template class goetia::StaticCompactor<goetia::dBG<goetia::SparseppSetStorage, goetia::CanLemireShifter>>;
+
+template class goetia::StaticCompactor<goetia::dBG<goetia::PHMapStorage, goetia::FwdLemireShifter>>;
+template class goetia::StaticCompactor<goetia::dBG<goetia::PHMapStorage, goetia::CanLemireShifter>>;
+
+template class goetia::StaticCompactor<goetia::dBG<goetia::BTreeStorage, goetia::FwdLemireShifter>>;
+template class goetia::StaticCompactor<goetia::dBG<goetia::BTreeStorage, goetia::CanLemireShifter>>;
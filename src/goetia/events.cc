@@ -0,0 +1,324 @@
+/**
+ * (c) Camille Scott, 2026
+ * File   : events.cc
+ * License: MIT
+ * Author : Camille Scott <camille.scott.w@gmail.com>
+ * Date   : 18.10.2026
+ */
+
+#include "goetia/events.hh"
+
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+
+
+namespace goetia {
+
+namespace {
+
+    constexpr const char * EVENT_TYPE_NAMES[] = {
+        "SampleStarted",
+        "Interval",
+        "SampleFinished",
+        "SampleSaturated",
+        "DistanceCalc",
+        "Error",
+        "EndStream"
+    };
+
+    // JSON has no NaN
+    void write_json_double(std::ostream& os, double value) {
+        if (std::isfinite(value)) {
+            os << value;
+        } else {
+            os << "null";
+        }
+    }
+
+    void write_json_string(std::ostream& os, const std::string& value) {
+        os << '"';
+        for (const char c : value) {
+            switch (c) {
+                case '"':  os << "\\\""; break;
+                case '\\': os << "\\\\"; break;
+                case '\n': os << "\\n"; break;
+                case '\r': os << "\\r"; break;
+                case '\t': os << "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        char escaped[7];
+                        std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                        os << escaped;
+                    } else {
+                        os << c;
+                    }
+            }
+        }
+        os << '"';
+    }
+
+    void open_json_list(std::ofstream& out, const std::string& filename) {
+        out.open(filename);
+        if (!out) {
+            throw GoetiaFileException("Could not open " + filename + " for writing.");
+        }
+        out << '[';
+    }
+
+    void write_json_item(std::ofstream& out, uint64_t& n_writes, const std::string& item) {
+        if (n_writes != 0) {
+            out << ",\n";
+        }
+        out << item;
+        out.flush();
+        ++n_writes;
+    }
+
+}
+
+
+const char * stream_event_type_name(StreamEventType type) {
+    return EVENT_TYPE_NAMES[static_cast<size_t>(type)];
+}
+
+
+std::string StreamEvent::to_json() const {
+    std::ostringstream os;
+    os << std::setprecision(17)
+       << "{\"msg_type\": \"" << stream_event_type_name(type) << '"'
+       << ", \"sample_id\": " << sample_id
+       << ", \"t\": " << t
+       << ", \"sequence\": " << sequence
+       << ", \"timestamp\": ";
+    write_json_double(os, timestamp);
+    if (type == DISTANCE_CALC) {
+        os << ", \"distance\": ";
+        write_json_double(os, distance);
+        os << ", \"stat\": ";
+        write_json_double(os, stat);
+    }
+    os << '}';
+    return os.str();
+}
+
+
+constexpr std::chrono::milliseconds StreamEventBus::POLL_INTERVAL;
+
+
+StreamEventBus::StreamEventBus(uint64_t capacity)
+    : queue(capacity),
+      _sample_id(0),
+      _stop_requested(false),
+      _running(false)
+{
+}
+
+
+StreamEventBus::~StreamEventBus() {
+    stop();
+}
+
+
+void StreamEventBus::subscribe(std::shared_ptr<StreamEventSubscriber> subscriber,
+                               bool                                   synchronous) {
+    if (synchronous) {
+        sync_subscribers.push_back(subscriber);
+    } else {
+        async_subscribers.push_back(subscriber);
+    }
+}
+
+
+bool StreamEventBus::publish(const StreamEvent& event) {
+    const bool queued = queue.push(event);
+    if (queued && _running.load(std::memory_order_relaxed)) {
+        // doesn't take the mutex, so the publisher never waits on the
+        // dispatcher; a missed wakeup costs at most POLL_INTERVAL
+        wake.notify_one();
+    }
+
+    for (auto& subscriber : sync_subscribers) {
+        subscriber->on_event(event, *this);
+    }
+
+    return queued;
+}
+
+
+bool StreamEventBus::sample_started(uint32_t sample_id, uint64_t t, uint64_t sequence) {
+    _sample_id.store(sample_id, std::memory_order_relaxed);
+    _stop_requested.store(false, std::memory_order_relaxed);
+    return publish(StreamEvent(SAMPLE_STARTED, sample_id, t, sequence));
+}
+
+
+size_t StreamEventBus::dispatch(size_t max_events) {
+    size_t n_dispatched = 0;
+    StreamEvent event;
+    while (n_dispatched < max_events && queue.pop(event)) {
+        for (auto& subscriber : async_subscribers) {
+            subscriber->on_event(event, *this);
+        }
+        ++n_dispatched;
+    }
+    return n_dispatched;
+}
+
+
+void StreamEventBus::run_dispatcher() {
+    while (true) {
+        if (dispatch() > 0) {
+            continue;
+        }
+        if (!_running.load(std::memory_order_acquire)) {
+            // anything published before stop() is delivered
+            dispatch();
+            return;
+        }
+        std::unique_lock<std::mutex> lock(wake_mutex);
+        wake.wait_for(lock, POLL_INTERVAL);
+    }
+}
+
+
+void StreamEventBus::start() {
+    if (_running.exchange(true)) {
+        return;
+    }
+    dispatcher = std::thread(&StreamEventBus::run_dispatcher, this);
+}
+
+
+void StreamEventBus::stop() {
+    if (!_running.exchange(false)) {
+        return;
+    }
+    wake.notify_one();
+    if (dispatcher.joinable()) {
+        dispatcher.join();
+    }
+}
+
+
+void StreamEventCollector::on_event(const StreamEvent& event, StreamEventBus&) {
+    std::lock_guard<std::mutex> lock(mutex);
+    buffer.push_back(event);
+}
+
+
+std::vector<StreamEvent> StreamEventCollector::collect() {
+    std::vector<StreamEvent> events;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        events.swap(buffer);
+    }
+    return events;
+}
+
+
+JSONEventWriter::JSONEventWriter(const std::string& filename)
+    : n_writes(0)
+{
+    open_json_list(out, filename);
+}
+
+
+JSONEventWriter::~JSONEventWriter() {
+    close();
+}
+
+
+void JSONEventWriter::on_event(const StreamEvent& event, StreamEventBus&) {
+    if (out.is_open()) {
+        write_json_item(out, n_writes, event.to_json());
+    }
+}
+
+
+void JSONEventWriter::close() {
+    if (out.is_open()) {
+        out << ']';
+        out.close();
+    }
+}
+
+
+MetricSnapshotter::MetricSnapshotter(const std::string& filename)
+    : n_writes(0)
+{
+    open_json_list(out, filename);
+}
+
+
+MetricSnapshotter::~MetricSnapshotter() {
+    close();
+}
+
+
+void MetricSnapshotter::on_event(const StreamEvent& event, StreamEventBus&) {
+    if (!out.is_open() || (event.type != INTERVAL && event.type != SAMPLE_FINISHED)) {
+        return;
+    }
+
+    std::ostringstream os;
+    os << std::setprecision(17)
+       << "{\"t\": " << event.t
+       << ", \"sequence\": " << event.sequence
+       << ", \"sample_id\": " << event.sample_id
+       << ", \"timestamp\": ";
+    write_json_double(os, event.timestamp);
+    for (const auto& [name, reader] : metrics) {
+        os << ", ";
+        write_json_string(os, name);
+        os << ": ";
+        write_json_double(os, reader());
+    }
+    os << '}';
+
+    write_json_item(out, n_writes, os.str());
+}
+
+
+void MetricSnapshotter::close() {
+    if (out.is_open()) {
+        out << ']';
+        out.close();
+    }
+}
+
+
+void ProfileSnapshotter::on_event(const StreamEvent& event, StreamEventBus&) {
+    if (event.type != INTERVAL && event.type != SAMPLE_FINISHED) {
+        return;
+    }
+
+    Snapshot snapshot;
+    if (event.type == INTERVAL) {
+        if (perf_counters) {
+            snapshot.perf_counters = profiler->take_interval();
+        }
+        if (latencies) {
+            snapshot.latencies = profiler->take_latencies();
+        }
+    } else if (latencies) {
+        snapshot.latencies = profiler->take_sample_latencies();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    snapshots[key_type(event.sample_id, event.t, event.type)] = std::move(snapshot);
+}
+
+
+auto ProfileSnapshotter::take(const StreamEvent& event) -> Snapshot {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = snapshots.find(key_type(event.sample_id, event.t, event.type));
+    if (it == snapshots.end()) {
+        return Snapshot();
+    }
+    Snapshot snapshot = std::move(it->second);
+    snapshots.erase(it);
+    return snapshot;
+}
+
+}
@@ -6,35 +6,221 @@
  * Date   : 15.01.2020
  */
 
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "goetia/hashing/rollinghashshifter.hh"
 #include "goetia/hashing/hashshifter.hh"
 #include "goetia/hashing/ukhs.hh"
+#include "goetia/utils/binary_io.hh"
 
 
 namespace goetia {
 
+    template<class ShifterType>
+    constexpr char UKHS<ShifterType>::TABLE_MAGIC[8];
+
+    template<class ShifterType>
+    constexpr uint16_t UKHS<ShifterType>::TABLE_VERSION;
+
+
     template<class ShifterType>
     UKHS<ShifterType>::UKHS(uint16_t W, uint16_t K,
                             std::vector<std::string>& unikmers)
-        : K (K),
-          W (W)
+        : W (W),
+          K (K)
     {
         if (unikmers.front().size() != K) {
             throw GoetiaException("K does not match k-mer size from provided UKHS");
         }
-        
-        uint64_t pid = 0;
+
+        unikmer_codes.reserve(unikmers.size());
         for (const std::string& unikmer : unikmers) {
-            hash_type h = shifter_type::hash(unikmer, K);
+            unikmer_codes.push_back(TwoBitCode::encode(unikmer.c_str(), K));
+        }
+        init_from_codes();
+    }
+
+
+    template<class ShifterType>
+    UKHS<ShifterType>::UKHS(uint16_t W, uint16_t K,
+                            std::vector<uint64_t>&& codes)
+        : unikmer_codes (std::move(codes)),
+          W (W),
+          K (K)
+    {
+        init_from_codes();
+    }
+
+
+    template<class ShifterType>
+    void
+    UKHS<ShifterType>::init_from_codes() {
+        if (K > 32) {
+            throw GoetiaException("UKHS K must be at most 32.");
+        }
 
-            if (!pmap.count(h.value())) {
+        std::vector<std::pair<uint64_t, uint32_t>> codes;
+        std::vector<char> unikmer(K);
+        shifter_type hasher(K);
+        uint64_t pid = 0;
+
+        pmap.reserve(unikmer_codes.size());
+        hashes.reserve(unikmer_codes.size());
+        if (K <= MAX_DIRECT_K) {
+            codes.reserve(is_canonical ? 2 * unikmer_codes.size() : unikmer_codes.size());
+        }
+
+        for (const uint64_t code : unikmer_codes) {
+            TwoBitCode::decode(code, K, unikmer.data());
+            hash_type h = hasher.hash_base(unikmer.data());
+
+            if (pmap.insert({h.value(), pid}).second) {
                 hashes.push_back(h);
-                pmap[h.value()] = pid;
+                if (K <= MAX_DIRECT_K) {
+                    index_unikmer_code(code, pid, codes);
+                }
                 ++pid;
             }
         }
+
+        if (K <= MAX_DIRECT_K) {
+            build_direct_index(codes);
+        }
+    }
+
+
+    template<class ShifterType>
+    std::shared_ptr<UKHS<ShifterType>>
+    UKHS<ShifterType>::load(const std::string& filename,
+                            uint16_t           W) {
+        std::ifstream in(filename, std::ios::binary);
+        if (!in) {
+            throw GoetiaFileException("Could not open UKHS table " + filename);
+        }
+        return load(in, W);
+    }
+
+
+    template<class ShifterType>
+    std::shared_ptr<UKHS<ShifterType>>
+    UKHS<ShifterType>::load(std::istream& in,
+                            uint16_t      W) {
+        char magic[sizeof(TABLE_MAGIC)];
+        in.read(magic, sizeof(TABLE_MAGIC));
+        if (!in || std::memcmp(magic, TABLE_MAGIC, sizeof(TABLE_MAGIC)) != 0) {
+            throw GoetiaFileException("Invalid UKHS table header.");
+        }
+
+        uint16_t version = read_le(in, 2);
+        if (version != TABLE_VERSION) {
+            throw GoetiaFileException("Unsupported UKHS table version: "
+                                      + std::to_string(version));
+        }
+        uint16_t table_W = read_le(in, 2);
+        uint16_t K       = read_le(in, 2);
+        uint64_t n_unikmers = read_le(in, 8);
+        if (!in) {
+            throw GoetiaFileException("Truncated UKHS table header.");
+        }
+        if (K == 0 || K > 32) {
+            throw GoetiaFileException("Invalid UKHS table K: " + std::to_string(K));
+        }
+        // codes are distinct K-mers, so there can't be more than 4^K of them
+        const uint64_t max_code = K == 32 ? std::numeric_limits<uint64_t>::max()
+                                          : (uint64_t(1) << (2 * K)) - 1;
+        if (n_unikmers > max_code) {
+            throw GoetiaFileException("Invalid UKHS table size: " + std::to_string(n_unikmers));
+        }
+        if (W == 0) {
+            W = table_W;
+        } else if (W < table_W) {
+            throw GoetiaException("Requested W (" + std::to_string(W) + ") is smaller than "
+                                  "the UKHS table W (" + std::to_string(table_W) + ").");
+        }
+
+        // read the code block in chunks and decode in place, so that a bad
+        // count can't allocate more than the table actually holds
+        constexpr uint64_t CHUNK = 1 << 16;
+        std::vector<uint64_t> codes;
+        while (codes.size() < n_unikmers) {
+            const size_t start = codes.size();
+            const size_t n     = std::min(CHUNK, n_unikmers - start);
+            codes.resize(start + n);
+            in.read(reinterpret_cast<char*>(codes.data() + start), n * sizeof(uint64_t));
+            if (!in) {
+                throw GoetiaFileException("Truncated UKHS table.");
+            }
+            for (size_t i = start; i < codes.size(); ++i) {
+                codes[i] = read_le(reinterpret_cast<const uint8_t*>(&codes[i]), 8);
+                if (codes[i] > max_code) {
+                    throw GoetiaFileException("Invalid UKHS table code: " + std::to_string(codes[i]));
+                }
+            }
+        }
+
+        return std::make_shared<UKHS>(W, K, std::move(codes));
+    }
+
+
+    template<class ShifterType>
+    void
+    UKHS<ShifterType>::save(const std::string& filename) const {
+        std::ofstream out(filename, std::ios::binary);
+        if (!out) {
+            throw GoetiaFileException("Could not open UKHS table " + filename + " for writing.");
+        }
+        save(out);
+    }
+
+
+    template<class ShifterType>
+    void
+    UKHS<ShifterType>::save(std::ostream& out) const {
+        out.write(TABLE_MAGIC, sizeof(TABLE_MAGIC));
+        write_le(out, TABLE_VERSION, 2);
+        write_le(out, W, 2);
+        write_le(out, K, 2);
+        write_le(out, unikmer_codes.size(), 8);
+        for (const uint64_t code : unikmer_codes) {
+            write_le(out, code, 8);
+        }
+    }
+
+
+    template<class ShifterType>
+    void
+    UKHS<ShifterType>::build_direct_index(std::vector<std::pair<uint64_t, uint32_t>>& codes) {
+
+        // reverse-complement palindromes are added twice under canonical
+        // hashing; keep the first partition seen for each code
+        std::stable_sort(codes.begin(), codes.end(),
+                         [](const auto& a, const auto& b) { return a.first < b.first; });
+        codes.erase(std::unique(codes.begin(), codes.end(),
+                                [](const auto& a, const auto& b) { return a.first == b.first; }),
+                    codes.end());
+
+        const size_t n_words = std::max<size_t>(1, (uint64_t(1) << (2 * K)) >> 6);
+        code_bits.assign(n_words, 0);
+        code_ranks.assign(n_words, 0);
+        code_partitions.clear();
+        code_partitions.reserve(codes.size());
+
+        for (const auto& [code, partition] : codes) {
+            code_bits[code >> 6] |= uint64_t(1) << (code & 63);
+            code_partitions.push_back(partition);
+        }
+
+        uint32_t rank = 0;
+        for (size_t word = 0; word < n_words; ++word) {
+            code_ranks[word] = rank;
+            rank += __builtin_popcountll(code_bits[word]);
+        }
     }
 
 
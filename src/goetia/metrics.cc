@@ -9,8 +9,97 @@
 
 #include "goetia/metrics.hh"
 
+#include <cmath>
+
 namespace goetia {
 
+    LatencyHistogram::LatencyHistogram() {
+        clear();
+    }
+
+
+    uint64_t LatencyHistogram::bucket_upper_bound(size_t index) {
+        if (index < 2 * SUB_BUCKETS) {
+            return index;
+        }
+        const unsigned shift = index / SUB_BUCKETS - 1;
+        const uint64_t lower = (SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+        return lower + ((1ULL << shift) - 1);
+    }
+
+
+    double LatencyHistogram::mean() const {
+        const uint64_t n = count();
+        return n == 0 ? 0.0 : static_cast<double>(_sum.load(std::memory_order_relaxed)) / n;
+    }
+
+
+    uint64_t LatencyHistogram::value_at_quantile(double quantile) const {
+        const uint64_t n = count();
+        if (n == 0) {
+            return 0;
+        }
+
+        quantile = std::clamp(quantile, 0.0, 1.0);
+        const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(quantile * n)));
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < N_BUCKETS; ++i) {
+            seen += _buckets[i].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                return std::min(bucket_upper_bound(i), max());
+            }
+        }
+        return max();
+    }
+
+
+    void LatencyHistogram::merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < N_BUCKETS; ++i) {
+            const uint64_t n = other._buckets[i].load(std::memory_order_relaxed);
+            if (n) {
+                _buckets[i].fetch_add(n, std::memory_order_relaxed);
+            }
+        }
+        _count.fetch_add(other.count(), std::memory_order_relaxed);
+        _sum.fetch_add(other._sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+        const uint64_t other_max = other.max();
+        uint64_t current = max();
+        while (other_max > current &&
+               !_max.compare_exchange_weak(current, other_max, std::memory_order_relaxed));
+    }
+
+
+    void LatencyHistogram::drain_into(LatencyHistogram& other) {
+        for (size_t i = 0; i < N_BUCKETS; ++i) {
+            if (_buckets[i].load(std::memory_order_relaxed)) {
+                other._buckets[i].fetch_add(_buckets[i].exchange(0, std::memory_order_relaxed),
+                                            std::memory_order_relaxed);
+            }
+        }
+        other._count.fetch_add(_count.exchange(0, std::memory_order_relaxed),
+                               std::memory_order_relaxed);
+        other._sum.fetch_add(_sum.exchange(0, std::memory_order_relaxed),
+                             std::memory_order_relaxed);
+
+        const uint64_t drained_max = _max.exchange(0, std::memory_order_relaxed);
+        uint64_t current = other.max();
+        while (drained_max > current &&
+               !other._max.compare_exchange_weak(current, drained_max, std::memory_order_relaxed));
+    }
+
+
+    void LatencyHistogram::clear() {
+        for (auto& bucket : _buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        _count.store(0, std::memory_order_relaxed);
+        _sum.store(0, std::memory_order_relaxed);
+        _max.store(0, std::memory_order_relaxed);
+    }
+
+
     template class ReservoirSample<uint64_t>;
     template class ReservoirSample<double>;
     template class ReservoirSample<float>;
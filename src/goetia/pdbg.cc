@@ -33,4 +33,7 @@ namespace goetia {
     template class PdBG<QFStorage, FwdUnikmerShifter>;
     template class PdBG<QFStorage, CanUnikmerShifter>;
 
+    template class PdBG<HLLStorage, FwdUnikmerShifter>;
+    template class PdBG<HLLStorage, CanUnikmerShifter>;
+
 }
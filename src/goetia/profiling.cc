@@ -0,0 +1,319 @@
+/**
+ * (c) Camille Scott, 2026
+ * File   : profiling.cc
+ * License: MIT
+ * Author : Camille Scott <camille.scott.w@gmail.com>
+ * Date   : 18.10.2026
+ */
+
+#include "goetia/profiling.hh"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+namespace goetia {
+
+namespace {
+
+    thread_local ScopeLatencies * active_latencies = nullptr;
+
+    constexpr const char * SCOPE_NAMES[N_PROFILE_SCOPES] = {
+        "parse",
+        "validate",
+        "process",
+        "hash",
+        "storage_insert",
+        "compactor_update"
+    };
+
+    constexpr const char * EVENT_NAMES[N_PERF_EVENTS] = {
+        "cycles",
+        "instructions",
+        "llc_misses",
+        "dtlb_misses",
+        "branch_misses"
+    };
+
+#ifdef __linux__
+
+    struct EventConfig {
+        uint32_t type;
+        uint64_t config;
+    };
+
+    // in PerfEvent order
+    constexpr EventConfig EVENT_CONFIGS[N_PERF_EVENTS] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB
+                             | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                             | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES}
+    };
+
+    int open_event(const EventConfig& event, int group_fd) {
+        perf_event_attr attr{};
+        attr.size           = sizeof(attr);
+        attr.type           = event.type;
+        attr.config         = event.config;
+        attr.read_format    = PERF_FORMAT_GROUP;
+        // user space only, so that it works with perf_event_paranoid <= 2
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        attr.disabled       = group_fd == -1;
+
+        // this thread, on any CPU
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+    }
+
+#endif
+
+}
+
+
+const char * profile_scope_name(ProfileScope scope) {
+    return SCOPE_NAMES[static_cast<size_t>(scope)];
+}
+
+
+const char * perf_event_name(PerfEvent event) {
+    return EVENT_NAMES[static_cast<size_t>(event)];
+}
+
+
+PerfCounterGroup::PerfCounterGroup()
+    : _leader(-1),
+      _n_open(0)
+{
+    _fds.fill(-1);
+    _slots.fill(0);
+
+#ifdef __linux__
+    for (size_t i = 0; i < N_PERF_EVENTS; ++i) {
+        int fd = open_event(EVENT_CONFIGS[i], _leader);
+        if (fd == -1) {
+            continue;
+        }
+        if (_leader == -1) {
+            _leader = fd;
+        }
+        _fds[i]   = fd;
+        _slots[i] = _n_open++;
+    }
+
+    if (_leader != -1) {
+        ioctl(_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+}
+
+
+PerfCounterGroup::~PerfCounterGroup() {
+#ifdef __linux__
+    for (int fd : _fds) {
+        if (fd != -1) {
+            close(fd);
+        }
+    }
+#endif
+}
+
+
+PerfCounterGroup& PerfCounterGroup::this_thread() {
+    thread_local PerfCounterGroup group;
+    return group;
+}
+
+
+void PerfCounterGroup::read(PerfCounts& counts) const {
+    counts.fill(0);
+
+#ifdef __linux__
+    if (_leader == -1) {
+        return;
+    }
+
+    // PERF_FORMAT_GROUP: the number of events, then their values in the
+    // order they were opened
+    uint64_t buffer[N_PERF_EVENTS + 1];
+    if (::read(_leader, buffer, sizeof(buffer)) <= 0) {
+        return;
+    }
+    for (size_t i = 0; i < N_PERF_EVENTS; ++i) {
+        if (_fds[i] != -1) {
+            counts[i] = buffer[1 + _slots[i]];
+        }
+    }
+#endif
+}
+
+
+Profiler::Profiler(bool enabled, bool count_events)
+    : _enabled(enabled),
+      _count_events(count_events)
+{
+    reset();
+}
+
+
+Profiler::Activation::Activation(Profiler * profiler)
+    : _previous(_active),
+      _previous_latencies(active_latencies)
+{
+    if (profiler != nullptr && profiler->is_enabled()) {
+        _active          = profiler;
+        active_latencies = &profiler->thread_latencies();
+    } else {
+        _active          = nullptr;
+        active_latencies = nullptr;
+    }
+}
+
+
+Profiler::Activation::~Activation() {
+    _active          = _previous;
+    active_latencies = _previous_latencies;
+}
+
+
+ScopeLatencies& Profiler::thread_latencies() {
+    const auto id = std::this_thread::get_id();
+
+    std::lock_guard<std::mutex> lock(_threads_mutex);
+    for (auto& thread : _threads) {
+        if (thread->id == id) {
+            return thread->scopes;
+        }
+    }
+    _threads.push_back(std::make_unique<ThreadLatencies>());
+    _threads.back()->id = id;
+    return _threads.back()->scopes;
+}
+
+
+void Profiler::add(ProfileScope scope, const PerfCounts& delta, uint64_t nanoseconds) {
+    const size_t index = static_cast<size_t>(scope);
+
+    auto& totals = _totals[index];
+    totals.calls.fetch_add(1, std::memory_order_relaxed);
+    for (size_t i = 0; i < N_PERF_EVENTS; ++i) {
+        totals.counts[i].fetch_add(delta[i], std::memory_order_relaxed);
+    }
+
+    // only null if the scope outlived the Activation it started under
+    if (active_latencies != nullptr) {
+        (*active_latencies)[index].record(nanoseconds);
+    }
+}
+
+
+bool Profiler::counters_available() const {
+    return PerfCounterGroup::this_thread().is_available();
+}
+
+
+void Profiler::reset() {
+    for (auto& totals : _totals) {
+        totals.calls.store(0, std::memory_order_relaxed);
+        for (auto& count : totals.counts) {
+            count.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(_threads_mutex);
+    for (auto& thread : _threads) {
+        for (auto& histogram : thread->scopes) {
+            histogram.clear();
+        }
+    }
+    for (auto& histogram : _sample_latencies) {
+        histogram.clear();
+    }
+}
+
+
+std::map<std::string, std::map<std::string, uint64_t>> Profiler::take_interval() {
+    std::map<std::string, std::map<std::string, uint64_t>> interval;
+
+    for (size_t scope = 0; scope < N_PROFILE_SCOPES; ++scope) {
+        auto& totals = _totals[scope];
+        const uint64_t calls = totals.calls.exchange(0, std::memory_order_relaxed);
+        if (calls == 0) {
+            continue;
+        }
+
+        auto& counts = interval[SCOPE_NAMES[scope]];
+        counts["calls"] = calls;
+        for (size_t event = 0; event < N_PERF_EVENTS; ++event) {
+            counts[EVENT_NAMES[event]] = totals.counts[event].exchange(0, std::memory_order_relaxed);
+        }
+    }
+
+    return interval;
+}
+
+
+void Profiler::drain_latencies(ScopeLatencies& into) {
+    std::lock_guard<std::mutex> lock(_threads_mutex);
+    for (auto& thread : _threads) {
+        for (size_t scope = 0; scope < N_PROFILE_SCOPES; ++scope) {
+            thread->scopes[scope].drain_into(into[scope]);
+        }
+    }
+}
+
+
+std::map<std::string, std::map<std::string, uint64_t>>
+Profiler::summarize(const ScopeLatencies& latencies) {
+    std::map<std::string, std::map<std::string, uint64_t>> summary;
+
+    for (size_t scope = 0; scope < N_PROFILE_SCOPES; ++scope) {
+        const auto& histogram = latencies[scope];
+        if (histogram.count() == 0) {
+            continue;
+        }
+
+        auto& stats = summary[SCOPE_NAMES[scope]];
+        stats["count"] = histogram.count();
+        stats["mean"]  = static_cast<uint64_t>(histogram.mean());
+        stats["p50"]   = histogram.value_at_quantile(0.5);
+        stats["p99"]   = histogram.value_at_quantile(0.99);
+        stats["p999"]  = histogram.value_at_quantile(0.999);
+        stats["max"]   = histogram.max();
+    }
+
+    return summary;
+}
+
+
+std::map<std::string, std::map<std::string, uint64_t>> Profiler::take_latencies() {
+    auto interval = std::make_unique<ScopeLatencies>();
+    drain_latencies(*interval);
+
+    for (size_t scope = 0; scope < N_PROFILE_SCOPES; ++scope) {
+        _sample_latencies[scope].merge((*interval)[scope]);
+    }
+
+    return summarize(*interval);
+}
+
+
+std::map<std::string, std::map<std::string, uint64_t>> Profiler::take_sample_latencies() {
+    drain_latencies(_sample_latencies);
+
+    auto summary = summarize(_sample_latencies);
+    for (auto& histogram : _sample_latencies) {
+        histogram.clear();
+    }
+
+    return summary;
+}
+
+}
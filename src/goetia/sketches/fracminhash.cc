@@ -0,0 +1,231 @@
+/**
+ * (c) Camille Scott, 2026
+ * File   : fracminhash.cc
+ * License: MIT
+ * Author : Camille Scott <camille.scott.w@gmail.com>
+ * Date   : 18.10.2026
+ */
+
+#include "goetia/sketches/fracminhash.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+#include "goetia/hashing/smhasher/MurmurHash3.h"
+
+
+namespace goetia {
+
+namespace {
+
+    inline char complement(char c) {
+        switch (c) {
+            case 'A': return 'T';
+            case 'C': return 'G';
+            case 'G': return 'C';
+            default:  return 'A';
+        }
+    }
+
+    inline bool is_acgt(char c) {
+        return c == 'A' || c == 'C' || c == 'G' || c == 'T';
+    }
+
+    inline uint64_t murmur64(const char * kmer,
+                             uint16_t     K,
+                             uint32_t     seed) {
+        uint64_t out[2];
+        murmurhash::MurmurHash3_x64_128(kmer, K, seed, out);
+        return out[0];
+    }
+
+    // merge sorted, unique src into sorted, unique dst
+    void merge_sorted(std::vector<uint64_t>&       dst,
+                      const std::vector<uint64_t>& src) {
+        if (src.empty()) {
+            return;
+        }
+        if (dst.empty()) {
+            dst = src;
+            return;
+        }
+        std::vector<uint64_t> merged;
+        merged.reserve(dst.size() + src.size());
+        std::set_union(dst.begin(), dst.end(),
+                       src.begin(), src.end(),
+                       std::back_inserter(merged));
+        dst.swap(merged);
+    }
+
+}
+
+
+FracMinHash::Sketch::Sketch(uint16_t K,
+                            uint64_t scaled,
+                            uint32_t seed,
+                            size_t   batch_size)
+    : _max_hash(max_hash_from_scaled(scaled)),
+      _seed(seed),
+      K(K),
+      scaled(scaled),
+      batch_size(std::max<size_t>(batch_size, 1))
+{
+    if (K == 0) {
+        throw GoetiaException("FracMinHash K must be greater than 0");
+    }
+    if (scaled == 0) {
+        throw GoetiaException("FracMinHash scaled must be greater than 0");
+    }
+    _pending.reserve(this->batch_size);
+}
+
+
+uint64_t FracMinHash::Sketch::hash_kmer(const char * kmer,
+                                        uint16_t     K,
+                                        uint32_t     seed) {
+    std::string rc(K, 'A');
+    for (uint16_t i = 0; i < K; ++i) {
+        rc[K - 1 - i] = complement(kmer[i]);
+    }
+    return murmur64(std::memcmp(kmer, rc.data(), K) < 0 ? kmer : rc.data(), K, seed);
+}
+
+
+size_t FracMinHash::Sketch::hash_sequence(const std::string&     sequence,
+                                          uint16_t               K,
+                                          uint32_t               seed,
+                                          uint64_t               max_hash,
+                                          std::vector<uint64_t>& out,
+                                          std::string&           scratch) {
+    const size_t n = sequence.size();
+    if (n < K) {
+        return 0;
+    }
+
+    // scratch holds the upper-cased sequence followed by its reverse
+    // complement, so the reverse complement of the k-mer at i is the
+    // K bases starting at n - i - K in the second half
+    scratch.resize(2 * n);
+    char * fwd = &scratch[0];
+    char * rev = &scratch[n];
+    for (size_t i = 0; i < n; ++i) {
+        char c = sequence[i];
+        if (c >= 'a' && c <= 'z') {
+            c -= 'a' - 'A';
+        }
+        fwd[i] = c;
+        rev[n - 1 - i] = complement(c);
+    }
+
+    size_t n_kmers   = 0;
+    // number of consecutive ACGT bases ending at the current position
+    size_t run       = 0;
+    for (size_t end = 0; end < n; ++end) {
+        if (is_acgt(fwd[end])) {
+            ++run;
+        } else {
+            run = 0;
+            continue;
+        }
+        if (run < K) {
+            continue;
+        }
+        const size_t i = end + 1 - K;
+        const char * f = fwd + i;
+        const char * r = rev + (n - i - K);
+        uint64_t h = murmur64(std::memcmp(f, r, K) < 0 ? f : r, K, seed);
+        if (h <= max_hash) {
+            out.push_back(h);
+        }
+        ++n_kmers;
+    }
+    return n_kmers;
+}
+
+
+size_t FracMinHash::Sketch::insert_sequences(const std::vector<std::string>& sequences,
+                                             unsigned int                    n_threads) {
+
+    n_threads = resolve_n_threads(n_threads, sequences.size());
+    std::vector<std::vector<uint64_t>> shards(n_threads);
+    std::vector<size_t>                shard_kmers(n_threads, 0);
+    size_t chunk_size = sequences.empty() ? 0 : (sequences.size() + n_threads - 1) / n_threads;
+
+    parallel_for_ranges(sequences.size(), n_threads,
+                        [&](size_t begin, size_t end) {
+                            const size_t shard = begin / chunk_size;
+                            auto& hashes = shards[shard];
+                            std::string scratch;
+                            for (size_t i = begin; i < end; ++i) {
+                                shard_kmers[shard] += hash_sequence(sequences[i], K, _seed,
+                                                                    _max_hash, hashes, scratch);
+                            }
+                            std::sort(hashes.begin(), hashes.end());
+                            hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+                        });
+
+    flush();
+    size_t n_kmers = 0;
+    for (unsigned int shard = 0; shard < n_threads; ++shard) {
+        merge_sorted(_mins, shards[shard]);
+        n_kmers += shard_kmers[shard];
+    }
+    return n_kmers;
+}
+
+
+void FracMinHash::Sketch::flush() const {
+    if (_pending.empty()) {
+        return;
+    }
+    std::sort(_pending.begin(), _pending.end());
+    _pending.erase(std::unique(_pending.begin(), _pending.end()), _pending.end());
+    merge_sorted(_mins, _pending);
+    _pending.clear();
+}
+
+
+void FracMinHash::Sketch::merge(const Sketch& other) {
+    if (!is_compatible(other)) {
+        throw GoetiaException("Can't merge FracMinHash sketches with different K, seed, or scaled");
+    }
+    if (&other == this) {
+        return;
+    }
+    flush();
+    other.flush();
+    merge_sorted(_mins, other._mins);
+}
+
+
+uint64_t FracMinHash::Sketch::count_common(const Sketch& other) const {
+    if (!is_compatible(other)) {
+        throw GoetiaException("Can't compare FracMinHash sketches with different K, seed, or scaled");
+    }
+    flush();
+    other.flush();
+    uint64_t common = 0;
+    auto a = _mins.begin(), b = other._mins.begin();
+    while (a != _mins.end() && b != other._mins.end()) {
+        if (*a < *b) {
+            ++a;
+        } else if (*b < *a) {
+            ++b;
+        } else {
+            ++common;
+            ++a;
+            ++b;
+        }
+    }
+    return common;
+}
+
+
+double FracMinHash::Sketch::jaccard(const Sketch& other) const {
+    uint64_t common = count_common(other);
+    uint64_t total  = _mins.size() + other._mins.size() - common;
+    return total == 0 ? 0.0 : static_cast<double>(common) / static_cast<double>(total);
+}
+
+}
@@ -38,10 +38,255 @@ Contact: khmer-project@idyll.org
 #include <math.h>
 #include <stdlib.h>
 #include <algorithm>
-#include <map>
-#include <numeric>
-#include <utility>
+#include <cstring>
+#include <sstream>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 #include "goetia/sketches/hllcounter.hh"
 
 
+namespace goetia {
+
+
+uint8_t HLLRegisters::precision_from_error(double error_rate) {
+    if (!(error_rate > 0.0) || error_rate >= 1.0) {
+        throw GoetiaException("HLL error rate must be in (0, 1)");
+    }
+    // the standard error of the estimate is 1.04 / sqrt(2^p)
+    int p = static_cast<int>(std::ceil(std::log2(std::pow(1.04 / error_rate, 2))));
+    return static_cast<uint8_t>(std::min<int>(MAX_PRECISION, std::max<int>(MIN_PRECISION, p)));
+}
+
+
+double HLLRegisters::alpha(size_t n_registers) {
+    switch (n_registers) {
+        case 16: return 0.673;
+        case 32: return 0.697;
+        case 64: return 0.709;
+        default: return 0.7213 / (1.0 + 1.079 / static_cast<double>(n_registers));
+    }
+}
+
+
+void HLLRegisters::merge(uint8_t *       dst,
+                         const uint8_t * src,
+                         size_t          n_registers) {
+    size_t i = 0;
+#ifdef __AVX2__
+    for (; i + 32 <= n_registers; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_max_epu8(a, b));
+    }
+#endif
+    for (; i < n_registers; ++i) {
+        dst[i] = std::max(dst[i], src[i]);
+    }
+}
+
+
+void HLLRegisters::harmonic_sum(const uint8_t * registers,
+                                size_t          n_registers,
+                                double&         sum,
+                                size_t&         n_zeros) {
+    sum     = 0.0;
+    n_zeros = 0;
+    size_t i = 0;
+#ifdef __AVX2__
+    // 2^-r is built directly as the float with exponent 127 - r; ranks
+    // are at most 64 - MIN_PRECISION + 1, so it's always normal
+    const __m256i bias  = _mm256_set1_epi32(127);
+    const __m256i zero  = _mm256_setzero_si256();
+    __m256d       acc_lo = _mm256_setzero_pd();
+    __m256d       acc_hi = _mm256_setzero_pd();
+    __m256i       zeros  = _mm256_setzero_si256();
+    for (; i + 8 <= n_registers; i += 8) {
+        __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(registers + i));
+        __m256i ranks = _mm256_cvtepu8_epi32(bytes);
+        __m256  inv   = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_sub_epi32(bias, ranks), 23));
+        acc_lo = _mm256_add_pd(acc_lo, _mm256_cvtps_pd(_mm256_castps256_ps128(inv)));
+        acc_hi = _mm256_add_pd(acc_hi, _mm256_cvtps_pd(_mm256_extractf128_ps(inv, 1)));
+        // cmpeq yields -1 per empty register
+        zeros  = _mm256_sub_epi32(zeros, _mm256_cmpeq_epi32(ranks, zero));
+    }
+    alignas(32) double   sums[4];
+    alignas(32) uint32_t counts[8];
+    _mm256_store_pd(sums, _mm256_add_pd(acc_lo, acc_hi));
+    _mm256_store_si256(reinterpret_cast<__m256i *>(counts), zeros);
+    sum = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+    for (int lane = 0; lane < 8; ++lane) {
+        n_zeros += counts[lane];
+    }
+#endif
+    for (; i < n_registers; ++i) {
+        sum += std::ldexp(1.0, -static_cast<int>(registers[i]));
+        n_zeros += registers[i] == 0;
+    }
+}
+
+
+double HLLRegisters::estimate(const uint8_t * registers,
+                              size_t          n_registers) {
+    double sum;
+    size_t n_zeros;
+    harmonic_sum(registers, n_registers, sum, n_zeros);
+    return estimate(sum, n_zeros, n_registers);
+}
+
+
+double HLLRegisters::estimate(double sum,
+                              size_t n_zeros,
+                              size_t n_registers) {
+    const double m = static_cast<double>(n_registers);
+    double E = alpha(n_registers) * m * m / sum;
+    if (E <= 2.5 * m && n_zeros != 0) {
+        E = m * std::log(m / static_cast<double>(n_zeros));
+    }
+    return E;
+}
+
+
+HLLStorage::HLLStorage(double error_rate)
+    : _owned(size_t(1) << HLLRegisters::precision_from_error(error_rate), 0),
+      _registers(_owned.data()),
+      _sum(static_cast<double>(_owned.size())),
+      _n_zeros(_owned.size()),
+      error_rate(error_rate),
+      p(HLLRegisters::precision_from_error(error_rate)),
+      n_registers(size_t(1) << p)
+{
+}
+
+
+HLLStorage::HLLStorage(double    error_rate,
+                       uint8_t * registers)
+    : _registers(registers),
+      error_rate(error_rate),
+      p(HLLRegisters::precision_from_error(error_rate)),
+      n_registers(size_t(1) << p)
+{
+    recount();
+}
+
+
+HLLStorage::HLLStorage(const HLLStorage& other)
+    : _owned(other._owned),
+      _registers(other._owned.empty() ? other._registers : _owned.data()),
+      _sum(other._sum),
+      _n_zeros(other._n_zeros),
+      error_rate(other.error_rate),
+      p(other.p),
+      n_registers(other.n_registers)
+{
+}
+
+
+void HLLStorage::reset() {
+    std::fill(_registers, _registers + n_registers, 0);
+    _sum     = static_cast<double>(n_registers);
+    _n_zeros = n_registers;
+}
+
+
+const uint64_t HLLStorage::n_occupied() const {
+    return n_registers - std::count(_registers, _registers + n_registers, 0);
+}
+
+
+void HLLStorage::merge(const HLLStorage& other) {
+    if (other.p != p) {
+        throw GoetiaException("Can't merge HLL counters with different precisions");
+    }
+    HLLRegisters::merge(_registers, other._registers, n_registers);
+    recount();
+}
+
+
+void HLLStorage::serialize(std::ofstream& out) {
+    out.write(std::string(this->NAME).c_str(), this->NAME.size());
+    out.write(this->version_binary(), sizeof(this->OBJECT_ABI_VERSION));
+    out.write(reinterpret_cast<const char *>(&error_rate), sizeof(error_rate));
+    out.write(reinterpret_cast<const char *>(_registers), n_registers);
+}
+
+
+std::shared_ptr<HLLStorage>
+HLLStorage::deserialize(std::ifstream& in) {
+
+    std::string name;
+    name.resize(Tagged<HLLStorage>::NAME.size());
+    size_t version;
+
+    in.read(name.data(), name.size());
+    in.read(reinterpret_cast<char *>(&version), sizeof(version));
+
+    if (name != Tagged<HLLStorage>::NAME) {
+        std::ostringstream err;
+        err << "File has wrong type tag: found "
+            << name
+            << ", should be "
+            << Tagged<HLLStorage>::NAME;
+        throw GoetiaFileException(err.str());
+    } else if (version != Tagged<HLLStorage>::OBJECT_ABI_VERSION) {
+        std::ostringstream err;
+        err << "File has wrong binary version: found "
+            << std::to_string(version)
+            << ", expected "
+            << std::to_string(Tagged<HLLStorage>::OBJECT_ABI_VERSION);
+        throw GoetiaFileException(err.str());
+    }
+
+    double error_rate;
+    in.read(reinterpret_cast<char *>(&error_rate), sizeof(error_rate));
+    auto storage = HLLStorage::build(error_rate);
+    in.read(reinterpret_cast<char *>(storage->_registers), storage->n_registers);
+    if (!in) {
+        throw GoetiaFileException("Truncated HLLStorage");
+    }
+    storage->recount();
+    return storage;
+}
+
+
+PartitionedStorage<HLLStorage>::PartitionedStorage(const uint64_t n_partitions,
+                                                   double         error_rate)
+    : n_partitions(n_partitions),
+      counts(n_partitions),
+      error_rate(error_rate)
+{
+    if (n_partitions == 0) {
+        throw GoetiaException("PartitionedStorage needs at least one partition");
+    }
+    const size_t n_registers = size_t(1) << HLLRegisters::precision_from_error(error_rate);
+    registers.assign(n_partitions * n_registers, 0);
+    partitions.reserve(n_partitions);
+    for (size_t i = 0; i < n_partitions; ++i) {
+        partitions.emplace_back(error_rate, registers.data() + i * n_registers);
+    }
+}
+
+
+void PartitionedStorage<HLLStorage>::reset() {
+    std::fill(registers.begin(), registers.end(), 0);
+    for (auto& partition : partitions) {
+        partition.reset();
+    }
+    counts.clear();
+}
+
+
+void PartitionedStorage<HLLStorage>::merge(const PartitionedStorage<HLLStorage>& other) {
+    if (other.n_partitions != n_partitions || other.n_registers() != n_registers()) {
+        throw GoetiaException("Can't merge partitioned HLL storages with different shapes");
+    }
+    HLLRegisters::merge(registers.data(), other.registers.data(), registers.size());
+    for (size_t pidx = 0; pidx < n_partitions; ++pidx) {
+        partitions[pidx].recount();
+        counts.set(pidx, partitions[pidx].n_unique_kmers());
+    }
+}
+
+}
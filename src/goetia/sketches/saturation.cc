@@ -0,0 +1,225 @@
+/**
+ * (c) Camille Scott, 2026
+ * File   : saturation.cc
+ * License: MIT
+ * Author : Camille Scott <camille.scott.w@gmail.com>
+ * Date   : 18.10.2026
+ */
+
+#include "goetia/sketches/saturation.hh"
+
+#include <algorithm>
+#include <numeric>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+
+namespace goetia {
+
+namespace {
+
+#ifdef __AVX2__
+    // exact for values below 2^52, which any k-mer count is
+    inline __m256d u64_to_pd(__m256i v) {
+        const __m256i magic_i = _mm256_set1_epi64x(0x4330000000000000LL);
+        const __m256d magic_d = _mm256_set1_pd(4503599627370496.0);
+        return _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(v, magic_i)), magic_d);
+    }
+
+    inline double hsum(__m256d v) {
+        alignas(32) double lanes[4];
+        _mm256_store_pd(lanes, v);
+        return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    }
+#endif
+
+    typedef unsigned __int128 uint128_t;
+
+}
+
+
+double SketchDistance::cosine(const uint64_t * a,
+                              const uint64_t * b,
+                              size_t           n) {
+    double ab = 0.0, aa = 0.0, bb = 0.0;
+    size_t i  = 0;
+#ifdef __AVX2__
+    __m256d acc_ab = _mm256_setzero_pd();
+    __m256d acc_aa = _mm256_setzero_pd();
+    __m256d acc_bb = _mm256_setzero_pd();
+    for (; i + 4 <= n; i += 4) {
+        __m256d va = u64_to_pd(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i)));
+        __m256d vb = u64_to_pd(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i)));
+        acc_ab = _mm256_add_pd(acc_ab, _mm256_mul_pd(va, vb));
+        acc_aa = _mm256_add_pd(acc_aa, _mm256_mul_pd(va, va));
+        acc_bb = _mm256_add_pd(acc_bb, _mm256_mul_pd(vb, vb));
+    }
+    ab = hsum(acc_ab);
+    aa = hsum(acc_aa);
+    bb = hsum(acc_bb);
+#endif
+    for (; i < n; ++i) {
+        const double x = static_cast<double>(a[i]), y = static_cast<double>(b[i]);
+        ab += x * y;
+        aa += x * x;
+        bb += y * y;
+    }
+    if (aa == 0.0 || bb == 0.0) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return ab / std::sqrt(aa * bb);
+}
+
+
+double IncrementalCosine::update(const uint32_t * indices,
+                                 const uint64_t * counts,
+                                 size_t           n_changed) {
+    const uint128_t old_norm2 = norm2;
+    uint128_t removed   = 0;
+    uint128_t added     = 0;
+    uint128_t cross     = 0;
+    for (size_t i = 0; i < n_changed; ++i) {
+        const uint64_t before = snapshot.at(indices[i]);
+        const uint64_t after  = counts[i];
+        removed += static_cast<uint128_t>(before) * before;
+        added   += static_cast<uint128_t>(after) * after;
+        cross   += static_cast<uint128_t>(before) * after;
+        snapshot[indices[i]] = after;
+    }
+    const uint128_t unchanged = old_norm2 - removed;
+    const uint128_t new_norm2 = unchanged + added;
+    const uint128_t dot       = unchanged + cross;
+    norm2 = new_norm2;
+
+    if (old_norm2 == 0 || new_norm2 == 0) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    const long double similarity = static_cast<long double>(dot)
+                                   / std::sqrt(static_cast<long double>(old_norm2)
+                                               * static_cast<long double>(new_norm2));
+    return static_cast<double>(1.0L - similarity);
+}
+
+
+double IncrementalCosine::update(const uint64_t * counts) {
+    std::vector<uint32_t> indices;
+    std::vector<uint64_t> changed;
+    for (size_t i = 0; i < snapshot.size(); ++i) {
+        if (counts[i] != snapshot[i]) {
+            indices.push_back(static_cast<uint32_t>(i));
+            changed.push_back(counts[i]);
+        }
+    }
+    return update(indices.data(), changed.data(), indices.size());
+}
+
+
+SaturationWindow::SaturationWindow(size_t             window_size,
+                                   double             cutoff,
+                                   const std::string& smoothing,
+                                   const std::string& cutoff_function)
+    : window_size(window_size),
+      cutoff(cutoff),
+      smoothing(parse_smoothing(smoothing)),
+      cutoff_function(parse_cutoff(cutoff_function))
+{
+    if (window_size < 2) {
+        throw GoetiaException("window_size must be at least 2");
+    }
+}
+
+
+SaturationWindow::smoothing_t
+SaturationWindow::parse_smoothing(const std::string& name) {
+    if (name == "mean") {
+        return SMOOTH_MEAN;
+    } else if (name == "median") {
+        return SMOOTH_MEDIAN;
+    } else if (name == "stddev") {
+        return SMOOTH_STDDEV;
+    }
+    throw GoetiaException("Unknown smoothing function: " + name);
+}
+
+
+SaturationWindow::cutoff_t
+SaturationWindow::parse_cutoff(const std::string& name) {
+    if (name == "all") {
+        return CUTOFF_ALL;
+    } else if (name == "median") {
+        return CUTOFF_MEDIAN;
+    }
+    throw GoetiaException("Unknown cutoff function: " + name);
+}
+
+
+SaturationStatus SaturationWindow::push(double   distance,
+                                        uint64_t t) {
+    SaturationStatus status{t, distance, std::numeric_limits<double>::quiet_NaN(), false};
+    if (std::isnan(distance)) {
+        return status;
+    }
+
+    values.push_back(distance);
+    if (values.size() > window_size) {
+        values.pop_front();
+    }
+    if (values.size() < window_size) {
+        return status;
+    }
+
+    status.stat = _smooth();
+    stats.push_back(status.stat);
+    if (stats.size() > window_size) {
+        stats.pop_front();
+    }
+    if (stats.size() == window_size) {
+        status.cutoff_reached = _check_cutoff();
+    }
+    return status;
+}
+
+
+double SaturationWindow::_smooth() {
+    const double n    = static_cast<double>(values.size());
+    const double mean = std::accumulate(values.begin(), values.end(), 0.0) / n;
+    switch (smoothing) {
+        case SMOOTH_MEDIAN:
+            return _median(values);
+        case SMOOTH_STDDEV: {
+            double ss = 0.0;
+            for (const double v : values) {
+                ss += (v - mean) * (v - mean);
+            }
+            return std::sqrt(ss / n);
+        }
+        default:
+            return mean;
+    }
+}
+
+
+bool SaturationWindow::_check_cutoff() {
+    if (cutoff_function == CUTOFF_MEDIAN) {
+        return _median(stats) > cutoff;
+    }
+    return std::all_of(stats.begin(), stats.end(),
+                       [this](double v) { return v > cutoff; });
+}
+
+
+double SaturationWindow::_median(const std::deque<double>& items) {
+    scratch.assign(items.begin(), items.end());
+    const size_t mid = scratch.size() / 2;
+    std::nth_element(scratch.begin(), scratch.begin() + mid, scratch.end());
+    if (scratch.size() % 2) {
+        return scratch[mid];
+    }
+    const double upper = scratch[mid];
+    const double lower = *std::max_element(scratch.begin(), scratch.begin() + mid);
+    return (lower + upper) / 2.0;
+}
+
+}
@@ -0,0 +1,138 @@
+/**
+ * (c) Camille Scott, 2026
+ * File   : spectrum.cc
+ * License: MIT
+ * Author : Camille Scott <camille.scott.w@gmail.com>
+ * Date   : 18.10.2026
+ */
+
+#include "goetia/sketches/spectrum.hh"
+
+#include <algorithm>
+
+#include "goetia/parallel.hh"
+
+
+namespace goetia {
+
+namespace {
+
+    template <class MapType>
+    void drop_above(MapType& sample, uint64_t max_hash) {
+        for (auto it = sample.begin(); it != sample.end(); ) {
+            if (it->first > max_hash) {
+                sample.erase(it++);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+}
+
+
+AbundanceSpectrum::AbundanceSpectrum(size_t   max_entries,
+                                     uint32_t max_abundance)
+    : _max_hash(std::numeric_limits<uint64_t>::max()),
+      _n_kmers(0),
+      max_entries(max_entries),
+      max_abundance(max_abundance)
+{
+    if (max_entries == 0) {
+        throw GoetiaException("AbundanceSpectrum max_entries must be greater than 0");
+    }
+    if (max_abundance == 0) {
+        throw GoetiaException("AbundanceSpectrum max_abundance must be greater than 0");
+    }
+}
+
+
+void AbundanceSpectrum::_downsample() {
+    while (_sample.size() > max_entries && _max_hash > 0) {
+        _max_hash >>= 1;
+        drop_above(_sample, _max_hash);
+    }
+}
+
+
+void AbundanceSpectrum::merge(const AbundanceSpectrum& other) {
+    if (other._max_hash < _max_hash) {
+        _max_hash = other._max_hash;
+        drop_above(_sample, _max_hash);
+    }
+    for (const auto& [m, count] : other._sample) {
+        if (m <= _max_hash) {
+            _sample[m] += count;
+        }
+    }
+    _n_kmers += other._n_kmers;
+    _downsample();
+}
+
+
+void AbundanceSpectrum::clear() {
+    _sample.clear();
+    _max_hash = std::numeric_limits<uint64_t>::max();
+    _n_kmers  = 0;
+}
+
+
+std::vector<uint64_t> AbundanceSpectrum::sampled_histogram() const {
+    std::vector<uint64_t> hist(max_abundance + 1, 0);
+    for (const auto& [m, count] : _sample) {
+        ++hist[std::min(count, max_abundance)];
+    }
+    return hist;
+}
+
+
+std::vector<double> AbundanceSpectrum::histogram() const {
+    const auto   sampled = sampled_histogram();
+    const double scale   = 1.0 / sample_fraction();
+
+    std::vector<double> hist(sampled.size());
+    for (size_t i = 0; i < sampled.size(); ++i) {
+        hist[i] = static_cast<double>(sampled[i]) * scale;
+    }
+    return hist;
+}
+
+
+std::vector<uint64_t> AbundanceSpectrum::exact(const Storage<uint64_t>& storage,
+                                               uint32_t                 max_abundance,
+                                               unsigned int             n_threads) {
+    if (max_abundance == 0) {
+        throw GoetiaException("AbundanceSpectrum max_abundance must be greater than 0");
+    }
+
+    // a shard per thread; the storage balances its own shards
+    const unsigned int n_shards = resolve_n_threads(n_threads, std::numeric_limits<size_t>::max());
+    std::vector<std::vector<uint64_t>> shard_hists(n_shards,
+                                                   std::vector<uint64_t>(max_abundance + 1, 0));
+
+    parallel_for_ranges(n_shards, n_shards,
+                        [&](size_t begin, size_t end) {
+                            for (size_t shard = begin; shard < end; ++shard) {
+                                auto& hist = shard_hists[shard];
+                                storage.for_each_range_batched(n_shards, shard,
+                                    [&hist, max_abundance](const uint64_t *,
+                                                           const count_t *  counts,
+                                                           size_t           n) {
+                                        for (size_t i = 0; i < n; ++i) {
+                                            const uint32_t count = counts[i] < 0 ? 0 : counts[i];
+                                            ++hist[std::min(count, max_abundance)];
+                                        }
+                                    });
+                            }
+                        });
+
+    std::vector<uint64_t> hist(max_abundance + 1, 0);
+    for (const auto& shard_hist : shard_hists) {
+        for (size_t i = 0; i < hist.size(); ++i) {
+            hist[i] += shard_hist[i];
+        }
+    }
+    return hist;
+}
+
+}
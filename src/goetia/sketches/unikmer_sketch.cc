@@ -9,12 +9,107 @@
 
 #include "goetia/sketches/unikmer_sketch.hh"
 
+#include <limits>
+
 #include "goetia/storage/storage_types.hh"
-//#include "goetia/sketches/hllcounter.hh"
+#include "goetia/sketches/hllcounter.hh"
 #include "goetia/hashing/canonical.hh"
 
 
 namespace goetia {
+
+    template <class StorageType, class HashType>
+    UnikmerSketchBuilder<StorageType, HashType>::UnikmerSketchBuilder(std::shared_ptr<Sketch> sketch,
+                                                                      unsigned int            n_threads,
+                                                                      uint64_t                interval,
+                                                                      bool                    verbose,
+                                                                      size_t                  batch_size)
+        : Base       (interval, verbose),
+          sketch     (sketch),
+          n_threads  (resolve_n_threads(n_threads, std::numeric_limits<size_t>::max())),
+          batch_size (std::max<size_t>(batch_size, 1))
+    {
+        auto ukhs = sketch->get_ukhs();
+        workers.resize(this->n_threads);
+        for (auto& worker : workers) {
+            worker.local = std::make_shared<pdbg_type>(sketch->W,
+                                                       sketch->K,
+                                                       ukhs,
+                                                       sketch->storage_params);
+            worker.touched.assign(sketch->get_size(), 0);
+        }
+        sequences.reserve(this->batch_size);
+    }
+
+
+    template <class StorageType, class HashType>
+    void
+    UnikmerSketchBuilder<StorageType, HashType>::_insert_batch() {
+        if (sequences.empty()) {
+            return;
+        }
+
+        const size_t n_workers  = resolve_n_threads(n_threads, sequences.size());
+        const size_t chunk_size = (sequences.size() + n_workers - 1) / n_workers;
+        parallel_for_ranges(sequences.size(), n_threads,
+                            [&](size_t begin, size_t end) {
+                                Worker& worker = workers[begin / chunk_size];
+                                for (size_t i = begin; i < end; ++i) {
+                                    // Processor skips these on SequenceLengthException
+                                    if (sequences[i].length() < sketch->W) {
+                                        continue;
+                                    }
+                                    worker.local->hash_sequence(sequences[i], worker.batch);
+                                    worker.local->insert_batch(worker.batch);
+                                    for (const auto partition : worker.batch.partitions) {
+                                        worker.touched[partition] = 1;
+                                    }
+                                }
+                            });
+
+        sequences.clear();
+        _merge();
+    }
+
+
+    template <class StorageType, class HashType>
+    void
+    UnikmerSketchBuilder<StorageType, HashType>::_merge() {
+        touched_partitions.clear();
+        const size_t n_partitions = sketch->get_size();
+        for (size_t partition = 0; partition < n_partitions; ++partition) {
+            for (const auto& worker : workers) {
+                if (worker.touched[partition]) {
+                    touched_partitions.push_back(partition);
+                    break;
+                }
+            }
+        }
+
+        // each partition is merged by one thread, so the stores need no locking
+        auto storage = sketch->get_pdbg()->get_storage();
+        parallel_for_ranges(touched_partitions.size(), n_threads,
+                            [&](size_t begin, size_t end) {
+                                for (size_t i = begin; i < end; ++i) {
+                                    const uint32_t partition = touched_partitions[i];
+                                    auto * global = storage->query_partition(partition);
+                                    for (auto& worker : workers) {
+                                        if (!worker.touched[partition]) {
+                                            continue;
+                                        }
+                                        auto * local = worker.local->get_storage()->query_partition(partition);
+                                        global->merge(*local);
+                                        local->reset();
+                                        worker.touched[partition] = 0;
+                                    }
+                                    storage->sync_partition_count(partition);
+                                }
+                            });
+
+        for (const auto partition : touched_partitions) {
+            sketch->mark_changed(partition);
+        }
+    }
     
     template class UnikmerSketch<BitStorage, Hash<uint64_t>>;
     template class UnikmerSketch<BitStorage, Canonical<uint64_t>>;
@@ -37,6 +132,18 @@ namespace goetia {
     template class UnikmerSketch<QFStorage, Hash<uint64_t>>;
     template class UnikmerSketch<QFStorage, Canonical<uint64_t>>;
 
-    //template class UnikmerSketch<HLLStorage, Hash<uint64_t>>;
-    //template class UnikmerSketch<HLLStorage, Canonical<uint64_t>>;
+    template class UnikmerSketch<HLLStorage, Hash<uint64_t>>;
+    template class UnikmerSketch<HLLStorage, Canonical<uint64_t>>;
+
+    template class UnikmerSketchBuilder<SparseppSetStorage, Hash<uint64_t>>;
+    template class UnikmerSketchBuilder<SparseppSetStorage, Canonical<uint64_t>>;
+
+    template class UnikmerSketchBuilder<PHMapStorage, Hash<uint64_t>>;
+    template class UnikmerSketchBuilder<PHMapStorage, Canonical<uint64_t>>;
+
+    template class UnikmerSketchBuilder<BTreeStorage, Hash<uint64_t>>;
+    template class UnikmerSketchBuilder<BTreeStorage, Canonical<uint64_t>>;
+
+    template class UnikmerSketchBuilder<HLLStorage, Hash<uint64_t>>;
+    template class UnikmerSketchBuilder<HLLStorage, Canonical<uint64_t>>;
 }
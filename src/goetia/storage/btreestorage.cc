@@ -29,6 +29,27 @@ BTreeStorage::query(value_type h) const {
 }
 
 
+void
+BTreeStorage::for_each_range_batched(size_t                     n_shards,
+                                     size_t                     shard_id,
+                                     const batch_callback_type& f,
+                                     size_t                     batch_size) const {
+    check_shard(n_shards, shard_id);
+    EnumerationBuffer buffer(f, batch_size);
+
+    // bounds over the full 64-bit range, so the last shard's end is 2^64
+    const __uint128_t span = static_cast<__uint128_t>(1) << 64;
+    auto it = _store->lower_bound(static_cast<value_type>(span * shard_id / n_shards));
+    auto end = shard_id + 1 == n_shards
+               ? _store->end()
+               : _store->lower_bound(static_cast<value_type>(span * (shard_id + 1) / n_shards));
+    for (; it != end; ++it) {
+        buffer.push(*it, 1);
+    }
+    buffer.flush();
+}
+
+
 std::shared_ptr<BTreeStorage>
 BTreeStorage::build() {
     return std::make_shared<BTreeStorage>();
@@ -1447,19 +1447,22 @@ void qf_remove(QF *qf, uint64_t key, uint64_t value, uint64_t count)
 void qf_iterator(const QF *qf, QFi *qfi, uint64_t position)
 {
 	assert(position < qf->nslots);
+	qfi->qf = qf;
 	if (!is_occupied(qf, position)) {
-		uint64_t block_index = position;
-		uint64_t idx = bitselect(get_block(qf, block_index)->occupieds[0], 0);
-		if (idx == 64) {
-			while(idx == 64 && block_index < qf->nblocks) {
-				block_index++;
-				idx = bitselect(get_block(qf, block_index)->occupieds[0], 0);
+		/* find the first occupied slot after position, if there is one */
+		uint64_t block_index = position / SLOTS_PER_BLOCK;
+		uint64_t idx = bitselectv(get_block(qf, block_index)->occupieds[0], position, 0);
+		while (idx == 64) {
+			block_index++;
+			if (block_index >= qf->nblocks) {
+				qfi->run = qfi->current = qf->xnslots;
+				return;
 			}
+			idx = bitselect(get_block(qf, block_index)->occupieds[0], 0);
 		}
 		position = block_index * SLOTS_PER_BLOCK + idx;
 	}
 
-	qfi->qf = qf;
 	qfi->run = position;
 	qfi->current = position == 0 ? 0 : run_end(qfi->qf, position-1) + 1;
 	if (qfi->current < position)
@@ -1506,6 +1509,8 @@ int qfi_next(QFi *qfi)
 				rank = 0;
 				while (next_run == 64 && block_index < qfi->qf->nblocks) {
 					block_index++;
+					if (block_index == qfi->qf->nblocks)
+						break;
 					next_run = bitselect(get_block(qfi->qf, block_index)->occupieds[0], rank);
 				}
 			}
@@ -29,6 +29,26 @@ PHMapStorage::query(value_type h) const {
 }
 
 
+void
+PHMapStorage::for_each_range_batched(size_t                     n_shards,
+                                     size_t                     shard_id,
+                                     const batch_callback_type& f,
+                                     size_t                     batch_size) const {
+    check_shard(n_shards, shard_id);
+    EnumerationBuffer buffer(f, batch_size);
+
+    auto [begin, end] = shard_bounds(n_submaps(), n_shards, shard_id);
+    for (size_t submap = begin; submap < end; ++submap) {
+        _store->with_submap(submap, [&buffer](const auto& set) {
+            for (const auto& h : set) {
+                buffer.push(h, 1);
+            }
+        });
+    }
+    buffer.flush();
+}
+
+
 std::shared_ptr<PHMapStorage>
 PHMapStorage::build() {
     return std::make_shared<PHMapStorage>();
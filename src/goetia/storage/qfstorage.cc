@@ -47,7 +47,9 @@
 
 #include <memory>
 #include <errno.h>
+#include <algorithm>
 #include <cstring>
+#include <limits>
 #include <sstream> // IWYU pragma: keep
 #include <fstream>
 #include <iostream>
@@ -106,6 +108,32 @@ QFStorage::query(value_type khash) const
 }
 
 
+void
+QFStorage::for_each_range_batched(size_t                     n_shards,
+                                  size_t                     shard_id,
+                                  const batch_callback_type& f,
+                                  size_t                     batch_size) const
+{
+    check_shard(n_shards, shard_id);
+    EnumerationBuffer buffer(f, batch_size);
+
+    auto [begin, end] = shard_bounds(cf->nslots, n_shards, shard_id);
+    if (begin < end) {
+        // keys are iterated in order of their quotient, which is the run
+        // they start in, so each shard is the keys whose runs start in it
+        QFi qfi;
+        qf_iterator(cf.get(), &qfi, begin);
+        while (!qfi_end(&qfi) && qfi.run < end) {
+            uint64_t key, value, count;
+            qfi_get(&qfi, &key, &value, &count);
+            buffer.push(key, static_cast<count_t>(std::min<uint64_t>(count, std::numeric_limits<count_t>::max())));
+            qfi_next(&qfi);
+        }
+    }
+    buffer.flush();
+}
+
+
 std::vector<uint64_t>
 QFStorage::get_tablesizes() const 
 { 
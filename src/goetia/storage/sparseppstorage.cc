@@ -31,6 +31,24 @@ SparseppSetStorage::query(value_type h) const {
 }
 
 
+void
+SparseppSetStorage::for_each_range_batched(size_t                     n_shards,
+                                           size_t                     shard_id,
+                                           const batch_callback_type& f,
+                                           size_t                     batch_size) const {
+    check_shard(n_shards, shard_id);
+    EnumerationBuffer buffer(f, batch_size);
+
+    auto [begin, end] = shard_bounds(_store->size(), n_shards, shard_id);
+    auto it = _store->cbegin();
+    std::advance(it, begin);
+    for (size_t i = begin; i < end; ++i, ++it) {
+        buffer.push(*it, 1);
+    }
+    buffer.flush();
+}
+
+
 std::shared_ptr<SparseppSetStorage>
 SparseppSetStorage::build() {
     return std::make_shared<SparseppSetStorage>();
@@ -0,0 +1,428 @@
+/**
+ * (c) Camille Scott, 2026
+ * File   : superkmer_counter.cc
+ * License: MIT
+ * Author : Camille Scott <camille.scott.w@gmail.com>
+ * Date   : 18.10.2026
+ */
+
+#include "goetia/superkmer_counter.hh"
+#include "goetia/utils/binary_io.hh"
+
+#include <cstring>
+#include <queue>
+
+
+namespace goetia {
+
+
+namespace {
+
+    // 2-bit code of each base, or 4 for anything outside ACGT
+    struct BaseCodes {
+        uint8_t codes[256];
+
+        BaseCodes() {
+            std::memset(codes, 4, sizeof(codes));
+            codes['A'] = codes['a'] = 0;
+            codes['C'] = codes['c'] = 1;
+            codes['G'] = codes['g'] = 2;
+            codes['T'] = codes['t'] = 3;
+        }
+    };
+
+    const BaseCodes BASE_CODES;
+
+    inline uint8_t base_code(char c) {
+        return BASE_CODES.codes[static_cast<uint8_t>(c)];
+    }
+
+}
+
+
+void SuperKmerIO::write(std::vector<uint8_t>& buffer,
+                        const char *          sequence,
+                        uint32_t              length) {
+
+    size_t offset = buffer.size();
+    buffer.resize(offset + 4 + (length + 3) / 4);
+    uint8_t * out = buffer.data() + offset;
+    for (int i = 0; i < 4; ++i) {
+        out[i] = static_cast<uint8_t>(length >> (8 * i));
+    }
+    out += 4;
+
+    uint32_t i = 0;
+    for (; i + 4 <= length; i += 4) {
+        *out++ = (base_code(sequence[i])     << 6)
+               | (base_code(sequence[i + 1]) << 4)
+               | (base_code(sequence[i + 2]) << 2)
+               |  base_code(sequence[i + 3]);
+    }
+    if (i < length) {
+        uint8_t byte = 0;
+        for (int shift = 6; i < length; ++i, shift -= 2) {
+            byte |= base_code(sequence[i]) << shift;
+        }
+        *out = byte;
+    }
+}
+
+
+bool SuperKmerIO::read(std::istream&         in,
+                       std::string&          sequence,
+                       std::vector<uint8_t>& scratch) {
+
+    uint8_t header[4];
+    in.read(reinterpret_cast<char*>(header), 4);
+    if (in.gcount() == 0) {
+        return false;
+    }
+    if (in.gcount() != 4) {
+        throw GoetiaFileException("Truncated super-k-mer record.");
+    }
+    uint32_t length = header[0]
+                    | (static_cast<uint32_t>(header[1]) << 8)
+                    | (static_cast<uint32_t>(header[2]) << 16)
+                    | (static_cast<uint32_t>(header[3]) << 24);
+
+    size_t n_bytes = (length + 3) / 4;
+    scratch.resize(n_bytes);
+    in.read(reinterpret_cast<char*>(scratch.data()), n_bytes);
+    if (static_cast<size_t>(in.gcount()) != n_bytes) {
+        throw GoetiaFileException("Truncated super-k-mer record.");
+    }
+
+    sequence.resize(length);
+    for (uint32_t i = 0; i < length; ++i) {
+        sequence[i] = "ACGT"[(scratch[i >> 2] >> (6 - 2 * (i & 3))) & 3];
+    }
+    return true;
+}
+
+
+constexpr char     KmerCountTable::TABLE_MAGIC[8];
+constexpr uint16_t KmerCountTable::TABLE_VERSION;
+
+
+KmerCountTable::Writer::Writer(const std::string& filename,
+                               uint16_t           K)
+    : out(filename, std::ios::binary),
+      _n_entries(0),
+      _last_hash(0),
+      K(K)
+{
+    if (!out) {
+        throw GoetiaFileException("Could not open count table " + filename + " for writing.");
+    }
+    out.write(TABLE_MAGIC, sizeof(TABLE_MAGIC));
+    write_le(out, TABLE_VERSION, 2);
+    write_le(out, K, 2);
+    // entry count, patched on close
+    write_le(out, 0, 8);
+}
+
+
+void KmerCountTable::Writer::write(const Entry& entry) {
+    if (_n_entries && entry.hash <= _last_hash) {
+        throw GoetiaException("Count table entries must be written in increasing hash order.");
+    }
+    write_le(out, entry.hash, 8);
+    write_le(out, entry.count, 4);
+    _last_hash = entry.hash;
+    ++_n_entries;
+}
+
+
+void KmerCountTable::Writer::close() {
+    if (!out.is_open()) {
+        return;
+    }
+    out.seekp(sizeof(TABLE_MAGIC) + 4);
+    write_le(out, _n_entries, 8);
+    out.close();
+}
+
+
+KmerCountTable::Reader::Reader(const std::string& filename)
+    : in(filename, std::ios::binary),
+      _n_entries(0),
+      _n_read(0),
+      _K(0)
+{
+    if (!in) {
+        throw GoetiaFileException("Could not open count table " + filename);
+    }
+
+    char magic[sizeof(TABLE_MAGIC)];
+    in.read(magic, sizeof(TABLE_MAGIC));
+    if (!in || std::memcmp(magic, TABLE_MAGIC, sizeof(TABLE_MAGIC)) != 0) {
+        throw GoetiaFileException("Invalid count table header in " + filename);
+    }
+    uint16_t version = read_le(in, 2);
+    if (version != TABLE_VERSION) {
+        throw GoetiaFileException("Unsupported count table version: "
+                                  + std::to_string(version));
+    }
+    _K         = read_le(in, 2);
+    _n_entries = read_le(in, 8);
+    if (!in) {
+        throw GoetiaFileException("Truncated count table header in " + filename);
+    }
+}
+
+
+bool KmerCountTable::Reader::next(Entry& entry) {
+    if (_n_read == _n_entries) {
+        return false;
+    }
+    entry.hash  = read_le(in, 8);
+    entry.count = read_le(in, 4);
+    if (!in) {
+        throw GoetiaFileException("Truncated count table.");
+    }
+    ++_n_read;
+    return true;
+}
+
+
+void KmerCountTable::write(const std::string&        filename,
+                           uint16_t                  K,
+                           const std::vector<Entry>& entries) {
+    Writer writer(filename, K);
+    for (const auto& entry : entries) {
+        writer.write(entry);
+    }
+    writer.close();
+}
+
+
+std::vector<KmerCountTable::Entry> KmerCountTable::read(const std::string& filename) {
+    Reader reader(filename);
+    std::vector<Entry> entries;
+    entries.reserve(reader.n_entries());
+    Entry entry;
+    while (reader.next(entry)) {
+        entries.push_back(entry);
+    }
+    return entries;
+}
+
+
+uint64_t KmerCountTable::merge(const std::vector<std::string>& filenames,
+                               const std::string&              output_filename) {
+
+    std::vector<std::unique_ptr<Reader>> readers;
+    uint16_t K = 0;
+    for (const auto& filename : filenames) {
+        readers.push_back(std::make_unique<Reader>(filename));
+        if (readers.size() > 1 && readers.back()->K() != K) {
+            throw GoetiaException("Cannot merge count tables with different K.");
+        }
+        K = readers.back()->K();
+    }
+
+    // min-heap of (head entry, reader index)
+    typedef std::pair<Entry, size_t> head_type;
+    auto cmp = [](const head_type& a, const head_type& b) {
+        return b.first < a.first;
+    };
+    std::priority_queue<head_type, std::vector<head_type>, decltype(cmp)> heads(cmp);
+
+    Entry entry;
+    for (size_t i = 0; i < readers.size(); ++i) {
+        if (readers[i]->next(entry)) {
+            heads.emplace(entry, i);
+        }
+    }
+
+    Writer writer(output_filename, K);
+    while (!heads.empty()) {
+        auto [current, index] = heads.top();
+        heads.pop();
+        if (readers[index]->next(entry)) {
+            heads.emplace(entry, index);
+        }
+
+        while (!heads.empty() && heads.top().first.hash == current.hash) {
+            auto [other, other_index] = heads.top();
+            heads.pop();
+            current.count = static_cast<uint32_t>(std::min<uint64_t>(uint64_t(current.count) + other.count,
+                                                                     UINT32_MAX));
+            if (readers[other_index]->next(entry)) {
+                heads.emplace(entry, other_index);
+            }
+        }
+        writer.write(current);
+    }
+    writer.close();
+
+    return writer.n_entries();
+}
+
+
+template <class ShifterType>
+SuperKmerCounter<ShifterType>::Spiller::Spiller(uint16_t           K,
+                                                uint16_t           minimizer_K,
+                                                uint32_t           n_buckets,
+                                                const std::string& prefix,
+                                                size_t             buffer_size)
+    : buckets(n_buckets),
+      window(K >= minimizer_K ? K - minimizer_K + 1 : 1),
+      mmer_hasher(minimizer_K),
+      _n_superkmers(0),
+      _n_kmers(0),
+      _closed(false),
+      K(K),
+      minimizer_K(minimizer_K),
+      n_buckets(n_buckets),
+      prefix(prefix),
+      buffer_size(buffer_size)
+{
+    if (minimizer_K > K) {
+        throw GoetiaException("minimizer_K must be at most K.");
+    }
+    if (n_buckets == 0) {
+        throw GoetiaException("Need at least one super-k-mer bucket.");
+    }
+
+    for (uint32_t b = 0; b < n_buckets; ++b) {
+        auto& bucket = buckets[b];
+        bucket.out.open(bucket_filename(b), std::ios::binary | std::ios::trunc);
+        if (!bucket.out) {
+            throw GoetiaFileException("Could not open super-k-mer bucket " + bucket_filename(b));
+        }
+        bucket.buffer.reserve(buffer_size);
+    }
+}
+
+
+template <class ShifterType>
+uint64_t
+SuperKmerCounter<ShifterType>::Spiller::insert_sequence(const std::string& sequence) {
+    if (_closed) {
+        throw GoetiaException("Cannot insert into a closed Spiller.");
+    }
+
+    uint64_t n_kmers_before = _n_kmers;
+
+    // split on non-ACGT and upper-case each run for the hasher
+    size_t start = 0;
+    while (start < sequence.size()) {
+        while (start < sequence.size() && base_code(sequence[start]) > 3) {
+            ++start;
+        }
+        size_t end = start;
+        while (end < sequence.size() && base_code(sequence[end]) <= 3) {
+            ++end;
+        }
+        if (end - start >= K) {
+            segment.assign(sequence, start, end - start);
+            for (auto& c : segment) {
+                c = "ACGT"[base_code(c)];
+            }
+            _spill_segment(segment.c_str(), segment.size());
+        }
+        start = end;
+    }
+
+    return _n_kmers - n_kmers_before;
+}
+
+
+template <class ShifterType>
+void
+SuperKmerCounter<ShifterType>::Spiller::_spill_segment(const char * sequence,
+                                                       size_t       length) {
+
+    const size_t n_mmers = length - minimizer_K + 1;
+
+    mmer_hashes.resize(n_mmers);
+    mmer_hashes[0] = mmer_hasher.hash_base(sequence).value();
+    for (size_t j = 1; j < n_mmers; ++j) {
+        mmer_hashes[j] = mmer_hasher.shift_right(sequence[j - 1],
+                                                 sequence[j + minimizer_K - 1]).value();
+    }
+    // one window of m-mers per k-mer
+    kmer_minimizers.resize(window.n_windows(n_mmers));
+    const size_t n_kmers = window.compute(mmer_hashes.data(), n_mmers, kmer_minimizers.data());
+
+    size_t   superkmer_start = 0;
+    uint32_t current_bucket  = 0;
+    for (size_t i = 0; i < n_kmers; ++i) {
+        value_type minimizer = kmer_minimizers[i];
+        uint32_t bucket = minimizer % n_buckets;
+
+        if (i == 0) {
+            current_bucket = bucket;
+        } else if (bucket != current_bucket) {
+            _write_superkmer(current_bucket, sequence + superkmer_start, i - superkmer_start + K - 1);
+            superkmer_start = i;
+            current_bucket  = bucket;
+        }
+    }
+    _write_superkmer(current_bucket, sequence + superkmer_start, length - superkmer_start);
+}
+
+
+template <class ShifterType>
+void
+SuperKmerCounter<ShifterType>::Spiller::_write_superkmer(uint32_t     b,
+                                                         const char * sequence,
+                                                         size_t       length) {
+    auto& bucket = buckets[b];
+    if (bucket.buffer.size() + 4 + (length + 3) / 4 > buffer_size) {
+        _flush_bucket(bucket);
+    }
+    SuperKmerIO::write(bucket.buffer, sequence, length);
+
+    uint64_t n_kmers = length - K + 1;
+    ++bucket.n_superkmers;
+    bucket.n_kmers += n_kmers;
+    ++_n_superkmers;
+    _n_kmers += n_kmers;
+}
+
+
+template <class ShifterType>
+void
+SuperKmerCounter<ShifterType>::Spiller::_flush_bucket(Bucket& bucket) {
+    if (bucket.buffer.empty()) {
+        return;
+    }
+    bucket.out.write(reinterpret_cast<const char*>(bucket.buffer.data()), bucket.buffer.size());
+    if (!bucket.out) {
+        throw GoetiaFileException("Error writing super-k-mer bucket.");
+    }
+    bucket.buffer.clear();
+}
+
+
+template <class ShifterType>
+void
+SuperKmerCounter<ShifterType>::Spiller::flush() {
+    for (auto& bucket : buckets) {
+        _flush_bucket(bucket);
+        bucket.out.flush();
+    }
+}
+
+
+template <class ShifterType>
+void
+SuperKmerCounter<ShifterType>::Spiller::close() {
+    if (_closed) {
+        return;
+    }
+    flush();
+    for (auto& bucket : buckets) {
+        bucket.out.close();
+    }
+    _closed = true;
+}
+
+
+template class SuperKmerCounter<FwdLemireShifter>;
+template class SuperKmerCounter<CanLemireShifter>;
+
+}
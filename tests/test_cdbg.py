@@ -13,8 +13,8 @@ import pytest
 from tests.utils import *
 
 from goetia import libgoetia, nullptr
-from goetia.cdbg import cDBG, StreamingCompactor
-from goetia.hashing import FwdLemireShifter
+from goetia.cdbg import cDBG, StaticCompactor, StreamingCompactor, UnitigMapper
+from goetia.hashing import CanLemireShifter, FwdLemireShifter
 from goetia.storage import PHMapStorage
 
 import cppyy.ll
@@ -1422,3 +1422,276 @@ class TestFindConnectedComponents:
         components = benchmark(compactor.cdbg.find_connected_components)
         assert len(components) == n_components
 
+
+
+@using(hasher_type=FwdLemireShifter, storage_type=PHMapStorage)
+class TestUnitigMapper:
+
+    @using(ksize=21, length=100)
+    def test_map_snp_bubble(self, ksize, length, graph, compactor,
+                                  snp_bubble, check_fp):
+
+        (wild, snp), L, R = snp_bubble()
+        check_fp()
+
+        compactor.insert_sequence(wild)
+        compactor.insert_sequence(snp)
+
+        mapper = UnitigMapper[type(graph)].Mapper.build(compactor.cdbg, 4)
+        assert not mapper.is_stale()
+
+        wild_map, snp_map = mapper.map_sequences([wild, snp], 2)
+        # left tip, bubble branch, right tip
+        assert wild_map.size() == 3
+        assert snp_map.size() == 3
+        assert wild_map.unitig_ids[0] == snp_map.unitig_ids[0]
+        assert wild_map.unitig_ids[1] != snp_map.unitig_ids[1]
+        assert wild_map.unitig_ids[2] == snp_map.unitig_ids[2]
+        assert list(wild_map.read_positions) == sorted(wild_map.read_positions)
+
+    @using(ksize=21, length=100)
+    def test_map_unrelated(self, ksize, length, graph, compactor,
+                                 random_sequence):
+
+        compactor.insert_sequence(random_sequence())
+        mapper = UnitigMapper[type(graph)].Mapper.build(compactor.cdbg)
+
+        assert not mapper.map_sequence(random_sequence()).is_mapped()
+        assert not mapper.map_sequence('A' * (ksize - 1)).is_mapped()
+
+    @using(ksize=21, length=100)
+    def test_map_sequences_bad_read(self, ksize, length, graph, compactor,
+                                          random_sequence):
+
+        sequence = random_sequence()
+        compactor.insert_sequence(sequence)
+        mapper = UnitigMapper[type(graph)].Mapper.build(compactor.cdbg)
+
+        bad = sequence[:length // 2] + 'N' + sequence[length // 2 + 1:]
+        mappings = mapper.map_sequences([sequence, bad, sequence], 2)
+        # the bad read doesn't take the rest of the batch with it
+        assert len(mappings) == 3
+        assert mappings[0].is_mapped()
+        assert not mappings[1].is_mapped()
+        assert mappings[2].is_mapped()
+        # lowercase is validated as the parsers do it, not hashed as-is
+        assert mapper.map_sequence(sequence.lower()).is_mapped()
+
+
+@using(hasher_type=FwdLemireShifter, storage_type=PHMapStorage)
+class TestEventRing:
+
+    @using(ksize=21, length=100)
+    def test_snp_bubble_events(self, ksize, length, graph, compactor,
+                                     snp_bubble, check_fp, tmpdir):
+
+        (wild, snp), L, R = snp_bubble()
+        check_fp()
+
+        ring = compactor.cdbg.enable_events(64)
+        compactor.insert_sequence(wild)
+        events = list(ring.drain(1000))
+        assert len(events) == 1
+        assert events[0].op == libgoetia.BUILD_UNODE
+        assert events[0].length == len(wild)
+
+        compactor.insert_sequence(snp)
+        events = list(ring.drain(1000))
+        ops = [e.op for e in events]
+        assert ops.count(libgoetia.BUILD_DNODE) == 2
+        assert ops.count(libgoetia.SPLIT_UNODE) >= 1
+        assert ring.empty()
+
+        path = str(tmpdir.join('cdbg.delta'))
+        libgoetia.cDBGEventRing.write_delta(path, events)
+        loaded = libgoetia.cDBGEventRing.read_delta(path)
+        assert [(e.op, e.node_id, e.length) for e in loaded] == \
+               [(e.op, e.node_id, e.length) for e in events]
+
+    @using(ksize=15, length=40)
+    def test_circular_merge_events(self, ksize, length, graph, compactor,
+                                         circular, check_fp):
+        sequence = circular()
+        check_fp()
+
+        ring = compactor.cdbg.enable_events(64)
+        compactor.insert_sequence(sequence[:length - 2])
+        node_id = list(ring.drain(1000))[0].node_id
+
+        compactor.insert_sequence(sequence)
+        events = list(ring.drain(1000))
+        # closing the circle absorbs no other unitig
+        assert libgoetia.MERGE_UNODES not in [e.op for e in events]
+        assert events[-1].op == libgoetia.EXTEND_UNODE
+        assert events[-1].node_id == node_id
+
+    def test_read_delta_rejects_corrupt(self, tmpdir):
+        import struct
+        header = b'GCDBGEV\0' + struct.pack('<H', 1)
+        record = struct.pack('<B7Q', libgoetia.BUILD_UNODE, 1, 0, 2, 3, 0, 30, 1)
+        path = str(tmpdir.join('bad.delta'))
+
+        def read(data):
+            with open(path, 'wb') as fp:
+                fp.write(data)
+            return libgoetia.cDBGEventRing.read_delta(path)
+
+        assert len(read(header + struct.pack('<Q', 1) + record)) == 1
+        for data in (header + struct.pack('<Q', 1 << 62) + record,      # huge count
+                     header + struct.pack('<Q', 1) + b'\xff' + record[1:],  # unknown op
+                     header[:-1],                                        # truncated version
+                     header + b'\x01\x00'):                              # truncated count
+            with pytest.raises(Exception):
+                read(data)
+
+    def test_ring_drops_when_full(self):
+        ring = libgoetia.cDBGEventRing.build(4)
+        assert ring.capacity == 4
+        for i in range(6):
+            ring.push(libgoetia.cDBGEvent(libgoetia.BUILD_UNODE, i, i, 0, 0, 0, 0, i))
+        assert ring.n_dropped() == 2
+        assert [e.node_id for e in ring.drain(10)] == [0, 1, 2, 3]
+
+
+@using(hasher_type=FwdLemireShifter, storage_type=PHMapStorage)
+class TestUnitigLengthHistogram:
+
+    @using(ksize=21, length=100)
+    def test_snp_bubble_lengths(self, ksize, length, graph, compactor,
+                                      snp_bubble, check_fp):
+
+        (wild, snp), L, R = snp_bubble()
+        check_fp()
+
+        compactor.insert_sequence(wild)
+        cdbg = compactor.cdbg
+        assert cdbg.n_unitig_bases() == len(wild)
+        assert cdbg.unitig_n50() == len(wild)
+
+        compactor.insert_sequence(snp)
+        hist = cdbg.metrics.unitig_lengths
+        assert hist.n_unitigs() == cdbg.n_unitig_nodes()
+
+        # every k-mer outside the decision nodes belongs to exactly one unitig
+        bins = [ksize, 2 * ksize]
+        counts = cDBG[type(graph)].compute_unitig_fragmentation(cdbg, bins)
+        assert sum(counts) == graph.n_unique() - cdbg.n_decision_nodes()
+
+    def test_bucket_bounds(self):
+        hist_t = libgoetia.UnitigLengthHistogram
+        for length in [1, 21, 31, 32, 100, 1000, 123456789]:
+            index = hist_t.bucket_index(length)
+            assert hist_t.bucket_lower(index) <= length < hist_t.bucket_lower(index + 1)
+
+    def test_kmers_per_bin_exact(self):
+        import random
+        K = 21
+        hist = libgoetia.UnitigLengthHistogram()
+        lengths = [random.randint(K, 3000) for _ in range(1000)]
+        for length in lengths:
+            hist.add(length)
+        for length in lengths[:100]:
+            hist.update(length, length + 7)
+        lengths[:100] = [length + 7 for length in lengths[:100]]
+
+        # 500 and 1000 fall inside log-linear buckets
+        bins = [K, 100, 200, 500, 1000]
+        expected = [0] * len(bins)
+        for length in lengths:
+            expected[sum(1 for edge in bins if edge <= length) - 1] += length - K + 1
+        assert list(hist.kmers_per_bin(bins, K)) == expected
+
+
+def unitigs_from_fasta(filename):
+    from goetia.parsing import read_fastx
+    return sorted((record.sequence, record.name.split('type=')[-1])
+                  for record in read_fastx(filename))
+
+
+@using(hasher_type=FwdLemireShifter, storage_type=PHMapStorage)
+class TestStaticCompactor:
+
+    @using(ksize=21, length=100)
+    @pytest.mark.parametrize('n_threads', [1, 4])
+    def test_snp_bubble_matches_streaming(self, ksize, length, graph, compactor,
+                                                snp_bubble, check_fp, tmpdir, n_threads):
+        (wild, snp), L, R = snp_bubble()
+        check_fp()
+
+        compactor.insert_sequence(wild)
+        compactor.insert_sequence(snp)
+
+        static = StaticCompactor[type(graph)].build(graph, n_threads)
+        assert static.compact([wild, snp]) == compactor.cdbg.n_unitig_nodes()
+        assert static.cdbg.n_decision_nodes() == compactor.cdbg.n_decision_nodes()
+
+        with tmpdir.as_cwd():
+            compactor.cdbg.write_fasta('streaming.fa')
+            static.cdbg.write_fasta('static.fa')
+            assert unitigs_from_fasta('static.fa') == unitigs_from_fasta('streaming.fa')
+
+    @using(ksize=21, length=100)
+    def test_fork_from_file(self, ksize, length, graph, compactor,
+                                  right_fork, check_fp, tmpdir):
+        (core, branch), pivot = right_fork()
+        check_fp()
+
+        compactor.insert_sequence(core)
+        compactor.insert_sequence(core[:pivot+1] + branch)
+
+        with tmpdir.as_cwd():
+            with open('fork.fa', 'w') as fp:
+                print('>core', core, '>branch', core[:pivot+1] + branch, sep='\n', file=fp)
+
+            static = StaticCompactor[type(graph)].build(graph, 2)
+            assert static.compact('fork.fa', 1) == 3
+            assert static.cdbg.n_decision_nodes() == 1
+            assert static.is_decision_kmer(graph.hash(core[pivot:pivot+ksize]))
+
+            compactor.cdbg.write_fasta('streaming.fa')
+            static.cdbg.write_fasta('static.fa')
+            assert unitigs_from_fasta('static.fa') == unitigs_from_fasta('streaming.fa')
+
+    @using(ksize=15, length=20)
+    def test_circular(self, ksize, length, graph, circular, check_fp):
+        sequence = circular()
+        graph.insert_sequence(sequence)
+        check_fp()
+
+        static = StaticCompactor[type(graph)].build(graph)
+        assert static.compact([sequence]) == 1
+        assert static.get_report().n_circular == 1
+
+        kmers = [sequence[i:i+ksize] for i in range(length)]
+        anchor = min(range(length), key=lambda i: graph.hash(kmers[i]).value())
+        unode = static.cdbg.query_unode_end(graph.hash(kmers[anchor]))
+        assert unode.meta == libgoetia.CIRCULAR
+        assert unode.sequence == (sequence[:length] * 3)[anchor:anchor+length+ksize-1]
+
+    @using(ksize=21, length=100, hasher_type=CanLemireShifter)
+    def test_canonical_independent_of_threads(self, ksize, length, graph, snp_bubble,
+                                                    check_fp, tmpdir):
+        from goetia.parsing import read_fastx
+        (wild, snp), L, R = snp_bubble()
+        check_fp()
+
+        def revcomp(seq):
+            return seq[::-1].translate(str.maketrans('ACGT', 'TGCA'))
+
+        # seed from both strands so that threads can walk unitigs either way
+        sequences = [wild, revcomp(snp), revcomp(wild), snp] * 4
+        graph.insert_sequence(wild)
+        graph.insert_sequence(snp)
+
+        outputs = []
+        with tmpdir.as_cwd():
+            for n_threads in (1, 4):
+                static = StaticCompactor[type(graph)].build(graph, n_threads)
+                static.compact(sequences)
+                static.cdbg.write_fasta(f'static-{n_threads}.fa')
+                outputs.append([(record.name, record.sequence)
+                                for record in read_fastx(f'static-{n_threads}.fa')])
+
+        assert outputs[0] == outputs[1]
+        for _, sequence in outputs[0]:
+            assert sequence <= revcomp(sequence)
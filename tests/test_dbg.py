@@ -334,3 +334,72 @@ def test_pdbg_get_counts(random_sequence, ksize, benchmark, partitioned_graph):
 
     counts = benchmark(graph.query_sequence, sequence)
     assert all((count > 0 for count in counts))
+
+
+def enumerate_shards(storage, n_shards, batch_size=4096):
+    shards = []
+    for shard_id in range(n_shards):
+        found = []
+        def collect(values, counts, n):
+            assert 0 < n <= batch_size
+            found.extend((values[i], counts[i]) for i in range(n))
+        storage.for_each_range_batched(n_shards, shard_id, collect, batch_size)
+        shards.append(found)
+    return shards
+
+
+@using(ksize=21, length=1000)
+@exact_backends()
+@pytest.mark.parametrize('n_shards', [1, 3, 64])
+def test_storage_for_each_range(graph, ksize, random_sequence, n_shards):
+    sequence = random_sequence()
+    graph.insert_sequence(sequence)
+    expected = set((graph.hash(kmer).value() for kmer in kmers(sequence, ksize)))
+
+    shards = enumerate_shards(graph.get_storage(), n_shards, 100)
+    found = [h for shard in shards for h, count in shard]
+    assert len(found) == len(expected)
+    assert set(found) == expected
+    assert all(count == 1 for shard in shards for h, count in shard)
+
+    single = []
+    graph.get_storage().for_each_range(1, 0, lambda h, count: single.append(h))
+    assert set(single) == expected
+
+
+@using(ksize=21, length=1000)
+@pytest.mark.parametrize('n_shards', [2, 16])
+def test_qfstorage_for_each_range(ksize, random_sequence, n_shards):
+    storage = libgoetia.QFStorage.build(12)
+    hasher = FwdLemireShifter(ksize)
+    sequence = random_sequence()
+    for kmer in kmers(sequence, ksize):
+        storage.insert(hasher.hash(kmer).value())
+    storage.insert(hasher.hash(sequence[:ksize]).value())
+
+    found = {}
+    for shard in enumerate_shards(storage, n_shards):
+        for h, count in shard:
+            assert h not in found
+            found[h] = count
+    assert len(found) == storage.n_unique_kmers()
+    assert sum(found.values()) == len(sequence) - ksize + 2
+
+
+@pytest.mark.parametrize('n_shards', [2, 4, 11])
+def test_partitioned_storage_for_each_range(n_shards):
+    pstore = libgoetia.PartitionedStorage[libgoetia.PHMapStorage](4)
+    expected = set(range(0, 40000, 7))
+    for h in expected:
+        pstore.insert(h, h % 4)
+
+    shards = enumerate_shards(pstore, n_shards)
+    found = [h for shard in shards for h, count in shard]
+    assert len(found) == len(expected)
+    assert set(found) == expected
+
+
+def test_storage_for_each_range_unsupported():
+    storage = libgoetia.BitStorage.build(1000, 4)
+    with pytest.raises(Exception):
+        storage.for_each_range(1, 0, lambda h, count: None)
@@ -0,0 +1,182 @@
+# goetia/tests/test_events.py
+# Copyright (C) 2026 Camille Scott
+# All rights reserved.
+#
+# This software may be modified and distributed under the terms
+# of the MIT license.  See the LICENSE file for details.
+
+import json
+
+import pytest
+
+from .utils import *
+from goetia import libgoetia
+
+
+def test_event_queue_fifo():
+    q = libgoetia.EventQueue[libgoetia.StreamEvent](8)
+    assert q.capacity == 8
+    for i in range(8):
+        assert q.push(libgoetia.StreamEvent(libgoetia.INTERVAL, 0, i, i))
+    assert not q.push(libgoetia.StreamEvent(libgoetia.INTERVAL, 0, 8, 8))
+    assert q.n_dropped() == 1
+
+    out = []
+    event = libgoetia.StreamEvent()
+    while q.pop(event):
+        out.append(event.t)
+    assert out == list(range(8))
+    assert q.empty()
+
+
+def test_bus_dispatch_order():
+    bus = libgoetia.StreamEventBus.build()
+    collector = libgoetia.StreamEventCollector.build()
+    bus.subscribe(collector)
+
+    bus.sample_started(3, 0, 0)
+    bus.interval(100, 10)
+    bus.sample_finished(150, 15)
+
+    # nothing is delivered until the bus is dispatched
+    assert len(collector.collect()) == 0
+    assert bus.dispatch() == 3
+
+    events = collector.collect()
+    assert [e.type for e in events] == [libgoetia.SAMPLE_STARTED,
+                                        libgoetia.INTERVAL,
+                                        libgoetia.SAMPLE_FINISHED]
+    assert all(e.sample_id == 3 for e in events)
+    assert [e.t for e in events] == [0, 100, 150]
+    assert events[0].timestamp <= events[1].timestamp <= events[2].timestamp
+    assert len(collector.collect()) == 0
+
+
+def test_bus_dispatcher_thread():
+    bus = libgoetia.StreamEventBus.build()
+    collector = libgoetia.StreamEventCollector.build()
+    bus.subscribe(collector)
+
+    bus.start()
+    assert bus.is_running()
+    for i in range(1000):
+        bus.interval(i, i)
+    bus.stop()
+
+    assert not bus.is_running()
+    assert bus.n_pending() == 0
+    assert [e.t for e in collector.collect()] == list(range(1000))
+
+
+def test_bus_synchronous_subscriber():
+    bus = libgoetia.StreamEventBus.build()
+    collector = libgoetia.StreamEventCollector.build()
+    bus.subscribe(collector, True)
+
+    bus.interval(100, 10)
+    # called on the publishing thread, without dispatching
+    assert len(collector.collect()) == 1
+
+
+def test_request_stop():
+    bus = libgoetia.StreamEventBus.build()
+    assert not bus.stop_requested()
+    bus.request_stop()
+    assert bus.stop_requested()
+    bus.sample_started(1, 0, 0)
+    assert not bus.stop_requested()
+
+
+def test_processor_publishes_intervals(graph, datadir):
+    interval = 1000
+    consumer = type(graph).Processor.build(graph, interval)
+    bus = libgoetia.StreamEventBus.build()
+    collector = libgoetia.StreamEventCollector.build()
+    bus.subscribe(collector)
+    consumer.set_event_bus(bus)
+
+    # every chunk but the last ends on an interval
+    chunks = [t for _, t, _ in consumer.chunked_process(datadir('random-20-a.fa'))]
+    bus.dispatch()
+
+    events = collector.collect()
+    assert len(events) >= len(chunks) - 1 > 0
+    assert all(e.type == libgoetia.INTERVAL for e in events)
+    assert [e.t for e in events] == chunks[:len(events)]
+
+
+def test_processor_stops_on_request(graph, datadir):
+    consumer = type(graph).Processor.build(graph, 1000)
+    bus = libgoetia.StreamEventBus.build()
+    consumer.set_event_bus(bus)
+    bus.request_stop()
+
+    n_seqs, t = consumer.process(datadir('random-20-a.fa'))
+
+    # the first interval ends the run
+    assert 1000 <= t < 2000
+
+
+def test_json_event_writer(tmpdir):
+    path = str(tmpdir.join('events.json'))
+    bus = libgoetia.StreamEventBus.build()
+    writer = libgoetia.JSONEventWriter.build(path)
+    bus.subscribe(writer)
+
+    bus.sample_started(0, 0, 0)
+    bus.interval(100, 10)
+    bus.distance_calc(100, 10, 0.5, float('nan'))
+    bus.dispatch()
+    writer.close()
+
+    with open(path) as fp:
+        events = json.load(fp)
+    assert [e['msg_type'] for e in events] == ['SampleStarted', 'Interval', 'DistanceCalc']
+    assert events[1]['t'] == 100
+    assert events[2]['distance'] == 0.5
+    assert events[2]['stat'] is None
+
+
+def test_metric_snapshotter_escapes_names(tmpdir):
+    path = str(tmpdir.join('metrics.json'))
+    bus = libgoetia.StreamEventBus.build()
+    snapshotter = libgoetia.MetricSnapshotter.build(path)
+    snapshotter.track('kmers "seen"\\total', lambda: 7.0)
+    bus.subscribe(snapshotter, True)
+
+    bus.interval(100, 10)
+    snapshotter.close()
+
+    with open(path) as fp:
+        metrics = json.load(fp)
+    assert metrics[0]['kmers "seen"\\total'] == 7.0
+
+
+def test_profile_snapshotter(graph, datadir):
+    consumer = type(graph).Processor.build(graph, 1000)
+    profiler = libgoetia.Profiler.build(True, False)
+    consumer.set_profiler(profiler)
+    bus = libgoetia.StreamEventBus.build()
+    collector = libgoetia.StreamEventCollector.build()
+    snapshotter = libgoetia.ProfileSnapshotter.build(profiler, False, True)
+    bus.subscribe(collector)
+    bus.subscribe(snapshotter, True)
+    consumer.set_event_bus(bus)
+
+    n_seqs, t = consumer.process(datadir('random-20-a.fa'))
+    bus.sample_finished(t, n_seqs)
+    bus.dispatch()
+
+    # each interval was snapshotted as it ended, so the snapshots split the
+    # sample's reads between them, however late they're collected
+    events = collector.collect()
+    intervals = [e for e in events if e.type == libgoetia.INTERVAL]
+    assert len(intervals) > 1
+    counts = [snapshotter.take(e).latencies['process']['count'] for e in intervals]
+    assert all(count > 0 for count in counts)
+    assert sum(counts) <= n_seqs
+
+    finished = snapshotter.take(events[-1]).latencies
+    assert finished['process']['count'] == n_seqs
+    # each snapshot is only given out once
+    assert len(snapshotter.take(intervals[0]).latencies) == 0
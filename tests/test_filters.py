@@ -7,8 +7,13 @@
 # Date   : 13.03.2020
 
 import filecmp
+import json
 import os
 
+import pytest
+
+from goetia import libgoetia
+from goetia.sketches import AbundanceSpectrum
 from .utils import run_shell_cmd
 
 
@@ -46,3 +51,81 @@ def test_solid_filter(datadir, tmpdir):
         print(f'Result: {open(outfile).read()}')
         assert filecmp.cmp(outfile, rfile)
 
+
+
+def insert_with_abundances(spectrum, n_distinct):
+    # k-mer i occurs (i % 4) + 1 times
+    for i in range(n_distinct):
+        for _ in range(i % 4 + 1):
+            spectrum.insert_hash(i)
+
+
+def test_abundance_spectrum_unsampled():
+    spectrum = AbundanceSpectrum.build(100000, 8)
+    insert_with_abundances(spectrum, 1000)
+
+    assert spectrum.sample_fraction() == 1.0
+    assert spectrum.n_sampled() == 1000
+    assert list(spectrum.sampled_histogram()) == [0, 250, 250, 250, 250, 0, 0, 0, 0]
+    assert list(spectrum.histogram()) == [0, 250, 250, 250, 250, 0, 0, 0, 0]
+
+
+def test_abundance_spectrum_subsampled():
+    spectrum = AbundanceSpectrum.build(2000, 8)
+    insert_with_abundances(spectrum, 100000)
+
+    assert spectrum.n_sampled() <= 2000
+    assert spectrum.sample_fraction() < 0.05
+    assert spectrum.n_kmers() == 250000
+    # sampled k-mers are counted exactly, so only whole spectrum is estimated
+    hist = list(spectrum.histogram())
+    for abundance in range(1, 5):
+        assert abs(hist[abundance] - 25000) < 0.2 * 25000
+    assert sum(hist[5:]) == 0
+
+
+def test_abundance_spectrum_merge():
+    serial = AbundanceSpectrum.build(1000, 8)
+    half_a = AbundanceSpectrum.build(1000, 8)
+    half_b = AbundanceSpectrum.build(1000, 8)
+    for i in range(20000):
+        for j in range(i % 4 + 1):
+            serial.insert_hash(i)
+            (half_a if j % 2 else half_b).insert_hash(i)
+    half_a.merge(half_b)
+
+    assert half_a.max_hash() == serial.max_hash()
+    assert list(half_a.sampled_histogram()) == list(serial.sampled_histogram())
+
+
+@pytest.mark.parametrize('n_threads', [1, 4])
+def test_abundance_spectrum_exact(n_threads):
+    storage = libgoetia.QFStorage.build(16)
+    sampled = AbundanceSpectrum.build(100000, 8)
+    for i in range(1000):
+        for _ in range(i % 10 + 1):
+            storage.insert(i * 7919)
+            sampled.insert_hash(i * 7919)
+
+    exact = list(AbundanceSpectrum.exact(storage, 8, n_threads))
+    assert exact == list(sampled.sampled_histogram())
+    assert exact[8] == 300
+
+
+def test_solid_filter_spectrum(datadir, tmpdir):
+    with tmpdir.as_cwd():
+        rfile = datadir('random-20-a.fa')
+        for storage in ('NibbleStorage', 'QFStorage'):
+            cmd = ['goetia', 'filter', 'solid', '-i', rfile, '--pairing-mode', 'single',
+                   '-K', '31', '-x', '1e6', '-S', storage, '--interval', '5',
+                   '-o', 'out.fa', '--spectrum', 'spectrum.json']
+            ret = run_shell_cmd(cmd)
+            assert ret.returncode == 0
+
+            with open('spectrum.json') as fp:
+                spectra = json.load(fp)
+            assert len(spectra) > 1
+            assert [s['seq_t'] for s in spectra] == sorted(s['seq_t'] for s in spectra)
+            # each read is new, so every k-mer is seen once
+            assert spectra[-1]['spectrum'][1] > 0
+            assert sum(spectra[-1]['spectrum'][2:]) < 0.01 * spectra[-1]['spectrum'][1]
@@ -218,6 +218,22 @@ def test_unikmer_shift_left(ksize, length, random_sequence, hasher):
         assert h.minimizer == exp_uk
 
 
+@pytest.mark.parametrize('hasher_type', [FwdUnikmerShifter, CanUnikmerShifter], indirect=True)
+def test_unikmer_batch_hasher(ksize, length, random_sequence, hasher):
+    seq = random_sequence()
+    batch_hasher = hasher.batch_hasher()
+    batch = type(hasher).batch_type()
+
+    assert batch_hasher.hash_sequence(seq, batch) == len(seq) - ksize + 1
+    assert batch.size() == len(seq) - ksize + 1
+
+    for i, kmer in enumerate(kmers(seq, ksize)):
+        exp_hash, exp_uk = get_min_unikmer(kmer, hasher.ukhs_map, type(hasher).base_shifter_type)
+        assert batch.hashes[i] == exp_hash.value, i
+        assert batch.unikmers[i] == exp_uk.value.value, i
+        assert batch.partitions[i] == exp_uk.partition, i
+
+
 @using(length=30, ksize=27)
 def test_shift_right(hasher, ksize, length, random_sequence):
     s = random_sequence()
@@ -284,6 +300,22 @@ def test_kmeriterator_from_proto(hasher, ksize, length, random_sequence):
     assert act == exp
 
 
+@pytest.mark.parametrize('hasher_type', [FwdLemireShifter, CanLemireShifter], indirect=True)
+@using(ksize=[21, 31, 51, 23, 64, 101], length=500)
+def test_hash_sequence_kernel(hasher, ksize, length, random_sequence):
+    # 21, 31 and 51 have K-specialized kernels; the rest take the generic one
+    s = random_sequence()
+
+    exp = [hasher.hash(kmer).value for kmer in kmers(s, ksize)]
+
+    act = std.vector[type(hasher).hash_type]()
+    assert hasher.hash_sequence(s, act) == len(exp)
+    assert [h.value for h in act] == exp
+    # left on the last k-mer, as a KmerIterator would leave it
+    assert hasher.get().value == exp[-1]
+    assert hasher.shift_left('A', s[-1]).value == hasher.hash('A' + s[-ksize:-1]).value
+
+
 
 @pytest.mark.parametrize('hasher_type', [FwdLemireShifter, CanLemireShifter], indirect=True)
 def test_kmeriterator_hashextender(hasher, ksize, length, random_sequence):
@@ -57,3 +57,48 @@ class TestReservoirSample:
             counts[r] = counts.get(r,0) + 1
         assert counts[7] == sample_size // 2
         assert counts[0] == sample_size - (sample_size // 2)
+
+
+class TestLatencyHistogram:
+
+    def test_small_values_exact(self):
+        H = libgoetia.LatencyHistogram()
+        for v in range(64):
+            H.record(v)
+        assert H.count() == 64
+        assert H.max() == 63
+        assert H.value_at_quantile(0.5) == 31
+        assert H.value_at_quantile(1.0) == 63
+
+    @pytest.mark.parametrize('value', [100, 1234, 99999, 10**9, 2**63 + 12345])
+    def test_relative_error(self, value):
+        H = libgoetia.LatencyHistogram()
+        H.record(value)
+        H.record(1)
+        index = H.bucket_index(value)
+        upper = H.bucket_upper_bound(index)
+        assert value <= upper
+        assert (upper - value) / value < 1 / 32
+        assert H.value_at_quantile(0.99) == value
+
+    def test_quantiles(self):
+        H = libgoetia.LatencyHistogram()
+        for v in range(1, 10001):
+            H.record(v)
+        assert H.count() == 10000
+        assert H.mean() == pytest.approx(5000.5)
+        for q in (0.5, 0.99, 0.999):
+            assert H.value_at_quantile(q) == pytest.approx(q * 10000, rel=1 / 32)
+        assert H.value_at_quantile(1.0) == 10000
+
+    def test_drain_into(self):
+        A, B = libgoetia.LatencyHistogram(), libgoetia.LatencyHistogram()
+        for v in range(100):
+            A.record(v)
+        B.record(1000)
+        A.drain_into(B)
+        assert A.count() == 0
+        assert A.max() == 0
+        assert B.count() == 101
+        assert B.max() == 1000
+        assert B.value_at_quantile(0.5) == 50
@@ -1,6 +1,7 @@
 import pytest
 
 from goetia import libgoetia
+from cppyy.gbl import std
 
 
 class TestInteriorMinimizer(object):
@@ -29,3 +30,30 @@ class TestInteriorMinimizer(object):
         for val in sequence:
             M.update(val)
         assert list(M.get_minimizer_values()) ==  [1]
+
+    @pytest.mark.parametrize('window_size', [1, 3, 8, 21])
+    def test_assign_matches_update(self, window_size):
+        import random
+        rng = random.Random(window_size)
+        # a small value range gives plenty of ties
+        sequence = [rng.randint(0, 5) for _ in range(200)]
+
+        streamed = libgoetia.InteriorMinimizer['uint64_t'](window_size)
+        for val in sequence:
+            streamed.update(val)
+
+        values = std.vector['uint64_t'](sequence)
+        bulk = libgoetia.InteriorMinimizer['uint64_t'](window_size)
+        bulk.assign(values.data(), len(values))
+
+        assert [(m.first, m.second) for m in bulk.get_minimizers()] == \
+               [(m.first, m.second) for m in streamed.get_minimizers()]
+
+    def test_minimizer_values(self):
+        sequence = [3, 1, 2, 7, 8, 4, 6, 8]
+        values = std.vector['uint64_t'](sequence)
+        out = std.vector['uint64_t']()
+
+        M = libgoetia.RollingMin['uint64_t'](3)
+        assert M.minimizer_values(values.data(), len(values), out) == 6
+        assert list(out) == [1, 1, 2, 4, 4, 4]
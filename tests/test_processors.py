@@ -70,3 +70,146 @@ def test_processor_kmer_timing(graph, ksize, length, random_fasta):
         prev_time = time
     assert n_seqs == N
     assert time == n_kmers
+
+
+def test_processor_profiler(graph, datadir):
+    from goetia import libgoetia
+
+    consumer = type(graph).Processor.build(graph, 10000)
+    profiler = libgoetia.Profiler.build()
+    consumer.set_profiler(profiler)
+    rfile = datadir('random-20-a.fa')
+
+    n_reads = 0
+    for n_reads, _, _ in consumer.chunked_process(rfile):
+        pass
+
+    interval = {scope.first: {event.first: event.second for event in scope.second}
+                for scope in profiler.take_interval()}
+    for scope in ('parse', 'validate', 'hash', 'storage_insert'):
+        assert interval[scope]['calls'] >= n_reads
+        assert 'cycles' in interval[scope]
+    assert 'compactor_update' not in interval
+
+    # taking the interval starts the next one from zero
+    assert len(profiler.take_interval()) == 0
+
+
+def test_processor_profiler_disabled(graph, datadir):
+    from goetia import libgoetia
+
+    consumer = type(graph).Processor.build(graph, 10000)
+    profiler = libgoetia.Profiler.build(False)
+    consumer.set_profiler(profiler)
+
+    consumer.process(datadir('random-20-a.fa'))
+
+    assert len(profiler.take_interval()) == 0
+
+
+def test_processor_latencies(graph, datadir):
+    from goetia import libgoetia
+
+    consumer = type(graph).Processor.build(graph, 10000)
+    profiler = libgoetia.Profiler.build(True, False)
+    consumer.set_profiler(profiler)
+    rfile = datadir('random-20-a.fa')
+
+    n_reads = 0
+    for n_reads, _, _ in consumer.chunked_process(rfile):
+        pass
+
+    def as_dict(scopes):
+        return {scope.first: {stat.first: stat.second for stat in scope.second}
+                for scope in scopes}
+
+    interval = as_dict(profiler.take_latencies())
+    for scope in ('parse', 'validate', 'process', 'hash', 'storage_insert'):
+        stats = interval[scope]
+        assert stats['count'] >= n_reads
+        assert stats['p50'] <= stats['p99'] <= stats['p999'] <= stats['max']
+        assert stats['max'] > 0
+    assert len(profiler.take_latencies()) == 0
+
+    # the sample covers every interval taken since it was last taken
+    consumer.process(rfile)
+    sample = as_dict(profiler.take_sample_latencies())
+    assert sample['process']['count'] == 2 * interval['process']['count']
+    assert len(profiler.take_sample_latencies()) == 0
+
+    # without event counting, scopes are still counted, with zero counts
+    counts = as_dict(profiler.take_interval())
+    assert counts['process']['calls'] == 2 * interval['process']['count']
+    assert counts['process']['cycles'] == 0
+
+
+def test_process_sequences(graph, datadir, ksize):
+    consumer = type(graph).Processor.build(graph, 10000)
+    rfile = datadir('random-20-a.fa')
+    sequences = [record.sequence for record in read_fastx(rfile)]
+
+    n_seqs, time = consumer.process_sequences(sequences)
+    assert n_seqs == len(sequences)
+
+    graph2 = graph.shallow_clone()
+    assert graph2.insert_sequences(sequences) == time
+    for sequence in sequences:
+        for kmer in kmers(sequence, ksize):
+            assert graph.get(kmer) == graph2.get(kmer)
+
+
+def test_process_sequences_validates(graph, ksize, random_sequence):
+    good, lower, bad = random_sequence(), random_sequence(), random_sequence()
+    bad = bad[:ksize] + 'N' + bad[ksize+1:]
+    consumer = type(graph).Processor.build(graph, 10000)
+
+    # lowercase is upper-cased, as the parser does; the N read is skipped
+    n_seqs, _ = consumer.process_sequences([good, lower.lower(), bad])
+    assert n_seqs == 2
+    for kmer in kmers(lower, ksize):
+        assert graph.get(kmer)
+    assert not graph.get(bad[:ksize])
+
+    with pytest.raises(Exception):
+        consumer.process_sequences([bad], True)
+
+    # too short
+    n_seqs, _ = consumer.process_sequences([good], False, len(good) + 1)
+    assert n_seqs == 2
+
+
+def test_process_files(graph, datadir):
+    consumer = type(graph).Processor.build(graph, 10000)
+    left, right = datadir('left.fq'), datadir('right.fq')
+
+    n_single, _ = consumer.process_files([left, right], 'single')
+    # split pairs the same files up, so it sees the same reads; the
+    # counts are running totals, as with process
+    n_total, _ = consumer.process_files([left, right], 'split')
+    assert n_total - n_single == n_single
+
+    with pytest.raises(Exception):
+        consumer.process_files([left], 'split')
+    with pytest.raises(Exception):
+        consumer.process_files([left], 'shuffled')
+
+
+def test_process_files_concurrently(graph, datadir):
+    import threading
+
+    rfile = datadir('random-20-a.fa')
+    graphs = [graph, graph.shallow_clone()]
+    results = [None, None]
+
+    def run(i):
+        consumer = type(graph).Processor.build(graphs[i], 10000)
+        results[i] = consumer.process_files([rfile] * 4)
+
+    threads = [threading.Thread(target=run, args=(i,)) for i in range(2)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+
+    assert results[0][0] == results[1][0] > 0
+    assert graphs[0].n_unique() == graphs[1].n_unique()
@@ -6,7 +6,7 @@
 # of the MIT license.  See the LICENSE file for details.
 
 from pprint import pprint
-from statistics import mean
+from statistics import mean, median
 
 import numpy as np
 import pytest
@@ -109,4 +109,55 @@ class TestSlidingCutoff:
         reached, smoothed, time = window.push(5)
         assert reached is True
         assert smoothed == 5
-        assert time == 4
\ No newline at end of file
+        assert time == 4
+
+class TestSaturationWindow:
+
+    @pytest.mark.parametrize("cutoff_name,cutoff_func", [('all', all_cutoff),
+                                                         ('median', median_cutoff)])
+    @pytest.mark.parametrize("smoothing_name,smoothing_func", [('mean', mean),
+                                                               ('median', median),
+                                                               ('stddev', np.std)])
+    def test_matches_sliding_cutoff(self, cutoff_name, cutoff_func,
+                                    smoothing_name, smoothing_func):
+        from goetia import libgoetia
+
+        rng = np.random.default_rng(42)
+        vals = list(rng.uniform(0, 1, 50))
+        native = libgoetia.SaturationWindow(4, 0.3, smoothing_name, cutoff_name)
+        python = SlidingCutoff(4, smoothing_func, cutoff_func(0.3))
+
+        for t, val in enumerate(vals):
+            status = native.push(val, t)
+            reached, smoothed, _ = python.push((val, t))
+            assert status.cutoff_reached == reached
+            if np.isnan(smoothed):
+                assert np.isnan(status.stat)
+            else:
+                assert status.stat == pytest.approx(smoothed)
+
+    def test_nan_distance_not_windowed(self):
+        from goetia import libgoetia
+
+        native = libgoetia.SaturationWindow(2, 0.5)
+        assert np.isnan(native.push(float('nan'), 0).stat)
+        assert np.isnan(native.push(1.0, 1).stat)
+        assert native.push(1.0, 2).stat == 1.0
+
+
+def test_incremental_cosine():
+    from goetia import libgoetia
+    from scipy.spatial.distance import cosine
+
+    rng = np.random.default_rng(7)
+    n = 100
+    counts = rng.integers(1, 10, n, dtype=np.uint64)
+    tracker = libgoetia.IncrementalCosine(n)
+
+    assert np.isnan(tracker.update(counts))
+    for _ in range(20):
+        prev = counts.copy()
+        changed = rng.choice(n, 10, replace=False)
+        counts[changed] += rng.integers(1, 100, 10, dtype=np.uint64)
+        distance = tracker.update(counts)
+        assert distance == pytest.approx(cosine(prev, counts), abs=1e-12)
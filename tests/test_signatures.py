@@ -10,7 +10,7 @@ import random
 
 from goetia.hashing import Canonical, StrandAware
 from goetia.parsing import read_fastx
-from goetia.sketches import SourmashSketch, UnikmerSketch
+from goetia.sketches import FracMinHash, SourmashSketch, UnikmerSketch, UnikmerSketchBuilder
 from goetia.storage import SparseppSetStorage
 from goetia.storage import HLLStorage
 
@@ -59,6 +59,45 @@ def test_sourmash_scaled(datadir, ksize):
     assert goetia_mh.similarity(sourmash_sig) == 1.0
 
 
+def test_fracminhash_matches_sourmash(datadir):
+    import sourmash
+
+    rfile = datadir('random-20-a.fa')
+    goetia_sig = FracMinHash.Sketch.build(31, 100)
+    sourmash_sig = sourmash.MinHash(0, 31, scaled=100)
+
+    processor = FracMinHash.Processor.build(goetia_sig)
+    processor.process(rfile)
+
+    for record in read_fastx(rfile):
+        sourmash_sig.add_sequence(record.sequence)
+
+    assert list(goetia_sig.mins()) == sorted(sourmash_sig.hashes)
+    assert goetia_sig.to_sourmash().similarity(sourmash_sig) == 1.0
+
+
+def test_fracminhash_sharded_merge(datadir):
+    rfile = datadir('random-20-a.fa')
+    sequences = [record.sequence for record in read_fastx(rfile)]
+
+    serial = FracMinHash.Sketch.build(31, 10)
+    for sequence in sequences:
+        serial.insert_sequence(sequence)
+
+    threaded = FracMinHash.Sketch.build(31, 10)
+    threaded.insert_sequences(cppyy.gbl.std.vector[cppyy.gbl.std.string](sequences), 4)
+
+    half_a = FracMinHash.Sketch.build(31, 10)
+    half_b = FracMinHash.Sketch.build(31, 10)
+    for i, sequence in enumerate(sequences):
+        (half_a if i % 2 else half_b).insert_sequence(sequence)
+    half_a.merge(half_b)
+
+    assert list(threaded.mins()) == list(serial.mins())
+    assert list(half_a.mins()) == list(serial.mins())
+    assert all(h <= serial.max_hash() for h in serial.mins())
+
+
 def test_draff_to_numpy(datadir):
     rfile = datadir('random-20-a.fa')
 
@@ -77,6 +116,86 @@ def test_draff_to_numpy(datadir):
         assert np_val == py_val
 
 
+def test_draff_numpy_view(datadir):
+    rfile = datadir('random-20-a.fa')
+
+    sketch_t = UnikmerSketch[SparseppSetStorage, StrandAware]
+    sketch = sketch_t.Sketch.build(31, 7)
+    view = sketch.to_numpy(copy=False)
+    assert not view.flags.writeable
+    assert view.sum() == 0
+
+    version = sketch.get_sketch_version()
+    processor = sketch_t.Processor.build(sketch)
+    processor.process(rfile)
+    assert sketch.get_sketch_version() > version
+
+    # the view tracks the sketch without being re-fetched
+    assert list(view) == list(sketch.get_sketch_as_vector())
+    assert view.sum() == sketch.get_n_kmers()
+
+    out = np.zeros(len(sketch), dtype=np.uint64)
+    assert sketch.snapshot(out) is out
+    assert list(out) == list(view)
+
+
+@pytest.mark.parametrize('storage_t', [SparseppSetStorage, HLLStorage])
+@pytest.mark.parametrize('n_threads', [1, 4])
+def test_draff_builder_matches_processor(datadir, storage_t, n_threads):
+    rfile = datadir('random-20-a.fa')
+    sketch_t = UnikmerSketch[storage_t, StrandAware]
+
+    serial = sketch_t.Sketch.build(31, 7)
+    processor = sketch_t.Processor.build(serial, 1000)
+    serial_ticks = [(n_seqs, t) for n_seqs, t, _ in processor.chunked_process(rfile)]
+
+    threaded = sketch_t.Sketch.build(31, 7)
+    builder = UnikmerSketchBuilder[storage_t, StrandAware].build(threaded, n_threads, 1000,
+                                                                 False, 64)
+    threaded_ticks = [(n_seqs, t) for n_seqs, t, _ in builder.chunked_process(rfile)]
+
+    assert threaded_ticks == serial_ticks
+    assert list(threaded.get_sketch_as_vector()) == list(serial.get_sketch_as_vector())
+    assert sorted(threaded.get_changed_partitions()) == sorted(serial.get_changed_partitions())
+
+
+@pytest.mark.parametrize('n_threads', [1, 4])
+def test_draff_builder_process_sequences(datadir, n_threads):
+    rfile = datadir('random-20-a.fa')
+    sketch_t = UnikmerSketch[SparseppSetStorage, StrandAware]
+
+    serial = sketch_t.Sketch.build(31, 7)
+    n_seqs, t = sketch_t.Processor.build(serial, 1000).process(rfile)
+
+    threaded = sketch_t.Sketch.build(31, 7)
+    builder = UnikmerSketchBuilder[SparseppSetStorage, StrandAware].build(threaded, n_threads, 1000,
+                                                                          False, 64)
+    sequences = [record.sequence for record in read_fastx(rfile)]
+    assert tuple(builder.process_sequences(sequences)) == (n_seqs, t)
+    assert list(threaded.get_sketch_as_vector()) == list(serial.get_sketch_as_vector())
+
+
+def test_draff_builder_process_sequences_validates(datadir):
+    rfile = datadir('random-20-a.fa')
+    sketch_t = UnikmerSketch[SparseppSetStorage, StrandAware]
+    sequences = [record.sequence for record in read_fastx(rfile)]
+
+    serial = sketch_t.Sketch.build(31, 7)
+    n_seqs, t = sketch_t.Processor.build(serial, 1000).process(rfile)
+
+    # a lowercased read sketches the same, and an N-containing read is skipped
+    bad = sequences[0][:40] + 'N' + sequences[0][41:]
+    sequences = [sequences[0].lower(), bad] + sequences[1:]
+    threaded = sketch_t.Sketch.build(31, 7)
+    builder = UnikmerSketchBuilder[SparseppSetStorage, StrandAware].build(threaded, 2, 1000,
+                                                                          False, 64)
+    assert tuple(builder.process_sequences(sequences)) == (n_seqs, t)
+    assert list(threaded.get_sketch_as_vector()) == list(serial.get_sketch_as_vector())
+
+    with pytest.raises(Exception):
+        builder.process_sequences([bad], True)
+
+
 def test_hllcounter():
     ints = set(np.random.randint(0, 100000, 100000))
     e = 0.01
@@ -96,6 +215,34 @@ def test_hllcounter():
     assert (act - margin) < est < (act + margin)
 
 
+def test_draff_hll_storage(datadir):
+    rfile = datadir('random-20-a.fa')
+
+    hll_t = UnikmerSketch[HLLStorage, StrandAware]
+    exact_t = UnikmerSketch[SparseppSetStorage, StrandAware]
+    hll_sketch = hll_t.Sketch.build(31, 7, storage_args=(0.01,))
+    exact_sketch = exact_t.Sketch.build(31, 7)
+    hll_t.Processor.build(hll_sketch).process(rfile)
+    exact_t.Processor.build(exact_sketch).process(rfile)
+
+    est = hll_sketch.get_n_kmers()
+    act = exact_sketch.get_n_kmers()
+    assert len(hll_sketch) == len(exact_sketch)
+    assert abs(est - act) < 0.05 * act
+
+
+def test_hllcounter_merge():
+    e = 0.01
+    a, b, union = HLLStorage(e), HLLStorage(e), HLLStorage(e)
+    for i in range(50000):
+        h = cppyy.gbl.uint64_t(i)
+        (a if i % 2 else b).insert(h)
+        union.insert(h)
+
+    a.merge(b)
+    assert a.n_unique_kmers() == union.n_unique_kmers()
+
+
 def test_sourmash_stream(tmpdir, datadir):
     with tmpdir.as_cwd():
         rfile = datadir('sacPom.pombase.fa.gz')
@@ -119,3 +266,20 @@ def test_sourmash_stream(tmpdir, datadir):
         comp = pd.read_csv(comp_file)
         assert comp.all().all()
 
+
+
+@pytest.mark.parametrize('size', [1, 3, 4, 7, 64, 1001])
+def test_sketch_cosine_kernel(size):
+    from goetia.signatures import cosine
+
+    rng = np.random.default_rng(size)
+    a = rng.integers(0, 1000, size=size, dtype=np.uint64)
+    b = rng.integers(0, 1000, size=size, dtype=np.uint64)
+    a[0], b[0] = 1, 1
+
+    x, y = a.astype(float), b.astype(float)
+    expected = 1.0 - x.dot(y) / np.sqrt(x.dot(x) * y.dot(y))
+
+    assert cosine(a, b) == pytest.approx(expected)
+    assert cosine(a, a) == pytest.approx(0.0)
+    assert np.isnan(cosine(a, np.zeros(size, dtype=np.uint64)))
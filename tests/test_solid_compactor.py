@@ -52,3 +52,30 @@ class TestFindSolidSegments:
 
         segments = solid_compactor.find_solid_segments(sequence)
         assert [tuple(segments[0])] == [(0, len(sequence))]
+
+    @using(ksize=21, length=100)
+    def test_insert_sequences_threaded(self, ksize, length, graph, compactor, solid_compactor,
+                                             min_abund, linear_path, check_fp):
+        sequence = linear_path()
+
+        solid_compactor.insert_sequences([sequence] * min_abund, 4)
+
+        segments = solid_compactor.find_solid_segments(sequence)
+        assert [tuple(segments[0])] == [(0, len(sequence))]
+        assert compactor.cdbg.n_unodes == 1
+
+    @using(ksize=21, length=100, min_abund=2)
+    @pytest.mark.parametrize('batch_size,n_threads', [(1, 1), (16, 1), (16, 4)])
+    def test_processor_batches(self, ksize, length, graph, compactor, solid_compactor,
+                                     min_abund, random_sequence, fastx_writer,
+                                     batch_size, n_threads):
+        sequences = [random_sequence() for _ in range(50)]
+        fasta = str(fastx_writer(sequences + sequences))
+
+        # counting the next batch overlaps committing this one, but every
+        # read still sees the counts from the batches before its own
+        processor_t = type(solid_compactor).Processor[libgoetia.FastxParser[libgoetia.DNA_SIMPLE]]
+        processor = processor_t.build(solid_compactor, batch_size, n_threads)
+        n_seqs, _ = processor.process(fasta)
+        assert n_seqs == 100
+        assert graph.n_unique() == 50 * (length - ksize + 1)
@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+# (c) Camille Scott, 2026
+# File   : test_superkmer_counter.py
+# License: MIT
+# Author : Camille Scott <camille.scott.w@gmail.com>
+# Date   : 18.10.2026
+
+from collections import Counter
+
+import pytest
+
+from goetia import libgoetia
+
+from .utils import *
+
+
+@pytest.fixture(params=[libgoetia.FwdLemireShifter, libgoetia.CanLemireShifter],
+                ids=['Fwd', 'Can'])
+def shifter_type(request):
+    return request.param
+
+
+def count_kmers(shifter_type, sequences, K):
+    counts = Counter()
+    for sequence in sequences:
+        for i in range(len(sequence) - K + 1):
+            counts[shifter_type.hash(sequence[i:i+K], K).value] += 1
+    return counts
+
+
+@using(ksize=21, length=500)
+@pytest.mark.parametrize('n_threads', [1, 4])
+def test_count_buckets(ksize, random_sequence, shifter_type, n_threads, tmpdir):
+    sequence = random_sequence()
+    # overlapping reads, so most k-mers are seen more than once
+    reads = [sequence[i:i+100] for i in range(0, len(sequence) - 100, 25)]
+    expected = count_kmers(shifter_type, reads, ksize)
+
+    counter_t = libgoetia.SuperKmerCounter[shifter_type]
+    spiller = counter_t.Spiller.build(ksize, 9, 8, str(tmpdir.join('skm')))
+    n_kmers = sum(spiller.insert_sequence(read) for read in reads)
+    spiller.close()
+    assert n_kmers == sum(expected.values())
+    assert spiller.n_kmers() == n_kmers
+
+    output = str(tmpdir.join('counts'))
+    n_distinct = counter_t.count_buckets[libgoetia.ByteStorage](spiller.bucket_filenames(),
+                                                                  ksize,
+                                                                  output,
+                                                                  n_threads,
+                                                                  (1000003, 4))
+    assert n_distinct == len(expected)
+
+    table = libgoetia.KmerCountTable.read(output)
+    hashes = [entry.hash for entry in table]
+    assert hashes == sorted(expected)
+    for entry in table:
+        assert entry.count == expected[entry.hash]
+
+
+@using(ksize=21, length=200)
+def test_spill_splits_on_n(ksize, random_sequence, tmpdir):
+    sequence = random_sequence()
+    counter_t = libgoetia.SuperKmerCounter[libgoetia.FwdLemireShifter]
+    spiller = counter_t.Spiller.build(ksize, 9, 4, str(tmpdir.join('skm')))
+
+    n_kmers = spiller.insert_sequence(sequence[:100] + 'N' + sequence[100:])
+    assert n_kmers == (100 - ksize + 1) + (len(sequence) - 100 - ksize + 1)
+
+
+@using(ksize=21, length=300)
+def test_merge_count_tables(ksize, random_sequence, tmpdir):
+    sequence = random_sequence()
+    counter_t = libgoetia.SuperKmerCounter[libgoetia.CanLemireShifter]
+
+    tables = []
+    for sample in range(2):
+        spiller = counter_t.Spiller.build(ksize, 9, 4, str(tmpdir.join('skm{0}'.format(sample))))
+        spiller.insert_sequence(sequence)
+        spiller.close()
+        tables.append(str(tmpdir.join('counts{0}'.format(sample))))
+        counter_t.count_buckets[libgoetia.ByteStorage](spiller.bucket_filenames(),
+                                                        ksize,
+                                                        tables[-1],
+                                                        1,
+                                                        (100003, 4))
+
+    merged = str(tmpdir.join('merged'))
+    libgoetia.KmerCountTable.merge(tables, merged)
+    single = libgoetia.KmerCountTable.read(tables[0])
+    double = libgoetia.KmerCountTable.read(merged)
+    assert [e.hash for e in single] == [e.hash for e in double]
+    for a, b in zip(single, double):
+        assert b.count == 2 * a.count
@@ -106,6 +106,19 @@ class TestLinear:
             assert walk.to_string() == contig[start:], start
             assert walk.end_state == STATES.STOP_FWD
 
+    @using(ksize=21, length=20000)
+    def test_long_unitig(self, ksize, length, linear_path, graph, consume, check_fp):
+        # long enough for the visited set to grow several times
+        contig = linear_path()
+        check_fp()
+        consume()
+
+        for _ in range(2):
+            lwalk, rwalk = graph.walk(contig[length // 2:length // 2 + ksize])
+            assert lwalk.glue(rwalk) == contig
+            assert lwalk.end_state == rwalk.end_state == STATES.STOP_FWD
+            assert len(graph.seen) == len(rwalk.path) + 1
+
     def test_circular(self, ksize, circular, graph, consume, check_fp):
         contig = circular()
         check_fp()
@@ -25,3 +25,77 @@ def test_ukhs_query(ksize):
 
         assert uhash == result.value
         assert result.partition == i
+
+
+@using(ksize=[21,31])
+def test_ukhs_query_code(ksize):
+    utype = UKHS[CanLemireShifter]
+    ukhs = utype.load(ksize, 7)
+    unikmers = utype.parse_unikmers(ksize, 7)
+    assert ukhs.has_direct_index()
+
+    for kmer in unikmers:
+        code = libgoetia.TwoBitCode.encode(kmer, 7)
+        rc_code = libgoetia.TwoBitCode.reverse_complement(code, 7)
+        partition = ukhs.query(CanLemireShifter.hash(kmer, 7)).value().partition
+
+        assert ukhs.query_code(code) == partition
+        assert ukhs.query_code(rc_code) == partition
+
+
+@using(ksize=[21,31])
+def test_ukhs_table_roundtrip(ksize, tmpdir):
+    utype = UKHS[CanLemireShifter]
+    unikmers = utype.parse_unikmers(ksize, 7)
+    ukhs = utype.build(ksize, 7, unikmers)
+
+    path = str(tmpdir.join('ukhs.table'))
+    ukhs.save(path)
+    loaded = utype.load_table(path)
+
+    assert loaded.W == ukhs.W
+    assert loaded.K == ukhs.K
+    assert loaded.n_hashes() == ukhs.n_hashes()
+    for kmer in unikmers:
+        uhash = CanLemireShifter.hash(kmer, 7)
+        assert loaded.query(uhash).value().partition == ukhs.query(uhash).value().partition
+
+    with pytest.raises(Exception):
+        utype.load_table(path, ksize - 1)
+
+
+def test_ukhs_table_cache(tmpdir, monkeypatch):
+    import os
+    from goetia.metadata import DATA_DIR
+
+    monkeypatch.setenv('XDG_CACHE_HOME', str(tmpdir))
+    before = set(os.listdir(DATA_DIR))
+
+    # not loaded by any other test, so it isn't in the in-memory cache
+    UKHS[FwdLemireShifter].load(51, 9)
+
+    # tables are built into the user's cache, never the package
+    assert set(os.listdir(DATA_DIR)) == before
+    assert 'res_9_50_4_0.ukhs' in before or \
+           tmpdir.join('goetia', 'ukhs', 'res_9_50_4_0.ukhs').exists()
+
+
+def test_ukhs_table_rejects_corrupt(tmpdir):
+    import struct
+    path = str(tmpdir.join('bad.ukhs'))
+
+    def header(K, n):
+        return b'GUKHS\0\0\0' + struct.pack('<HHHQ', 1, 20, K, n)
+
+    def load(data):
+        with open(path, 'wb') as fp:
+            fp.write(data)
+        return UKHS[FwdLemireShifter].load_table(path, 0)
+
+    assert load(header(3, 2) + struct.pack('<2Q', 5, 63)).K == 3
+    for data in (header(3, 1 << 60) + struct.pack('<Q', 5),   # more codes than 4^K
+                 header(3, 2) + struct.pack('<2Q', 5, 64),    # code of a longer k-mer
+                 header(3, 3) + struct.pack('<2Q', 5, 6),     # truncated
+                 header(33, 1) + struct.pack('<Q', 5)):       # K too large
+        with pytest.raises(Exception):
+            load(data)